@@ -80,9 +80,9 @@ int SearchInstance::succ_to_node(
 )
 {
     assert(mesh != nullptr);
-    const Polygon& polygon = mesh->mesh_polygons[parent->next_polygon];
-    const std::vector<int>& V = polygon.vertices;
-    const std::vector<int>& P = polygon.polygons;
+    const int* V = mesh->poly_vertices(parent->next_polygon);
+    const int* P = mesh->poly_neighbours(parent->next_polygon);
+    const int N = mesh->poly_sides(parent->next_polygon);
 
     double right_g = -1, left_g = -1;
 
@@ -98,7 +98,7 @@ int SearchInstance::succ_to_node(
 
         // If the successor we're about to push pushes into a one-way polygon,
         // and the polygon isn't the end polygon, just continue.
-        if (mesh->mesh_polygons[next_polygon].is_one_way &&
+        if (mesh->poly_is_one_way[next_polygon] &&
             next_polygon != end_polygon)
         {
             continue;
@@ -106,7 +106,7 @@ int SearchInstance::succ_to_node(
         const int left_vertex  = V[succ.poly_left_ind];
         const int right_vertex = succ.poly_left_ind ?
                                  V[succ.poly_left_ind - 1] :
-                                 V.back();
+                                 V[N - 1];
 
         // Note that g is evaluated twice here. (But this is a lambda!)
         // Always try to precompute before using this macro.
@@ -143,9 +143,9 @@ int SearchInstance::succ_to_node(
                 right_vertex, next_polygon, g, g};
         };
 
-        const Point& parent_root = (parent->root == -1 ?
-                                    start :
-                                    mesh->mesh_vertices[parent->root].p);
+        const Point parent_root = (parent->root == -1 ?
+                                   start :
+                                   mesh->vertex_point(parent->root));
         #define get_g(new_root) parent->g + parent_root.distance(new_root)
 
         switch (succ.type)
@@ -198,8 +198,6 @@ void SearchInstance::gen_initial_nodes()
     #define get_lazy(next, left, right) new (node_pool->allocate()) SearchNode \
         {nullptr, -1, start, start, left, right, next, h, 0}
 
-    #define v(vertex) mesh->mesh_vertices[vertex]
-
     const auto push_lazy = [&](SearchNodePtr lazy)
     {
         const int poly = lazy->next_polygon;
@@ -221,12 +219,12 @@ void SearchInstance::gen_initial_nodes()
             return;
         }
         // iterate over poly, throwing away vertices if needed
-        const std::vector<int>& vertices =
-            mesh->mesh_polygons[poly].vertices;
-        Successor* successors = new Successor [vertices.size()];
-        int last_vertex = vertices.back();
+        const int* vertices = mesh->poly_vertices(poly);
+        const int num_vertices = mesh->poly_sides(poly);
+        Successor* successors = new Successor [num_vertices];
+        int last_vertex = vertices[num_vertices - 1];
         int num_succ = 0;
-        for (int i = 0; i < (int) vertices.size(); i++)
+        for (int i = 0; i < num_vertices; i++)
         {
             const int vertex = vertices[i];
             if (vertex == lazy->right_vertex ||
@@ -236,8 +234,8 @@ void SearchInstance::gen_initial_nodes()
                 continue;
             }
             successors[num_succ++] =
-                {Successor::OBSERVABLE, v(vertex).p,
-                 v(last_vertex).p, i};
+                {Successor::OBSERVABLE, mesh->vertex_point(vertex),
+                 mesh->vertex_point(last_vertex), i};
             last_vertex = vertex;
         }
         SearchNode* nodes = new SearchNode [num_succ];
@@ -248,8 +246,8 @@ void SearchInstance::gen_initial_nodes()
         {
             SearchNodePtr n = new (node_pool->allocate())
                 SearchNode(nodes[i]);
-            const Point& n_root = (n->root == -1 ? start :
-                                   mesh->mesh_vertices[n->root].p);
+            const Point n_root = (n->root == -1 ? start :
+                                  mesh->vertex_point(n->root));
             n->f += get_h_value(n_root, goal, n->left, n->right);
             n->parent = lazy;
             #ifndef NDEBUG
@@ -310,7 +308,7 @@ void SearchInstance::gen_initial_nodes()
 
         case PointLocation::ON_NON_CORNER_VERTEX:
         {
-            for (int& poly : v(pl.vertex1).polygons)
+            for (int& poly : mesh->mesh_vertices[pl.vertex1].polygons)
             {
                 SearchNodePtr lazy = get_lazy(poly, pl.vertex1, pl.vertex1);
                 push_lazy(lazy);
@@ -329,11 +327,10 @@ void SearchInstance::gen_initial_nodes()
             break;
     }
 
-    #undef v
     #undef get_lazy
 }
 
-#define root_to_point(root) ((root) == -1 ? start : mesh->mesh_vertices[root].p)
+#define root_to_point(root) ((root) == -1 ? start : mesh->vertex_point(root))
 
 bool SearchInstance::search()
 {
@@ -378,7 +375,7 @@ bool SearchInstance::search()
 
             const int final_root = [&]()
             {
-                const Point& root = root_to_point(node->root);
+                const Point root = root_to_point(node->root);
                 const Point root_goal = goal - root;
                 // If root-left-goal is not CW, use left.
                 if (root_goal * (node->left - root) < -EPSILON)
@@ -507,8 +504,8 @@ bool SearchInstance::search()
                 n = new (node_pool->allocate()) SearchNode(cur_node);
                 n->parent = node;
             }
-            const Point& n_root = (n->root == -1 ? start :
-                                   mesh->mesh_vertices[n->root].p);
+            const Point n_root = (n->root == -1 ? start :
+                                  mesh->vertex_point(n->root));
             n->f += get_h_value(n_root, goal, n->left, n->right);
 
             #ifndef NDEBUG
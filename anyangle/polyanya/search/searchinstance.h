@@ -62,7 +62,7 @@ class SearchInstance
         {
             assert(mesh != nullptr);
             search_id = 0;
-            size_t num_vertices = mesh->mesh_vertices.size();
+            size_t num_vertices = mesh->vertex_x.size();
             root_g_values.resize(num_vertices);
             root_search_ids.resize(num_vertices);
         }
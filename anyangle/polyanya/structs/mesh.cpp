@@ -13,6 +13,7 @@ namespace polyanya
 Mesh::Mesh(std::istream& infile)
 {
     read(infile);
+    freeze();
     precalc_point_location();
 }
 
@@ -221,8 +222,48 @@ void Mesh::read(std::istream& infile)
     #undef fail
 }
 
+void Mesh::freeze()
+{
+    const int V = (int) mesh_vertices.size();
+    const int P = (int) mesh_polygons.size();
+
+    vertex_x.resize(V);
+    vertex_y.resize(V);
+    vertex_is_corner.resize(V);
+    for (int i = 0; i < V; i++)
+    {
+        vertex_x[i] = mesh_vertices[i].p.x;
+        vertex_y[i] = mesh_vertices[i].p.y;
+        vertex_is_corner[i] = mesh_vertices[i].is_corner;
+    }
+
+    poly_offsets.resize(P + 1);
+    poly_data.clear();
+    poly_is_one_way.resize(P);
+    poly_bounds.resize(P);
+    for (int i = 0; i < P; i++)
+    {
+        const Polygon& p = mesh_polygons[i];
+        poly_offsets[i] = (int) poly_data.size();
+        poly_data.insert(poly_data.end(), p.vertices.begin(),
+                         p.vertices.end());
+        poly_data.insert(poly_data.end(), p.polygons.begin(),
+                         p.polygons.end());
+        poly_is_one_way[i] = p.is_one_way;
+        poly_bounds[i] = {p.min_x, p.max_x, p.min_y, p.max_y};
+    }
+    poly_offsets[P] = (int) poly_data.size();
+}
+
 void Mesh::precalc_point_location()
 {
+    precalc_slabs();
+    precalc_grid();
+}
+
+void Mesh::precalc_slabs()
+{
+    slabs.clear();
     for (Vertex& v : mesh_vertices)
     {
         slabs[v.p.x] = std::vector<int>(0); // initialises the vector
@@ -257,6 +298,62 @@ void Mesh::precalc_point_location()
     }
 }
 
+void Mesh::precalc_grid()
+{
+    const int P = (int) mesh_polygons.size();
+    const double width = std::max(max_x - min_x, EPSILON);
+    const double height = std::max(max_y - min_y, EPSILON);
+
+    // Roughly square cells.
+    const double cell_size = std::sqrt(width * height /
+                                       (P * GRID_CELLS_PER_POLYGON));
+    grid_width = std::max(1, (int) std::ceil(width / cell_size));
+    grid_height = std::max(1, (int) std::ceil(height / cell_size));
+    grid_cell_width = width / grid_width;
+    grid_cell_height = height / grid_height;
+
+    // Count the polygons in each cell, then fill them in.
+    grid_offsets.assign(grid_width * grid_height + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            for (int c = 0; c < grid_width * grid_height; c++)
+            {
+                grid_offsets[c + 1] += grid_offsets[c];
+            }
+            grid_polys.resize(grid_offsets.back());
+        }
+        for (int i = 0; i < P; i++)
+        {
+            const BoundingBox& b = poly_bounds[i];
+            const int low = grid_cell(b.min_x - EPSILON, b.min_y - EPSILON);
+            const int high = grid_cell(b.max_x + EPSILON, b.max_y + EPSILON);
+            for (int cy = low / grid_width; cy <= high / grid_width; cy++)
+            {
+                for (int cx = low % grid_width; cx <= high % grid_width; cx++)
+                {
+                    const int c = cy * grid_width + cx;
+                    if (pass == 0)
+                    {
+                        grid_offsets[c + 1]++;
+                    }
+                    else
+                    {
+                        grid_polys[grid_offsets[c]++] = i;
+                    }
+                }
+            }
+        }
+    }
+    // Filling in moved every offset to the start of the next cell.
+    for (int c = grid_width * grid_height; c > 0; c--)
+    {
+        grid_offsets[c] = grid_offsets[c - 1];
+    }
+    grid_offsets[0] = 0;
+}
+
 // Finds out whether the polygon specified by "poly" contains point P.
 PolyContainment Mesh::poly_contains_point(int poly, Point& p)
 {
@@ -266,26 +363,28 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
     // demonstrations.wolfram.com/AnEfficientTestForAPointToBeInAConvexPolygon/
 
     // Assume points are in counterclockwise order.
-    const Polygon& poly_ref = mesh_polygons[poly];
-    if (p.x < poly_ref.min_x - EPSILON || p.x > poly_ref.max_x + EPSILON ||
-        p.y < poly_ref.min_y - EPSILON || p.y > poly_ref.max_y + EPSILON)
+    const BoundingBox& bounds = poly_bounds[poly];
+    if (p.x < bounds.min_x - EPSILON || p.x > bounds.max_x + EPSILON ||
+        p.y < bounds.min_y - EPSILON || p.y > bounds.max_y + EPSILON)
     {
         return {PolyContainment::OUTSIDE, -1, -1, -1};
     }
-    const Point& last_point_in_poly = mesh_vertices[poly_ref.vertices.back()].p;
+    const int* V = poly_vertices(poly);
+    const int* P = poly_neighbours(poly);
+    const int N = poly_sides(poly);
     const Point ZERO = {0, 0};
 
-    Point last = last_point_in_poly - p;
+    Point last = vertex_point(V[N - 1]) - p;
     if (last == ZERO)
     {
-        return {PolyContainment::ON_VERTEX, -1, poly_ref.vertices.back(), -1};
+        return {PolyContainment::ON_VERTEX, -1, V[N - 1], -1};
     }
 
-    int last_index = poly_ref.vertices.back();
-    for (int i = 0; i < (int) poly_ref.vertices.size(); i++)
+    int last_index = V[N - 1];
+    for (int i = 0; i < N; i++)
     {
-        const int point_index = poly_ref.vertices[i];
-        const Point cur = mesh_vertices[point_index].p - p;
+        const int point_index = V[i];
+        const Point cur = vertex_point(point_index) - p;
         if (cur == ZERO)
         {
             return {PolyContainment::ON_VERTEX, -1, point_index, -1};
@@ -319,7 +418,7 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
                     continue;
                 }
             }
-            return {PolyContainment::ON_EDGE, poly_ref.polygons[i],
+            return {PolyContainment::ON_EDGE, P[i],
                     point_index, last_index};
         }
 
@@ -336,7 +435,82 @@ PolyContainment Mesh::poly_contains_point(int poly, Point& p)
 }
 
 // Finds where the point P lies in the mesh.
+PointLocation Mesh::get_containment_location(
+    int polygon, const PolyContainment& result
+)
+{
+    switch (result.type)
+    {
+        case PolyContainment::INSIDE:
+            // This one strictly contains the point.
+            return {PointLocation::IN_POLYGON, polygon, -1, -1, -1};
+
+        case PolyContainment::ON_EDGE:
+            // This one lies on the edge.
+            // Chek whether the other one is -1.
+            return {
+                (result.adjacent_poly == -1 ?
+                 PointLocation::ON_MESH_BORDER :
+                 PointLocation::ON_EDGE),
+                polygon, result.adjacent_poly,
+                result.vertex1, result.vertex2
+            };
+
+        case PolyContainment::ON_VERTEX:
+            // This one lies on a corner.
+        {
+            const Vertex& v = mesh_vertices[result.vertex1];
+            if (v.is_corner)
+            {
+                if (v.is_ambig)
+                {
+                    return {PointLocation::ON_CORNER_VERTEX_AMBIG, -1, -1,
+                            result.vertex1, -1};
+                }
+                else
+                {
+                    return {PointLocation::ON_CORNER_VERTEX_UNAMBIG,
+                            polygon, -1, result.vertex1, -1};
+                }
+            }
+            else
+            {
+                return {PointLocation::ON_NON_CORNER_VERTEX,
+                        polygon, -1,
+                        result.vertex1, -1};
+            }
+        }
+
+        default:
+            // This should not be reachable
+            assert(false);
+    }
+    return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
+}
+
 PointLocation Mesh::get_point_location(Point& p)
+{
+    if (p.x < min_x - EPSILON || p.x > max_x + EPSILON ||
+        p.y < min_y - EPSILON || p.y > max_y + EPSILON)
+    {
+        return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
+    }
+    // Every polygon which could contain p is listed in its cell, in the
+    // order get_point_location_naive tries them.
+    const int cell = grid_cell(p.x, p.y);
+    for (int i = grid_offsets[cell]; i < grid_offsets[cell + 1]; i++)
+    {
+        const int polygon = grid_polys[i];
+        const PolyContainment result = poly_contains_point(polygon, p);
+        if (result.type != PolyContainment::OUTSIDE)
+        {
+            return get_containment_location(polygon, result);
+        }
+    }
+    return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
+}
+
+PointLocation Mesh::get_point_location_slab(Point& p)
 {
     if (p.x < min_x - EPSILON || p.x > max_x + EPSILON ||
         p.y < min_y - EPSILON || p.y > max_y + EPSILON)
@@ -355,8 +529,8 @@ PointLocation Mesh::get_point_location(Point& p)
         {
             // Sorts based on the midpoints.
             // If tied, sort based on width of poly.
-            const Polygon& poly = mesh_polygons[poly_index];
-            return poly.min_y + poly.max_y < y_coord * 2;
+            const BoundingBox& bounds = poly_bounds[poly_index];
+            return bounds.min_y + bounds.max_y < y_coord * 2;
         }
     );
     const int close_index = close_it - polys.begin()
@@ -373,55 +547,9 @@ PointLocation Mesh::get_point_location(Point& p)
     {
         const int polygon = polys[i];
         const PolyContainment result = poly_contains_point(polygon, p);
-        switch (result.type)
+        if (result.type != PolyContainment::OUTSIDE)
         {
-            case PolyContainment::OUTSIDE:
-                // Does not contain: try the next one.
-                break;
-
-            case PolyContainment::INSIDE:
-                // This one strictly contains the point.
-                return {PointLocation::IN_POLYGON, polygon, -1, -1, -1};
-
-            case PolyContainment::ON_EDGE:
-                // This one lies on the edge.
-                // Chek whether the other one is -1.
-                return {
-                    (result.adjacent_poly == -1 ?
-                     PointLocation::ON_MESH_BORDER :
-                     PointLocation::ON_EDGE),
-                    polygon, result.adjacent_poly,
-                    result.vertex1, result.vertex2
-                };
-
-            case PolyContainment::ON_VERTEX:
-                // This one lies on a corner.
-            {
-                const Vertex& v = mesh_vertices[result.vertex1];
-                if (v.is_corner)
-                {
-                    if (v.is_ambig)
-                    {
-                        return {PointLocation::ON_CORNER_VERTEX_AMBIG, -1, -1,
-                                result.vertex1, -1};
-                    }
-                    else
-                    {
-                        return {PointLocation::ON_CORNER_VERTEX_UNAMBIG,
-                                polygon, -1, result.vertex1, -1};
-                    }
-                }
-                else
-                {
-                    return {PointLocation::ON_NON_CORNER_VERTEX,
-                            polygon, -1,
-                            result.vertex1, -1};
-                }
-            }
-
-            default:
-                // This should not be reachable
-                assert(false);
+            return get_containment_location(polygon, result);
         }
 
 
@@ -460,61 +588,32 @@ PointLocation Mesh::get_point_location_naive(Point& p)
     for (int polygon = 0; polygon < (int) mesh_polygons.size(); polygon++)
     {
         const PolyContainment result = poly_contains_point(polygon, p);
-        switch (result.type)
+        if (result.type != PolyContainment::OUTSIDE)
         {
-            case PolyContainment::OUTSIDE:
-                // Does not contain: try the next one.
-                break;
-
-            case PolyContainment::INSIDE:
-                // This one strictly contains the point.
-                return {PointLocation::IN_POLYGON, polygon, -1, -1, -1};
-
-            case PolyContainment::ON_EDGE:
-                // This one lies on the edge.
-                // Chek whether the other one is -1.
-                return {
-                    (result.adjacent_poly == -1 ?
-                     PointLocation::ON_MESH_BORDER :
-                     PointLocation::ON_EDGE),
-                    polygon, result.adjacent_poly,
-                    result.vertex1, result.vertex2
-                };
-
-            case PolyContainment::ON_VERTEX:
-                // This one lies on a corner.
-            {
-                const Vertex& v = mesh_vertices[result.vertex1];
-                if (v.is_corner)
-                {
-                    if (v.is_ambig)
-                    {
-                        return {PointLocation::ON_CORNER_VERTEX_AMBIG, -1, -1,
-                                result.vertex1, -1};
-                    }
-                    else
-                    {
-                        return {PointLocation::ON_CORNER_VERTEX_UNAMBIG,
-                                polygon, -1, result.vertex1, -1};
-                    }
-                }
-                else
-                {
-                    return {PointLocation::ON_NON_CORNER_VERTEX,
-                            polygon, -1,
-                            result.vertex1, -1};
-                }
-            }
-
-            default:
-                // This should not be reachable
-                assert(false);
+            return get_containment_location(polygon, result);
         }
     }
     // Haven't returned yet, therefore P does not lie on the mesh.
     return {PointLocation::NOT_ON_MESH, -1, -1, -1, -1};
 }
 
+size_t Mesh::grid_mem()
+{
+    return sizeof(int) * (grid_offsets.capacity() + grid_polys.capacity());
+}
+
+size_t Mesh::slab_mem()
+{
+    // Assumes a red-black tree node has three pointers and a colour.
+    size_t out = 0;
+    for (const auto& pair : slabs)
+    {
+        out += 4 * sizeof(void*) + sizeof(pair) +
+               sizeof(int) * pair.second.capacity();
+    }
+    return out;
+}
+
 void Mesh::print(std::ostream& outfile)
 {
     outfile << "mesh with " << mesh_vertices.size() << " vertices, " \
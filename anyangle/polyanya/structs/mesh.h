@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <map>
+#include <algorithm>
 #include <memory>
 
 namespace polyanya
@@ -195,12 +196,44 @@ struct PointLocation
     }
 };
 
+struct BoundingBox
+{
+    double min_x, max_x, min_y, max_y;
+};
+
 class Mesh
 {
     private:
         std::map<double, std::vector<int>> slabs;
         double min_x, max_x, min_y, max_y;
 
+        // A uniform grid over the bounding box of the mesh, with about
+        // GRID_CELLS_PER_POLYGON cells per polygon. The polygons whose
+        // bounding boxes, grown by EPSILON, overlap cell c are
+        // grid_polys[grid_offsets[c]] to grid_polys[grid_offsets[c+1]-1],
+        // in increasing order.
+        static const int GRID_CELLS_PER_POLYGON = 1;
+        int grid_width, grid_height;
+        double grid_cell_width, grid_cell_height;
+        std::vector<int> grid_offsets;
+        std::vector<int> grid_polys;
+
+        int grid_cell(double x, double y) const
+        {
+            const int cx = std::min(grid_width - 1, std::max(0,
+                (int) ((x - min_x) / grid_cell_width)));
+            const int cy = std::min(grid_height - 1, std::max(0,
+                (int) ((y - min_y) / grid_cell_height)));
+            return cy * grid_width + cx;
+        }
+
+        void precalc_slabs();
+        void precalc_grid();
+        // Converts a result of poly_contains_point which is not OUTSIDE.
+        PointLocation get_containment_location(
+            int polygon, const PolyContainment& result
+        );
+
     public:
         Mesh() { }
         Mesh(std::istream& infile);
@@ -208,12 +241,52 @@ class Mesh
         std::vector<Polygon> mesh_polygons;
         int max_poly_sides;
 
+        // A frozen copy of the mesh, built by freeze().
+        // This is what the search reads: mesh_vertices and mesh_polygons
+        // keep one heap array per vertex and two per polygon, which
+        // get_successors would otherwise chase on every expansion.
+
+        // Vertex v is at (vertex_x[v], vertex_y[v]).
+        std::vector<double> vertex_x, vertex_y;
+        std::vector<char> vertex_is_corner;
+        // Polygon i starts at poly_data[poly_offsets[i]]: first its vertices,
+        // then the polygons across each side (in the same order as
+        // Polygon::vertices and Polygon::polygons).
+        std::vector<int> poly_offsets;
+        std::vector<int> poly_data;
+        std::vector<char> poly_is_one_way;
+        std::vector<BoundingBox> poly_bounds;
+
+        Point vertex_point(int v) const
+        {
+            return {vertex_x[v], vertex_y[v]};
+        }
+        int poly_sides(int poly) const
+        {
+            return (poly_offsets[poly + 1] - poly_offsets[poly]) >> 1;
+        }
+        const int* poly_vertices(int poly) const
+        {
+            return &poly_data[poly_offsets[poly]];
+        }
+        const int* poly_neighbours(int poly) const
+        {
+            return poly_vertices(poly) + poly_sides(poly);
+        }
+
         void read(std::istream& infile);
+        void freeze();
         void precalc_point_location();
         void print(std::ostream& outfile);
         PolyContainment poly_contains_point(int poly, Point& p);
+        // Uses the grid. Same result as get_point_location_naive.
         PointLocation get_point_location(Point& p);
+        // Uses the slabs.
+        PointLocation get_point_location_slab(Point& p);
         PointLocation get_point_location_naive(Point& p);
+        // Bytes used by each point location index.
+        size_t grid_mem();
+        size_t slab_mem();
 
         void print_polygon(std::ostream& outfile, int index);
         void print_vertex(std::ostream& outfile, int index);
@@ -48,7 +48,9 @@ void benchmark_point_lookup_single(Point test_point)
     cout << "from get_point_location." << endl;
 }
 
-void benchmark_point_lookup_average()
+void benchmark_point_lookup_average(
+    PointLocation (Mesh::*lookup)(Point&), const string& name, size_t mem
+)
 {
     clock_t t;
     Point p;
@@ -59,13 +61,14 @@ void benchmark_point_lookup_average()
         {
             p.x = x;
             p.y = y;
-            m.get_point_location(p);
+            (m.*lookup)(p);
         }
     }
     t = clock() - t;
     const double total_micro = (t/1.0/CLOCKS_PER_SEC * 1e6);
     const double average_micro = total_micro / ((MAX_X + 1) * (MAX_Y + 1));
-    cout << "Point lookup took " << average_micro << "us on average." << endl;
+    cout << "Point lookup (" << name << ", " << mem << " bytes) took "
+         << average_micro << "us on average." << endl;
 }
 
 void test_point_lookup_correct()
@@ -79,6 +82,7 @@ void test_point_lookup_correct()
         {
             Point test_point = {(double)x, (double)y};
             PointLocation pl       = m.get_point_location(test_point),
+                          pl_slab  = m.get_point_location_slab(test_point),
                           pl_naive = m.get_point_location_naive(test_point);
             // Do some checks: continue if it's the same.
             if (pl != pl_naive)
@@ -87,6 +91,12 @@ void test_point_lookup_correct()
                 cout << "Method gives " << pl << endl;
                 cout << "Naive gives " << pl_naive << endl;
             }
+            if (pl_slab != pl_naive)
+            {
+                cout << "Found discrepancy at " << test_point << endl;
+                cout << "Slabs give " << pl_slab << endl;
+                cout << "Naive gives " << pl_naive << endl;
+            }
         }
     }
 }
@@ -148,7 +158,10 @@ int main(int argc, char* argv[])
     // test_io();
     // test_containment(tp);
     test_point_lookup_correct();
-    benchmark_point_lookup_average();
+    benchmark_point_lookup_average(&Mesh::get_point_location, "grid",
+                                   m.grid_mem());
+    benchmark_point_lookup_average(&Mesh::get_point_location_slab, "slabs",
+                                   m.slab_mem());
     benchmark_point_lookup_single(tp);
     test_projection_asserts();
     test_reflection_asserts();
@@ -9,6 +9,7 @@
 
 #include "cbs.h"
 #include "cbs_ll_heuristic.h"
+#include "cbs_search.h"
 #include "cfg.h"
 #include "constants.h"
 #include "flexible_astar.h"
@@ -18,13 +19,18 @@
 #include "manhattan_heuristic.h"
 #include "mapf/plan.h"
 #include "scenario_manager.h"
+#include "sparse_reservation_table.h"
+#include "speculative_planner.h"
 #include "timer.h"
+#include "windowed_planner.h"
 #include "sipp/sipp_expansion_policy.h"
 #include "sipp/jpst_gridmap.h"
 #include "sipp/temporal_jps_expansion_policy.h"
 #include "getopt.h"
 #include "Statistic.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -39,6 +45,8 @@ Statistic g_statistic;
 
 // check computed solutions are optimal
 int checkopt = 0;
+// sipp: each planned agent is an obstacle for the agents after it
+int prioritised = 0;
 // print debugging info during search
 int verbose = 0;
 // display program help on startup
@@ -52,8 +60,24 @@ help()
 	<< "\t--scen [scenario filename]\n"
 	<< "\t--plan [plan filename (existing plan describing paths of higher priority agents)]\n"
 	<< "\t--verbose (optional)\n"
+	<< "\t--agents [int] (optional; cbs and lifelong only. plan the first [int]\n"
+	<< "\t          instances of the scenario file. default=all)\n"
+	<< "\t--prioritised (optional; sipp only. each agent avoids the paths of the\n"
+	<< "\t          agents planned before it)\n"
+	<< "\t--threads [int] (optional; cbs and sipp only. number of worker threads.\n"
+	<< "\t          default=1)\n"
+	<< "\t--tables [int] (optional; cbs and lifelong only. maximum number of\n"
+	<< "\t          heuristic tables kept in memory. default=all)\n"
+	<< "\t--window [int] (optional; lifelong only. timesteps ahead for which\n"
+	<< "\t          collisions are resolved. default=10)\n"
+	<< "\t--period [int] (optional; lifelong only. timesteps executed between\n"
+	<< "\t          replanning steps; at most --window. default=5)\n"
+	<< "\t--timesteps [int] (optional; lifelong only. length of the\n"
+	<< "\t          simulation. default=500)\n"
+	<< "\t--task-rate [float] (optional; lifelong only. tasks arriving per\n"
+	<< "\t          timestep. default=0, i.e. whenever an agent is free)\n"
     << "\nRecognised values for --alg:\n"
-    << "\tcbs_ll, jpst, sipp\n";
+    << "\tcbs, cbs_ll, jpst, lifelong, sipp\n";
 }
 
 
@@ -82,72 +106,19 @@ run_sipp(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
     auto add_higher_priority_plan = 
     [&sipp_map, &expander](warthog::solution& sol) -> void
     {
-        for(uint32_t i = 0; i < sol.path_.size(); i++)
+        // each location on the path is blocked until the agent moves
+        // away; agents occupy their target location for one timestep
+        // then disappear (DIFFERENT FROM STANDARD MAPF!!)
+        sipp_map.add_path(sol.path_);
+        if(verbose)
         {
-            int32_t x, y;
-            expander.get_xy(sol.path_.at(i), x, y);
-
-            uint32_t xy_id = (uint32_t)(sol.path_.at(i));
-            warthog::cost_t timestep = (sol.path_.at(i) >> 32);
-
-            if(xy_id == (uint32_t)sol.path_.back()) 
-            { 
-                // agents occupy their target location for one 
-                // timestep then disappear (DIFFERENT FROM STANDARD MAPF!!)
-                sipp_map.add_obstacle( (uint32_t)x, (uint32_t)y, 
-                    timestep, timestep+1, warthog::cbs::move::WAIT);
-
-                if(verbose)
-                {
-                    std::cerr  << " add obstacle: " << xy_id 
-                               << " (" << x << ", " << y << ") @ "
-                               << "(" << timestep << ", " << timestep+1 << ") "
-                               << " dir " << warthog::cbs::WAIT << std::endl;
-                }
-                break;
-            }
-
-            int32_t nx, ny;
-            expander.get_xy((uint32_t)sol.path_.at(i+1), nx, ny);
-            warthog::cost_t timestep_next = (sol.path_.at(i+1) >> 32);
-            assert(nx == x || ny == y);
-
-            // impute the next move from xy locations of nodes on the path
-            warthog::cbs::move direction = warthog::cbs::move::WAIT;
-            //if(nx == x && ny == y) {  direction = warthog::cbs::move::WAIT; }
-            if(nx == x && ny < y) {  direction = warthog::cbs::move::NORTH; }
-            if(nx == x && ny > y) {  direction = warthog::cbs::move::SOUTH; }
-            if(nx < x && ny == y) {  direction = warthog::cbs::move::WEST; }
-            if(nx > x && ny == y) {  direction = warthog::cbs::move::EAST; }
-
-            sipp_map.add_obstacle(
-                (uint32_t)x, (uint32_t)y, timestep, timestep_next, direction);
-
-            if(verbose)
+            for(uint32_t i = 0; i < sol.path_.size(); i++)
             {
-                std::cerr  << " add obstacle: " << xy_id << 
-                           " (" << x << ", " << y << ") @ "
-                           << "(" << timestep << ", " << timestep_next << ") "
-                           << " dir " << warthog::cbs::WAIT << std::endl;
+                int32_t x, y;
+                expander.get_xy(sol.path_.at(i), x, y);
+                std::cerr  << " add obstacle: (" << x << ", " << y << ") @ " 
+                           << (sol.path_.at(i) >> 32) << std::endl;
             }
-
-            //if(i == (sol.path_.size()-2))
-            //{
-            //    // after arriving, agents block their target 
-            //    // location indefinitely 
-            //    start_time = end_time;
-            //    end_time = warthog::COST_MAX;
-            //    sipp_map.add_obstacle( (uint32_t)nx, (uint32_t)ny, 
-            //        end_time, end_time+1, warthog::cbs::move::WAIT);
-            //    if(verbose)
-            //    {
-            //        std::cerr 
-            //            << "add obstacle: (" << nx << ", " << ny 
-            //            << ") @ (" << start_time << ", " << end_time
-            //            << ") dir WAIT" << std::endl;
-            //    }
-            //    break;
-            //}
         }
     };
 
@@ -178,6 +149,15 @@ run_sipp(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
 
         //if(i == 621) { pi.verbose_ = true; }
         astar.get_path(pi, sol);
+
+        // with prioritised planning the path is made into obstacles,
+        // which need the time of every step
+        if(prioritised && sol.path_.size() > 0)
+        {
+            std::vector<warthog::sn_id_t> ti_path;
+            expander.get_time_indexed_path(sol.path_, ti_path);
+            sol.path_.swap(ti_path);
+        }
 		std::cout
             << i<<"\t" 
             << alg_name << "\t" 
@@ -196,7 +176,10 @@ run_sipp(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
 
          // all subsequent agents need to avoid locations on the
          // newly found plan (i.e. we perform prioritised planning)
-         // add_higher_priority_plan(sol);
+         if(prioritised && sol.path_.size() > 0)
+         {
+             add_higher_priority_plan(sol);
+         }
 
          // load plans of higher priority agents (if any) and block their
          // temporal locations to avoid collisions
@@ -222,9 +205,9 @@ run_sipp(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
     uint32_t map_sz = sipp_map.gm_->header_height() * sipp_map.gm_->header_width();
     for(uint32_t i = 0; i < map_sz; i++)
     {
-        max_intervals = sipp_map.get_all_intervals(i).size() > max_intervals ? 
-                        sipp_map.get_all_intervals(i).size() : max_intervals;
-        tot_intervals += sipp_map.get_all_intervals(i).size();
+        max_intervals = std::max<size_t>(
+                max_intervals, sipp_map.get_num_intervals(i));
+        tot_intervals += sipp_map.get_num_intervals(i);
     }
 
     std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
@@ -238,12 +221,91 @@ run_sipp(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
 	std::cerr << "avg sipp intervals per node: "<< tot_intervals / (double)map_sz << "\n";
 }
 
+// as run_sipp, but agents are planned speculatively by @param num_threads
+// threads (see mapf/speculative_planner.h). the results are the same.
+void
+run_sipp_parallel(warthog::scenario_manager& scenmgr, std::string alg_name, 
+        std::string plan_file, uint32_t num_threads)
+{
+    warthog::gridmap gm(scenmgr.get_experiment(0)->map().c_str());
+    warthog::mapf::speculative_planner planner(&gm, num_threads);
+    planner.set_prioritised(prioritised);
+
+    warthog::mapf::plan hoplan; 
+    if(plan_file != "")
+    {
+        std::ifstream ifs(plan_file);
+        ifs >> hoplan;
+        ifs.close();
+    }
+
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> targets;
+	for(unsigned int i=0; i < scenmgr.num_experiments(); i++)
+	{
+		warthog::experiment* exp = scenmgr.get_experiment(i);
+		starts.push_back(exp->starty() * exp->mapwidth() + exp->startx());
+		targets.push_back(exp->goaly() * exp->mapwidth() + exp->goalx());
+    }
+
+    warthog::mapf::plan theplan;
+    planner.solve(starts, targets, hoplan, theplan.paths_);
+
+    std::cout 
+        << "id\talg\texpanded\ttouched\treopen\tsurplus\theapops"
+        << "\tnanos\tpcost\tplen\tmap\n";
+	for(unsigned int i=0; i < theplan.paths_.size(); i++)
+	{
+        warthog::solution& sol = theplan.paths_.at(i);
+		std::cout
+            << i<<"\t" 
+            << alg_name << "\t" 
+            << sol.nodes_expanded_ << "\t" 
+            << sol.nodes_touched_ << "\t"
+            << sol.nodes_reopen_ << "\t"
+            << sol.nodes_surplus_ << "\t"
+            << sol.heap_ops_ << "\t"
+            << sol.time_elapsed_nano_ << "\t"
+            << sol.sum_of_edge_costs_ << "\t" 
+            << (sol.path_.size()-1) << "\t" 
+            << scenmgr.last_file_loaded() 
+            << std::endl;
+    }
+
+    // some extra info about sipp's performance
+    warthog::sipp_gridmap* sipp_map = planner.get_sipp_map();
+    size_t max_intervals = 0;
+    size_t tot_intervals = 0;
+    uint32_t map_sz = gm.header_height() * gm.header_width();
+    for(uint32_t i = 0; i < map_sz; i++)
+    {
+        max_intervals = std::max<size_t>(
+                max_intervals, sipp_map->get_num_intervals(i));
+        tot_intervals += sipp_map->get_num_intervals(i);
+    }
+
+    std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
+    std::cerr  << "writing plan to " << tmp_planfile << std::endl;
+    std::ofstream ofs(tmp_planfile);
+    ofs << theplan;
+    ofs.close();
+	std::cerr << "done. \n";
+	std::cerr << "threads: " << planner.get_num_threads() 
+        << " searches: " << planner.get_searches()
+        << " discarded: " << planner.get_discarded()
+        << " wall time (s): " << planner.get_time_elapsed_nano() / 1e9 << "\n";
+	std::cerr << "total memory: "<< planner.mem() + scenmgr.mem() << "\n";
+	std::cerr << "max sipp intervals per node: "<< max_intervals << "\n";
+	std::cerr << "avg sipp intervals per node: "<< tot_intervals / (double)map_sz << "\n";
+}
+
 void
 run_jpst(warthog::scenario_manager& scenmgr, std::string alg_name, std::string plan_file)
 {
     warthog::gridmap gm(scenmgr.get_experiment(0)->map().c_str());
     warthog::manhattan_heuristic heuristic(gm.header_width(), gm.header_height());
     warthog::jpst_gridmap jpst_gm(&gm);
+    jpst_gm.enable_jump_cache();
     warthog::temporal_jps_expansion_policy expander(&jpst_gm);
     warthog::pqueue_min open;
 
@@ -262,72 +324,19 @@ run_jpst(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
     auto add_higher_priority_plan = 
     [&jpst_gm, &expander](warthog::solution& sol) -> void
     {
-        for(uint32_t i = 0; i < sol.path_.size(); i++)
+        // each location on the path is blocked until the agent moves
+        // away; agents occupy their target location for one timestep
+        // then disappear (DIFFERENT FROM STANDARD MAPF!!)
+        jpst_gm.add_path(sol.path_);
+        if(verbose)
         {
-            int32_t x, y;
-            expander.get_xy(sol.path_.at(i), x, y);
-
-            uint32_t xy_id = (uint32_t)(sol.path_.at(i));
-            warthog::cost_t timestep = (sol.path_.at(i) >> 32);
-
-            if(xy_id == (uint32_t)sol.path_.back()) 
-            { 
-                // agents occupy their target location for one 
-                // timestep then disappear (DIFFERENT FROM STANDARD MAPF!!)
-                jpst_gm.add_obstacle( (uint32_t)x, (uint32_t)y, 
-                    timestep, timestep+1, warthog::cbs::move::WAIT);
-
-                if(verbose)
-                {
-                    std::cerr  << " add obstacle: " << xy_id 
-                               << " (" << x << ", " << y << ") @ "
-                               << "(" << timestep << ", " << timestep+1 << ") "
-                               << " dir " << warthog::cbs::WAIT << std::endl;
-                }
-
-                break;
-            }
-
-            int32_t nx, ny;
-            expander.get_xy(sol.path_.at(i+1), nx, ny);
-            warthog::cost_t timestep_next = (sol.path_.at(i+1) >> 32);
-            assert(nx == x || ny == y);
-
-            // impute the next move from xy locations of nodes on the path
-            warthog::cbs::move direction = warthog::cbs::move::WAIT;
-            //if(nx == x && ny == y) {  direction = warthog::cbs::move::WAIT; }
-            if(nx == x && ny < y) {  direction = warthog::cbs::move::NORTH; }
-            if(nx == x && ny > y) {  direction = warthog::cbs::move::SOUTH; }
-            if(nx < x && ny == y) {  direction = warthog::cbs::move::WEST; }
-            if(nx > x && ny == y) {  direction = warthog::cbs::move::EAST; }
-
-            jpst_gm.add_obstacle(
-                (uint32_t)x, (uint32_t)y, timestep, timestep_next, direction);
-
-            if(verbose)
+            for(uint32_t i = 0; i < sol.path_.size(); i++)
             {
-                std::cerr  << " add obstacle: (" << x << ", " << y << ") @ (" 
-                           << timestep << ", " << timestep_next << ") dir " 
-                           << direction << std::endl;
+                int32_t x, y;
+                expander.get_xy(sol.path_.at(i), x, y);
+                std::cerr  << " add obstacle: (" << x << ", " << y << ") @ " 
+                           << (sol.path_.at(i) >> 32) << std::endl;
             }
-
-            //if(i == (sol.path_.size()-2))
-            //{
-            //    // after arriving, agents block their target 
-            //    // location indefinitely 
-            //    start_time = end_time;
-            //    end_time = warthog::COST_MAX;
-            //    jpst_gm.add_obstacle( (uint32_t)nx, (uint32_t)ny, 
-            //        end_time, end_time+1, warthog::cbs::move::WAIT);
-            //    if(verbose)
-            //    {
-            //        std::cerr 
-            //            << "add obstacle: (" << nx << ", " << ny 
-            //            << ") @ (" << start_time << ", " << end_time
-            //            << ") dir WAIT" << std::endl;
-            //    }
-            //    break;
-            //}
         }
     };
 
@@ -387,9 +396,9 @@ run_jpst(warthog::scenario_manager& scenmgr, std::string alg_name, std::string p
     uint32_t map_sz = jpst_gm.gm_->header_height() * jpst_gm.gm_->header_width();
     for(uint32_t i = 0; i < map_sz; i++)
     {
-        max_intervals = jpst_gm.get_all_intervals(i).size() > max_intervals ? 
-                        jpst_gm.get_all_intervals(i).size() : max_intervals;
-        tot_intervals += jpst_gm.get_all_intervals(i).size();
+        max_intervals = std::max<size_t>(
+                max_intervals, jpst_gm.get_num_intervals(i));
+        tot_intervals += jpst_gm.get_num_intervals(i);
     }
 
     std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
@@ -411,6 +420,10 @@ run_cbs_ll(warthog::scenario_manager& scenmgr, std::string alg_name)
 	warthog::cbs_ll_expansion_policy expander(&gm, &heuristic);
     warthog::pqueue_min open;
 
+    // the paths of previously planned agents
+    warthog::sparse_reservation_table restab;
+    expander.set_reservation_table(&restab);
+
 	warthog::flexible_astar<
 		warthog::cbs_ll_heuristic,
 	   	warthog::cbs_ll_expansion_policy,
@@ -448,70 +461,274 @@ run_cbs_ll(warthog::scenario_manager& scenmgr, std::string alg_name)
 
         // the path of the agent now becomes an obstacle for 
         // the next agent. We assume that agents reach their
-        // target and then disappear after one unit of time
-        for(uint32_t i = 0; i < sol.path_.size(); i++)
+        // target and then disappear after one unit of time.
+        // the moves of the agent are reserved too, which keeps
+        // other agents from swapping positions with it
+        // (i.e. prevents edge collisions)
+        restab.reserve_path(sol.path_);
+        if(verbose)
         {
-            int32_t x, y;
-            uint32_t xy_id = (uint32_t)sol.path_.back();
-            uint32_t timestep = (uint32_t)(sol.path_.at(i) >> 32);
-            expander.get_xy((uint32_t)sol.path_.back(), x, y);
-            if((uint32_t)sol.path_.at(i) == (uint32_t)sol.path_.back()) 
-            { 
-                expander.get_constraint(xy_id)->v_ = true;
-                if(verbose)
-                {
-                    std::cerr << "add obstacle (" << x << ", " << y << ") @ " << i << std::endl;
-                }
-                break;
+            for(uint32_t j = 0; j < sol.path_.size(); j++)
+            {
+                int32_t x, y;
+                expander.get_xy(sol.path_.at(j), x, y);
+                std::cerr << "add obstacle (" << x << ", " << y << ") @ " 
+                          << j << std::endl;
             }
+        }
+
+        theplan.paths_.push_back(sol);
+
+	}
+    std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
+    std::cerr  << "writing plan to " << tmp_planfile << std::endl;
+    std::ofstream ofs(tmp_planfile);
+    ofs << theplan;
+    ofs.close();
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() 
+        + restab.mem() << "\n";
+}
+
+// run conflict-based search; each instance is an agent. all agents are
+// planned together and the resulting plan is free of collisions.
+void
+run_cbs(warthog::scenario_manager& scenmgr, std::string alg_name,
+        uint32_t num_agents, uint32_t num_threads, uint32_t max_tables)
+{
+    warthog::gridmap gm(scenmgr.get_experiment(0)->map().c_str());
+    warthog::cbs::cbs_search cbs(&gm, num_threads, max_tables);
+
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> targets;
+    for(uint32_t i = 0; i < num_agents; i++)
+    {
+		warthog::experiment* exp = scenmgr.get_experiment(i);
+		starts.push_back(exp->starty() * exp->mapwidth() + exp->startx());
+		targets.push_back(exp->goaly() * exp->mapwidth() + exp->goalx());
+    }
+
+    warthog::mapf::plan theplan;
+    bool solved = cbs.solve(starts, targets, theplan);
+
+    warthog::cost_t soc = 0;
+    size_t makespan = 0;
+    for(warthog::solution& sol : theplan.paths_)
+    {
+        soc += sol.sum_of_edge_costs_;
+        makespan = std::max(makespan, sol.path_.size() - 1);
+    }
+    double nanos = cbs.get_time_elapsed_nano();
+
+    std::cout 
+        << "alg\tagents\tthreads\tsolved\tct_expanded\tct_generated"
+        << "\tll_searches\tll_expanded\tnanos\tct_per_sec\tsoc\tmakespan"
+        << "\tmap\n";
+    std::cout
+        << alg_name << "\t"
+        << num_agents << "\t"
+        << cbs.get_num_threads() << "\t"
+        << solved << "\t"
+        << cbs.get_ct_expanded() << "\t"
+        << cbs.get_ct_generated() << "\t"
+        << cbs.get_ll_searches() << "\t"
+        << cbs.get_ll_expanded() << "\t"
+        << nanos << "\t"
+        << (nanos > 0 ? cbs.get_ct_expanded() / (nanos / 1e9) : 0) << "\t"
+        << soc << "\t"
+        << makespan << "\t"
+        << scenmgr.last_file_loaded() 
+        << std::endl;
+
+    if(!solved) { return; }
+
+    warthog::cbs::cbs_conflict conflict;
+    if(cbs.find_conflicts(theplan, conflict))
+    {
+        std::cerr << "err; plan has a conflict between agents "
+            << conflict.a1_ << " and " << conflict.a2_ << " at time "
+            << conflict.timestep_ << "\n";
+        exit(1);
+    }
+
+    std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
+    std::cerr  << "writing plan to " << tmp_planfile << std::endl;
+    std::ofstream ofs(tmp_planfile);
+    ofs << theplan;
+    ofs.close();
+	std::cerr << "done. total memory: "<< cbs.mem() + scenmgr.mem() << "\n";
+}
+
+// lifelong MAPF with rolling-horizon planning. agent i starts at the
+// start location of the ith instance. tasks are the goals of the 
+// instances, in order (wrapping around). they arrive at a rate of 
+// @param task_rate per timestep, or whenever an agent is free if the
+// rate is 0. every @param period timesteps, free agents take the oldest
+// waiting tasks and the agents that need it are replanned (collisions
+// are resolved @param window timesteps ahead).
+void
+run_lifelong(warthog::scenario_manager& scenmgr, std::string alg_name,
+        uint32_t num_agents, uint32_t window, uint32_t period, 
+        uint32_t num_timesteps, double task_rate, uint32_t max_tables)
+{
+    warthog::gridmap gm(scenmgr.get_experiment(0)->map().c_str());
+    warthog::mapf::windowed_planner planner(&gm, window, max_tables);
+    for(uint32_t i = 0; i < num_agents; i++)
+    {
+		warthog::experiment* exp = scenmgr.get_experiment(i);
+		planner.add_agent(exp->starty() * exp->mapwidth() + exp->startx());
+    }
+
+    // the task of each agent (UINT32_MAX if free) and the arrival time
+    // of each task
+    std::vector<uint32_t> task(num_agents, UINT32_MAX);
+    std::vector<uint32_t> arrival;
+    uint32_t next_task = 0;
+    std::deque<uint32_t> waiting;
+
+    uint64_t completed = 0;
+    std::vector<double> latency;
+    std::vector<uint32_t> service_time;
+    double total_nanos = 0;
+
+    std::cout 
+        << "timestep\talg\tagents\treplanned\ttrapped\tll_expanded"
+        << "\tnanos\tcompleted\tmap\n";
+    while(planner.get_timestep() < num_timesteps)
+    {
+        uint32_t now = planner.get_timestep();
 
-            int32_t nx, ny;
-            expander.get_xy(sol.path_.at(i+1), nx, ny);
+        // newly arrived tasks wait in a queue; free agents take the 
+        // oldest ones
+        while(task_rate > 0 && next_task / task_rate <= now)
+        {
+            waiting.push_back(next_task++);
+            arrival.push_back(now);
+        }
+        for(uint32_t i = 0; i < num_agents; i++)
+        {
+            if(task[i] != UINT32_MAX) { continue; }
+            if(task_rate == 0) 
+            { 
+                waiting.push_back(next_task++); 
+                arrival.push_back(now);
+            }
+            if(waiting.empty()) { break; }
+            task[i] = waiting.front();
+            waiting.pop_front();
+            warthog::experiment* exp = 
+                scenmgr.get_experiment(task[i] % scenmgr.num_experiments());
+            planner.set_goal(i, exp->goaly() * exp->mapwidth() + exp->goalx());
+        }
 
-            // block each cell occupied by the agent
-            expander.get_constraint(xy_id)->v_ = true;
-            if(verbose)
+        uint64_t trapped = planner.get_num_trapped();
+        uint64_t expanded = planner.get_ll_expanded();
+        warthog::timer mytimer;
+        mytimer.start();
+        uint32_t replanned = planner.replan(now + period);
+        mytimer.stop();
+        latency.push_back(mytimer.elapsed_time_nano());
+        total_nanos += mytimer.elapsed_time_nano();
+
+        for(uint32_t j = 0; 
+            j < period && planner.get_timestep() < num_timesteps; j++)
+        {
+            planner.step();
+            for(uint32_t i = 0; i < num_agents; i++)
             {
-                std::cerr << "add obstacle (" << x << ", " << y << ") @ " 
-                          << i << std::endl;
+                if(task[i] == UINT32_MAX || !planner.at_goal(i)) { continue; }
+                service_time.push_back(
+                        planner.get_timestep() - arrival.at(task[i]));
+                task[i] = UINT32_MAX;
+                completed++;
             }
-            assert(expander.get_constraint(xy_id)->v_);
+        }
+
+        std::cout
+            << now << "\t"
+            << alg_name << "\t"
+            << num_agents << "\t"
+            << replanned << "\t"
+            << planner.get_num_trapped() - trapped << "\t"
+            << planner.get_ll_expanded() - expanded << "\t"
+            << latency.back() << "\t"
+            << completed << "\t"
+            << scenmgr.last_file_loaded()
+            << std::endl;
+    }
 
-            // block any other agent from swapping positions with the agent
-            // (i.e. prevent edge collisions) 
-            if(nx !=  x || ny != y)
+    // executed paths must be free of collisions
+    warthog::mapf::plan theplan;
+    theplan.paths_.resize(num_agents);
+    std::unordered_map<uint32_t, uint32_t> occupant;
+    for(uint32_t t = 0; t <= num_timesteps; t++)
+    {
+        occupant.clear();
+        for(uint32_t i = 0; i < num_agents; i++)
+        {
+            uint32_t xy_id = (uint32_t)planner.get_trajectory(i).at(t);
+            auto it = occupant.find(xy_id);
+            if(it != occupant.end())
             {
-                // compute the opposite direction
-                warthog::cbs::move direction = warthog::cbs::WAIT;
-                if(nx == x && ny < y) {  direction = warthog::cbs::move::SOUTH; }
-                if(nx == x && ny > y) {  direction = warthog::cbs::move::NORTH; }
-                if(nx < x && ny == y) {  direction = warthog::cbs::move::EAST; }
-                if(nx > x && ny == y) {  direction = warthog::cbs::move::WEST; }
-
-                // place a constraint that forbids moving in the opposite
-                // direction to the agent. the constraint is placed on the 
-                // tile corresponding to the kth xy location on the path but
-                // at one timestep earlier than the arrival of the current agent
-                uint32_t n_xy_id = sol.path_.at(i+1);
-                warthog::sn_id_t block_id = ((uint64_t)timestep << 32) | n_xy_id;
-                expander.get_constraint(block_id)->e_ 
-                    |= (uint8_t)(1 << direction);
+                std::cerr << "err; agents " << it->second << " and " << i 
+                    << " collide at time " << t << "\n";
+                exit(1);
             }
+            occupant[xy_id] = i;
         }
+        if(t == 0) { continue; }
+        for(uint32_t i = 0; i < num_agents; i++)
+        {
+            uint32_t prev_xy_id = (uint32_t)planner.get_trajectory(i).at(t-1);
+            auto it = occupant.find(prev_xy_id);
+            if(it != occupant.end() && it->second != i &&
+               (uint32_t)planner.get_trajectory(it->second).at(t-1) == 
+               (uint32_t)planner.get_trajectory(i).at(t))
+            {
+                std::cerr << "err; agents " << it->second << " and " << i 
+                    << " swap places at time " << t << "\n";
+                exit(1);
+            }
+        }
+    }
+    for(uint32_t i = 0; i < num_agents; i++)
+    {
+        theplan.paths_[i].path_ = planner.get_trajectory(i);
+    }
 
-        theplan.paths_.push_back(sol);
+    auto percentile = [](std::vector<double> values, double p) -> double
+    {
+        if(values.empty()) { return 0; }
+        std::sort(values.begin(), values.end());
+        size_t index = (size_t)std::ceil(p * values.size());
+        return values.at(index == 0 ? 0 : index - 1);
+    };
+    std::vector<double> service(service_time.begin(), service_time.end());
 
-	}
     std::string tmp_planfile = scenmgr.last_file_loaded() + "." + alg_name + ".plan";
     std::cerr  << "writing plan to " << tmp_planfile << std::endl;
     std::ofstream ofs(tmp_planfile);
     ofs << theplan;
     ofs.close();
-	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+    std::cerr 
+        << "tasks completed: " << completed << " in " << num_timesteps 
+        << " timesteps (" << completed / (double)num_timesteps 
+        << " per timestep)\n"
+        << "planning time: " << total_nanos / 1e9 << "s ("
+        << (total_nanos > 0 ? completed / (total_nanos / 1e9) : 0)
+        << " tasks per second)\n"
+        << "planning latency (ms): p50 " << percentile(latency, 0.5) / 1e6
+        << " p90 " << percentile(latency, 0.9) / 1e6
+        << " p99 " << percentile(latency, 0.99) / 1e6
+        << " max " << percentile(latency, 1) / 1e6 << "\n"
+        << "task service time (timesteps): p50 " << percentile(service, 0.5)
+        << " p90 " << percentile(service, 0.9)
+        << " p99 " << percentile(service, 0.99)
+        << " max " << percentile(service, 1) << "\n"
+        << "trapped agents: " << planner.get_num_trapped() 
+        << " low-level searches: " << planner.get_ll_searches() << "\n";
+	std::cerr << "done. total memory: "<< planner.mem() + scenmgr.mem() << "\n";
 }
 
-
-
 int 
 main(int argc, char** argv)
 {
@@ -524,7 +741,15 @@ main(int argc, char** argv)
 		{"help", no_argument, &print_help, 1},
 		{"checkopt",  no_argument, &checkopt, 1},
 		{"verbose",  no_argument, &verbose, 1},
+		{"prioritised",  no_argument, &prioritised, 1},
 		{"format",  required_argument, 0, 1},
+		{"agents",  required_argument, 0, 1},
+		{"threads",  required_argument, 0, 1},
+		{"tables",  required_argument, 0, 1},
+		{"window",  required_argument, 0, 1},
+		{"period",  required_argument, 0, 1},
+		{"timesteps",  required_argument, 0, 1},
+		{"task-rate",  required_argument, 0, 1},
 		{0,  0, 0, 0}
 	};
 
@@ -551,13 +776,67 @@ main(int argc, char** argv)
 	warthog::scenario_manager scenmgr;
 	scenmgr.load_scenario(sfile.c_str());
 
-    if(alg == "cbs_ll")
+    if(alg == "cbs")
+    {
+        uint32_t num_agents = scenmgr.num_experiments();
+        std::string agents = cfg.get_param_value("agents");
+        if(agents != "")
+        {
+            num_agents = std::min<uint32_t>(
+                    num_agents, (uint32_t)std::stoul(agents));
+        }
+        std::string threads = cfg.get_param_value("threads");
+        uint32_t num_threads = threads == "" ? 1 : (uint32_t)std::stoul(threads);
+        std::string tables = cfg.get_param_value("tables");
+        uint32_t max_tables = 
+            tables == "" ? UINT32_MAX : (uint32_t)std::stoul(tables);
+        run_cbs(scenmgr, alg, num_agents, num_threads, max_tables);
+    }
+    else if(alg == "lifelong")
+    {
+        uint32_t num_agents = scenmgr.num_experiments();
+        std::string agents = cfg.get_param_value("agents");
+        if(agents != "")
+        {
+            num_agents = std::min<uint32_t>(
+                    num_agents, (uint32_t)std::stoul(agents));
+        }
+        std::string window = cfg.get_param_value("window");
+        uint32_t window_sz = window == "" ? 10 : (uint32_t)std::stoul(window);
+        std::string period = cfg.get_param_value("period");
+        uint32_t period_sz = period == "" ? 5 : (uint32_t)std::stoul(period);
+        if(period_sz == 0 || period_sz > window_sz)
+        {
+            std::cerr << "err; --period must be between 1 and --window\n";
+            exit(1);
+        }
+        std::string timesteps = cfg.get_param_value("timesteps");
+        uint32_t num_timesteps = 
+            timesteps == "" ? 500 : (uint32_t)std::stoul(timesteps);
+        std::string rate = cfg.get_param_value("task-rate");
+        double task_rate = rate == "" ? 0 : std::stod(rate);
+        std::string tables = cfg.get_param_value("tables");
+        uint32_t max_tables = 
+            tables == "" ? UINT32_MAX : (uint32_t)std::stoul(tables);
+        run_lifelong(scenmgr, alg, num_agents, window_sz, period_sz, 
+                num_timesteps, task_rate, max_tables);
+    }
+    else if(alg == "cbs_ll")
     {
         run_cbs_ll(scenmgr, alg); 
     }
     else if(alg == "sipp")
     {
-        run_sipp(scenmgr, alg, planfile);
+        std::string threads = cfg.get_param_value("threads");
+        uint32_t num_threads = threads == "" ? 1 : (uint32_t)std::stoul(threads);
+        if(num_threads > 1)
+        {
+            run_sipp_parallel(scenmgr, alg, planfile, num_threads);
+        }
+        else
+        {
+            run_sipp(scenmgr, alg, planfile);
+        }
     }
     else if(alg == "jpst")
     {
@@ -7,6 +7,8 @@
 // @created: 2016-11-24
 //
 
+#include "af_filter.h"
+#include "af_labelling.h"
 #include "anytime_astar.h"
 #include "apex_filter.h"
 #include "bb_filter.h"
@@ -17,11 +19,14 @@
 #include "bidirectional_graph_expansion_policy.h"
 #include "bidirectional_search.h"
 #include "cfg.h"
+#include "compact_bb_labelling.h"
+#include "component_labelling.h"
 #include "constants.h"
 #include "contraction.h"
 #include "cpd_extractions.h"
 #include "cpd_heuristic.h"
 #include "cpd_search.h"
+#include "customizable_ch.h"
 #include "depth_first_search.h"
 #include "dimacs_parser.h"
 #include "euclidean_heuristic.h"
@@ -32,15 +37,19 @@
 #include "graph_oracle.h"
 #include "cpd_graph_expansion_policy.h"
 #include "lazy_graph_contraction.h"
+#include "phast.h"
 #include "xy_graph.h"
 #include "solution.h"
 #include "timer.h"
+#include "tnr_search.h"
+#include "transit_node_routing.h"
 #include "workload_manager.h"
 #include "zero_heuristic.h"
 #include "Statistic.h"
 
 #include "getopt.h"
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -60,6 +69,9 @@ int print_help = 0;
 // suppress the header row when printing results? (default: no)
 int suppress_header = 0;
 
+// reject queries between disconnected nodes before searching
+int components = 0;
+
 long nruns = 1;
 
 void
@@ -82,9 +94,21 @@ help()
     << "\t--problem [ ss or p2p problem file (required) ]\n"
     << "\t--verbose (print debug info; omitting this param means no)\n"
     << "\t--nruns [int (repeats per instance; default=" << nruns << ")]\n"
+    << "\t--order [node rank file, e.g. METIS .iperm (cch only; optional)]\n"
+    << "\t--diff [xy-graph with updated arc costs (cch only; optional)]\n"
+    << "\t--bound [max cost of reachable nodes (isochrone only)]\n"
+    << "\t--batch [sources per sweep, 1-" << warthog::ch::phast::MAX_SOURCES
+    << " (phast and isochrone only; default=1)]\n"
+    << "\t--dist-out [file for the distances from every source and, for\n"
+    << "\t             isochrone, the nodes within --bound (optional)]\n"
+    << "\t--partition [cell id of every node, one per line (arc flags only)]\n"
+    << "\t--transit [number of transit nodes (tnr only; default=4*sqrt(n))]\n"
+    << "\t--components (reject unreachable queries without searching;\n"
+    << "\t               astar and dijkstra only)\n"
     << "\nRecognised values for --alg:\n"
-    << "\tastar, astar-bb, dijkstra, bi-astar, bi-dijkstra\n"
-    << "\tbch, bch-astar, bch-bb, fch, fch-bb\n"
+    << "\tastar, astar-bb, astar-af, astar-af-bb, dijkstra, bi-astar, bi-dijkstra\n"
+    << "\tbch, bch-astar, bch-bb, fch, fch-bb, cch, tnr\n"
+    << "\tphast, isochrone (one-to-all; chd input)\n"
     << "\tdfs, cpd, cpd-search\n";
 }
 
@@ -102,6 +126,7 @@ run_experiments( warthog::search* algo, std::string alg_name,
             << "\tnanos\tpcost\tplen\tmap\n";
     }
     uint32_t exp_id = 0;
+    uint32_t short_circuited = 0;
     for(auto it = parser.experiments_begin();
             it != parser.experiments_end();
             it++)
@@ -123,6 +148,7 @@ run_experiments( warthog::search* algo, std::string alg_name,
             heap_ops += sol.heap_ops_;
             touched += sol.nodes_touched_;
             surplus += sol.nodes_surplus_;
+            short_circuited += sol.short_circuited_;
             nano_time = nano_time < sol.time_elapsed_nano_
                             ?  nano_time : sol.time_elapsed_nano_;
         }
@@ -140,6 +166,11 @@ run_experiments( warthog::search* algo, std::string alg_name,
             << parser.get_problemfile()
             << std::endl;
     }
+    if(components)
+    {
+        std::cerr << "short-circuited queries: " << short_circuited / nruns
+            << " of " << exp_id << "\n";
+    }
 }
 
 void
@@ -167,6 +198,10 @@ run_astar(warthog::util::cfg& cfg,
         warthog::pqueue_min>
             alg(&h, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&g) : 0);
+    alg.set_component_labelling(comp.get());
+
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
@@ -234,6 +269,114 @@ run_astar_bb(warthog::util::cfg& cfg,
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+// arc flags are loaded from (or saved to) the file
+// [partition file].af; the bounding boxes from [xy-graph file].label.bb
+void
+run_astar_af(warthog::util::cfg& cfg,
+    warthog::dimacs_parser& parser, std::string alg_name, bool with_bb)
+{
+    std::string xy_filename = cfg.get_param_value("input");
+    std::string part_filename = cfg.get_param_value("partition");
+    if(xy_filename == "" || part_filename == "")
+    {
+        std::cerr << "parameter is missing: --input [xy-graph file] "
+            << "--partition [partition file]\n";
+        return;
+    }
+
+    warthog::graph::xy_graph g;
+    std::ifstream ifs(xy_filename);
+    ifs >> g;
+    ifs.close();
+
+    std::vector<uint32_t> part;
+    if(!warthog::helpers::load_integer_labels(part_filename.c_str(), part))
+    {
+        return;
+    }
+    if(part.size() != g.get_num_nodes())
+    {
+        std::cerr << "err; partition has " << part.size() << " labels but "
+            << "the graph has " << g.get_num_nodes() << " nodes\n";
+        return;
+    }
+
+    warthog::label::af_labelling lab(&g, &part);
+    std::string label_filename = part_filename + ".af";
+    bool loaded = false;
+    ifs.open(label_filename.c_str(), std::ios_base::in|std::ios_base::binary);
+    if(ifs.is_open())
+    {
+        ifs >> lab;
+        loaded = !ifs.fail();
+        ifs.close();
+        if(!loaded)
+        {
+            std::cerr << "could not load arc flags from " << label_filename
+                << "; recomputing them\n";
+        }
+    }
+    if(!loaded)
+    {
+        warthog::util::workload_manager workload(lab.get_num_parts());
+        workload.set_all_flags(true);
+        lab.precompute(&workload);
+
+        std::cerr << "saving precompute data to "
+            << label_filename << "...\n";
+        std::ofstream ofs(label_filename,
+                std::ios_base::out|std::ios_base::binary);
+        ofs << lab;
+        if(!ofs.good())
+        {
+            std::cerr << "\nerror trying to write to file "
+                << label_filename << std::endl;
+        }
+        ofs.close();
+    }
+
+    warthog::label::bb_labelling* bbl = 0;
+    warthog::bb_filter* bbf = 0;
+    if(with_bb)
+    {
+        bbl = new warthog::label::bb_labelling(&g);
+        std::string bb_filename = xy_filename + ".label.bb";
+        ifs.open(bb_filename.c_str());
+        if(ifs.is_open())
+        {
+            ifs >> *bbl;
+            ifs.close();
+        }
+        else
+        {
+            warthog::util::workload_manager workload(g.get_num_nodes());
+            workload.set_all_flags(true);
+            bbl->precompute(&workload);
+            std::ofstream ofs(bb_filename,
+                    std::ios_base::out|std::ios_base::binary);
+            ofs << *bbl;
+            ofs.close();
+        }
+        bbf = new warthog::bb_filter(bbl);
+    }
+
+    warthog::af_filter filter(&lab, bbf);
+    warthog::graph_expansion_policy<warthog::af_filter> expander(&g, &filter);
+    warthog::euclidean_heuristic h(&g);
+    warthog::pqueue_min open;
+
+    warthog::flexible_astar<
+        warthog::euclidean_heuristic,
+        warthog::graph_expansion_policy<warthog::af_filter>,
+        warthog::pqueue_min>
+            alg(&h, &expander, &open);
+
+    run_experiments(&alg, alg_name, parser, std::cout);
+
+    delete bbf;
+    delete bbl;
+}
+
 void
 run_dijkstra(warthog::util::cfg& cfg,
     warthog::dimacs_parser& parser, std::string alg_name )
@@ -259,6 +402,10 @@ run_dijkstra(warthog::util::cfg& cfg,
         warthog::pqueue<warthog::cmp_less_search_node_f_only, warthog::min_q>>
             alg(&h, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&g) : 0);
+    alg.set_component_labelling(comp.get());
+
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
@@ -273,7 +420,7 @@ run_bi_astar( warthog::util::cfg& cfg,
         return;
     }
 
-    warthog::graph::xy_graph g;
+    warthog::graph::xy_graph g(0, "", true);
     std::ifstream ifs(xy_filename);
     ifs >> g;
     ifs.close();
@@ -353,6 +500,140 @@ run_bch(warthog::util::cfg& cfg,
     run_experiments(&alg, alg_name, parser, std::cout);
 }
 
+// transit node routing with bch for local queries. precomputed data is
+// loaded from (or saved to) the file [chd file].tnr-[number of transit nodes]
+void
+run_tnr(warthog::util::cfg& cfg,
+        warthog::dimacs_parser& parser, std::string alg_name)
+{
+    std::string chd_file = cfg.get_param_value("input");
+    if(chd_file == "")
+    {
+        std::cerr << "err; missing chd input file\n";
+        return;
+    }
+
+    warthog::ch::ch_data chd;
+    chd.type_ = warthog::ch::UP_ONLY;
+    std::ifstream ifs(chd_file.c_str());
+    if(!ifs.is_open())
+    {
+        std::cerr << "err; invalid path to chd input file\n";
+        return;
+    }
+    ifs >> chd;
+    ifs.close();
+
+    uint32_t num_nodes = chd.g_->get_num_nodes();
+    uint32_t num_transit = (uint32_t)(4*sqrt((double)num_nodes));
+    std::string transit_str = cfg.get_param_value("transit");
+    if(transit_str != "")
+    {
+        num_transit = (uint32_t)strtol(transit_str.c_str(), 0, 10);
+    }
+    if(num_transit == 0 || num_transit > num_nodes)
+    {
+        std::cerr << "err; --transit must be between 1 and "
+            << num_nodes << "\n";
+        return;
+    }
+
+    warthog::ch::transit_node_routing tnr(&chd);
+    std::string tnr_file = chd_file + ".tnr-" + std::to_string(num_transit);
+    if(!tnr.load(tnr_file.c_str()))
+    {
+        tnr.precompute(num_transit);
+        std::cerr << "saving precompute data to " << tnr_file << "...\n";
+        if(!tnr.save(tnr_file.c_str()))
+        {
+            std::cerr << "\nerror trying to write to file "
+                << tnr_file << std::endl;
+        }
+    }
+
+    warthog::bch_expansion_policy fexp(chd.g_);
+    warthog::bch_expansion_policy bexp (chd.g_, true);
+    warthog::zero_heuristic h;
+    warthog::bch_search<
+        warthog::zero_heuristic,
+        warthog::bch_expansion_policy>
+            bch(&fexp, &bexp, &h);
+
+    warthog::tnr_search alg(&tnr, &bch);
+    run_experiments(&alg, alg_name, parser, std::cout);
+
+    uint32_t total = alg.get_table_queries() + alg.get_local_queries();
+    std::cerr << "tnr table lookups: " << alg.get_table_queries()
+        << " of " << total << " queries ("
+        << (total ? alg.get_table_queries() / (double)total : 0) << ")\n";
+}
+
+void
+run_cch(warthog::util::cfg& cfg,
+        warthog::dimacs_parser& parser, std::string alg_name)
+{
+    std::string xy_filename = cfg.get_param_value("input");
+    if(xy_filename == "")
+    {
+        std::cerr << "parameter is missing: --input [xy-graph file]\n";
+        return;
+    }
+
+    warthog::graph::xy_graph g;
+    std::ifstream ifs(xy_filename);
+    if(!ifs.good())
+    {
+        std::cerr << "Could not open xy-graph: " << xy_filename << std::endl;
+        return;
+    }
+    ifs >> g;
+    ifs.close();
+    g.set_filename(xy_filename.c_str());
+
+    std::string diff_filename = cfg.get_param_value("diff");
+    std::string rank_filename = cfg.get_param_value("order");
+
+    // the metric-independent part: a nested dissection order (either
+    // loaded from METIS or computed internally) and the shortcut topology
+    warthog::ch::customizable_ch cch(&g);
+    if(rank_filename != "")
+    {
+        if(!cch.load_node_ranks(rank_filename.c_str())) { return; }
+    }
+    else
+    {
+        cch.compute_nested_dissection_order();
+    }
+    cch.build_topology();
+    cch.customize();
+
+    // edge weights changed? re-customize. the topology stays the same.
+    if(diff_filename != "")
+    {
+        ifs.open(diff_filename);
+        if (!ifs.good())
+        {
+            std::cerr <<
+                "Could not open diff-graph: " << diff_filename << std::endl;
+            return;
+        }
+        g.perturb(ifs);
+        ifs.close();
+        cch.customize();
+    }
+
+    warthog::ch::ch_data* chd = cch.get_ch_data();
+    warthog::bch_expansion_policy fexp(chd->g_);
+    warthog::bch_expansion_policy bexp (chd->g_, true);
+    warthog::zero_heuristic h;
+    warthog::bch_search<
+        warthog::zero_heuristic,
+        warthog::bch_expansion_policy>
+            alg(&fexp, &bexp, &h);
+
+    run_experiments(&alg, alg_name, parser, std::cout);
+}
+
 void
 run_bch_backwards_only(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
         std::string alg_name)
@@ -434,6 +715,177 @@ run_bch_backwards_only(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     }
 }
 
+// one-to-all queries. when the problem is point-to-point, the distance
+// to the target is reported as pcost. the isochrone variant reports
+// the number of nodes within the given cost bound.
+void
+run_phast(warthog::util::cfg& cfg,
+        warthog::dimacs_parser& parser, std::string alg_name, bool isochrone)
+{
+    std::string chd_file = cfg.get_param_value("input");
+    if(chd_file == "")
+    {
+        std::cerr << "err; missing chd input file\n";
+        return;
+    }
+
+    warthog::cost_t bound = warthog::INF32;
+    std::string par_bound = cfg.get_param_value("bound");
+    if(isochrone)
+    {
+        if(par_bound == "")
+        {
+            std::cerr << "err; require --bound [cost]\n";
+            return;
+        }
+        bound = strtod(par_bound.c_str(), 0);
+    }
+
+    uint32_t batch = 1;
+    std::string par_batch = cfg.get_param_value("batch");
+    if(par_batch != "")
+    {
+        batch = (uint32_t)strtol(par_batch.c_str(), 0, 10);
+        if(batch == 0 || batch > warthog::ch::phast::MAX_SOURCES)
+        {
+            std::cerr << "err; --batch must be in the range 1-"
+                << warthog::ch::phast::MAX_SOURCES << "\n";
+            return;
+        }
+    }
+
+    warthog::ch::ch_data chd;
+    chd.type_ = warthog::ch::UP_ONLY;
+    std::ifstream ifs(chd_file.c_str());
+    if(!ifs.is_open())
+    {
+        std::cerr << "err; invalid path to chd input file\n";
+        return;
+    }
+
+    ifs >> chd;
+    ifs.close();
+
+    // per source, a "d" line with the distance to every node in id
+    // order (-1 if unreachable) and, for isochrone, an "r" line with the
+    // number of nodes within the bound followed by their sorted ids
+    std::ofstream dist_out;
+    std::string dist_file = cfg.get_param_value("dist-out");
+    if(dist_file != "")
+    {
+        dist_out.open(dist_file.c_str());
+        if(!dist_out.is_open())
+        {
+            std::cerr << "err; cannot write to " << dist_file << "\n";
+            return;
+        }
+        dist_out << std::setprecision(15);
+        dist_out << "c one-to-all distances from " << chd_file << "\n"
+            << "c d [source] [distance to node 0] [distance to node 1] ...\n";
+        if(isochrone)
+        {
+            dist_out << "c r [source] [count] [ids of nodes within "
+                << bound << "]\n";
+        }
+    }
+
+    warthog::ch::phast alg(&chd);
+    std::cerr << "running experiments\n";
+    std::cerr << "(averaging over " << nruns << " runs per batch of "
+        << batch << " sources)\n";
+
+    if(!suppress_header)
+    {
+        std::cout
+            << "id\talg\tsource\tup_settled\treached\tmaxcost"
+            << "\tnanos\tpcost\tmap\n";
+    }
+
+    std::vector<warthog::dimacs_parser::experiment> exps(
+            parser.experiments_begin(), parser.experiments_end());
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> reached;
+    uint32_t exp_id = 0;
+    for(size_t first = 0; first < exps.size(); first += batch)
+    {
+        size_t last = std::min(exps.size(), first + batch);
+        sources.clear();
+        for(size_t i = first; i < last; i++)
+        {
+            sources.push_back((uint32_t)exps[i].source);
+        }
+
+        double nano_time = DBL_MAX;
+        for(uint32_t i = 0; i < nruns; i++)
+        {
+            warthog::timer t;
+            t.start();
+            alg.one_to_all(sources.data(), (uint32_t)sources.size());
+            t.stop();
+            nano_time = std::min(nano_time, t.elapsed_time_nano());
+        }
+
+        for(size_t i = first; i < last; i++)
+        {
+            uint32_t which = (uint32_t)(i - first);
+            warthog::cost_t maxcost = 0;
+            reached.clear();
+            alg.isochrone(bound, reached, which);
+            for(uint32_t id : reached)
+            {
+                maxcost = std::max(maxcost, alg.get_distance(id, which));
+            }
+
+            // same test as isochrone: the target counts if it is
+            // reached at cost at most bound
+            long long pcost = -1;
+            if(exps[i].p2p && exps[i].target < alg.get_num_nodes())
+            {
+                warthog::cost_t d =
+                    alg.get_distance((uint32_t)exps[i].target, which);
+                if(d != warthog::INF32 && d <= bound)
+                {
+                    pcost = (long long)d;
+                }
+            }
+
+            std::cout
+                << exp_id++ << "\t"
+                << alg_name << "\t"
+                << exps[i].source << "\t"
+                << alg.get_upward_settled() / sources.size() << "\t"
+                << reached.size() << "\t"
+                << (long long)maxcost << "\t"
+                << (long long)(nano_time / sources.size()) << "\t"
+                << pcost << "\t"
+                << parser.get_problemfile()
+                << std::endl;
+
+            if(!dist_out.is_open()) { continue; }
+            dist_out << "d " << exps[i].source;
+            for(uint32_t id = 0; id < alg.get_num_nodes(); id++)
+            {
+                warthog::cost_t d = alg.get_distance(id, which);
+                if(d == warthog::INF32) { dist_out << " -1"; }
+                else { dist_out << " " << d; }
+            }
+            dist_out << "\n";
+            if(isochrone)
+            {
+                std::sort(reached.begin(), reached.end());
+                dist_out << "r " << exps[i].source << " " << reached.size();
+                for(uint32_t id : reached) { dist_out << " " << id; }
+                dist_out << "\n";
+            }
+        }
+    }
+
+    if(dist_out.is_open() && !dist_out.good())
+    {
+        std::cerr << "err; failed writing to " << dist_file << "\n";
+    }
+}
+
 void
 run_bch_astar(warthog::util::cfg& cfg,
               warthog::dimacs_parser& parser, std::string alg_name)
@@ -514,56 +966,72 @@ run_bch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     label_filename += std::to_string(pct_dijkstra);
 
     warthog::label::dfs_labelling lab(&chd);
+    warthog::label::compact_bb_labelling bbl(chd.g_);
 
     // load up the edge label data (or else precompute it)
     label_filename =  chd_file + "." + label_filename;
-    ifs.open(label_filename);
-    if(ifs.is_open())
+
+    // compact labels are mapped straight into memory. if they do not exist
+    // yet, or the full labels changed since, we read (or compute) the
+    // full labels and compress them again.
+    std::string compact_filename = label_filename + ".compact";
+    if(!bbl.load(compact_filename.c_str(), label_filename.c_str()))
     {
-        ifs >> lab;
-        ifs.close();
+        ifs.open(label_filename);
+        if(ifs.is_open())
+        {
+            ifs >> lab;
+            ifs.close();
+        }
+        else
+        {
+            std::cerr
+                << "err; label file does not exist: "
+                << label_filename << std::endl
+                << "you could try to generate it with "
+                << "--alg fch-bb " << pct_dijkstra << "\n";
+            return;
+
+            //warthog::util::workload_manager workload(chd.g_->get_num_nodes());
+            //double cutoff = (((double)pct_dijkstra)/100);
+            //uint32_t min_level = (uint32_t)(chd.level_->size()*(1-cutoff));
+            //for(size_t i = 0; i < chd.g_->get_num_nodes(); i++)
+            //{
+            //    if(chd.level_->at(i) >= min_level)
+            //    { workload.set_flag((uint32_t)i, true); }
+            //}
+
+            //lab.precompute(&workload);
+
+            //warthog::timer t;
+            //t.start();
+            //std::cerr << "saving precompute data to "
+            //    << label_filename << "...\n";
+
+            //std::ofstream out(label_filename,
+            //        std::ios_base::out|std::ios_base::binary);
+            //out << lab;
+            //if(!out.good())
+            //{
+            //    std::cerr << "\nerror trying to write to file "
+            //        << label_filename << std::endl;
+            //}
+            //out.close();
+            //t.stop();
+            //std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
+
+        }
+
+        bbl.compress(&lab);
+        if(!bbl.save(compact_filename.c_str(), label_filename.c_str()))
+        {
+            std::cerr << "\nerror trying to write to file "
+                << compact_filename << std::endl;
+        }
     }
-    else
-    {
-        std::cerr
-            << "err; label file does not exist: "
-            << label_filename << std::endl
-            << "you could try to generate it with "
-            << "--alg fch-bb " << pct_dijkstra << "\n";
-        return;
 
-        //warthog::util::workload_manager workload(chd.g_->get_num_nodes());
-        //double cutoff = (((double)pct_dijkstra)/100);
-        //uint32_t min_level = (uint32_t)(chd.level_->size()*(1-cutoff));
-        //for(size_t i = 0; i < chd.g_->get_num_nodes(); i++)
-        //{
-        //    if(chd.level_->at(i) >= min_level)
-        //    { workload.set_flag((uint32_t)i, true); }
-        //}
-
-        //lab.precompute(&workload);
-
-        //warthog::timer t;
-        //t.start();
-        //std::cerr << "saving precompute data to "
-        //    << label_filename << "...\n";
-
-        //std::ofstream out(label_filename,
-        //        std::ios_base::out|std::ios_base::binary);
-        //out << lab;
-        //if(!out.good())
-        //{
-        //    std::cerr << "\nerror trying to write to file "
-        //        << label_filename << std::endl;
-        //}
-        //out.close();
-        //t.stop();
-        //std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
-
-    }
-
-    warthog::bch_bb_expansion_policy fexp(&lab, false);
-    warthog::bch_bb_expansion_policy bexp (&lab, true);
+    warthog::bch_bb_expansion_policy fexp(&lab, &bbl, false);
+    warthog::bch_bb_expansion_policy bexp (&lab, &bbl, true);
     warthog::zero_heuristic h;
     warthog::bch_search<
         warthog::zero_heuristic,
@@ -672,48 +1140,64 @@ run_fch_bb(warthog::util::cfg& cfg, warthog::dimacs_parser& parser,
     label_filename += std::to_string(pct_dijkstra);
 
     warthog::label::dfs_labelling lab(&chd);
+    warthog::label::compact_bb_labelling bbl(chd.g_);
 
     // load up the edge label data (or else precompute it)
     label_filename =  chd_file + "." + label_filename;
-    ifs.open(label_filename);
-    if(ifs.is_open())
-    {
-        ifs >> lab;
-        ifs.close();
-    }
-    else
+
+    // compact labels are mapped straight into memory. if they do not exist
+    // yet, or the full labels changed since, we read (or compute) the
+    // full labels and compress them again.
+    std::string compact_filename = label_filename + ".compact";
+    if(!bbl.load(compact_filename.c_str(), label_filename.c_str()))
     {
-        warthog::util::workload_manager workload(chd.g_->get_num_nodes());
-        double cutoff = (((double)pct_dijkstra)/100);
-        uint32_t min_level = (uint32_t)(chd.level_->size()*(1-cutoff));
-        for(size_t i = 0; i < chd.g_->get_num_nodes(); i++)
+        ifs.open(label_filename);
+        if(ifs.is_open())
         {
-            if(chd.level_->at(i) >= min_level)
-            { workload.set_flag((uint32_t)i, true); }
+            ifs >> lab;
+            ifs.close();
         }
+        else
+        {
+            warthog::util::workload_manager workload(chd.g_->get_num_nodes());
+            double cutoff = (((double)pct_dijkstra)/100);
+            uint32_t min_level = (uint32_t)(chd.level_->size()*(1-cutoff));
+            for(size_t i = 0; i < chd.g_->get_num_nodes(); i++)
+            {
+                if(chd.level_->at(i) >= min_level)
+                { workload.set_flag((uint32_t)i, true); }
+            }
+
+            lab.precompute(&workload);
+
+            warthog::timer t;
+            t.start();
+            std::cerr << "saving precompute data to "
+                << label_filename << "...\n";
+
+            std::ofstream out(label_filename,
+                    std::ios_base::out|std::ios_base::binary);
+            out << lab;
+            if(!out.good())
+            {
+                std::cerr << "\nerror trying to write to file "
+                    << label_filename << std::endl;
+            }
+            out.close();
+            t.stop();
+            std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
 
-        lab.precompute(&workload);
-
-        warthog::timer t;
-        t.start();
-        std::cerr << "saving precompute data to "
-            << label_filename << "...\n";
+        }
 
-        std::ofstream out(label_filename,
-                std::ios_base::out|std::ios_base::binary);
-        out << lab;
-        if(!out.good())
+        bbl.compress(&lab);
+        if(!bbl.save(compact_filename.c_str(), label_filename.c_str()))
         {
             std::cerr << "\nerror trying to write to file "
-                << label_filename << std::endl;
+                << compact_filename << std::endl;
         }
-        out.close();
-        t.stop();
-        std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
-
     }
 
-    warthog::fch_bb_expansion_policy fexp(&lab);
+    warthog::fch_bb_expansion_policy fexp(&lab, &bbl);
     warthog::euclidean_heuristic h(chd.g_);
     warthog::pqueue_min open;
 
@@ -1043,6 +1527,14 @@ run_dimacs(warthog::util::cfg& cfg)
     {
         run_astar_bb(cfg, parser, alg_name);
     }
+    else if(alg_name == "astar-af")
+    {
+        run_astar_af(cfg, parser, alg_name, false);
+    }
+    else if(alg_name == "astar-af-bb")
+    {
+        run_astar_af(cfg, parser, alg_name, true);
+    }
     else if(alg_name == "bi-dijkstra")
     {
         run_bi_dijkstra(cfg, parser, alg_name);
@@ -1055,6 +1547,22 @@ run_dimacs(warthog::util::cfg& cfg)
     {
         run_bch(cfg, parser, alg_name);
     }
+    else if(alg_name == "tnr")
+    {
+        run_tnr(cfg, parser, alg_name);
+    }
+    else if(alg_name == "cch")
+    {
+        run_cch(cfg, parser, alg_name);
+    }
+    else if(alg_name == "phast")
+    {
+        run_phast(cfg, parser, alg_name, false);
+    }
+    else if(alg_name == "isochrone")
+    {
+        run_phast(cfg, parser, alg_name, true);
+    }
     else if(alg_name == "bchb")
     {
         run_bch_backwards_only(cfg, parser, alg_name);
@@ -1130,11 +1638,19 @@ main(int argc, char** argv)
         {"checkopt",  no_argument, &checkopt, 1},
         {"verbose",  no_argument, &verbose, 1},
         {"noheader",  no_argument, &suppress_header, 1},
+        {"components",  no_argument, &components, 1},
         {"input",  required_argument, 0, 1},
         {"problem",  required_argument, 0, 1},
         {"fscale", required_argument, 0, 1},
         {"uslim", required_argument, 0, 1},
         {"kmoves", required_argument, 0, 1},
+        {"diff", required_argument, 0, 1},
+        {"order", required_argument, 0, 1},
+        {"bound", required_argument, 0, 1},
+        {"batch", required_argument, 0, 1},
+        {"dist-out", required_argument, 0, 1},
+        {"partition", required_argument, 0, 1},
+        {"transit", required_argument, 0, 1},
         {0,  0, 0, 0}
     };
 
@@ -7,30 +7,39 @@
 // @created: 2016-11-23
 //
 
+#include "bidirectional_search.h"
 #include "cbs.h"
 #include "cbs_ll_expansion_policy.h"
 #include "cbs_ll_heuristic.h"
 #include "cfg.h"
+#include "component_labelling.h"
 #include "constants.h"
 #include "depth_first_search.h"
+#include "dstar_lite.h"
 #include "flexible_astar.h"
 #include "four_connected_jps_locator.h"
 #include "greedy_depth_first_search.h"
 #include "gridmap.h"
 #include "gridmap_expansion_policy.h"
+#include "gridmap_path_smoother.h"
+#include "hpa_search.h"
 #include "jps_expansion_policy.h"
 #include "jps2_expansion_policy.h"
 #include "jps2plus_expansion_policy.h"
 #include "jps4c_expansion_policy.h"
+#include "jps4cplus_expansion_policy.h"
 #include "jpsplus_expansion_policy.h"
+#include "jps_tiled_expansion_policy.h"
 #include "ll_expansion_policy.h"
 #include "manhattan_heuristic.h"
 #include "octile_heuristic.h"
 #include "scenario_manager.h"
+#include "tiled_gridmap.h"
 #include "timer.h"
 #include "labelled_gridmap.h"
 #include "sipp_expansion_policy.h"
 #include "vl_gridmap_expansion_policy.h"
+#include "weighted_jps_expansion_policy.h"
 #include "zero_heuristic.h"
 
 #include "getopt.h"
@@ -52,6 +61,10 @@ int checkopt = 0;
 int verbose = 0;
 // display program help on startup
 int print_help = 0;
+// reject queries between disconnected tiles before searching
+int components = 0;
+// smooth the paths of gridmap searches (greedy or optimal)
+std::string smoothing;
 
 Statistic g_statistic;
 
@@ -70,16 +83,33 @@ help()
     << "\t--map [map file] (optional; specify this to override map values in scen file) \n"
 	<< "\t--checkopt (optional; compare solution costs against values in the scen file)\n"
 	<< "\t--verbose (optional; prints debugging info when compiled with debug symbols)\n"
+	<< "\t--cluster [int] (optional; cluster size for hpa. default=16)\n"
+	<< "\t--components (optional; label connected components and reject\n"
+	<< "\t              unreachable queries without searching. applies to\n"
+	<< "\t              astar, astar4c, jps, jps2, jps+, jps2+, jps4c, jps4c+)\n"
+	<< "\t--smooth [greedy|optimal] (optional; post-process each path with\n"
+	<< "\t              any-angle string pulling and report the time taken\n"
+	<< "\t              and the smoothed length. applies to astar, dijkstra,\n"
+	<< "\t              jps, jps2, jps+, jps2+)\n"
     << "Invoking the program this way solves all instances in [scen file] with algorithm [alg]\n"
     << "Currently recognised values for [alg]:\n"
-    << "\tcbs_ll, cbs_ll_w, dijkstra, astar, astar_wgm, astar4c, sipp\n"
-    << "\tsssp, jps, jps2, jps+, jps2+, jps, jps4c\n"
+    << "\tcbs_ll, cbs_ll_w, dijkstra, astar, astar_wgm, jps_wgm, astar4c, sipp\n"
+    << "\tdstar_lite, dstar_lite_wgm, hpa\n"
+    << "\tsssp, jps, jps2, jps+, jps2+, jps, jps4c, jps4c+, jps_tiled, jps64\n"
+    << "\tbi-jps\n"
     << "\tdfs, gdfs\n\n"
     << ""
     << "The following are valid parameters for GENERATING instances:\n"
     << "\t --gen [map file (required)]\n"
     << "Invoking the program this way generates at random 1000 valid problems for \n"
-    << "gridmap [map file]\n";
+    << "gridmap [map file]\n\n";
+
+    std::cerr
+    << "The following are valid parameters for CONVERTING maps:\n"
+    << "\t --map [map file (required)] --bits [output file (required)]\n"
+    << "Invoking the program this way writes the padded bitfield of [map file]\n"
+    << "to [output file]. Bit files can be given to --map in place of the\n"
+    << "original map; they are memory-mapped instead of parsed.\n";
 }
 
 bool
@@ -115,17 +145,37 @@ check_optimality(warthog::solution& sol, warthog::experiment* exp)
 void
 run_experiments(warthog::search* algo, std::string alg_name,
         warthog::scenario_manager& scenmgr, bool verbose, bool checkopt,
-        std::ostream& out)
+        std::ostream& out, warthog::gridmap* map = 0)
 {
+    // smoothing adds three columns: the time taken to smooth the path,
+    // the smoothed length and its reduction relative to pcost
+    std::unique_ptr<warthog::gridmap_path_smoother> smoother;
+    if(map && smoothing != "")
+    {
+        smoother.reset(new warthog::gridmap_path_smoother(map));
+    }
+    else if(smoothing != "")
+    {
+        std::cerr << "warning; --smooth is not supported by " << alg_name
+            << " and will be ignored\n";
+    }
+
 	std::cout 
         << "id\talg\texpanded\ttouched\treopen\tsurplus\theapops"
-        << "\tnanos\tpcost\tplen\tmap\n";
+        << "\tnanos\tpcost\tplen"
+        << (smoother ? "\tsnanos\tspcost\tsdelta" : "") << "\tmap\n";
+    uint32_t short_circuited = 0;
+    double total_cost = 0, total_smoothed = 0, total_snanos = 0;
+    warthog::timer mytimer;
+    std::vector<warthog::sn_id_t> spath;
 	for(unsigned int i=0; i < scenmgr.num_experiments(); i++)
 	{
 		warthog::experiment* exp = scenmgr.get_experiment(i);
 
-		uint32_t startid = exp->starty() * exp->mapwidth() + exp->startx();
-		uint32_t goalid = exp->goaly() * exp->mapwidth() + exp->goalx();
+		warthog::sn_id_t startid = (warthog::sn_id_t)exp->starty() *
+            exp->mapwidth() + exp->startx();
+		warthog::sn_id_t goalid = (warthog::sn_id_t)exp->goaly() *
+            exp->mapwidth() + exp->goalx();
         warthog::problem_instance pi(startid, goalid, verbose);
         warthog::solution sol;
 
@@ -141,13 +191,43 @@ run_experiments(warthog::search* algo, std::string alg_name,
             << sol.heap_ops_ << "\t"
             << sol.time_elapsed_nano_ << "\t"
             << sol.sum_of_edge_costs_ << "\t" 
-            << (sol.path_.size()-1) << "\t" 
-            << scenmgr.last_file_loaded() 
-            << std::endl;
+            << (sol.path_.size()-1) << "\t";
+        if(smoother)
+        {
+            spath = sol.path_;
+            mytimer.start();
+            if(smoothing == "optimal") { smoother->optimal(spath); }
+            else { smoother->greedy(spath); }
+            mytimer.stop();
+            double slen = sol.path_.empty() ? 0 : smoother->length(spath);
+            double scost = sol.path_.empty() ? 0 : sol.sum_of_edge_costs_;
+            out
+                << mytimer.elapsed_time_nano() << "\t"
+                << slen << "\t"
+                << (scost - slen) << "\t";
+            total_cost += scost;
+            total_smoothed += slen;
+            total_snanos += mytimer.elapsed_time_nano();
+        }
+        out << scenmgr.last_file_loaded() << std::endl;
         out << g_statistic<<"\n";
+        short_circuited += sol.short_circuited_;
 
         if(checkopt) { check_optimality(sol, exp); }
 	}
+    if(components)
+    {
+        std::cerr << "short-circuited queries: " << short_circuited
+            << " of " << scenmgr.num_experiments() << "\n";
+    }
+    if(smoother)
+    {
+        std::cerr << "smoothing (" << smoothing << "): total nanos "
+            << total_snanos << "; total length " << total_cost
+            << " -> " << total_smoothed << " ("
+            << (total_cost > 0 ? 100*(1 - total_smoothed/total_cost) : 0)
+            << "% shorter)\n";
+    }
 }
 
 
@@ -165,12 +245,35 @@ run_jpsplus(warthog::scenario_manager& scenmgr, std::string mapname, std::string
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+            verbose, checkopt, std::cout, &map);
 
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+void
+run_bi_jps(warthog::scenario_manager& scenmgr, std::string mapname, 
+        std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
+	warthog::jps2_expansion_policy fexp(&map, false);
+	warthog::jps2_expansion_policy bexp(&map, true);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+
+    warthog::bidirectional_search<
+        warthog::octile_heuristic,
+        warthog::jps2_expansion_policy>
+            alg(&fexp, &bexp, &heuristic);
+
+    run_experiments(&alg, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< alg.mem() + scenmgr.mem() << "\n";
+}
+
 void
 run_jps2plus(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
@@ -184,8 +287,12 @@ run_jps2plus(warthog::scenario_manager& scenmgr, std::string mapname, std::strin
 	   	warthog::jps2plus_expansion_policy,
         warthog::pqueue_min> astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+            verbose, checkopt, std::cout, &map);
 
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
@@ -204,8 +311,12 @@ run_jps2(warthog::scenario_manager& scenmgr, std::string mapname, std::string al
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+            verbose, checkopt, std::cout, &map);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
@@ -223,6 +334,57 @@ run_jps(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
+    run_experiments(&astar, alg_name, scenmgr, 
+            verbose, checkopt, std::cout, &map);
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+}
+
+// as run_jps but with 64-bit ids, for maps with more than 2^32 padded tiles
+void
+run_jps64(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    warthog::gridmap_base<uint64_t> map(mapname.c_str());
+	warthog::jps_expansion_policy_base<uint64_t> expander(&map);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::jps_expansion_policy_base<uint64_t>,
+        warthog::pqueue_min> 
+            astar(&heuristic, &expander, &open);
+
+    run_experiments(&astar, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_jps_tiled(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    // the tiled copy replaces the gridmap, which is only needed to load
+    // the map file
+    std::unique_ptr<warthog::tiled_gridmap> map;
+    {
+        warthog::gridmap gm(mapname.c_str());
+        map.reset(new warthog::tiled_gridmap(&gm));
+    }
+	warthog::jps_tiled_expansion_policy expander(map.get());
+	warthog::octile_heuristic heuristic(map->width(), map->height());
+    warthog::pqueue_min open;
+
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::jps_tiled_expansion_policy,
+        warthog::pqueue_min> 
+            astar(&heuristic, &expander, &open);
+
     run_experiments(&astar, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
@@ -242,6 +404,34 @@ run_jps4c(warthog::scenario_manager& scenmgr, std::string mapname, std::string a
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
+    run_experiments(&astar, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_jps4cplus(warthog::scenario_manager& scenmgr, std::string mapname, 
+        std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
+	warthog::jps4cplus_expansion_policy expander(&map);
+	warthog::manhattan_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+
+	warthog::flexible_astar<
+		warthog::manhattan_heuristic,
+	   	warthog::jps4cplus_expansion_policy,
+        warthog::pqueue_min> 
+            astar(&heuristic, &expander, &open);
+
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
@@ -261,8 +451,12 @@ run_astar(warthog::scenario_manager& scenmgr, std::string mapname, std::string a
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+            verbose, checkopt, std::cout, &map);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
@@ -280,11 +474,66 @@ run_astar4c(warthog::scenario_manager& scenmgr, std::string mapname, std::string
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
+    std::unique_ptr<warthog::label::component_labelling> comp(
+            components ? new warthog::label::component_labelling(&map) : 0);
+    astar.set_component_labelling(comp.get());
+
     run_experiments(&astar, alg_name, scenmgr, 
             verbose, checkopt, std::cout);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+void
+run_dstar_lite(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
+	warthog::gridmap_expansion_policy expander(&map);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+
+	warthog::dstar_lite<
+		warthog::octile_heuristic,
+	   	warthog::gridmap_expansion_policy> 
+            alg(&heuristic, &expander);
+
+    run_experiments(&alg, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< alg.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_dstar_lite_wgm(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+{
+    warthog::vl_gridmap map(mapname.c_str());
+	warthog::vl_gridmap_expansion_policy expander(&map);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    heuristic.set_hscale('.');
+
+	warthog::dstar_lite<
+		warthog::octile_heuristic,
+	   	warthog::vl_gridmap_expansion_policy> 
+            alg(&heuristic, &expander);
+
+    run_experiments(&alg, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< alg.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_hpa(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name, uint32_t cluster_size)
+{
+    warthog::gridmap map(mapname.c_str());
+    warthog::hpa::cluster_abstraction abs(&map, cluster_size);
+    abs.build();
+    std::cerr << "hpa preprocessing time (ms): "
+        << abs.get_preprocessing_nanos() / 1e6 << "\n";
+
+    warthog::hpa::hpa_search alg(&abs);
+    run_experiments(&alg, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< alg.mem() + scenmgr.mem() << "\n";
+}
+
 void
 run_sipp(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
@@ -331,8 +580,10 @@ run_cbs_ll(warthog::scenario_manager& scenmgr, std::string mapname, std::string
 	{
 		warthog::experiment* exp = scenmgr.get_experiment(i);
 
-		uint32_t startid = exp->starty() * exp->mapwidth() + exp->startx();
-		uint32_t goalid = exp->goaly() * exp->mapwidth() + exp->goalx();
+		warthog::sn_id_t startid = (warthog::sn_id_t)exp->starty() *
+            exp->mapwidth() + exp->startx();
+		warthog::sn_id_t goalid = (warthog::sn_id_t)exp->goaly() *
+            exp->mapwidth() + exp->goalx();
         warthog::problem_instance pi(startid, goalid, verbose);
         warthog::solution sol;
 
@@ -394,7 +645,7 @@ run_dijkstra(warthog::scenario_manager& scenmgr, std::string mapname, std::strin
             astar(&heuristic, &expander, &open);
 
     run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+            verbose, checkopt, std::cout, &map);
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
@@ -422,6 +673,29 @@ run_wgm_astar(warthog::scenario_manager& scenmgr, std::string mapname, std::stri
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+void
+run_wgm_jps(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+{
+    warthog::vl_gridmap map(mapname.c_str());
+	warthog::weighted_jps_expansion_policy expander(&map);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+
+    // as for astar_wgm, scale the heuristic by the cost of the
+    // cheapest terrain
+    heuristic.set_hscale('.');
+
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::weighted_jps_expansion_policy,
+        warthog::pqueue_min> 
+            astar(&heuristic, &expander, &open);
+
+    run_experiments(&astar, alg_name, scenmgr, 
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+}
+
 void
 run_wgm_sssp(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
@@ -511,6 +785,10 @@ main(int argc, char** argv)
 		{"help", no_argument, &print_help, 1},
 		{"checkopt",  no_argument, &checkopt, 1},
 		{"verbose",  no_argument, &verbose, 1},
+		{"components",  no_argument, &components, 1},
+		{"cluster",  required_argument, 0, 1},
+		{"smooth",  required_argument, 0, 1},
+		{"bits",  required_argument, 0, 1},
 		{0,  0, 0, 0}
 	};
 
@@ -527,6 +805,25 @@ main(int argc, char** argv)
     std::string alg = cfg.get_param_value("alg");
     std::string gen = cfg.get_param_value("gen");
     std::string mapname = cfg.get_param_value("map");
+    std::string bits = cfg.get_param_value("bits");
+    smoothing = cfg.get_param_value("smooth");
+    if(smoothing != "" && smoothing != "greedy" && smoothing != "optimal")
+    {
+        std::cerr << "err; unknown smoothing strategy " << smoothing << "\n";
+        exit(1);
+    }
+
+    if(bits != "")
+    {
+        if(mapname == "") { help(); exit(0); }
+        warthog::gridmap_base<uint64_t> gm(mapname.c_str());
+        if(!gm.save_bits(bits.c_str()))
+        {
+            std::cerr << "err; could not write bit file " << bits << "\n";
+            exit(1);
+        }
+        exit(0);
+    }
 
 	if(gen != "")
 	{
@@ -569,6 +866,11 @@ main(int argc, char** argv)
         run_jps2(scenmgr, mapname, alg);
     }
 
+    else if(alg == "bi-jps")
+    {
+        run_bi_jps(scenmgr, mapname, alg);
+    }
+
     else if(alg == "jps2+")
     {
         run_jps2plus(scenmgr, mapname, alg);
@@ -578,11 +880,24 @@ main(int argc, char** argv)
     {
         run_jps(scenmgr, mapname, alg);
     }
+    else if(alg == "jps64")
+    {
+        run_jps64(scenmgr, mapname, alg);
+    }
+    else if(alg == "jps_tiled")
+    {
+        run_jps_tiled(scenmgr, mapname, alg);
+    }
     else if(alg == "jps4c")
     {
         run_jps4c(scenmgr, mapname, alg);
     }
 
+    else if(alg == "jps4c+")
+    {
+        run_jps4cplus(scenmgr, mapname, alg);
+    }
+
     else if(alg == "dijkstra")
     {
         run_dijkstra(scenmgr, mapname, alg); 
@@ -605,6 +920,32 @@ main(int argc, char** argv)
     {
         run_cbs_ll_w(scenmgr, mapname, alg); 
     }
+    else if(alg == "dstar_lite")
+    {
+        run_dstar_lite(scenmgr, mapname, alg);
+    }
+    else if(alg == "dstar_lite_wgm")
+    {
+        run_dstar_lite_wgm(scenmgr, mapname, alg);
+    }
+    else if(alg == "hpa")
+    {
+        uint32_t cluster_size = 16;
+        std::string cluster = cfg.get_param_value("cluster");
+        if(cluster != "")
+        {
+            char* end = 0;
+            long val = strtol(cluster.c_str(), &end, 10);
+            if(*end != 0 || val <= 0 || val > UINT16_MAX)
+            {
+                std::cerr << "err; --cluster must be an integer in the range "
+                    << "1-" << UINT16_MAX << "\n";
+                exit(1);
+            }
+            cluster_size = (uint32_t)val;
+        }
+        run_hpa(scenmgr, mapname, alg, cluster_size);
+    }
     else if(alg == "sipp")
     {
         run_sipp(scenmgr, mapname, alg);
@@ -615,6 +956,11 @@ main(int argc, char** argv)
         run_wgm_astar(scenmgr, mapname, alg); 
     }
 
+    else if(alg == "jps_wgm")
+    {
+        run_wgm_jps(scenmgr, mapname, alg); 
+    }
+
     else if(alg == "sssp")
     {
         run_sssp(scenmgr, mapname, alg);
@@ -5,9 +5,10 @@
 #include "search_node.h"
 
 warthog::bch_bb_expansion_policy::bch_bb_expansion_policy(
-        warthog::label::dfs_labelling* lab, bool backward)
+        warthog::label::dfs_labelling* lab,
+        warthog::label::compact_bb_labelling* bbl, bool backward)
     : expansion_policy(lab->get_ch_data()->g_->get_num_nodes()), 
-      lab_(lab), backward_(backward)
+      lab_(lab), bbl_(bbl), backward_(backward)
 {
     if(backward_)
     {
@@ -99,6 +100,7 @@ warthog::bch_bb_expansion_policy::generate_start_node(
     if(t_graph_id != warthog::INF32) 
     { 
         lab_->get_ch_data()->g_->get_xy(t_graph_id, tx_, ty_);
+        bbl_->to_cell(tx_, ty_, tcx_, tcy_);
     }
 
     // generate the start node
@@ -119,6 +121,7 @@ warthog::bch_bb_expansion_policy::generate_target_node(
     // update the filter with the new target location
     {
         lab_->get_ch_data()->g_->get_xy(t_graph_id, tx_, ty_);
+        bbl_->to_cell(tx_, ty_, tcx_, tcy_);
     }
     return generate(t_graph_id);
 }
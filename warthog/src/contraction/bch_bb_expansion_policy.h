@@ -10,6 +10,7 @@
 //
 
 #include "contraction/contraction.h"
+#include "label/compact_bb_labelling.h"
 #include "domains/xy_graph.h"
 #include "label/dfs_labelling.h"
 #include "search/expansion_policy.h"
@@ -27,9 +28,10 @@ class bch_bb_expansion_policy : public  expansion_policy
     public:
         // @param backward: when true successors are generated by following 
         // incoming arcs rather than outgoing arcs (default is outgoing)
-        // @param filter: the filter used to prune arcs
+        // @param bbl: the bounding boxes of the dfs labels, in compact form
         bch_bb_expansion_policy(
                 warthog::label::dfs_labelling*, 
+                warthog::label::compact_bb_labelling* bbl,
                 bool backward=false);
 
         virtual 
@@ -55,8 +57,10 @@ class bch_bb_expansion_policy : public  expansion_policy
 
     private:
         warthog::label::dfs_labelling* lab_;
+        warthog::label::compact_bb_labelling* bbl_;
         bool backward_;
         int32_t tx_, ty_;
+        uint32_t tcx_, tcy_;
 
         typedef warthog::graph::edge_iter
                 (warthog::bch_bb_expansion_policy::*chep_get_iter_fn) 
@@ -89,10 +93,7 @@ class bch_bb_expansion_policy : public  expansion_policy
         inline bool
         filter_bb_only(uint32_t node_idx, uint32_t edge_idx)
         {
-            warthog::label::dfs_label& label = 
-                lab_->get_label(node_idx, edge_idx);
-            bool retval = label.bbox_.contains(tx_, ty_);
-            return !retval; 
+            return !bbl_->contains(node_idx, edge_idx, tcx_, tcy_);
         }
 
         typedef bool
@@ -104,10 +105,7 @@ class bch_bb_expansion_policy : public  expansion_policy
         inline bool
         filter_bb_fwd(uint32_t node_idx, uint32_t edge_idx)
         {
-            warthog::label::dfs_label& label = 
-                lab_->get_label(node_idx, edge_idx);
-            bool retval = label.bbox_.contains(tx_, ty_);
-            return !retval; 
+            return !bbl_->contains(node_idx, edge_idx, tcx_, tcy_);
         }
 
         inline bool
@@ -45,6 +45,7 @@ warthog::bch_expansion_policy::expand(warthog::search_node* current,
     {
         warthog::graph::edge& e = *it;
         assert(e.node_id_ < g_->get_num_nodes());
+        if(e.wt_ == warthog::INF32) { continue; } // no such path
         warthog::search_node* next = this->generate(e.node_id_);
         if(next->get_search_number() == current->get_search_number() &&
                 current->get_g() > (next->get_g() + e.wt_))
@@ -60,6 +61,7 @@ warthog::bch_expansion_policy::expand(warthog::search_node* current,
     {
         warthog::graph::edge& e = *it;
         assert(e.node_id_ < g_->get_num_nodes());
+        if(e.wt_ == warthog::INF32) { continue; } // no such path
         this->add_neighbour(this->generate(e.node_id_), e.wt_);
     }
 }
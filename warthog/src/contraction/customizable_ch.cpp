@@ -0,0 +1,457 @@
+#include "contraction.h"
+#include "customizable_ch.h"
+#include "helpers.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+
+// undirected adjacency lists, without duplicates or self loops
+void
+build_undirected_adjacency(warthog::graph::xy_graph* g,
+        std::vector<std::vector<uint32_t>>& adj)
+{
+    adj.clear();
+    adj.resize(g->get_num_nodes());
+    for(uint32_t i = 0; i < g->get_num_nodes(); i++)
+    {
+        warthog::graph::node* n = g->get_node(i);
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            if(it->node_id_ == i) { continue; }
+            adj[i].push_back(it->node_id_);
+            adj[it->node_id_].push_back(i);
+        }
+    }
+
+    for(uint32_t i = 0; i < adj.size(); i++)
+    {
+        std::sort(adj[i].begin(), adj[i].end());
+        adj[i].erase(std::unique(adj[i].begin(), adj[i].end()), adj[i].end());
+    }
+}
+
+// recursive coordinate bisection. each cell is split at the median
+// of its wider dimension; nodes on the left side which have a neighbour
+// on the right side form the separator. separator nodes are ordered after
+// the nodes of both sub-cells.
+void
+nested_dissection(std::vector<uint32_t>& cell, warthog::graph::xy_graph* g,
+        std::vector<std::vector<uint32_t>>& adj, std::vector<uint32_t>& tag,
+        uint32_t& next_tag, uint32_t max_leaf_size,
+        std::vector<uint32_t>& order)
+{
+    if(cell.size() <= max_leaf_size)
+    {
+        // contract low degree nodes first
+        std::sort(cell.begin(), cell.end(),
+            [&adj](uint32_t a, uint32_t b) -> bool
+            { return adj[a].size() < adj[b].size(); });
+        order.insert(order.end(), cell.begin(), cell.end());
+        return;
+    }
+
+    int32_t minx = INT32_MAX, miny = INT32_MAX;
+    int32_t maxx = INT32_MIN, maxy = INT32_MIN;
+    for(uint32_t id : cell)
+    {
+        int32_t x, y;
+        g->get_xy(id, x, y);
+        minx = std::min(minx, x); maxx = std::max(maxx, x);
+        miny = std::min(miny, y); maxy = std::max(maxy, y);
+    }
+    bool split_x = ((int64_t)maxx - minx) >= ((int64_t)maxy - miny);
+
+    size_t mid = cell.size() / 2;
+    std::nth_element(cell.begin(), cell.begin() + mid, cell.end(),
+        [g, split_x](uint32_t a, uint32_t b) -> bool
+        {
+            int32_t ax, ay, bx, by;
+            g->get_xy(a, ax, ay);
+            g->get_xy(b, bx, by);
+            return split_x ? (ax < bx || (ax == bx && a < b))
+                           : (ay < by || (ay == by && a < b));
+        });
+
+    uint32_t right_tag = next_tag++;
+    for(size_t i = mid; i < cell.size(); i++) { tag[cell[i]] = right_tag; }
+
+    std::vector<uint32_t> left, right, sep;
+    right.assign(cell.begin() + mid, cell.end());
+    for(size_t i = 0; i < mid; i++)
+    {
+        uint32_t id = cell[i];
+        bool is_sep = false;
+        for(uint32_t nei : adj[id])
+        {
+            if(tag[nei] == right_tag) { is_sep = true; break; }
+        }
+        if(is_sep) { sep.push_back(id); }
+        else { left.push_back(id); }
+    }
+
+    // the cell is no longer needed; free it before recursing
+    std::vector<uint32_t>().swap(cell);
+    nested_dissection(left, g, adj, tag, next_tag, max_leaf_size, order);
+    nested_dissection(right, g, adj, tag, next_tag, max_leaf_size, order);
+    order.insert(order.end(), sep.begin(), sep.end());
+}
+
+}
+
+warthog::ch::customizable_ch::customizable_ch(warthog::graph::xy_graph* g)
+    : g_(g), chd_(0)
+{ }
+
+warthog::ch::customizable_ch::~customizable_ch()
+{
+    delete chd_;
+}
+
+void
+warthog::ch::customizable_ch::compute_nested_dissection_order(
+        uint32_t max_leaf_size)
+{
+    warthog::timer t;
+    t.start();
+
+    std::vector<std::vector<uint32_t>> adj;
+    build_undirected_adjacency(g_, adj);
+
+    std::vector<uint32_t> cell(g_->get_num_nodes());
+    for(uint32_t i = 0; i < cell.size(); i++) { cell[i] = i; }
+
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> tag(g_->get_num_nodes(), 0);
+    uint32_t next_tag = 1;
+    order.reserve(g_->get_num_nodes());
+    nested_dissection(cell, g_, adj, tag, next_tag,
+            std::max<uint32_t>(1, max_leaf_size), order);
+
+    // convert from order-of-contraction to rank
+    warthog::helpers::value_index_swap_array(order);
+    rank_.swap(order);
+
+    t.stop();
+    std::cerr << "nested dissection order, computed. time "
+        << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+bool
+warthog::ch::customizable_ch::load_node_ranks(const char* filename)
+{
+    std::vector<uint32_t> ranks;
+    if(!warthog::helpers::load_integer_labels(filename, ranks))
+    { return false; }
+
+    // ranks must be a permutation of [0, num_nodes)
+    std::vector<bool> seen(g_->get_num_nodes(), false);
+    if(ranks.size() != g_->get_num_nodes())
+    {
+        std::cerr << "err; expected " << g_->get_num_nodes()
+            << " node ranks but read " << ranks.size() << std::endl;
+        return false;
+    }
+    for(uint32_t r : ranks)
+    {
+        if(r >= seen.size() || seen[r])
+        {
+            std::cerr << "err; node ranks are not a permutation\n";
+            return false;
+        }
+        seen[r] = true;
+    }
+    rank_.swap(ranks);
+    return true;
+}
+
+bool
+warthog::ch::customizable_ch::load_node_order(const char* filename)
+{
+    std::vector<uint32_t> order;
+    if(!warthog::ch::load_node_order(filename, order, false))
+    { return false; }
+    if(order.size() != g_->get_num_nodes())
+    {
+        std::cerr << "err; expected " << g_->get_num_nodes()
+            << " nodes in the order but read " << order.size() << std::endl;
+        return false;
+    }
+    warthog::helpers::value_index_swap_array(order);
+    rank_.swap(order);
+    return true;
+}
+
+void
+warthog::ch::customizable_ch::build_topology()
+{
+    if(rank_.size() != g_->get_num_nodes())
+    {
+        compute_nested_dissection_order();
+    }
+
+    warthog::timer t;
+    t.start();
+    uint32_t num_nodes = g_->get_num_nodes();
+
+    std::vector<uint32_t> order(rank_);
+    warthog::helpers::value_index_swap_array(order);
+
+    // simulate the contraction of every node. the upward neighbours of
+    // a node form a clique so it is enough to pass them on to the lowest
+    // ranked upward neighbour (i.e. the parent in the elimination tree)
+    std::vector<std::vector<uint32_t>> upper(num_nodes);
+    {
+        std::vector<std::vector<uint32_t>> adj;
+        build_undirected_adjacency(g_, adj);
+        for(uint32_t i = 0; i < num_nodes; i++)
+        {
+            for(uint32_t nei : adj[i])
+            {
+                if(rank_[nei] > rank_[i]) { upper[i].push_back(nei); }
+            }
+        }
+    }
+
+    auto by_rank = [this](uint32_t a, uint32_t b) -> bool
+    { return rank_[a] < rank_[b]; };
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        std::vector<uint32_t>& up = upper[order[r]];
+        std::sort(up.begin(), up.end(), by_rank);
+        up.erase(std::unique(up.begin(), up.end()), up.end());
+        if(up.size() < 2) { continue; }
+
+        std::vector<uint32_t>& parent = upper[up[0]];
+        parent.insert(parent.end(), up.begin()+1, up.end());
+    }
+
+    // flatten the upward arcs
+    up_begin_.assign(num_nodes+1, 0);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        up_begin_[i+1] = up_begin_[i] + (uint32_t)upper[i].size();
+    }
+    up_head_.resize(up_begin_[num_nodes]);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        std::copy(upper[i].begin(), upper[i].end(),
+                up_head_.begin() + up_begin_[i]);
+        std::vector<uint32_t>().swap(upper[i]);
+    }
+    up_wt_.assign(up_head_.size(), warthog::INF32);
+    down_wt_.assign(up_head_.size(), warthog::INF32);
+
+    // index the same arcs by head; visiting tails in rank order
+    // keeps every list sorted by the rank of the tail
+    down_begin_.assign(num_nodes+1, 0);
+    for(uint32_t head : up_head_) { down_begin_[head+1]++; }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        down_begin_[i+1] += down_begin_[i];
+    }
+    down_tail_.resize(up_head_.size());
+    down_arc_.resize(up_head_.size());
+    std::vector<uint32_t> fill(down_begin_.begin(), down_begin_.end()-1);
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        uint32_t tail = order[r];
+        for(uint32_t a = up_begin_[tail]; a < up_begin_[tail+1]; a++)
+        {
+            uint32_t pos = fill[up_head_[a]]++;
+            down_tail_[pos] = tail;
+            down_arc_[pos] = a;
+        }
+    }
+
+    // group nodes by height in the elimination tree
+    std::vector<uint32_t> height(num_nodes, 0);
+    uint32_t max_height = 0;
+    for(uint32_t r = 0; r < num_nodes; r++)
+    {
+        uint32_t tail = order[r];
+        max_height = std::max(max_height, height[tail]);
+        for(uint32_t a = up_begin_[tail]; a < up_begin_[tail+1]; a++)
+        {
+            uint32_t head = up_head_[a];
+            height[head] = std::max(height[head], height[tail]+1);
+        }
+    }
+    level_begin_.assign(max_height+2, 0);
+    for(uint32_t i = 0; i < num_nodes; i++) { level_begin_[height[i]+1]++; }
+    for(uint32_t i = 0; i <= max_height; i++)
+    {
+        level_begin_[i+1] += level_begin_[i];
+    }
+    level_nodes_.resize(num_nodes);
+    fill.assign(level_begin_.begin(), level_begin_.end()-1);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        level_nodes_[fill[height[i]]++] = i;
+    }
+
+    // the CH graph stores every upward arc twice: as an outgoing arc
+    // (tail to head) and as an incoming arc (head to tail). both lists
+    // use the same index so that ::customize can update them in place
+    delete chd_;
+    chd_ = new warthog::ch::ch_data(true);
+    chd_->type_ = warthog::ch::UP_ONLY;
+    chd_->g_->set_filename(g_->get_filename());
+    chd_->g_->grow(num_nodes);
+    chd_->level_->assign(rank_.begin(), rank_.end());
+    chd_->up_degree_->resize(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        int32_t x, y;
+        g_->get_xy(i, x, y);
+        chd_->g_->set_xy(i, x, y);
+
+        uint32_t degree = up_begin_[i+1] - up_begin_[i];
+        assert(degree < warthog::graph::ECAP_MAX);
+        chd_->up_degree_->at(i) = degree;
+
+        warthog::graph::node* n = chd_->g_->get_node(i);
+        n->capacity((warthog::graph::ECAP_T)degree,
+                    (warthog::graph::ECAP_T)degree);
+        for(uint32_t a = up_begin_[i]; a < up_begin_[i+1]; a++)
+        {
+            n->add_outgoing(warthog::graph::edge(up_head_[a], warthog::INF32));
+            n->add_incoming(warthog::graph::edge(up_head_[a], warthog::INF32));
+        }
+    }
+
+    t.stop();
+    std::cerr << "cch topology, computed. time "
+        << t.elapsed_time_nano() / 1e9 << " s"
+        << "; nodes " << num_nodes
+        << "; input edges " << g_->get_num_edges_out()
+        << "; cch arcs " << up_head_.size()
+        << "; elimination tree height " << (max_height+1) << std::endl;
+}
+
+uint32_t
+warthog::ch::customizable_ch::find_arc(uint32_t tail_id, uint32_t head_id)
+{
+    auto begin = up_head_.begin() + up_begin_[tail_id];
+    auto end = up_head_.begin() + up_begin_[tail_id+1];
+    uint32_t head_rank = rank_[head_id];
+    auto it = std::lower_bound(begin, end, head_rank,
+        [this](uint32_t id, uint32_t rank) -> bool
+        { return rank_[id] < rank; });
+    if(it == end || *it != head_id) { return warthog::INF32; }
+    return (uint32_t)(it - up_head_.begin());
+}
+
+void
+warthog::ch::customizable_ch::customize_node(uint32_t u)
+{
+    // process every lower triangle {v, u, w} with rank v < rank u < rank w.
+    // the upward neighbours of v form a clique so every w which appears
+    // after u in the (rank-sorted) arc list of v is also an upward
+    // neighbour of u.
+    for(uint32_t k = down_begin_[u]; k < down_begin_[u+1]; k++)
+    {
+        uint32_t v = down_tail_[k];
+        uint32_t vu = down_arc_[k];
+        uint32_t uw = up_begin_[u];
+        for(uint32_t vw = vu+1; vw < up_begin_[v+1]; vw++)
+        {
+            uint32_t w = up_head_[vw];
+            while(up_head_[uw] != w) { uw++; }
+            assert(uw < up_begin_[u+1]);
+
+            // u -> v -> w and w -> v -> u. arcs with no finite weight
+            // (INF32) are skipped rather than summed
+            if(down_wt_[vu] != warthog::INF32 && up_wt_[vw] != warthog::INF32)
+            {
+                warthog::graph::edge_cost_t via = down_wt_[vu] + up_wt_[vw];
+                if(via < up_wt_[uw]) { up_wt_[uw] = via; }
+            }
+            if(down_wt_[vw] != warthog::INF32 && up_wt_[vu] != warthog::INF32)
+            {
+                warthog::graph::edge_cost_t via = down_wt_[vw] + up_wt_[vu];
+                if(via < down_wt_[uw]) { down_wt_[uw] = via; }
+            }
+        }
+    }
+}
+
+void
+warthog::ch::customizable_ch::customize()
+{
+    if(!chd_) { build_topology(); }
+
+    warthog::timer t;
+    t.start();
+
+    // initial arc weights are taken from the input graph
+    std::fill(up_wt_.begin(), up_wt_.end(), warthog::INF32);
+    std::fill(down_wt_.begin(), down_wt_.end(), warthog::INF32);
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        warthog::graph::node* n = g_->get_node(i);
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            uint32_t j = it->node_id_;
+            if(j == i) { continue; }
+            if(rank_[i] < rank_[j])
+            {
+                uint32_t a = find_arc(i, j);
+                up_wt_[a] = std::min(up_wt_[a], it->wt_);
+            }
+            else
+            {
+                uint32_t a = find_arc(j, i);
+                down_wt_[a] = std::min(down_wt_[a], it->wt_);
+            }
+        }
+    }
+
+    // bottom-up; nodes at the same height in the elimination tree
+    // only read arcs of lower nodes and only write their own arcs
+    for(uint32_t h = 0; h+1 < level_begin_.size(); h++)
+    {
+        int64_t first = level_begin_[h];
+        int64_t last = level_begin_[h+1];
+        #pragma omp parallel for schedule(dynamic, 64)
+        for(int64_t i = first; i < last; i++)
+        {
+            customize_node(level_nodes_[i]);
+        }
+    }
+
+    // copy the new weights into the CH graph
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        warthog::graph::node* n = chd_->g_->get_node(i);
+        warthog::graph::edge_iter out = n->outgoing_begin();
+        warthog::graph::edge_iter in = n->incoming_begin();
+        for(uint32_t a = up_begin_[i]; a < up_begin_[i+1]; a++)
+        {
+            (out++)->wt_ = up_wt_[a];
+            (in++)->wt_ = down_wt_[a];
+        }
+    }
+
+    t.stop();
+    std::cerr << "cch, customized. time "
+        << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+size_t
+warthog::ch::customizable_ch::mem()
+{
+    return
+        sizeof(*this) +
+        (chd_ ? chd_->mem() : 0) +
+        sizeof(uint32_t) * (rank_.size() + up_begin_.size() +
+            up_head_.size() + down_begin_.size() + down_tail_.size() +
+            down_arc_.size() + level_begin_.size() + level_nodes_.size()) +
+        sizeof(warthog::graph::edge_cost_t) *
+            (up_wt_.size() + down_wt_.size());
+}
@@ -0,0 +1,127 @@
+#ifndef WARTHOG_CUSTOMIZABLE_CH_H
+#define WARTHOG_CUSTOMIZABLE_CH_H
+
+// contraction/customizable_ch.h
+//
+// A Customizable Contraction Hierarchy (CCH) separates preprocessing
+// into two phases:
+//
+//  (i) a metric-independent phase which fixes a node order (usually a
+//  nested dissection order) and computes the set of shortcut arcs
+//  created by contracting the nodes in that order. Shortcuts are
+//  added between every pair of higher-ranked neighbours, regardless of
+//  edge weights, so the topology is valid for any metric.
+//
+//  (ii) a customization phase which assigns weights to every arc of
+//  the hierarchy by processing lower triangles bottom-up. This phase
+//  is cheap and can be repeated every time the edge weights of the
+//  input graph change (e.g. after xy_graph::perturb).
+//
+// The result is made available as an UP_ONLY warthog::ch::ch_data
+// object which can be queried with warthog::bch_search and
+// warthog::bch_expansion_policy. Arcs which have no finite cost under
+// the current metric are kept (with cost warthog::INF32) so that
+// re-customization can update weights in place; bch_expansion_policy
+// and phast never relax them.
+//
+// For more details see:
+// [Dibbelt, Strasser and Wagner.
+// Customizable Contraction Hierarchies.
+// ACM Journal of Experimental Algorithmics, vol 21, 2016]
+//
+
+#include "ch_data.h"
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+class customizable_ch
+{
+    public:
+        // @param g: the input graph. edge weights of this graph are
+        // used as the metric during ::customize
+        customizable_ch(warthog::graph::xy_graph* g);
+        ~customizable_ch();
+
+        // compute a nested dissection order by recursive coordinate
+        // bisection of the input graph. every cell with at most
+        // @param max_leaf_size nodes is not further subdivided.
+        void
+        compute_nested_dissection_order(uint32_t max_leaf_size = 64);
+
+        // load a node ranking, one integer per line, where the value on
+        // line i is the contraction rank of node i. This is the format of
+        // the .iperm files METIS (ndmetis) produces when given the output
+        // of dimacs2metis.
+        bool
+        load_node_ranks(const char* filename);
+
+        // load an order-of-contraction file
+        // (cf. warthog::ch::load_node_order)
+        bool
+        load_node_order(const char* filename);
+
+        // compute the metric-independent shortcut topology for the current
+        // node order and allocate the CH graph that stores it
+        void
+        build_topology();
+
+        // (re)compute arc weights from the current edge weights of the
+        // input graph
+        void
+        customize();
+
+        inline warthog::ch::ch_data*
+        get_ch_data() { return chd_; }
+
+        inline uint32_t
+        get_num_arcs() { return (uint32_t)up_head_.size(); }
+
+        size_t
+        mem();
+
+    private:
+        warthog::graph::xy_graph* g_;
+        warthog::ch::ch_data* chd_;
+
+        // rank_[i] is the contraction rank of node i
+        std::vector<uint32_t> rank_;
+
+        // upward arcs, in CSR format, sorted by rank of the head node.
+        // up_wt_ is the cost of going from tail to head and down_wt_
+        // is the cost of going from head to tail
+        std::vector<uint32_t> up_begin_;
+        std::vector<uint32_t> up_head_;
+        std::vector<warthog::graph::edge_cost_t> up_wt_;
+        std::vector<warthog::graph::edge_cost_t> down_wt_;
+
+        // the same arcs, indexed by head and sorted by rank of the tail
+        std::vector<uint32_t> down_begin_;
+        std::vector<uint32_t> down_tail_;
+        std::vector<uint32_t> down_arc_;
+
+        // nodes grouped by height in the elimination tree. nodes with
+        // the same height share no lower triangles and can be customized
+        // in parallel
+        std::vector<uint32_t> level_begin_;
+        std::vector<uint32_t> level_nodes_;
+
+        uint32_t
+        find_arc(uint32_t tail_id, uint32_t head_id);
+
+        void
+        customize_node(uint32_t node_id);
+};
+
+}
+
+}
+
+#endif
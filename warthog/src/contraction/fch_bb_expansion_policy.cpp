@@ -3,9 +3,11 @@
 #include "xy_graph.h"
 #include "search_node.h"
 
-warthog::fch_bb_expansion_policy::fch_bb_expansion_policy(warthog::label::dfs_labelling* lab)
+warthog::fch_bb_expansion_policy::fch_bb_expansion_policy(
+        warthog::label::dfs_labelling* lab,
+        warthog::label::compact_bb_labelling* bbl)
     : expansion_policy(lab->get_ch_data()->g_->get_num_nodes()), 
-      chd_(lab->get_ch_data()), lab_(lab)
+      chd_(lab->get_ch_data()), lab_(lab), bbl_(bbl)
 {
     t_label = s_label = INT32_MAX;
     filter = &warthog::fch_bb_expansion_policy::filter_bb_only;
@@ -108,6 +110,7 @@ warthog::fch_bb_expansion_policy::generate_target_node(
     t_label = lab_->get_dfs_index(t_graph_id);
     
     get_xy(t_graph_id, tx_, ty_);
+    bbl_->to_cell(tx_, ty_, tcx_, tcy_);
 
     return generate(t_graph_id);
 }
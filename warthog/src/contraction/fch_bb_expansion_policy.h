@@ -8,6 +8,7 @@
 // To improve preprocessing times it is possible to precompute BB labels only 
 // for some percentage of the highest nodes in the CH. 
 // The rest of the nodes receive BB labels computed with depth-first search.
+// Labels are read from a compact_bb_labelling store.
 // This implementation is based on the following paper:
 //
 // [ Forward Search in Contraction Hierarchies. 2018. 
@@ -18,6 +19,7 @@
 // @created: 2017-12-02
 //
 
+#include "compact_bb_labelling.h"
 #include "contraction.h"
 #include "dfs_labelling.h"
 #include "expansion_policy.h"
@@ -32,7 +34,10 @@ namespace warthog
 class fch_bb_expansion_policy : public expansion_policy
 {
     public:
-        fch_bb_expansion_policy(warthog::label::dfs_labelling* lab);
+        // @param lab: dfs labels for the hierarchy
+        // @param bbl: the bounding boxes of @param lab, in compact form
+        fch_bb_expansion_policy(warthog::label::dfs_labelling* lab,
+                warthog::label::compact_bb_labelling* bbl);
 
         virtual 
         ~fch_bb_expansion_policy() { }
@@ -62,8 +67,10 @@ class fch_bb_expansion_policy : public expansion_policy
         warthog::ch::ch_data* chd_;
 
         warthog::label::dfs_labelling* lab_;
+        warthog::label::compact_bb_labelling* bbl_;
         uint32_t s_label, t_label;
         int32_t tx_, ty_;
+        uint32_t tcx_, tcy_;
         uint32_t t_graph_id;
         uint32_t t_level;
 
@@ -76,19 +83,13 @@ class fch_bb_expansion_policy : public expansion_policy
         inline bool
         filter_all(uint32_t node_idx, uint32_t edge_idx)
         {
-            warthog::label::dfs_label& label = 
-                lab_->get_label(node_idx, edge_idx);
-            bool retval = label.bbox_.contains(tx_, ty_);
-            return !retval; 
+            return !bbl_->contains(node_idx, edge_idx, tcx_, tcy_);
         }
 
         inline bool
         filter_bb_only(uint32_t node_idx, uint32_t edge_idx)
         {
-            warthog::label::dfs_label& label = 
-                lab_->get_label(node_idx, edge_idx);
-            bool retval = label.bbox_.contains(tx_, ty_);
-            return !retval; 
+            return !bbl_->contains(node_idx, edge_idx, tcx_, tcy_);
         }
 
         inline uint32_t
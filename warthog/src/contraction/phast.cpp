@@ -0,0 +1,149 @@
+#include "phast.h"
+#include "xy_graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+warthog::ch::phast::phast(warthog::ch::ch_data* chd)
+    : num_sources_(1), up_settled_(0)
+{
+    assert(chd->type_ == warthog::ch::UP_ONLY);
+    warthog::graph::xy_graph* g = chd->g_;
+    num_nodes_ = g->get_num_nodes();
+
+    // sweep order: highest level first
+    node_at_.resize(num_nodes_);
+    for(uint32_t i = 0; i < num_nodes_; i++) { node_at_[i] = i; }
+    std::vector<uint32_t>* level = chd->level_;
+    std::sort(node_at_.begin(), node_at_.end(),
+        [level](uint32_t a, uint32_t b) -> bool
+        { return level->at(a) > level->at(b); });
+    pos_.resize(num_nodes_);
+    for(uint32_t p = 0; p < num_nodes_; p++) { pos_[node_at_[p]] = p; }
+
+    // outgoing arcs go up; incoming arcs come down from higher nodes
+    up_begin_.resize(num_nodes_+1, 0);
+    down_begin_.resize(num_nodes_+1, 0);
+    for(uint32_t p = 0; p < num_nodes_; p++)
+    {
+        warthog::graph::node* n = g->get_node(node_at_[p]);
+        up_begin_[p+1] = up_begin_[p] + n->out_degree();
+        down_begin_[p+1] = down_begin_[p] + n->in_degree();
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            up_head_.push_back(pos_[it->node_id_]);
+            up_wt_.push_back(it->wt_);
+        }
+        for(warthog::graph::edge_iter it = n->incoming_begin();
+                it != n->incoming_end(); it++)
+        {
+            assert(pos_[it->node_id_] < p);
+            down_tail_.push_back(pos_[it->node_id_]);
+            down_wt_.push_back(it->wt_);
+        }
+    }
+}
+
+warthog::ch::phast::~phast()
+{ }
+
+void
+warthog::ch::phast::one_to_all(uint32_t source_id)
+{
+    one_to_all(&source_id, 1);
+}
+
+void
+warthog::ch::phast::one_to_all(const uint32_t* sources, uint32_t num_sources)
+{
+    assert(num_sources > 0 && num_sources <= MAX_SOURCES);
+    num_sources_ = num_sources;
+    up_settled_ = 0;
+    dist_.assign((size_t)num_nodes_ * num_sources_, warthog::INF32);
+
+    for(uint32_t s = 0; s < num_sources_; s++)
+    {
+        if(sources[s] >= num_nodes_) { continue; }
+        upward_search(pos_[sources[s]], s);
+    }
+    downward_sweep();
+}
+
+void
+warthog::ch::phast::upward_search(uint32_t source_pos, uint32_t which)
+{
+    typedef std::pair<warthog::cost_t, uint32_t> qentry;
+    std::priority_queue<qentry, std::vector<qentry>, std::greater<qentry>> open;
+
+    dist_[(size_t)source_pos*num_sources_ + which] = 0;
+    open.push(qentry(0, source_pos));
+    while(!open.empty())
+    {
+        qentry top = open.top();
+        open.pop();
+        uint32_t p = top.second;
+        if(top.first > dist_[(size_t)p*num_sources_ + which]) { continue; }
+        up_settled_++;
+
+        for(uint32_t a = up_begin_[p]; a < up_begin_[p+1]; a++)
+        {
+            warthog::cost_t gval = top.first + up_wt_[a];
+            warthog::cost_t& dh = dist_[(size_t)up_head_[a]*num_sources_ + which];
+            if(gval < dh)
+            {
+                dh = gval;
+                open.push(qentry(gval, up_head_[a]));
+            }
+        }
+    }
+}
+
+void
+warthog::ch::phast::downward_sweep()
+{
+    const uint32_t k = num_sources_;
+    warthog::cost_t* dist = dist_.data();
+    for(uint32_t p = 0; p < num_nodes_; p++)
+    {
+        warthog::cost_t* dv = dist + (size_t)p*k;
+        for(uint32_t a = down_begin_[p]; a < down_begin_[p+1]; a++)
+        {
+            const warthog::cost_t* du = dist + (size_t)down_tail_[a]*k;
+            const warthog::cost_t wt = down_wt_[a];
+            for(uint32_t s = 0; s < k; s++)
+            {
+                warthog::cost_t via = du[s] + wt;
+                dv[s] = via < dv[s] ? via : dv[s];
+            }
+        }
+    }
+}
+
+void
+warthog::ch::phast::isochrone(warthog::cost_t bound,
+        std::vector<uint32_t>& nodes, uint32_t which)
+{
+    assert(which < num_sources_);
+    for(uint32_t p = 0; p < num_nodes_; p++)
+    {
+        warthog::cost_t d = dist_[(size_t)p*num_sources_ + which];
+        if(d != warthog::INF32 && d <= bound)
+        {
+            nodes.push_back(node_at_[p]);
+        }
+    }
+}
+
+size_t
+warthog::ch::phast::mem()
+{
+    return
+        sizeof(*this) +
+        sizeof(uint32_t) * (pos_.size() + node_at_.size() +
+            up_begin_.size() + up_head_.size() +
+            down_begin_.size() + down_tail_.size()) +
+        sizeof(warthog::cost_t) *
+            (up_wt_.size() + down_wt_.size() + dist_.size());
+}
@@ -0,0 +1,119 @@
+#ifndef WARTHOG_PHAST_H
+#define WARTHOG_PHAST_H
+
+// contraction/phast.h
+//
+// PHAST: one-to-all shortest path distances on a contraction hierarchy.
+// A query runs in two phases:
+//
+//  (i) a forward Dijkstra search from the source which follows only
+//  upward arcs of the hierarchy and;
+//
+//  (ii) a single linear sweep over all nodes in descending level order
+//  which relaxes every incoming downward arc of the current node.
+//
+// The second phase needs no priority queue. Nodes are renumbered by
+// sweep position, so both the distance array and the arc arrays are
+// scanned sequentially. Several sources can be processed in the same
+// sweep; their distances are interleaved so that the inner loop is a
+// short vectorisable min over all sources.
+//
+// The input hierarchy must be of type warthog::ch::UP_ONLY.
+//
+// For more details see:
+// [Delling, Goldberg, Nowatzyk and Werneck.
+// PHAST: Hardware-Accelerated Shortest Path Trees.
+// Journal of Parallel and Distributed Computing, vol 73, 2013]
+//
+
+#include "ch_data.h"
+#include "constants.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+class phast
+{
+    public:
+        // the maximum number of sources processed by a single sweep
+        static const uint32_t MAX_SOURCES = 16;
+
+        phast(warthog::ch::ch_data* chd);
+        ~phast();
+
+        // compute distances from @param source_id to every node
+        void
+        one_to_all(uint32_t source_id);
+
+        // compute distances from each of @param num_sources nodes
+        // (at most MAX_SOURCES) to every node, in a single sweep
+        void
+        one_to_all(const uint32_t* sources, uint32_t num_sources);
+
+        // @return the distance from the @param which-th source of the
+        // last query to @param node_id, or warthog::INF32 if the node
+        // is not reachable
+        inline warthog::cost_t
+        get_distance(uint32_t node_id, uint32_t which = 0)
+        {
+            assert(which < num_sources_);
+            return dist_[(size_t)pos_[node_id]*num_sources_ + which];
+        }
+
+        // collect every node whose distance from the @param which-th
+        // source of the last query is at most @param bound (unreached
+        // nodes are never included)
+        void
+        isochrone(warthog::cost_t bound, std::vector<uint32_t>& nodes,
+                uint32_t which = 0);
+
+        inline uint32_t
+        get_num_nodes() { return num_nodes_; }
+
+        // number of nodes settled by the upward searches of the last query
+        inline uint32_t
+        get_upward_settled() { return up_settled_; }
+
+        size_t
+        mem();
+
+    private:
+        uint32_t num_nodes_;
+        uint32_t num_sources_;
+        uint32_t up_settled_;
+
+        // pos_[id] is the sweep position of node id; node_at_ is the inverse
+        std::vector<uint32_t> pos_;
+        std::vector<uint32_t> node_at_;
+
+        // upward arcs, indexed and labelled by sweep position
+        std::vector<uint32_t> up_begin_;
+        std::vector<uint32_t> up_head_;
+        std::vector<warthog::cost_t> up_wt_;
+
+        // incoming downward arcs, indexed and labelled by sweep position
+        std::vector<uint32_t> down_begin_;
+        std::vector<uint32_t> down_tail_;
+        std::vector<warthog::cost_t> down_wt_;
+
+        // distances, indexed by [position * num_sources_ + source]
+        std::vector<warthog::cost_t> dist_;
+
+        void
+        upward_search(uint32_t source_pos, uint32_t which);
+
+        void
+        downward_sweep();
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,518 @@
+#include "transit_node_routing.h"
+#include "helpers.h"
+#include "timer.h"
+#include "xy_graph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <queue>
+
+namespace
+{
+
+const uint32_t TNR_MAGIC = 0x33524e54; // "TNR3"
+
+struct tnr_header
+{
+    uint32_t magic_;
+    uint32_t num_nodes_;
+    uint32_t num_transit_;
+    uint32_t padding_;
+    uint64_t num_fwd_access_;
+    uint64_t num_bwd_access_;
+    uint64_t num_fwd_space_;
+    uint64_t num_bwd_space_;
+
+    // ch_checksum of the hierarchy the data was computed from
+    uint64_t checksum_;
+};
+
+// FNV-1a over the node order and every arc (head and the bits of its
+// weight) of the hierarchy. a hierarchy rebuilt after its arc costs
+// change can keep the same order and file size, but not this checksum
+uint64_t
+ch_checksum(warthog::ch::ch_data* chd)
+{
+    uint64_t checksum = 0xcbf29ce484222325ull;
+    auto mix = [&checksum](uint64_t value) -> void
+    {
+        for(uint32_t b = 0; b < 64; b += 8)
+        {
+            checksum ^= (value >> b) & 0xff;
+            checksum *= 0x100000001b3ull;
+        }
+    };
+    auto mix_edge = [&mix](warthog::graph::edge& e) -> void
+    {
+        uint64_t wt;
+        memcpy(&wt, &e.wt_, sizeof(wt));
+        mix(e.node_id_);
+        mix(wt);
+    };
+
+    uint32_t num_nodes = chd->g_->get_num_nodes();
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = chd->g_->get_node(i);
+        mix(chd->level_->at(i));
+        mix(n->out_degree());
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        { mix_edge(*it); }
+        mix(n->in_degree());
+        for(warthog::graph::edge_iter it = n->incoming_begin();
+                it != n->incoming_end(); it++)
+        { mix_edge(*it); }
+    }
+    return checksum;
+}
+
+typedef std::pair<warthog::cost_t, uint32_t> qentry;
+typedef std::priority_queue<qentry, std::vector<qentry>,
+        std::greater<qentry>> min_queue;
+
+}
+
+warthog::ch::transit_node_routing::transit_node_routing(
+        warthog::ch::ch_data* chd)
+    : chd_(chd), num_transit_(0)
+{
+    assert(chd_->type_ == warthog::ch::UP_ONLY);
+    num_nodes_ = chd_->g_->get_num_nodes();
+    num_fwd_access_ = num_bwd_access_ = 0;
+    num_fwd_space_ = num_bwd_space_ = 0;
+    table_ = fwd_dist_ = bwd_dist_ = 0;
+    transit_node_ = fwd_access_ = bwd_access_ = 0;
+    fwd_space_ = bwd_space_ = 0;
+    fwd_begin_ = bwd_begin_ = fwd_space_begin_ = bwd_space_begin_ = 0;
+}
+
+warthog::ch::transit_node_routing::~transit_node_routing()
+{ }
+
+void
+warthog::ch::transit_node_routing::pruned_search(uint32_t source,
+        bool backward, std::vector<uint32_t>& transit_id,
+        std::vector<warthog::cost_t>& dist, std::vector<uint32_t>& touched,
+        std::vector<uint32_t>& access,
+        std::vector<warthog::cost_t>& access_dist,
+        std::vector<uint32_t>& space)
+{
+    min_queue open;
+    dist[source] = 0;
+    touched.push_back(source);
+    open.push(qentry(0, source));
+    while(!open.empty())
+    {
+        qentry top = open.top();
+        open.pop();
+        uint32_t v = top.second;
+        if(top.first > dist[v]) { continue; }
+
+        if(transit_id[v] != warthog::INF32)
+        {
+            access.push_back(transit_id[v]);
+            access_dist.push_back(top.first);
+            continue;
+        }
+        space.push_back(v);
+
+        warthog::graph::node* n = chd_->g_->get_node(v);
+        warthog::graph::edge_iter begin =
+            backward ? n->incoming_begin() : n->outgoing_begin();
+        warthog::graph::edge_iter end =
+            backward ? n->incoming_end() : n->outgoing_end();
+        for(warthog::graph::edge_iter it = begin; it != end; it++)
+        {
+            warthog::cost_t gval = top.first + it->wt_;
+            if(gval < dist[it->node_id_])
+            {
+                if(dist[it->node_id_] == warthog::INF32)
+                {
+                    touched.push_back(it->node_id_);
+                }
+                dist[it->node_id_] = gval;
+                open.push(qentry(gval, it->node_id_));
+            }
+        }
+    }
+
+    for(uint32_t id : touched) { dist[id] = warthog::INF32; }
+    touched.clear();
+    std::sort(space.begin(), space.end());
+}
+
+void
+warthog::ch::transit_node_routing::prune_access_nodes(bool backward,
+        std::vector<uint32_t>& access,
+        std::vector<warthog::cost_t>& access_dist)
+{
+    std::vector<bool> keep(access.size(), true);
+    for(uint32_t i = 0; i < access.size(); i++)
+    {
+        for(uint32_t j = 0; j < access.size(); j++)
+        {
+            if(i == j || !keep[j]) { continue; }
+            warthog::cost_t via = backward
+                ? table_[(size_t)access[i]*num_transit_ + access[j]]
+                : table_[(size_t)access[j]*num_transit_ + access[i]];
+            if(access_dist[j] + via <= access_dist[i])
+            {
+                keep[i] = false;
+                break;
+            }
+        }
+    }
+
+    uint32_t num_kept = 0;
+    for(uint32_t i = 0; i < access.size(); i++)
+    {
+        if(!keep[i]) { continue; }
+        access[num_kept] = access[i];
+        access_dist[num_kept] = access_dist[i];
+        num_kept++;
+    }
+    access.resize(num_kept);
+    access_dist.resize(num_kept);
+}
+
+void
+warthog::ch::transit_node_routing::precompute(uint32_t num_transit)
+{
+    warthog::timer t;
+    t.start();
+    num_transit_ = std::min(num_transit, num_nodes_);
+    uint32_t k = num_transit_;
+
+    // transit nodes are the highest nodes in the hierarchy
+    std::vector<uint32_t> order(num_nodes_);
+    for(uint32_t i = 0; i < num_nodes_; i++) { order[i] = i; }
+    std::vector<uint32_t>* level = chd_->level_;
+    std::stable_sort(order.begin(), order.end(),
+        [level](uint32_t a, uint32_t b) -> bool
+        { return level->at(a) > level->at(b); });
+    v_transit_node_.assign(order.begin(), order.begin() + k);
+    std::vector<uint32_t> transit_id(num_nodes_, warthog::INF32);
+    for(uint32_t i = 0; i < k; i++) { transit_id[v_transit_node_[i]] = i; }
+
+    // the subgraph induced by the transit nodes: up arcs are the outgoing
+    // edges; down arcs are the incoming edges, which all come from
+    // higher (hence transit) nodes
+    std::vector<std::vector<std::pair<uint32_t, warthog::cost_t>>> arcs(k);
+    for(uint32_t i = 0; i < k; i++)
+    {
+        warthog::graph::node* n = chd_->g_->get_node(v_transit_node_[i]);
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            assert(transit_id[it->node_id_] != warthog::INF32);
+            arcs[i].push_back(std::make_pair(transit_id[it->node_id_], it->wt_));
+        }
+        for(warthog::graph::edge_iter it = n->incoming_begin();
+                it != n->incoming_end(); it++)
+        {
+            assert(transit_id[it->node_id_] != warthog::INF32);
+            arcs[transit_id[it->node_id_]].push_back(std::make_pair(i, it->wt_));
+        }
+    }
+
+    struct shared_data
+    {
+        warthog::ch::transit_node_routing* tnr_;
+        std::vector<std::vector<std::pair<uint32_t, warthog::cost_t>>>* arcs_;
+        std::vector<uint32_t>* transit_id_;
+        std::vector<access_data>* results_;
+    };
+    shared_data shared;
+    shared.tnr_ = this;
+    shared.arcs_ = &arcs;
+    shared.transit_id_ = &transit_id;
+
+    // phase 1: one Dijkstra search per transit node fills one table row
+    v_table_.assign((size_t)k*k, warthog::INF32);
+    void*(*table_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        shared_data* shared = (shared_data*) par->shared_;
+        warthog::ch::transit_node_routing* tnr = shared->tnr_;
+        auto& arcs = *shared->arcs_;
+        uint32_t k = tnr->num_transit_;
+
+        for(uint32_t i = par->thread_id_; i < k; i += par->max_threads_)
+        {
+            warthog::cost_t* dist = &tnr->v_table_[(size_t)i*k];
+            min_queue open;
+            dist[i] = 0;
+            open.push(qentry(0, i));
+            while(!open.empty())
+            {
+                qentry top = open.top();
+                open.pop();
+                if(top.first > dist[top.second]) { continue; }
+                for(auto& arc : arcs[top.second])
+                {
+                    warthog::cost_t gval = top.first + arc.second;
+                    if(gval < dist[arc.first])
+                    {
+                        dist[arc.first] = gval;
+                        open.push(qentry(gval, arc.first));
+                    }
+                }
+            }
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+    std::cerr << "computing transit distance table; " << k
+        << " transit nodes\n";
+    warthog::helpers::parallel_compute(table_fn, &shared, k);
+    table_ = v_table_.data();
+
+    // phase 2: access nodes and search spaces of every node
+    std::vector<access_data> results(num_nodes_);
+    shared.results_ = &results;
+    void*(*access_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        shared_data* shared = (shared_data*) par->shared_;
+        warthog::ch::transit_node_routing* tnr = shared->tnr_;
+        std::vector<access_data>& results = *shared->results_;
+
+        std::vector<warthog::cost_t> dist(tnr->num_nodes_, warthog::INF32);
+        std::vector<uint32_t> touched;
+        for(uint32_t v = par->thread_id_; v < tnr->num_nodes_;
+                v += par->max_threads_)
+        {
+            access_data& r = results[v];
+            tnr->pruned_search(v, false, *shared->transit_id_, dist,
+                    touched, r.fwd_access_, r.fwd_dist_, r.fwd_space_);
+            tnr->pruned_search(v, true, *shared->transit_id_, dist,
+                    touched, r.bwd_access_, r.bwd_dist_, r.bwd_space_);
+            tnr->prune_access_nodes(false, r.fwd_access_, r.fwd_dist_);
+            tnr->prune_access_nodes(true, r.bwd_access_, r.bwd_dist_);
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+    std::cerr << "computing access nodes\n";
+    warthog::helpers::parallel_compute(access_fn, &shared, num_nodes_);
+
+    // flatten everything into contiguous arrays
+    v_fwd_begin_.assign(1, 0);
+    v_bwd_begin_.assign(1, 0);
+    v_fwd_space_begin_.assign(1, 0);
+    v_bwd_space_begin_.assign(1, 0);
+    v_fwd_access_.clear(); v_fwd_dist_.clear();
+    v_bwd_access_.clear(); v_bwd_dist_.clear();
+    v_fwd_space_.clear(); v_bwd_space_.clear();
+    for(uint32_t v = 0; v < num_nodes_; v++)
+    {
+        access_data& r = results[v];
+        v_fwd_access_.insert(v_fwd_access_.end(),
+                r.fwd_access_.begin(), r.fwd_access_.end());
+        v_fwd_dist_.insert(v_fwd_dist_.end(),
+                r.fwd_dist_.begin(), r.fwd_dist_.end());
+        v_bwd_access_.insert(v_bwd_access_.end(),
+                r.bwd_access_.begin(), r.bwd_access_.end());
+        v_bwd_dist_.insert(v_bwd_dist_.end(),
+                r.bwd_dist_.begin(), r.bwd_dist_.end());
+        v_fwd_space_.insert(v_fwd_space_.end(),
+                r.fwd_space_.begin(), r.fwd_space_.end());
+        v_bwd_space_.insert(v_bwd_space_.end(),
+                r.bwd_space_.begin(), r.bwd_space_.end());
+        v_fwd_begin_.push_back(v_fwd_access_.size());
+        v_bwd_begin_.push_back(v_bwd_access_.size());
+        v_fwd_space_begin_.push_back(v_fwd_space_.size());
+        v_bwd_space_begin_.push_back(v_bwd_space_.size());
+        r = access_data();
+    }
+    num_fwd_access_ = v_fwd_access_.size();
+    num_bwd_access_ = v_bwd_access_.size();
+    num_fwd_space_ = v_fwd_space_.size();
+    num_bwd_space_ = v_bwd_space_.size();
+    bind_vectors();
+
+    t.stop();
+    std::cerr << "tnr precompute done. avg access nodes (fwd/bwd) "
+        << num_fwd_access_ / (double)num_nodes_ << " / "
+        << num_bwd_access_ / (double)num_nodes_ << "; time "
+        << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+void
+warthog::ch::transit_node_routing::bind_vectors()
+{
+    table_ = v_table_.data();
+    fwd_dist_ = v_fwd_dist_.data();
+    bwd_dist_ = v_bwd_dist_.data();
+    transit_node_ = v_transit_node_.data();
+    fwd_begin_ = v_fwd_begin_.data();
+    fwd_access_ = v_fwd_access_.data();
+    bwd_begin_ = v_bwd_begin_.data();
+    bwd_access_ = v_bwd_access_.data();
+    fwd_space_begin_ = v_fwd_space_begin_.data();
+    fwd_space_ = v_fwd_space_.data();
+    bwd_space_begin_ = v_bwd_space_begin_.data();
+    bwd_space_ = v_bwd_space_.data();
+}
+
+// the file is a header followed by every array in turn. arrays of
+// 8-byte values (costs and offsets) come first so that every array
+// stays aligned when mapped.
+bool
+warthog::ch::transit_node_routing::save(const char* filename)
+{
+    std::ofstream ofs(filename, std::ios_base::out|std::ios_base::binary);
+    if(!ofs.good()) { return false; }
+
+    tnr_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic_ = TNR_MAGIC;
+    hdr.num_nodes_ = num_nodes_;
+    hdr.num_transit_ = num_transit_;
+    hdr.num_fwd_access_ = num_fwd_access_;
+    hdr.num_bwd_access_ = num_bwd_access_;
+    hdr.num_fwd_space_ = num_fwd_space_;
+    hdr.num_bwd_space_ = num_bwd_space_;
+    hdr.checksum_ = ch_checksum(chd_);
+    ofs.write((const char*)&hdr, sizeof(hdr));
+
+    size_t n1 = num_nodes_ + 1;
+    size_t k = num_transit_;
+    ofs.write((const char*)table_, sizeof(warthog::cost_t) * k * k);
+    ofs.write((const char*)fwd_dist_, sizeof(warthog::cost_t) * num_fwd_access_);
+    ofs.write((const char*)bwd_dist_, sizeof(warthog::cost_t) * num_bwd_access_);
+    ofs.write((const char*)fwd_begin_, sizeof(uint64_t) * n1);
+    ofs.write((const char*)bwd_begin_, sizeof(uint64_t) * n1);
+    ofs.write((const char*)fwd_space_begin_, sizeof(uint64_t) * n1);
+    ofs.write((const char*)bwd_space_begin_, sizeof(uint64_t) * n1);
+    ofs.write((const char*)transit_node_, sizeof(uint32_t) * k);
+    ofs.write((const char*)fwd_access_, sizeof(uint32_t) * num_fwd_access_);
+    ofs.write((const char*)bwd_access_, sizeof(uint32_t) * num_bwd_access_);
+    ofs.write((const char*)fwd_space_, sizeof(uint32_t) * num_fwd_space_);
+    ofs.write((const char*)bwd_space_, sizeof(uint32_t) * num_bwd_space_);
+    return ofs.good();
+}
+
+bool
+warthog::ch::transit_node_routing::load(const char* filename)
+{
+    if(!file_.open(filename)) { return false; }
+
+    const char* ptr = file_.data();
+    tnr_header hdr;
+    if(file_.size() < sizeof(hdr)) { file_.close(); return false; }
+    memcpy(&hdr, ptr, sizeof(hdr));
+    ptr += sizeof(hdr);
+
+    size_t n1 = hdr.num_nodes_ + 1;
+    size_t k = hdr.num_transit_;
+    size_t expected = sizeof(hdr) +
+        sizeof(warthog::cost_t) *
+            (k*k + hdr.num_fwd_access_ + hdr.num_bwd_access_) +
+        sizeof(uint64_t) * 4*n1 +
+        sizeof(uint32_t) *
+            (k + hdr.num_fwd_access_ + hdr.num_bwd_access_ +
+             hdr.num_fwd_space_ + hdr.num_bwd_space_);
+    if(hdr.magic_ != TNR_MAGIC || hdr.num_nodes_ != num_nodes_ ||
+       file_.size() != expected)
+    {
+        std::cerr << "err; tnr file " << filename
+            << " does not match the input graph\n";
+        file_.close();
+        return false;
+    }
+    if(hdr.checksum_ != ch_checksum(chd_))
+    {
+        std::cerr << "err; tnr file " << filename
+            << " was computed for a different hierarchy\n";
+        file_.close();
+        return false;
+    }
+
+    num_transit_ = hdr.num_transit_;
+    num_fwd_access_ = hdr.num_fwd_access_;
+    num_bwd_access_ = hdr.num_bwd_access_;
+    num_fwd_space_ = hdr.num_fwd_space_;
+    num_bwd_space_ = hdr.num_bwd_space_;
+
+    table_ = (const warthog::cost_t*)ptr;
+    ptr += sizeof(warthog::cost_t) * k * k;
+    fwd_dist_ = (const warthog::cost_t*)ptr;
+    ptr += sizeof(warthog::cost_t) * num_fwd_access_;
+    bwd_dist_ = (const warthog::cost_t*)ptr;
+    ptr += sizeof(warthog::cost_t) * num_bwd_access_;
+    fwd_begin_ = (const uint64_t*)ptr;
+    ptr += sizeof(uint64_t) * n1;
+    bwd_begin_ = (const uint64_t*)ptr;
+    ptr += sizeof(uint64_t) * n1;
+    fwd_space_begin_ = (const uint64_t*)ptr;
+    ptr += sizeof(uint64_t) * n1;
+    bwd_space_begin_ = (const uint64_t*)ptr;
+    ptr += sizeof(uint64_t) * n1;
+    transit_node_ = (const uint32_t*)ptr;
+    ptr += sizeof(uint32_t) * k;
+    fwd_access_ = (const uint32_t*)ptr;
+    ptr += sizeof(uint32_t) * num_fwd_access_;
+    bwd_access_ = (const uint32_t*)ptr;
+    ptr += sizeof(uint32_t) * num_bwd_access_;
+    fwd_space_ = (const uint32_t*)ptr;
+    ptr += sizeof(uint32_t) * num_fwd_space_;
+    bwd_space_ = (const uint32_t*)ptr;
+    return true;
+}
+
+bool
+warthog::ch::transit_node_routing::is_local(uint32_t s, uint32_t t)
+{
+    const uint32_t* a = fwd_space_ + fwd_space_begin_[s];
+    const uint32_t* a_end = fwd_space_ + fwd_space_begin_[s+1];
+    const uint32_t* b = bwd_space_ + bwd_space_begin_[t];
+    const uint32_t* b_end = bwd_space_ + bwd_space_begin_[t+1];
+    while(a != a_end && b != b_end)
+    {
+        if(*a == *b) { return true; }
+        if(*a < *b) { a++; }
+        else { b++; }
+    }
+    return false;
+}
+
+warthog::cost_t
+warthog::ch::transit_node_routing::get_distance(
+        uint32_t s, uint32_t t, uint32_t& lookups)
+{
+    warthog::cost_t best = warthog::INF32;
+    lookups = 0;
+    for(uint64_t i = fwd_begin_[s]; i < fwd_begin_[s+1]; i++)
+    {
+        const warthog::cost_t* row = table_ + (size_t)fwd_access_[i]*num_transit_;
+        warthog::cost_t ds = fwd_dist_[i];
+        for(uint64_t j = bwd_begin_[t]; j < bwd_begin_[t+1]; j++)
+        {
+            warthog::cost_t d = ds + row[bwd_access_[j]] + bwd_dist_[j];
+            best = d < best ? d : best;
+        }
+        lookups += (uint32_t)(bwd_begin_[t+1] - bwd_begin_[t]);
+    }
+    return best < warthog::INF32 ? best : warthog::INF32;
+}
+
+size_t
+warthog::ch::transit_node_routing::mem()
+{
+    size_t n1 = num_nodes_ + 1;
+    return sizeof(*this) +
+        sizeof(warthog::cost_t) * ((size_t)num_transit_*num_transit_ +
+            num_fwd_access_ + num_bwd_access_) +
+        sizeof(uint64_t) * 4*n1 +
+        sizeof(uint32_t) * (num_transit_ +
+            num_fwd_access_ + num_bwd_access_ +
+            num_fwd_space_ + num_bwd_space_);
+}
@@ -0,0 +1,171 @@
+#ifndef WARTHOG_TRANSIT_NODE_ROUTING_H
+#define WARTHOG_TRANSIT_NODE_ROUTING_H
+
+// contraction/transit_node_routing.h
+//
+// Transit Node Routing (TNR) on top of a contraction hierarchy.
+// The k highest nodes of the hierarchy are chosen as transit nodes.
+// For every node we precompute:
+//
+//  (i) its forward and backward access nodes: the transit nodes reached
+//  by an upward search which is not allowed to continue past a transit
+//  node, together with their distances. Access nodes which are
+//  dominated (i.e. reached more cheaply via another access node) are
+//  discarded.
+//
+//  (ii) its forward and backward search spaces: the non-transit nodes
+//  settled by the same two searches, sorted by id.
+//
+// We also store a dense k*k table of distances between transit nodes.
+// Because transit nodes are closed upward, every up-down path between
+// two of them stays among the transit nodes; so the table is computed
+// with one Dijkstra search per transit node on the (small) subgraph
+// they induce.
+//
+// A query from s to t is "local" if the forward search space of s and
+// the backward search space of t share a node. Otherwise the apex of
+// the shortest up-down path is a transit node and the distance is:
+//      min d(s, a) + D(a, b) + d(b, t)
+// over all forward access nodes a of s and backward access nodes b of t.
+// Local queries need to be answered by some other method (e.g. bch).
+//
+// Precomputed data is saved as a flat binary file which is mapped
+// into memory when loaded. The file records a checksum of the hierarchy
+// it was computed from, so data for an older hierarchy is not loaded.
+//
+// For more details see:
+// [Arz, Luxen and Sanders.
+// Transit Node Routing Reconsidered.
+// 12th International Symposium on Experimental Algorithms, 2013]
+//
+
+#include "ch_data.h"
+#include "constants.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace ch
+{
+
+class transit_node_routing
+{
+    public:
+        // @param chd: a hierarchy of type warthog::ch::UP_ONLY
+        transit_node_routing(warthog::ch::ch_data* chd);
+        ~transit_node_routing();
+
+        // choose the @param num_transit highest nodes as transit nodes
+        // and compute access nodes, search spaces and the distance table
+        void
+        precompute(uint32_t num_transit);
+
+        // write precomputed data to @param filename.
+        // @return true if successful, false otherwise.
+        bool
+        save(const char* filename);
+
+        // map the precomputed data in @param filename into memory.
+        // fails if the data was computed for a different hierarchy
+        // (i.e. another node order, or other arcs or arc costs).
+        // @return true if successful, false otherwise.
+        bool
+        load(const char* filename);
+
+        // @return true if the forward search space of @param s and the
+        // backward search space of @param t intersect
+        bool
+        is_local(uint32_t s, uint32_t t);
+
+        // @return the distance from @param s to @param t, computed from
+        // the access nodes and the distance table, or warthog::INF32 if
+        // t is not reachable. Only valid if the query is not local.
+        // @param lookups: the number of table entries examined
+        warthog::cost_t
+        get_distance(uint32_t s, uint32_t t, uint32_t& lookups);
+
+        inline uint32_t
+        get_num_transit() { return num_transit_; }
+
+        inline uint32_t
+        get_num_nodes() { return num_nodes_; }
+
+        size_t
+        mem();
+
+    private:
+        warthog::ch::ch_data* chd_;
+        uint32_t num_nodes_;
+        uint32_t num_transit_;
+
+        // precomputed data. these point into the vectors below (after
+        // precompute) or into the mapped file (after load)
+        const warthog::cost_t* table_;
+        const warthog::cost_t* fwd_dist_;
+        const warthog::cost_t* bwd_dist_;
+        const uint32_t* transit_node_;
+        const uint64_t* fwd_begin_;
+        const uint32_t* fwd_access_;
+        const uint64_t* bwd_begin_;
+        const uint32_t* bwd_access_;
+        const uint64_t* fwd_space_begin_;
+        const uint32_t* fwd_space_;
+        const uint64_t* bwd_space_begin_;
+        const uint32_t* bwd_space_;
+
+        // summed over all nodes, access nodes and search spaces can
+        // exceed 2^32 entries on large graphs; so offsets are 64-bit
+        uint64_t num_fwd_access_, num_bwd_access_;
+        uint64_t num_fwd_space_, num_bwd_space_;
+
+        warthog::util::mapped_file file_;
+        std::vector<warthog::cost_t> v_table_;
+        std::vector<warthog::cost_t> v_fwd_dist_, v_bwd_dist_;
+        std::vector<uint32_t> v_transit_node_;
+        std::vector<uint64_t> v_fwd_begin_, v_bwd_begin_;
+        std::vector<uint64_t> v_fwd_space_begin_, v_bwd_space_begin_;
+        std::vector<uint32_t> v_fwd_access_, v_bwd_access_;
+        std::vector<uint32_t> v_fwd_space_, v_bwd_space_;
+
+        // per-node results of the pruned upward searches
+        struct access_data
+        {
+            std::vector<uint32_t> fwd_access_;
+            std::vector<warthog::cost_t> fwd_dist_;
+            std::vector<uint32_t> bwd_access_;
+            std::vector<warthog::cost_t> bwd_dist_;
+            std::vector<uint32_t> fwd_space_;
+            std::vector<uint32_t> bwd_space_;
+        };
+
+        // upward search from @param source which does not expand transit
+        // nodes; backward searches follow incoming arcs. @param dist and
+        // @param touched are scratch space for the calling thread.
+        void
+        pruned_search(uint32_t source, bool backward,
+                std::vector<uint32_t>& transit_id,
+                std::vector<warthog::cost_t>& dist,
+                std::vector<uint32_t>& touched,
+                std::vector<uint32_t>& access,
+                std::vector<warthog::cost_t>& access_dist,
+                std::vector<uint32_t>& space);
+
+        // remove access nodes which are reached more cheaply via another
+        // access node of the same node
+        void
+        prune_access_nodes(bool backward, std::vector<uint32_t>& access,
+                std::vector<warthog::cost_t>& access_dist);
+
+        void
+        bind_vectors();
+};
+
+}
+
+}
+
+#endif
@@ -25,7 +25,9 @@ static const uint32_t LOG_BLOCKSIZE =
     static_cast<uint32_t>(ceil(log10(BLOCKSIZE) / log10(2)));
 
 class gm_parser;
-class gridmap;
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
 class blockmap
 {
 	public:
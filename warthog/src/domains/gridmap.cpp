@@ -2,25 +2,65 @@
 
 #include <cassert>
 #include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-warthog::gridmap::gridmap(unsigned int h, unsigned int w)
-	: header_(h, w, "octile")
+namespace
+{
+
+// bit files begin with this header. the tiles follow, stored exactly
+// as in gridmap_base::db_, starting at offset BITS_DATA_OFFSET.
+struct bits_header
+{
+    char magic_[8];
+    uint32_t version_;
+    uint32_t height_;
+    uint32_t width_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint32_t reserved_;
+    uint64_t db_size_;
+    uint64_t num_traversable_;
+};
+
+const char BITS_MAGIC[8] = {'w', 'g', 'm', 'b', 'i', 't', 's', 0};
+const uint32_t BITS_VERSION = 1;
+const size_t BITS_DATA_OFFSET = 64;
+
+}
+
+template<typename ID_T>
+warthog::gridmap_base<ID_T>::gridmap_base(unsigned int h, unsigned int w)
+	: header_(h, w, "octile"), mapped_(0), mapped_size_(0)
 {	
+	filename_[0] = 0;
+	num_traversable_ = 0;
 	this->init_db();
 }
 
-warthog::gridmap::gridmap(const char* filename)
+template<typename ID_T>
+warthog::gridmap_base<ID_T>::gridmap_base(const char* filename)
+	: mapped_(0), mapped_size_(0)
+{
+	strncpy(filename_, filename, sizeof(filename_) - 1);
+	filename_[sizeof(filename_) - 1] = 0;
+	if(!load_bits(filename)) { load_map(filename); }
+}
+
+template<typename ID_T>
+void
+warthog::gridmap_base<ID_T>::load_map(const char* filename)
 {
-	strcpy(filename_, filename);
 	warthog::gm_parser parser(filename);
 	this->header_ = parser.get_header();
-
 	init_db();
 	// populate matrix
     num_traversable_ = 0;
-	for(unsigned int i = 0; i < parser.get_num_tiles(); i++)
+	for(ID_T i = 0; i < parser.get_num_tiles(); i++)
 	{
-		unsigned char c = parser.get_tile_at(i);
+		unsigned char c = parser.get_tile_at((unsigned int)i);
 		switch(c)
 		{
 			case 'S':
@@ -40,8 +80,9 @@ warthog::gridmap::gridmap(const char* filename)
 	}
 }
 
+template<typename ID_T>
 void
-warthog::gridmap::init_db()
+warthog::gridmap_base<ID_T>::init_db(bool allocate)
 {
 	// when storing the grid we pad the edges of the map with
 	// zeroes. this eliminates the need for bounds checking when
@@ -61,27 +102,121 @@ warthog::gridmap::init_db()
     }
 	this->padding_per_row_ = this->padded_width_ - this->header_.width_;
 
+	// every padded tile needs an id
+	if((uint64_t)padded_width_ * padded_height_ - 1 > (uint64_t)(ID_T)~(ID_T)0)
+	{
+		std::cerr << "err; map with " << header_.width_ << "x" 
+			<< header_.height_ << " tiles is too large for " 
+			<< sizeof(ID_T)*8 << "-bit ids" << std::endl;
+		exit(1);
+	}
+
     this->dbheight_ = padded_height_;
     this->dbwidth_ = padded_width_ >> warthog::LOG2_DBWORD_BITS;
-	this->db_size_ = this->dbwidth_ * this->dbheight_;
+	this->db_size_ = (ID_T)this->dbwidth_ * this->dbheight_;
+	max_id_ = db_size_-1;
+	if(!allocate) { return; }
 
 	// create a one dimensional dbword array to store the grid
 	this->db_ = new warthog::dbword[db_size_];
-	for(unsigned int i=0; i < db_size_; i++)
+	for(ID_T i=0; i < db_size_; i++)
 	{
 		db_[i] = 0;
 	}
+}
 
-	max_id_ = db_size_-1;
+template<typename ID_T>
+warthog::gridmap_base<ID_T>::~gridmap_base()
+{
+	if(mapped_) { munmap(mapped_, mapped_size_); }
+	else { delete [] db_; }
 }
 
-warthog::gridmap::~gridmap()
+// map the tiles of a bit file into memory. pages are mapped privately:
+// changes made with ::set_label are visible to this gridmap only and
+// are never written back to the file.
+template<typename ID_T>
+bool
+warthog::gridmap_base<ID_T>::load_bits(const char* filename)
 {
-	delete [] db_;
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0) { return false; }
+
+	bits_header bh;
+	if(read(fd, &bh, sizeof(bh)) != (ssize_t)sizeof(bh) ||
+	   memcmp(bh.magic_, BITS_MAGIC, sizeof(BITS_MAGIC)) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	if(bh.version_ != BITS_VERSION)
+	{
+		std::cerr << "err; unsupported bit file version " << bh.version_ 
+			<< " in " << filename << std::endl;
+		exit(1);
+	}
+
+	this->header_ = warthog::gm_header(bh.height_, bh.width_, "octile");
+	init_db(false);
+	if(bh.db_size_ != (uint64_t)db_size_ || 
+	   bh.padded_width_ != padded_width_ ||
+	   bh.padded_height_ != padded_height_)
+	{
+		std::cerr << "err; bit file " << filename << " does not match the "
+			<< "layout of this gridmap" << std::endl;
+		exit(1);
+	}
+
+	struct stat st;
+	mapped_size_ = BITS_DATA_OFFSET + (size_t)db_size_;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < mapped_size_)
+	{
+		std::cerr << "err; bit file " << filename << " is truncated" 
+			<< std::endl;
+		exit(1);
+	}
+
+	mapped_ = mmap(0, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, 
+			fd, 0);
+	close(fd);
+	if(mapped_ == MAP_FAILED)
+	{
+		std::cerr << "err; cannot map bit file " << filename << std::endl;
+		exit(1);
+	}
+	db_ = (warthog::dbword*)((char*)mapped_ + BITS_DATA_OFFSET);
+	num_traversable_ = (ID_T)bh.num_traversable_;
+	return true;
 }
 
+template<typename ID_T>
+bool
+warthog::gridmap_base<ID_T>::save_bits(const char* filename)
+{
+	bits_header bh;
+	memset(&bh, 0, sizeof(bh));
+	memcpy(bh.magic_, BITS_MAGIC, sizeof(BITS_MAGIC));
+	bh.version_ = BITS_VERSION;
+	bh.height_ = header_.height_;
+	bh.width_ = header_.width_;
+	bh.padded_width_ = padded_width_;
+	bh.padded_height_ = padded_height_;
+	bh.db_size_ = db_size_;
+	bh.num_traversable_ = num_traversable_;
+
+	std::ofstream out(filename, std::ios::out | std::ios::binary);
+	if(!out.is_open()) { return false; }
+	char zeroes[BITS_DATA_OFFSET] = {0};
+	out.write((const char*)&bh, sizeof(bh));
+	out.write(zeroes, BITS_DATA_OFFSET - sizeof(bh));
+	out.write((const char*)db_, (std::streamsize)db_size_);
+	return out.good();
+}
+
+template<typename ID_T>
 void 
-warthog::gridmap::print(std::ostream& out)
+warthog::gridmap_base<ID_T>::print(std::ostream& out)
 {
 	out << "printing padded map" << std::endl;
 	out << "-------------------" << std::endl;
@@ -93,9 +228,12 @@ warthog::gridmap::print(std::ostream& out)
 	{
 		for(unsigned int x=0; x < this->width(); x++)
 		{
-			warthog::dbword c = this->get_label(y*this->width()+x);
+			warthog::dbword c = this->get_label((ID_T)y*this->width()+x);
 			out << (c ? '.' : '@');
 		}
 		out << std::endl;
 	}	
 }
+
+template class warthog::gridmap_base<uint32_t>;
+template class warthog::gridmap_base<uint64_t>;
@@ -14,6 +14,14 @@
 // in a one dimensional array and also to avoid range checks when trying to 
 // identify invalid neighbours of tiles on the edge of the map.
 //
+// The type of padded ids is a template parameter. warthog::gridmap uses
+// 32-bit ids; maps with more than 2^32 padded tiles need
+// gridmap_base<uint64_t>. Such maps are too large to parse from text, so
+// the tiles can also be loaded from a bit file (see ::save_bits) which is
+// memory-mapped rather than read: only the pages touched during search
+// are brought into memory. Files in either format are recognised by the
+// filename constructor.
+//
 // @author: dharabor
 // @created: 08/08/2012
 // 
@@ -30,54 +38,65 @@ namespace warthog
 {
 
 const uint32_t GRID_ID_MAX = (uint32_t)warthog::SN_ID_MAX;
-class gridmap
+
+template<typename ID_T>
+class gridmap_base
 {
 	public:
-		gridmap(uint32_t height, uint32_t width);
-		gridmap(const char* filename);
-		~gridmap();
+		gridmap_base(uint32_t height, uint32_t width);
+		gridmap_base(const char* filename);
+		~gridmap_base();
+
+		// write the tiles to a bit file, which can be loaded
+		// by the filename constructor. @return false on error
+		bool
+		save_bits(const char* filename);
+
+		// true if the tiles are memory-mapped from a bit file
+		inline bool
+		is_mapped() { return mapped_size_ != 0; }
 
 		// here we convert from the coordinate space of 
 		// the original grid to the coordinate space of db_. 
-		inline uint32_t
-		to_padded_id(uint32_t node_id)
+		inline ID_T
+		to_padded_id(ID_T node_id)
 		{
 			return node_id + 
 				// padded rows before the actual map data starts
-				padded_rows_before_first_row_*padded_width_ +
+				(ID_T)padded_rows_before_first_row_*padded_width_ +
 			   	// padding from each row of data before this one
 				(node_id / header_.width_) * padding_per_row_;
 		}
 
 		// here we convert from the coordinate space of 
 		// the original grid to the coordinate space of db_. 
-		inline uint32_t
+		inline ID_T
 		to_padded_id(uint32_t x, uint32_t y)
 		{
-			return to_padded_id(y * this->header_width() + x);
+			return to_padded_id((ID_T)y * this->header_width() + x);
 		}
 
 		inline void
-		to_padded_xy(uint32_t grid_id_p, uint32_t& x, uint32_t& y)
+		to_padded_xy(ID_T grid_id_p, uint32_t& x, uint32_t& y)
 		{
-			y = grid_id_p / padded_width_;
-			x = grid_id_p % padded_width_;
+			y = (uint32_t)(grid_id_p / padded_width_);
+			x = (uint32_t)(grid_id_p % padded_width_);
 		}
 
 		inline void
-		to_unpadded_xy(uint32_t grid_id_p, uint32_t& x, uint32_t& y)
+		to_unpadded_xy(ID_T grid_id_p, uint32_t& x, uint32_t& y)
 		{
-			grid_id_p -= padded_rows_before_first_row_* padded_width_;
-			y = grid_id_p / padded_width_;
-			x = grid_id_p % padded_width_;
+			grid_id_p -= (ID_T)padded_rows_before_first_row_* padded_width_;
+			y = (uint32_t)(grid_id_p / padded_width_);
+			x = (uint32_t)(grid_id_p % padded_width_);
 		}
 
-        inline uint32_t 
-        to_unpadded_id(uint32_t padded_id)
+        inline ID_T 
+        to_unpadded_id(ID_T padded_id)
         {
             uint32_t x, y;
             to_unpadded_xy(padded_id, x, y);
-            return y * header_.width_ + x;
+            return (ID_T)y * header_.width_ + x;
         }
 
 		// get the immediately adjacent neighbours of @param node_id
@@ -88,18 +107,18 @@ class gridmap
 		// lowest positions of the byte.
 		// position :0 is the nei in direction NW, :1 is N and :2 is NE 
 		inline void
-		get_neighbours(uint32_t grid_id_p, uint8_t tiles[3])
+		get_neighbours(ID_T grid_id_p, uint8_t tiles[3])
 		{
 			// 1. calculate the dbword offset for the node at index grid_id_p
 			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			uint32_t bit_offset = (uint32_t)(grid_id_p & warthog::DBWORD_BITS_MASK);
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
 
 			// compute dbword indexes for tiles immediately above 
 			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
+			ID_T pos1 = dbindex - dbwidth_;
+			ID_T pos2 = dbindex;
+			ID_T pos3 = dbindex + dbwidth_;
 
 			// read from the byte just before node_id and shift down until the
 			// nei adjacent to node_id is in the lowest position
@@ -112,18 +131,18 @@ class gridmap
 		// 32 tiles long. the middle row begins with tile grid_id_p. the other tiles
 		// are from the row immediately above and immediately below grid_id_p.
 		void
-		get_neighbours_32bit(uint32_t grid_id_p, uint32_t tiles[3])
+		get_neighbours_32bit(ID_T grid_id_p, uint32_t tiles[3])
 		{
 			// 1. calculate the dbword offset for the node at index grid_id_p
 			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			uint32_t bit_offset = (uint32_t)(grid_id_p & warthog::DBWORD_BITS_MASK);
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
 
 			// compute dbword indexes for tiles immediately above 
 			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
+			ID_T pos1 = dbindex - dbwidth_;
+			ID_T pos2 = dbindex;
+			ID_T pos3 = dbindex + dbwidth_;
 
 			// read 32bits of memory; grid_id_p is in the 
 			// lowest bit position of tiles[1]
@@ -136,12 +155,12 @@ class gridmap
 		// upper bit of the return value. this variant is useful when jumping
 		// toward smaller memory addresses (i.e. west instead of east).
 		inline void
-		get_neighbours_upper_32bit(uint32_t grid_id_p, uint32_t tiles[3])
+		get_neighbours_upper_32bit(ID_T grid_id_p, uint32_t tiles[3])
 		{
 			// 1. calculate the dbword offset for the node at index grid_id_p
 			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			uint32_t bit_offset = (uint32_t)(grid_id_p & warthog::DBWORD_BITS_MASK);
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
 			
 			// start reading from a prior index. this way everything
 			// up to grid_id_p is cached.
@@ -149,9 +168,9 @@ class gridmap
 
 			// compute dbword indexes for tiles immediately above 
 			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
+			ID_T pos1 = dbindex - dbwidth_;
+			ID_T pos2 = dbindex;
+			ID_T pos3 = dbindex + dbwidth_;
 
 			// read 32bits of memory; grid_id_p is in the 
 			// highest bit position of tiles[1]
@@ -164,25 +183,25 @@ class gridmap
 		inline bool
 		get_label(uint32_t x, unsigned int y)
 		{
-			return this->get_label(y*padded_width_+x);
+			return this->get_label((ID_T)y*padded_width_+x);
 		}
 
 		inline warthog::dbword 
-		get_label(uint32_t grid_id_p)
+		get_label(ID_T grid_id_p)
 		{
 			// now we can fetch the label
 			uint32_t bitmask = 1;
-			bitmask <<=  (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			bitmask <<=  (uint32_t)(grid_id_p & warthog::DBWORD_BITS_MASK);
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
 			if(dbindex > max_id_) { return 0; }
 			return (db_[dbindex] & bitmask) != 0;
 		}
 
         // get a pointer to the word that contains the label of node @grid_id_p
         inline warthog::dbword*
-        get_mem_ptr(uint32_t grid_id_p)
+        get_mem_ptr(ID_T grid_id_p)
         {
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
 			if(dbindex > max_id_) { return 0; }
 			return &db_[dbindex];
         }
@@ -191,14 +210,14 @@ class gridmap
 		inline void
 		set_label(uint32_t x, unsigned int y, bool label)
 		{
-			this->set_label(y*padded_width_+x, label);
+			this->set_label((ID_T)y*padded_width_+x, label);
 		}
 
 		inline void 
-		set_label(uint32_t grid_id_p, bool label)
+		set_label(ID_T grid_id_p, bool label)
 		{
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
-			uint32_t bitmask = 1u << (grid_id_p & warthog::DBWORD_BITS_MASK);
+			ID_T dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			uint32_t bitmask = 1u << (uint32_t)(grid_id_p & warthog::DBWORD_BITS_MASK);
 
 			if(dbindex > max_id_) { return; }
 
@@ -212,10 +231,10 @@ class gridmap
 			}
 		}
 
-		inline uint32_t
+		inline ID_T
 		padded_mapsize()
 		{
-			return padded_width_ * padded_height_;
+			return (ID_T)padded_width_ * padded_height_;
 		}
 
 		inline uint32_t 
@@ -248,7 +267,7 @@ class gridmap
 			return this->filename_;
 		}
 
-        inline uint32_t
+        inline ID_T
         get_num_traversable_tiles()
         {
             return num_traversable_;
@@ -258,7 +277,7 @@ class gridmap
         inline void
         invert()
         {
-            for(unsigned int i=0; i < db_size_; i++)
+            for(ID_T i=0; i < db_size_; i++)
             {
                 db_[i] = (warthog::dbword)~db_[i];
             }
@@ -286,21 +305,34 @@ class gridmap
 
 		uint32_t dbwidth_;
 		uint32_t dbheight_;
-		uint32_t db_size_;
+		ID_T db_size_;
 		uint32_t padded_width_;
 		uint32_t padded_height_;
 		uint32_t padding_per_row_;
 		uint32_t padding_column_above_;
 		uint32_t padded_rows_before_first_row_;
 		uint32_t padded_rows_after_last_row_;
-		uint32_t max_id_;
-        uint32_t num_traversable_;
+		ID_T max_id_;
+        ID_T num_traversable_;
 
-		gridmap(const warthog::gridmap& other) {}
-		gridmap& operator=(const warthog::gridmap& other) { return *this; }
-		void init_db();
+        // non-zero if db_ points into a memory-mapped bit file
+        void* mapped_;
+        size_t mapped_size_;
+
+		gridmap_base(const gridmap_base& other) {}
+		gridmap_base& operator=(const gridmap_base& other) { return *this; }
+
+		// compute the padded dimensions from the header. if
+		// @param allocate, create a zeroed array to store the tiles
+		void init_db(bool allocate = true);
+
+		// @return false if @param filename is not a bit file
+		bool load_bits(const char* filename);
+		void load_map(const char* filename);
 };
 
+typedef gridmap_base<uint32_t> gridmap;
+
 }
 
 #endif
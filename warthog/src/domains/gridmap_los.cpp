@@ -0,0 +1,68 @@
+#include "gridmap_los.h"
+
+#include <algorithm>
+
+bool
+warthog::gridmap_los::los(uint32_t from, uint32_t to)
+{
+    uint32_t x0, y0, x1, y1;
+    map_->to_padded_xy(from, x0, y0);
+    map_->to_padded_xy(to, x1, y1);
+    return los(x0, y0, x1, y1);
+}
+
+bool
+warthog::gridmap_los::los(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    if(y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); }
+    if(y0 == y1) { return span(std::min(x0, x1), std::max(x0, x1), y0); }
+
+    // we work with doubled coordinates, so that tile centres are at odd
+    // values and tile borders at even values. the segment runs from
+    // (X0, Y0) to (X0 + DX, Y0 + DY) with DY > 0.
+    int64_t X0 = 2*(int64_t)x0 + 1;
+    int64_t Y0 = 2*(int64_t)y0 + 1;
+    int64_t DX = 2*((int64_t)x1 - (int64_t)x0);
+    int64_t DY = 2*((int64_t)y1 - (int64_t)y0);
+    int64_t Y1 = Y0 + DY;
+
+    for(uint32_t y = y0; y <= y1; y++)
+    {
+        // the part of the segment inside row y; at height Y its
+        // x-coordinate is (X0*DY + (Y-Y0)*DX) / DY
+        int64_t ya = std::max<int64_t>(2*(int64_t)y, Y0);
+        int64_t yb = std::min<int64_t>(2*(int64_t)y + 2, Y1);
+        int64_t xa = X0*DY + (ya - Y0)*DX;
+        int64_t xb = X0*DY + (yb - Y0)*DX;
+        if(xa > xb) { std::swap(xa, xb); }
+
+        // tile c spans [2c, 2c+2] and is touched iff 2c <= xb/DY and
+        // 2c+2 >= xa/DY. all values are positive.
+        int64_t den = 2*DY;
+        uint32_t lo = (uint32_t)((xa + den - 1) / den - 1);
+        uint32_t hi = (uint32_t)(xb / den);
+        if(!span(lo, hi, y)) { return false; }
+    }
+    return true;
+}
+
+bool
+warthog::gridmap_los::span(uint32_t x0, uint32_t x1, uint32_t y)
+{
+    // read 64 bits at the byte holding the first tile of each run. after
+    // shifting, at least 56 tiles of the run are in the low bits. rows
+    // are followed by padding so the reads never leave the map.
+    uint32_t id = y*map_->width() + x0;
+    uint32_t len = x1 - x0 + 1;
+    while(len)
+    {
+        uint32_t n = std::min<uint32_t>(len, 56);
+        uint64_t tiles = *((uint64_t*)map_->get_mem_ptr(id));
+        tiles >>= (id & warthog::DBWORD_BITS_MASK);
+        uint64_t mask = (1ull << n) - 1;
+        if((tiles & mask) != mask) { return false; }
+        id += n;
+        len -= n;
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef WARTHOG_GRIDMAP_LOS_H
+#define WARTHOG_GRIDMAP_LOS_H
+
+// domains/gridmap_los.h
+//
+// Line-of-sight tests on a gridmap. The segment between the centres of
+// two tiles has line of sight if every tile it touches is traversable,
+// including tiles which the segment only touches at a corner. This is
+// the same rule that forbids corner cutting during search, so every
+// edge of a grid path has line of sight.
+//
+// Instead of visiting tiles one at a time, the test works row by row:
+// the part of the segment inside each row touches a contiguous run of
+// tiles, which is computed exactly (in integer arithmetic) and then
+// checked 56 tiles at a time by reading a word of the row and masking
+// it. A segment that spans dx columns and dy rows costs O(dy + dx/56).
+//
+// All coordinates and ids are padded (see gridmap).
+//
+
+#include "gridmap.h"
+
+#include <cstdint>
+
+namespace warthog
+{
+
+class gridmap_los
+{
+    public:
+        gridmap_los(warthog::gridmap* map) : map_(map) { }
+
+        // true if the segment between the centres of tiles @param from
+        // and @param to touches only traversable tiles
+        bool
+        los(uint32_t from, uint32_t to);
+
+        bool
+        los(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+        // true if the tiles from @param x0 to @param x1 (inclusive) in
+        // row @param y are all traversable
+        bool
+        span(uint32_t x0, uint32_t x1, uint32_t y);
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+    private:
+        warthog::gridmap* map_;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,140 @@
+#include "gridmap_path_smoother.h"
+
+#include <cmath>
+
+warthog::gridmap_path_smoother::gridmap_path_smoother(warthog::gridmap* map)
+    : map_(map), los_(map)
+{ }
+
+warthog::cost_t
+warthog::gridmap_path_smoother::distance(uint32_t from, uint32_t to)
+{
+    uint32_t x0, y0, x1, y1;
+    map_->to_padded_xy(from, x0, y0);
+    map_->to_padded_xy(to, x1, y1);
+    double dx = (double)x1 - (double)x0;
+    double dy = (double)y1 - (double)y0;
+    return sqrt(dx*dx + dy*dy);
+}
+
+void
+warthog::gridmap_path_smoother::turning_points(
+        std::vector<warthog::sn_id_t>& path)
+{
+    pts_.clear();
+    if(path.empty()) { return; }
+
+    int32_t mapw = (int32_t)map_->width();
+    int32_t pdx = 0, pdy = 0;
+    pts_.push_back((uint32_t)path[0]);
+    for(size_t i = 1; i < path.size(); i++)
+    {
+        uint32_t from = pts_.back();
+        uint32_t to = (uint32_t)path[i];
+        uint32_t x0, y0, x1, y1;
+        map_->to_padded_xy(from, x0, y0);
+        map_->to_padded_xy(to, x1, y1);
+        int32_t dx = (int32_t)x1 - (int32_t)x0;
+        int32_t dy = (int32_t)y1 - (int32_t)y0;
+        int32_t sx = (dx > 0) - (dx < 0);
+        int32_t sy = (dy > 0) - (dy < 0);
+        if(sx == 0 && sy == 0) { continue; }
+
+        // diagonal-first turning point between jump points
+        int32_t adx = dx * sx, ady = dy * sy;
+        if(adx != 0 && ady != 0 && adx != ady)
+        {
+            int32_t steps = std::min(adx, ady);
+            uint32_t mid = (uint32_t)((int32_t)from + steps*(sy*mapw + sx));
+            if(pts_.size() > 1 && sx == pdx && sy == pdy)
+            { pts_.back() = mid; }
+            else { pts_.push_back(mid); }
+            pdx = sx; pdy = sy;
+            sx = adx > ady ? sx : 0;
+            sy = ady > adx ? sy : 0;
+        }
+
+        // drop the previous point if it is in the middle of a line
+        if(pts_.size() > 1 && sx == pdx && sy == pdy) { pts_.back() = to; }
+        else { pts_.push_back(to); }
+        pdx = sx; pdy = sy;
+    }
+}
+
+void
+warthog::gridmap_path_smoother::greedy(std::vector<warthog::sn_id_t>& path)
+{
+    turning_points(path);
+    if(pts_.size() < 3)
+    {
+        path.assign(pts_.begin(), pts_.end());
+        return;
+    }
+
+    path.clear();
+    path.push_back(pts_[0]);
+    uint32_t anchor = pts_[0];
+    for(size_t k = 1; k+1 < pts_.size(); k++)
+    {
+        if(!los_.los(anchor, pts_[k+1]))
+        {
+            anchor = pts_[k];
+            path.push_back(anchor);
+        }
+    }
+    path.push_back(pts_.back());
+}
+
+void
+warthog::gridmap_path_smoother::optimal(std::vector<warthog::sn_id_t>& path)
+{
+    turning_points(path);
+    size_t n = pts_.size();
+    if(n < 3)
+    {
+        path.assign(pts_.begin(), pts_.end());
+        return;
+    }
+
+    // dist_[j] is the length of the shortest path from pts_[0] to pts_[j]
+    // through earlier turning points. consecutive turning points always
+    // have line of sight, so that is the initial candidate.
+    dist_.assign(n, 0);
+    parent_.assign(n, 0);
+    for(size_t j = 1; j < n; j++)
+    {
+        dist_[j] = dist_[j-1] + distance(pts_[j-1], pts_[j]);
+        parent_[j] = (uint32_t)(j-1);
+        for(size_t i = 0; i+1 < j; i++)
+        {
+            warthog::cost_t d = dist_[i] + distance(pts_[i], pts_[j]);
+            if(d < dist_[j] && los_.los(pts_[i], pts_[j]))
+            {
+                dist_[j] = d;
+                parent_[j] = (uint32_t)i;
+            }
+        }
+    }
+
+    path.clear();
+    for(uint32_t j = (uint32_t)(n-1); ; j = parent_[j])
+    {
+        path.push_back(pts_[j]);
+        if(j == 0) { break; }
+    }
+    for(size_t i = 0, k = path.size()-1; i < k; i++, k--)
+    {
+        std::swap(path[i], path[k]);
+    }
+}
+
+warthog::cost_t
+warthog::gridmap_path_smoother::length(std::vector<warthog::sn_id_t>& path)
+{
+    warthog::cost_t len = 0;
+    for(size_t i = 1; i < path.size(); i++)
+    {
+        len += distance((uint32_t)path[i-1], (uint32_t)path[i]);
+    }
+    return len;
+}
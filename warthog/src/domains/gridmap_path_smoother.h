@@ -0,0 +1,78 @@
+#ifndef WARTHOG_GRIDMAP_PATH_SMOOTHER_H
+#define WARTHOG_GRIDMAP_PATH_SMOOTHER_H
+
+// domains/gridmap_path_smoother.h
+//
+// Post-processing for paths on a gridmap. Smoothing replaces the
+// octile moves of a path with any-angle segments between tiles which
+// have line of sight (see gridmap_los), which shortens the path.
+//
+// Paths are sequences of padded ids, as produced by searching with
+// gridmap_expansion_policy or any of the JPS variants. Consecutive ids
+// need not be adjacent: a pair which is not on a straight or diagonal
+// line is assumed to be connected by a diagonal then a straight
+// segment, as in jump point search, and the turning point is added.
+// Collinear points are then removed; the remaining turning points are
+// the candidate vertices of the smoothed path.
+//
+// There are two strategies:
+//  - greedy: from each vertex of the smoothed path, move on to the
+//  furthest turning point that is visible without skipping one that
+//  isn't (string pulling). One line of sight test per turning point.
+//  - optimal: the shortest path from start to goal which uses only the
+//  turning points as vertices (dynamic programming; quadratic in the
+//  number of turning points, but most candidates are discarded before
+//  line of sight is tested because they cannot improve on the best
+//  distance found so far).
+//
+// In both cases the result is never longer than the input.
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "gridmap_los.h"
+
+#include <vector>
+
+namespace warthog
+{
+
+class gridmap_path_smoother
+{
+    public:
+        gridmap_path_smoother(warthog::gridmap* map);
+
+        void
+        greedy(std::vector<warthog::sn_id_t>& path);
+
+        void
+        optimal(std::vector<warthog::sn_id_t>& path);
+
+        // @return the euclidean length of @param path
+        warthog::cost_t
+        length(std::vector<warthog::sn_id_t>& path);
+
+        inline warthog::gridmap_los*
+        get_los() { return &los_; }
+
+    private:
+        warthog::gridmap* map_;
+        warthog::gridmap_los los_;
+
+        // scratch memory
+        std::vector<uint32_t> pts_;
+        std::vector<warthog::cost_t> dist_;
+        std::vector<uint32_t> parent_;
+
+        // copy the turning points of @param path to pts_
+        void
+        turning_points(std::vector<warthog::sn_id_t>& path);
+
+        warthog::cost_t
+        distance(uint32_t from, uint32_t to);
+};
+
+}
+
+#endif
+
@@ -0,0 +1,33 @@
+#include "tiled_gridmap.h"
+
+warthog::tiled_gridmap::tiled_gridmap(warthog::gridmap* map)
+{
+    header_width_ = map->header_width();
+    header_height_ = map->header_height();
+
+    // ::row_bits and ::col_bits read up to three blocks (24 tiles) from
+    // their starting position, which can be as far as PADDING tiles past
+    // the edge of the map; round up to a whole number of superblocks
+    // (64 tiles) so that ::row_segment and ::col_segment stay in bounds
+    padded_width_ = ((header_width_ + 2*PADDING + 16 + 63) / 64) * 64;
+    padded_height_ = ((header_height_ + 2*PADDING + 16 + 63) / 64) * 64;
+    superblocks_wide_ = padded_width_ / 64;
+    id_shift_ = 6;
+    while((1u << id_shift_) < padded_width_) { id_shift_++; }
+    blocks_.assign((size_t)(padded_width_ / 8) * (padded_height_ / 8), 0);
+
+    for(uint32_t y = 0; y < header_height_; y++)
+    {
+        for(uint32_t x = 0; x < header_width_; x++)
+        {
+            if(map->get_label(map->to_padded_id(x, y)))
+            {
+                set_label(x + PADDING, y + PADDING, true);
+            }
+        }
+    }
+}
+
+warthog::tiled_gridmap::~tiled_gridmap()
+{
+}
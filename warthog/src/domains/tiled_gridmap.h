@@ -0,0 +1,258 @@
+#ifndef WARTHOG_TILED_GRIDMAP_H
+#define WARTHOG_TILED_GRIDMAP_H
+
+// domains/tiled_gridmap.h
+//
+// A cache-blocked copy of a gridmap. Tiles are stored in 8x8 blocks,
+// one block per 64-bit word: bit (8*r + c) of a block is the tile in
+// row r and column c of the block. Blocks are grouped into superblocks
+// of 8x8 blocks (512 bytes) which are laid out row by row; inside a
+// superblock the blocks follow a Z-order (Morton) curve.
+//
+// In this layout the 8 tiles of a row segment and the 8 tiles of a
+// column segment are in the same word, and vertically adjacent blocks
+// are usually in the same or the next cache line. Scans in any
+// direction therefore touch a similar number of cache lines, so jump
+// point search does not need a second, rotated copy of the map.
+//
+// Like gridmap, coordinates and ids are padded: there are PADDING
+// obstacle tiles on every side of the map, so that scans can read a
+// few words past the edge without bounds checks. Ids are row-major in
+// the padded coordinate space but rows are a power of two apart, so
+// that converting ids to coordinates needs no division; ids past the
+// end of a row do not correspond to any tile.
+//
+
+#include "gridmap.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+class tiled_gridmap
+{
+    public:
+        // copy the tiles of @param map
+        tiled_gridmap(warthog::gridmap* map);
+        ~tiled_gridmap();
+
+        static const uint32_t PADDING = 16;
+
+        // width and height of the padded map. the width is the
+        // distance between the ids of vertically adjacent tiles.
+        inline uint32_t
+        width() const { return 1u << id_shift_; }
+
+        inline uint32_t
+        height() const { return padded_height_; }
+
+        // width and height of the original map
+        inline uint32_t
+        header_width() const { return header_width_; }
+
+        inline uint32_t
+        header_height() const { return header_height_; }
+
+        // id of the tile at padded coordinates (@param x, @param y)
+        inline uint32_t
+        to_id(uint32_t x, uint32_t y)
+        {
+            return (y << id_shift_) | x;
+        }
+
+        inline uint32_t
+        to_padded_id(uint32_t x, uint32_t y)
+        {
+            return to_id(x + PADDING, y + PADDING);
+        }
+
+        inline uint32_t
+        to_padded_id(uint32_t node_id)
+        {
+            return to_padded_id(node_id % header_width_,
+                    node_id / header_width_);
+        }
+
+        inline void
+        to_padded_xy(uint32_t padded_id, uint32_t& x, uint32_t& y)
+        {
+            y = padded_id >> id_shift_;
+            x = padded_id & ((1u << id_shift_) - 1);
+        }
+
+        inline void
+        to_unpadded_xy(uint32_t padded_id, uint32_t& x, uint32_t& y)
+        {
+            to_padded_xy(padded_id, x, y);
+            x -= PADDING;
+            y -= PADDING;
+        }
+
+        // labels, given padded coordinates
+        inline bool
+        get_label(uint32_t x, uint32_t y)
+        {
+            return (block(x, y) >> (((y & 7) << 3) | (x & 7))) & 1;
+        }
+
+        inline void
+        set_label(uint32_t x, uint32_t y, bool label)
+        {
+            uint64_t bit = 1ull << (((y & 7) << 3) | (x & 7));
+            uint64_t& b = block(x, y);
+            b = label ? (b | bit) : (b & ~bit);
+        }
+
+        inline bool
+        get_label(uint32_t padded_id)
+        {
+            uint32_t x, y;
+            to_padded_xy(padded_id, x, y);
+            return get_label(x, y);
+        }
+
+        inline void
+        set_label(uint32_t padded_id, bool label)
+        {
+            uint32_t x, y;
+            to_padded_xy(padded_id, x, y);
+            set_label(x, y, label);
+        }
+
+        // 16 tiles from row @param y, beginning at column @param x.
+        // tile (x, y) is in the lowest bit.
+        inline uint32_t
+        row_bits(uint32_t x, uint32_t y)
+        {
+            uint32_t shift = (y & 7) << 3;
+            uint32_t v =
+                (uint32_t)((block(x, y) >> shift) & 0xff) |
+                (uint32_t)((block(x + 8, y) >> shift) & 0xff) << 8 |
+                (uint32_t)((block(x + 16, y) >> shift) & 0xff) << 16;
+            return (v >> (x & 7)) & 0xffff;
+        }
+
+        // 16 tiles from column @param x, beginning at row @param y.
+        // tile (x, y) is in the lowest bit.
+        inline uint32_t
+        col_bits(uint32_t x, uint32_t y)
+        {
+            uint32_t c = x & 7;
+            uint32_t v =
+                column(block(x, y), c) |
+                column(block(x, y + 8), c) << 8 |
+                column(block(x, y + 16), c) << 16;
+            return (v >> (y & 7)) & 0xffff;
+        }
+
+        // the 64 tiles of row @param y which are in superblock column
+        // @param sx, i.e. tiles (64*sx, y) to (64*sx + 63, y), with the
+        // first in the lowest bit. each row of a block is one byte, so
+        // we read the bytes directly (assumes little endian format).
+        inline uint64_t
+        row_segment(uint32_t sx, uint32_t y)
+        {
+            const uint8_t* b = (const uint8_t*)&blocks_[
+                (((y >> 6) * superblocks_wide_ + sx) << 6) |
+                (spread3((y >> 3) & 7) << 1)] + (y & 7);
+            return
+                (uint64_t)b[0] | (uint64_t)b[8] << 8 |
+                (uint64_t)b[32] << 16 | (uint64_t)b[40] << 24 |
+                (uint64_t)b[128] << 32 | (uint64_t)b[136] << 40 |
+                (uint64_t)b[160] << 48 | (uint64_t)b[168] << 56;
+        }
+
+        // the 64 tiles of column @param x which are in superblock row
+        // @param sy, i.e. tiles (x, 64*sy) to (x, 64*sy + 63), with the
+        // first in the lowest bit
+        inline uint64_t
+        col_segment(uint32_t x, uint32_t sy)
+        {
+            const uint64_t* b = &blocks_[
+                ((sy * superblocks_wide_ + (x >> 6)) << 6) |
+                spread3((x >> 3) & 7)];
+            uint32_t c = x & 7;
+            return
+                (uint64_t)column(b[0], c) |
+                (uint64_t)column(b[2], c) << 8 |
+                (uint64_t)column(b[8], c) << 16 |
+                (uint64_t)column(b[10], c) << 24 |
+                (uint64_t)column(b[32], c) << 32 |
+                (uint64_t)column(b[34], c) << 40 |
+                (uint64_t)column(b[40], c) << 48 |
+                (uint64_t)column(b[42], c) << 56;
+        }
+
+        // get the immediately adjacent neighbours of @param padded_id,
+        // in the same format as gridmap::get_neighbours: tiles[0] has
+        // the row above, tiles[1] the same row and tiles[2] the row
+        // below; the bits for (x-1, x, x+1) are the three lowest.
+        inline void
+        get_neighbours(uint32_t padded_id, uint8_t tiles[3])
+        {
+            uint32_t x, y;
+            to_padded_xy(padded_id, x, y);
+
+            // usually all nine tiles are in the same block
+            if(((x & 7) - 1) < 6 && ((y & 7) - 1) < 6)
+            {
+                uint64_t b = block(x, y) >>
+                    ((((y & 7) - 1) << 3) + (x & 7) - 1);
+                tiles[0] = (uint8_t)(b & 7);
+                tiles[1] = (uint8_t)((b >> 8) & 7);
+                tiles[2] = (uint8_t)((b >> 16) & 7);
+                return;
+            }
+            tiles[0] = (uint8_t)(row_bits(x - 1, y - 1) & 7);
+            tiles[1] = (uint8_t)(row_bits(x - 1, y) & 7);
+            tiles[2] = (uint8_t)(row_bits(x - 1, y + 1) & 7);
+        }
+
+        inline size_t
+        mem()
+        {
+            return sizeof(*this) + sizeof(uint64_t) * blocks_.capacity();
+        }
+
+    private:
+        uint32_t header_width_, header_height_;
+        uint32_t padded_width_, padded_height_;
+        uint32_t superblocks_wide_;
+        uint32_t id_shift_;
+        std::vector<uint64_t> blocks_;
+
+        // interleave the three lowest bits of v with zeroes
+        static inline uint32_t
+        spread3(uint32_t v)
+        {
+            return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+        }
+
+        inline uint32_t
+        block_index(uint32_t bx, uint32_t by)
+        {
+            uint32_t sb = (by >> 3) * superblocks_wide_ + (bx >> 3);
+            return (sb << 6) | spread3(bx & 7) | (spread3(by & 7) << 1);
+        }
+
+        // the word holding tile (@param x, @param y)
+        inline uint64_t&
+        block(uint32_t x, uint32_t y)
+        {
+            return blocks_[block_index(x >> 3, y >> 3)];
+        }
+
+        // gather column @param c of a block into the low byte
+        static inline uint32_t
+        column(uint64_t b, uint32_t c)
+        {
+            return (uint32_t)((((b >> c) & 0x0101010101010101ull) *
+                        0x0102040810204080ull) >> 56) & 0xff;
+        }
+};
+
+}
+
+#endif
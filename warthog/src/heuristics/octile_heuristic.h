@@ -43,8 +43,19 @@ class octile_heuristic
 		{
 			int32_t x, x2;
 			int32_t y, y2;
-			warthog::helpers::index_to_xy((uint32_t)id, mapwidth_, x, y);
-			warthog::helpers::index_to_xy((uint32_t)id2,mapwidth_, x2, y2);
+			if(((id | id2) >> 32) == 0)
+			{
+				warthog::helpers::index_to_xy((uint32_t)id, mapwidth_, x, y);
+				warthog::helpers::index_to_xy((uint32_t)id2,mapwidth_, x2, y2);
+			}
+			else
+			{
+				// ids from maps with more than 2^32 padded tiles
+				y = (int32_t)(id / mapwidth_);
+				x = (int32_t)(id % mapwidth_);
+				y2 = (int32_t)(id2 / mapwidth_);
+				x2 = (int32_t)(id2 % mapwidth_);
+			}
 			return this->h(x, y, x2, y2);
 		}
 
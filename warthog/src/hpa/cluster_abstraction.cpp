@@ -0,0 +1,391 @@
+#include "cluster_abstraction.h"
+#include "gridmap.h"
+#include "helpers.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+namespace
+{
+
+// entrances at least this wide get a transition at each end;
+// narrower entrances get a single transition in the middle
+const uint32_t MIN_WIDE_ENTRANCE = 6;
+
+struct cluster_shared_data
+{
+    warthog::hpa::cluster_abstraction* abs_;
+    std::vector<uint32_t>* clusters_;
+    bool entrances_;
+};
+
+}
+
+warthog::hpa::cluster_abstraction::cluster_abstraction(
+        warthog::gridmap* map, uint32_t cluster_size)
+    : map_(map), cluster_size_(std::max<uint32_t>(cluster_size, 2))
+{
+    clusters_wide_ =
+        (map_->header_width() + cluster_size_ - 1) / cluster_size_;
+    clusters_high_ =
+        (map_->header_height() + cluster_size_ - 1) / cluster_size_;
+    num_clusters_ = clusters_wide_ * clusters_high_;
+    version_ = 0;
+    preproc_nanos_ = 0;
+}
+
+warthog::hpa::cluster_abstraction::~cluster_abstraction()
+{ }
+
+void
+warthog::hpa::cluster_abstraction::build()
+{
+    border_.assign(num_clusters_ * 2, std::vector<transition>());
+    cluster_cells_.assign(num_clusters_, std::vector<uint32_t>());
+    cluster_edges_.assign(num_clusters_, std::vector<intra_edge>());
+
+    std::vector<uint32_t> clusters(num_clusters_);
+    for(uint32_t i = 0; i < num_clusters_; i++) { clusters[i] = i; }
+    compute_clusters(clusters);
+}
+
+void
+warthog::hpa::cluster_abstraction::update(const std::vector<uint32_t>& cells)
+{
+    // the borders of a changed cluster belong to the cluster itself and
+    // to its neighbours to the west and north. the abstract nodes of all
+    // four neighbours may change.
+    std::vector<uint32_t> clusters;
+    for(uint32_t cell : cells)
+    {
+        uint32_t c = cluster_of(cell);
+        uint32_t cx = c % clusters_wide_;
+        uint32_t cy = c / clusters_wide_;
+        clusters.push_back(c);
+        if(cx > 0) { clusters.push_back(c - 1); }
+        if(cy > 0) { clusters.push_back(c - clusters_wide_); }
+        if(cx + 1 < clusters_wide_) { clusters.push_back(c + 1); }
+        if(cy + 1 < clusters_high_) { clusters.push_back(c + clusters_wide_); }
+    }
+    std::sort(clusters.begin(), clusters.end());
+    clusters.erase(std::unique(clusters.begin(), clusters.end()),
+            clusters.end());
+    compute_clusters(clusters);
+}
+
+void
+warthog::hpa::cluster_abstraction::compute_clusters(
+        std::vector<uint32_t>& clusters)
+{
+    warthog::timer mytimer;
+    mytimer.start();
+
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        cluster_shared_data* shared = (cluster_shared_data*) par->shared_;
+        warthog::hpa::cluster_abstraction* abs = shared->abs_;
+        std::vector<uint32_t>& clusters = *shared->clusters_;
+
+        dijkstra_data scratch;
+        for(size_t i = par->thread_id_; i < clusters.size();
+                i += par->max_threads_)
+        {
+            if(shared->entrances_) { abs->compute_entrances(clusters[i]); }
+            else { abs->compute_intra_edges(clusters[i], scratch); }
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    cluster_shared_data shared;
+    shared.abs_ = this;
+    shared.clusters_ = &clusters;
+
+    // every cluster owns its east and south borders, so entrances can be
+    // found independently. intra-edges depend on the borders of the
+    // neighbouring clusters, so they wait until all entrances are known.
+    shared.entrances_ = true;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, (uint32_t)clusters.size());
+    shared.entrances_ = false;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, (uint32_t)clusters.size());
+
+    assemble();
+    mytimer.stop();
+    preproc_nanos_ += mytimer.elapsed_time_nano();
+    std::cerr << "hpa abstraction: " << clusters.size() << " of "
+        << num_clusters_ << " clusters computed; "
+        << cell_of_node_.size() << " abstract nodes; "
+        << mytimer.elapsed_time_micro() / 1000 << "ms\n";
+}
+
+uint32_t
+warthog::hpa::cluster_abstraction::cluster_of(uint32_t cell)
+{
+    uint32_t x, y;
+    map_->to_unpadded_xy(cell, x, y);
+    return (y / cluster_size_) * clusters_wide_ + (x / cluster_size_);
+}
+
+void
+warthog::hpa::cluster_abstraction::compute_entrances(uint32_t c)
+{
+    uint32_t cx = c % clusters_wide_;
+    uint32_t cy = c / clusters_wide_;
+    uint32_t x0 = cx * cluster_size_;
+    uint32_t y0 = cy * cluster_size_;
+    uint32_t x1 = std::min(map_->header_width(), x0 + cluster_size_);
+    uint32_t y1 = std::min(map_->header_height(), y0 + cluster_size_);
+
+    // scan a border one tile pair at a time; @param step moves along the
+    // border and @param across moves from this cluster into the next
+    auto scan = [this](uint32_t first, uint32_t len, uint32_t step,
+            uint32_t across, std::vector<transition>& out)
+    {
+        out.clear();
+        uint32_t run = 0;
+        for(uint32_t i = 0; i <= len; i++)
+        {
+            uint32_t cell = first + i * step;
+            bool open = i < len &&
+                map_->get_label(cell) && map_->get_label(cell + across);
+            if(open) { run++; continue; }
+            if(run == 0) { continue; }
+
+            uint32_t run_first = first + (i - run) * step;
+            uint32_t run_last = first + (i - 1) * step;
+            if(run < MIN_WIDE_ENTRANCE)
+            {
+                uint32_t mid = first + (i - run + (run - 1) / 2) * step;
+                out.push_back(transition{mid, mid + across});
+            }
+            else
+            {
+                out.push_back(transition{run_first, run_first + across});
+                out.push_back(transition{run_last, run_last + across});
+            }
+            run = 0;
+        }
+    };
+
+    if(cx + 1 < clusters_wide_)
+    {
+        scan(map_->to_padded_id(x1 - 1, y0), y1 - y0, map_->width(), 1,
+                border_[2*c]);
+    }
+    if(cy + 1 < clusters_high_)
+    {
+        scan(map_->to_padded_id(x0, y1 - 1), x1 - x0, 1, map_->width(),
+                border_[2*c + 1]);
+    }
+}
+
+void
+warthog::hpa::cluster_abstraction::compute_intra_edges(
+        uint32_t c, dijkstra_data& scratch)
+{
+    uint32_t cx = c % clusters_wide_;
+    uint32_t cy = c / clusters_wide_;
+
+    std::vector<uint32_t>& cells = cluster_cells_[c];
+    cells.clear();
+    for(transition& t : border_[2*c]) { cells.push_back(t.from_); }
+    for(transition& t : border_[2*c + 1]) { cells.push_back(t.from_); }
+    if(cx > 0)
+    {
+        for(transition& t : border_[2*(c-1)]) { cells.push_back(t.to_); }
+    }
+    if(cy > 0)
+    {
+        for(transition& t : border_[2*(c-clusters_wide_) + 1])
+        { cells.push_back(t.to_); }
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    std::vector<intra_edge>& edges = cluster_edges_[c];
+    edges.clear();
+    uint32_t x0 = cx * cluster_size_;
+    uint32_t y0 = cy * cluster_size_;
+    for(uint32_t from : cells)
+    {
+        cluster_dijkstra(c, from, scratch);
+        for(uint32_t to : cells)
+        {
+            if(to == from) { continue; }
+            uint32_t x, y;
+            map_->to_unpadded_xy(to, x, y);
+            warthog::cost_t d =
+                scratch.dist_[(y - y0) * cluster_size_ + (x - x0)];
+            if(d != warthog::COST_MAX)
+            {
+                edges.push_back(intra_edge{from, to, d});
+            }
+        }
+    }
+}
+
+void
+warthog::hpa::cluster_abstraction::cluster_dijkstra(
+        uint32_t c, uint32_t source, dijkstra_data& scratch)
+{
+    uint32_t x0 = (c % clusters_wide_) * cluster_size_;
+    uint32_t y0 = (c / clusters_wide_) * cluster_size_;
+    uint32_t x1 = std::min(map_->header_width(), x0 + cluster_size_);
+    uint32_t y1 = std::min(map_->header_height(), y0 + cluster_size_);
+    scratch.dist_.assign(cluster_size_ * cluster_size_, warthog::COST_MAX);
+
+    typedef std::pair<warthog::cost_t, uint32_t> qentry;
+    std::priority_queue<qentry, std::vector<qentry>, std::greater<qentry>>
+        open;
+
+    uint32_t sx, sy;
+    map_->to_unpadded_xy(source, sx, sy);
+    scratch.dist_[(sy - y0) * cluster_size_ + (sx - x0)] = 0;
+    open.push(qentry(0, (sy - y0) * cluster_size_ + (sx - x0)));
+
+    const int32_t dx[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+    const int32_t dy[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+    while(open.size())
+    {
+        qentry top = open.top();
+        open.pop();
+        if(top.first > scratch.dist_[top.second]) { continue; }
+
+        int32_t lx = (int32_t)(top.second % cluster_size_);
+        int32_t ly = (int32_t)(top.second / cluster_size_);
+        for(uint32_t k = 0; k < 8; k++)
+        {
+            int32_t nx = lx + dx[k];
+            int32_t ny = ly + dy[k];
+            if(nx < 0 || ny < 0 ||
+               (uint32_t)nx + x0 >= x1 || (uint32_t)ny + y0 >= y1)
+            {
+                continue;
+            }
+            if(!map_->get_label(map_->to_padded_id(nx + x0, ny + y0)))
+            { continue; }
+
+            warthog::cost_t cost = 1;
+            if(k >= 4)
+            {
+                // no corner cutting; both corner tiles lie in the cluster
+                if(!map_->get_label(map_->to_padded_id(nx + x0, ly + y0)) ||
+                   !map_->get_label(map_->to_padded_id(lx + x0, ny + y0)))
+                {
+                    continue;
+                }
+                cost = warthog::DBL_ROOT_TWO;
+            }
+
+            uint32_t nid = (uint32_t)ny * cluster_size_ + (uint32_t)nx;
+            warthog::cost_t g = top.first + cost;
+            if(g < scratch.dist_[nid])
+            {
+                scratch.dist_[nid] = g;
+                open.push(qentry(g, nid));
+            }
+        }
+    }
+}
+
+void
+warthog::hpa::cluster_abstraction::connect(uint32_t source, uint32_t target,
+        std::vector<std::pair<uint32_t, warthog::cost_t>>& reached,
+        warthog::cost_t& target_dist)
+{
+    reached.clear();
+    target_dist = warthog::COST_MAX;
+
+    uint32_t c = cluster_of(source);
+    uint32_t x0 = (c % clusters_wide_) * cluster_size_;
+    uint32_t y0 = (c / clusters_wide_) * cluster_size_;
+    cluster_dijkstra(c, source, query_scratch_);
+
+    for(uint32_t cell : cluster_cells_[c])
+    {
+        uint32_t x, y;
+        map_->to_unpadded_xy(cell, x, y);
+        warthog::cost_t d =
+            query_scratch_.dist_[(y - y0) * cluster_size_ + (x - x0)];
+        if(d != warthog::COST_MAX)
+        {
+            reached.push_back(std::pair<uint32_t, warthog::cost_t>(
+                        node_of_cell_[cell], d));
+        }
+    }
+
+    if(cluster_of(target) == c)
+    {
+        uint32_t x, y;
+        map_->to_unpadded_xy(target, x, y);
+        target_dist =
+            query_scratch_.dist_[(y - y0) * cluster_size_ + (x - x0)];
+    }
+}
+
+void
+warthog::hpa::cluster_abstraction::assemble()
+{
+    cell_of_node_.clear();
+    node_of_cell_.clear();
+    for(uint32_t c = 0; c < num_clusters_; c++)
+    {
+        for(uint32_t cell : cluster_cells_[c])
+        {
+            node_of_cell_[cell] = (uint32_t)cell_of_node_.size();
+            cell_of_node_.push_back(cell);
+        }
+    }
+
+    g_.clear();
+    for(uint32_t id = 0; id < cell_of_node_.size(); id++)
+    {
+        uint32_t x, y;
+        map_->to_unpadded_xy(cell_of_node_[id], x, y);
+        g_.add_node((int32_t)x, (int32_t)y, id);
+    }
+
+    // reserved nodes for the start and goal of each query
+    g_.add_node(0, 0, get_start_node());
+    g_.add_node(0, 0, get_goal_node());
+
+    for(uint32_t c = 0; c < num_clusters_; c++)
+    {
+        for(intra_edge& e : cluster_edges_[c])
+        {
+            g_.get_node(node_of_cell_[e.from_])->add_outgoing(
+                    warthog::graph::edge(node_of_cell_[e.to_], e.cost_));
+        }
+        for(uint32_t d = 0; d < 2; d++)
+        {
+            for(transition& t : border_[2*c + d])
+            {
+                uint32_t from = node_of_cell_[t.from_];
+                uint32_t to = node_of_cell_[t.to_];
+                g_.get_node(from)->add_outgoing(warthog::graph::edge(to, 1));
+                g_.get_node(to)->add_outgoing(warthog::graph::edge(from, 1));
+            }
+        }
+    }
+    version_++;
+}
+
+size_t
+warthog::hpa::cluster_abstraction::mem()
+{
+    size_t bytes = sizeof(*this) + g_.mem() +
+        sizeof(uint32_t) * cell_of_node_.capacity() +
+        (sizeof(uint32_t) * 2 + sizeof(void*)) * node_of_cell_.size();
+    for(auto& b : border_) { bytes += sizeof(transition) * b.capacity(); }
+    for(auto& c : cluster_cells_) { bytes += sizeof(uint32_t) * c.capacity(); }
+    for(auto& e : cluster_edges_) { bytes += sizeof(intra_edge) * e.capacity(); }
+    return bytes;
+}
@@ -0,0 +1,180 @@
+#ifndef WARTHOG_HPA_CLUSTER_ABSTRACTION_H
+#define WARTHOG_HPA_CLUSTER_ABSTRACTION_H
+
+// hpa/cluster_abstraction.h
+//
+// A two-level abstraction of a gridmap, as used by HPA*.
+// The map is divided into square clusters. Wherever two adjacent
+// clusters share a run of traversable tiles along their common border
+// we create an entrance: one transition (a pair of facing tiles) in the
+// middle of short runs and two transitions, one at each end, of long
+// runs. The tiles of every transition are nodes of the abstract graph.
+// Inter-edges connect the two tiles of each transition. Intra-edges
+// connect every pair of nodes inside the same cluster and are labelled
+// with the length of the shortest path between them that does not leave
+// the cluster.
+//
+// Entrances and intra-edges are computed for each cluster independently,
+// in parallel. The abstract graph is stored as an xy_graph; two extra
+// nodes at the end are reserved for the start and goal of each query
+// (see hpa_search). When tiles change, only the clusters around them are
+// recomputed and the graph is reassembled.
+//
+// For more details see:
+// [Botea, Muller and Schaeffer. Near Optimal Hierarchical Path-Finding.
+// Journal of Game Development, 2004]
+//
+
+#include "constants.h"
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace warthog
+{
+
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
+
+namespace hpa
+{
+
+class cluster_abstraction
+{
+    public:
+        // @param cluster_size: width and height of each cluster, in tiles
+        cluster_abstraction(warthog::gridmap* map, uint32_t cluster_size);
+        ~cluster_abstraction();
+
+        // build clusters, entrances and the abstract graph
+        void
+        build();
+
+        // recompute the clusters around the tiles with (padded) ids
+        // @param cells and reassemble the abstract graph. the map must
+        // already contain the new values.
+        void
+        update(const std::vector<uint32_t>& cells);
+
+        // compute the shortest paths from (padded) tile @param source to
+        // every abstract node in its cluster. paths may not leave the
+        // cluster. @return one (node id, cost) pair per reachable node.
+        // if @param target is inside the same cluster and reachable, its
+        // distance is written to @param target_dist (otherwise, the
+        // value is warthog::COST_MAX).
+        void
+        connect(uint32_t source, uint32_t target,
+                std::vector<std::pair<uint32_t, warthog::cost_t>>& reached,
+                warthog::cost_t& target_dist);
+
+        inline warthog::graph::xy_graph*
+        get_graph() { return &g_; }
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+        // @return the (padded) id of the tile of abstract node @param id
+        inline uint32_t
+        get_cell(uint32_t id) { return cell_of_node_.at(id); }
+
+        // id of the abstract node reserved for the start of a query
+        inline uint32_t
+        get_start_node() { return (uint32_t)cell_of_node_.size(); }
+
+        // id of the abstract node reserved for the goal of a query
+        inline uint32_t
+        get_goal_node() { return (uint32_t)cell_of_node_.size() + 1; }
+
+        inline uint32_t
+        get_cluster_size() { return cluster_size_; }
+
+        inline uint32_t
+        get_num_clusters() { return num_clusters_; }
+
+        // incremented every time the abstract graph is reassembled
+        inline uint32_t
+        get_version() { return version_; }
+
+        // total time spent building and updating the abstraction
+        inline double
+        get_preprocessing_nanos() { return preproc_nanos_; }
+
+        size_t
+        mem();
+
+    private:
+        // a pair of facing tiles on a border between two clusters
+        struct transition
+        {
+            uint32_t from_;
+            uint32_t to_;
+        };
+
+        struct intra_edge
+        {
+            uint32_t from_;
+            uint32_t to_;
+            warthog::cost_t cost_;
+        };
+
+        // scratch memory for cluster-restricted Dijkstra searches
+        struct dijkstra_data
+        {
+            std::vector<warthog::cost_t> dist_;
+            std::vector<uint32_t> touched_;
+        };
+
+        warthog::gridmap* map_;
+        uint32_t cluster_size_;
+        uint32_t clusters_wide_;
+        uint32_t clusters_high_;
+        uint32_t num_clusters_;
+        uint32_t version_;
+        double preproc_nanos_;
+
+        // transitions on the east and south border of every cluster,
+        // indexed as 2*cluster_id (east) and 2*cluster_id + 1 (south)
+        std::vector<std::vector<transition>> border_;
+
+        // the abstract nodes and intra-edges of every cluster
+        std::vector<std::vector<uint32_t>> cluster_cells_;
+        std::vector<std::vector<intra_edge>> cluster_edges_;
+
+        warthog::graph::xy_graph g_;
+        std::vector<uint32_t> cell_of_node_;
+        std::unordered_map<uint32_t, uint32_t> node_of_cell_;
+        dijkstra_data query_scratch_;
+
+        uint32_t
+        cluster_of(uint32_t cell);
+
+        // find the transitions on the east and south border of @param c
+        void
+        compute_entrances(uint32_t c);
+
+        // collect the abstract nodes of @param c and connect them
+        void
+        compute_intra_edges(uint32_t c, dijkstra_data& scratch);
+
+        // Dijkstra from @param source which does not leave cluster @param c
+        void
+        cluster_dijkstra(uint32_t c, uint32_t source, dijkstra_data& scratch);
+
+        // run compute_entrances then compute_intra_edges, in parallel,
+        // for every cluster in @param clusters
+        void
+        compute_clusters(std::vector<uint32_t>& clusters);
+
+        // rebuild the xy_graph from the per-cluster data
+        void
+        assemble();
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef WARTHOG_HPA_SEARCH_H
+#define WARTHOG_HPA_SEARCH_H
+
+// hpa/hpa_search.h
+//
+// HPA* query algorithm. Every query has three steps:
+//
+//  (i) insertion: the start and goal are connected to the abstract
+//  nodes of their clusters, using the two nodes that the abstraction
+//  reserves for this purpose. If both are in the same cluster and
+//  connected inside it, a direct edge is added too.
+//
+//  (ii) abstract search: A* on the abstract graph, from the start node
+//  to the goal node.
+//
+//  (iii) refinement: every segment of the abstract path is turned into
+//  a path on the grid with jump point search.
+//
+// Paths are near-optimal: the abstract path goes through the
+// transitions chosen during preprocessing, though refinement may find
+// a shorter segment between two of them. The reported cost is the
+// length of the refined path.
+//
+
+#include "cluster_abstraction.h"
+#include "euclidean_heuristic.h"
+#include "flexible_astar.h"
+#include "graph_expansion_policy.h"
+#include "gridmap.h"
+#include "jps_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+
+#include <memory>
+#include <vector>
+
+namespace warthog
+{
+
+namespace hpa
+{
+
+class hpa_search : public warthog::search
+{
+    typedef warthog::flexible_astar<
+                warthog::euclidean_heuristic,
+                warthog::simple_graph_expansion_policy,
+                warthog::pqueue_min> abstract_search;
+
+    typedef warthog::flexible_astar<
+                warthog::octile_heuristic,
+                warthog::jps_expansion_policy,
+                warthog::pqueue_min> refinement_search;
+
+    public:
+        hpa_search(warthog::hpa::cluster_abstraction* abs)
+            : abs_(abs), version_(UINT32_MAX),
+              ah_(abs->get_graph()),
+              jps_(abs->get_map()),
+              rh_(abs->get_map()->width(), abs->get_map()->height()),
+              refine_(&rh_, &jps_, &ropen_)
+        { }
+
+        virtual ~hpa_search() { }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            sol.reset();
+            warthog::timer mytimer;
+            mytimer.start();
+
+            warthog::gridmap* map = abs_->get_map();
+            uint32_t max_id = map->header_width() * map->header_height();
+            if(pi.start_id_ >= max_id || pi.target_id_ >= max_id) { return; }
+            uint32_t s = map->to_padded_id((uint32_t)pi.start_id_);
+            uint32_t t = map->to_padded_id((uint32_t)pi.target_id_);
+            if(!map->get_label(s) || !map->get_label(t)) { return; }
+
+            // the node pool of the abstract search depends on the size of
+            // the graph, which changes whenever the abstraction is updated
+            if(abs_->get_version() != version_)
+            {
+                expander_.reset(new warthog::simple_graph_expansion_policy(
+                            abs_->get_graph()));
+                abstract_.reset(new abstract_search(
+                            &ah_, expander_.get(), &aopen_));
+                version_ = abs_->get_version();
+            }
+
+            std::vector<uint32_t> path_cells;
+            warthog::solution asol;
+            if(!insert_and_search(s, t, asol, path_cells))
+            {
+                finish(mytimer, asol, sol);
+                return;
+            }
+
+            // refine each abstract segment
+            warthog::cost_t cost = 0;
+            uint32_t refine_expanded = 0, refine_touched = 0;
+            sol.path_.push_back(s);
+            for(uint32_t i = 1; i < path_cells.size(); i++)
+            {
+                warthog::problem_instance rpi(
+                        map->to_unpadded_id(path_cells[i-1]),
+                        map->to_unpadded_id(path_cells[i]));
+                warthog::solution rsol;
+                refine_.get_path(rpi, rsol);
+                refine_expanded += rsol.nodes_expanded_;
+                refine_touched += rsol.nodes_touched_;
+                if(rsol.path_.size() == 0) { sol.path_.clear(); break; }
+                cost += rsol.sum_of_edge_costs_;
+                sol.path_.insert(sol.path_.end(),
+                        rsol.path_.begin() + 1, rsol.path_.end());
+            }
+            if(sol.path_.size()) { sol.sum_of_edge_costs_ = cost; }
+
+            asol.nodes_expanded_ += refine_expanded;
+            asol.nodes_touched_ += refine_touched;
+            finish(mytimer, asol, sol);
+        }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            get_path(pi, sol);
+        }
+
+        // call between queries, after changing the traversability of
+        // the cells @param changed_ids (padded ids) on the map
+        void
+        update_map(const std::vector<uint32_t>& changed_ids)
+        {
+            abs_->update(changed_ids);
+            jps_.update_map(changed_ids);
+        }
+
+        virtual size_t
+        mem()
+        {
+            return sizeof(*this) + abs_->mem() + refine_.mem() +
+                (abstract_ ? abstract_->mem() : 0);
+        }
+
+    private:
+        warthog::hpa::cluster_abstraction* abs_;
+        uint32_t version_;
+
+        warthog::euclidean_heuristic ah_;
+        warthog::pqueue_min aopen_;
+        std::unique_ptr<warthog::simple_graph_expansion_policy> expander_;
+        std::unique_ptr<abstract_search> abstract_;
+
+        warthog::jps_expansion_policy jps_;
+        warthog::octile_heuristic rh_;
+        warthog::pqueue_min ropen_;
+        refinement_search refine_;
+
+        std::vector<std::pair<uint32_t, warthog::cost_t>> reached_;
+        std::vector<uint32_t> goal_links_;
+
+        // connect the (padded) tiles @param s and @param t to the
+        // abstract graph, search it, then remove the temporary edges.
+        // @return true if a path exists, in which case @param cells are
+        // the tiles along the abstract path, from s to t.
+        bool
+        insert_and_search(uint32_t s, uint32_t t,
+                warthog::solution& asol, std::vector<uint32_t>& cells)
+        {
+            warthog::graph::xy_graph* g = abs_->get_graph();
+            uint32_t start_node = abs_->get_start_node();
+            uint32_t goal_node = abs_->get_goal_node();
+            int32_t x, y;
+
+            warthog::graph::node* start = g->get_node(start_node);
+            start->clear();
+            abs_->get_map()->to_unpadded_xy(s, (uint32_t&)x, (uint32_t&)y);
+            g->set_xy(start_node, x, y);
+
+            warthog::cost_t direct;
+            abs_->connect(s, t, reached_, direct);
+            for(auto& r : reached_)
+            {
+                start->add_outgoing(warthog::graph::edge(r.first, r.second));
+            }
+            if(direct != warthog::COST_MAX)
+            {
+                start->add_outgoing(warthog::graph::edge(goal_node, direct));
+            }
+
+            // edges are symmetric, so the distances from t are
+            // also the distances to t
+            abs_->get_map()->to_unpadded_xy(t, (uint32_t&)x, (uint32_t&)y);
+            g->set_xy(goal_node, x, y);
+            abs_->connect(t, s, reached_, direct);
+            goal_links_.clear();
+            for(auto& r : reached_)
+            {
+                g->get_node(r.first)->add_outgoing(
+                        warthog::graph::edge(goal_node, r.second));
+                goal_links_.push_back(r.first);
+            }
+
+            warthog::problem_instance api(start_node, goal_node);
+            abstract_->get_path(api, asol);
+
+            // the goal node has no permanent edges, so the only edge
+            // into it is the temporary one
+            for(uint32_t id : goal_links_)
+            {
+                warthog::graph::node* n = g->get_node(id);
+                warthog::graph::edge_iter it = n->find_edge(
+                        goal_node, n->outgoing_begin(), n->outgoing_end());
+                assert(it != n->outgoing_end());
+                n->del_outgoing(it);
+            }
+
+            cells.clear();
+            for(warthog::sn_id_t id : asol.path_)
+            {
+                uint32_t cell = id == start_node ? s :
+                    id == goal_node ? t : abs_->get_cell((uint32_t)id);
+                if(cells.size() && cells.back() == cell) { continue; }
+                cells.push_back(cell);
+            }
+            return asol.path_.size() != 0;
+        }
+
+        void
+        finish(warthog::timer& mytimer, warthog::solution& asol,
+                warthog::solution& sol)
+        {
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+            sol.nodes_expanded_ = asol.nodes_expanded_;
+            sol.nodes_touched_ = asol.nodes_touched_;
+            sol.nodes_surplus_ = asol.nodes_surplus_;
+            sol.heap_ops_ = asol.heap_ops_;
+        }
+};
+
+}
+
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include "jps2_expansion_policy.h"
 
-warthog::jps2_expansion_policy::jps2_expansion_policy(warthog::gridmap* map)
+warthog::jps2_expansion_policy::jps2_expansion_policy(
+        warthog::gridmap* map, bool backward)
     : expansion_policy(map->height() * map->width())
 {
 	map_ = map;
+    backward_ = backward;
 	jpl_ = new warthog::jps::online_jump_point_locator2(map);
 	jp_ids_.reserve(100);
 }
@@ -38,7 +40,8 @@ warthog::jps2_expansion_policy::expand(
 	// look for jump points in the direction of each natural 
 	// and forced neighbour
 	uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
-	uint32_t goal_id = (uint32_t)problem->target_id_;
+	uint32_t goal_id = (uint32_t)
+        (backward_ ? problem->start_id_ : problem->target_id_);
 
 	for(uint32_t i = 0; i < 8; i++)
 	{
@@ -27,7 +27,10 @@ namespace warthog
 class jps2_expansion_policy : public expansion_policy
 {
 	public:
-		jps2_expansion_policy(warthog::gridmap* map);
+		// @param backward: when true the policy is used by the backward
+		// half of a bidirectional search; jumps then look for the start
+		// node instead of the target
+		jps2_expansion_policy(warthog::gridmap* map, bool backward = false);
 		virtual ~jps2_expansion_policy();
 
 		virtual void 
@@ -59,6 +62,7 @@ class jps2_expansion_policy : public expansion_policy
 	private:
 		warthog::gridmap* map_;
         warthog::jps::online_jump_point_locator2* jpl_;
+        bool backward_;
 		std::vector<uint32_t> jp_ids_;
         std::vector<warthog::cost_t> jp_costs_;
 
@@ -49,6 +49,14 @@ class jps2plus_expansion_policy : public expansion_policy
         virtual warthog::search_node*
         generate_target_node(warthog::problem_instance* pi);
 
+		// call between queries, after changing the traversability of 
+		// the cells @param changed_ids (padded ids) on the map
+		inline void
+		update_map(const std::vector<uint32_t>& changed_ids)
+		{
+			jpl_->update(changed_ids);
+		}
+
 	private:
 		warthog::gridmap* map_;
 		offline_jump_point_locator2* jpl_;
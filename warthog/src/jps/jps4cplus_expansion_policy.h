@@ -0,0 +1,62 @@
+#ifndef WARTHOG_JPS4CPLUS_EXPANSION_POLICY_H
+#define WARTHOG_JPS4CPLUS_EXPANSION_POLICY_H
+
+// jps/jps4cplus_expansion_policy.h
+//
+// Successor generating functions for JPS+ on 4-connected gridmaps.
+// Same successors as warthog::jps4c_expansion_policy but jump points are
+// read from a precomputed database (see
+// warthog::offline_four_connected_jps_locator) instead of being found by
+// scanning the grid.
+//
+
+#include "expansion_policy.h"
+#include "gridmap.h"
+#include "helpers.h"
+#include "jps.h"
+#include "offline_four_connected_jps_locator.h"
+#include "problem_instance.h"
+#include "search_node.h"
+
+#include "stdint.h"
+
+namespace warthog
+{
+
+class jps4cplus_expansion_policy : public expansion_policy
+{
+	public:
+		jps4cplus_expansion_policy(warthog::gridmap* map);
+		virtual ~jps4cplus_expansion_policy();
+
+		virtual void 
+		expand(warthog::search_node*, warthog::problem_instance*);
+
+        virtual void
+        get_xy(warthog::sn_id_t nid, int32_t& x, int32_t& y);
+
+        virtual warthog::search_node* 
+        generate_start_node(warthog::problem_instance* pi);
+
+        virtual warthog::search_node*
+        generate_target_node(warthog::problem_instance* pi);
+
+		virtual inline size_t
+		mem()
+		{
+            return expansion_policy::mem() +
+                sizeof(*this) + map_->mem() + jpl_->mem();
+		}
+
+	private:
+		warthog::gridmap* map_;
+		warthog::offline_four_connected_jps_locator* jpl_;
+
+        warthog::jps::direction
+        compute_direction(uint32_t n1_id, uint32_t n2_id);
+};
+
+}
+
+#endif
+
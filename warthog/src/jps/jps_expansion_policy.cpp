@@ -3,38 +3,46 @@
 
 extern Statistic g_statistic;
 
-warthog::jps_expansion_policy::jps_expansion_policy(warthog::gridmap* map)
-    : expansion_policy(map->height()*map->width())
+template<typename ID_T>
+warthog::jps_expansion_policy_base<ID_T>::jps_expansion_policy_base(
+        warthog::gridmap_base<ID_T>* map, bool backward)
+    : expansion_policy(HASHED ? 0 : (size_t)map->height()*map->width())
 {
 	map_ = map;
-	jpl_ = new warthog::online_jump_point_locator(map);
+	backward_ = backward;
+	jpl_ = new warthog::online_jump_point_locator_base<ID_T>(map);
+	nodes_ = HASHED ? new warthog::mem::node_table() : 0;
 	reset();
 }
 
-warthog::jps_expansion_policy::~jps_expansion_policy()
+template<typename ID_T>
+warthog::jps_expansion_policy_base<ID_T>::~jps_expansion_policy_base()
 {
+	delete nodes_;
 	delete jpl_;
 }
 
+template<typename ID_T>
 void 
-warthog::jps_expansion_policy::expand(
+warthog::jps_expansion_policy_base<ID_T>::expand(
 		warthog::search_node* current, warthog::problem_instance* problem)
 {
 	reset();
 
 	// compute the direction of travel used to reach the current node.
 	warthog::jps::direction dir_c =
-	   	this->compute_direction((uint32_t)current->get_parent(), (uint32_t)current->get_id());
+	   	this->compute_direction((ID_T)current->get_parent(), (ID_T)current->get_id());
 
 	// get the tiles around the current node c
 	uint32_t c_tiles;
-	uint32_t current_id = (uint32_t)current->get_id();
+	ID_T current_id = (ID_T)current->get_id();
 	map_->get_neighbours(current_id, (uint8_t*)&c_tiles);
 
 	// look for jump points in the direction of each natural 
 	// and forced neighbour
 	uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
-	uint32_t goal_id = (uint32_t)problem->target_id_;
+	ID_T goal_id = (ID_T)
+        (backward_ ? problem->start_id_ : problem->target_id_);
     //uint32_t search_id = problem->get_searchid();
 	for(uint32_t i = 0; i < 8; i++)
 	{
@@ -43,10 +51,10 @@ warthog::jps_expansion_policy::expand(
 		{
             g_statistic.expandCnt++;
             warthog::cost_t jumpcost;
-			uint32_t succ_id;
+			ID_T succ_id;
 			jpl_->jump(d, current_id, goal_id, succ_id, jumpcost);
 
-			if(succ_id != warthog::INF32)
+			if(succ_id != jpl_->INF)
 			{
                 warthog::search_node* jp_succ = this->generate(succ_id);
                 //if(jp_succ->get_searchid() != search_id) { jp_succ->reset(search_id); }
@@ -56,44 +64,51 @@ warthog::jps_expansion_policy::expand(
 	}
 }
 
+template<typename ID_T>
 void
-warthog::jps_expansion_policy::get_xy(
+warthog::jps_expansion_policy_base<ID_T>::get_xy(
         warthog::sn_id_t nid, int32_t& x, int32_t& y)
 {
-    map_->to_unpadded_xy((uint32_t)nid, (uint32_t&)x, (uint32_t&)y);
+    map_->to_unpadded_xy((ID_T)nid, (uint32_t&)x, (uint32_t&)y);
 }
 
+template<typename ID_T>
 warthog::search_node* 
-warthog::jps_expansion_policy::generate_start_node(
+warthog::jps_expansion_policy_base<ID_T>::generate_start_node(
         warthog::problem_instance* pi)
 { 
-    uint32_t max_id = map_->header_width() * map_->header_height();
-    if((uint32_t)pi->start_id_ >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id((uint32_t)pi->start_id_);
+    ID_T max_id = (ID_T)map_->header_width() * map_->header_height();
+    if(pi->start_id_ >= max_id) { return 0; }
+    ID_T padded_id = map_->to_padded_id((ID_T)pi->start_id_);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    // a new search begins; hashed nodes from the previous one are discarded
+    if(HASHED) { nodes_->clear(); }
     return generate(padded_id);
 }
 
+template<typename ID_T>
 warthog::search_node*
-warthog::jps_expansion_policy::generate_target_node(
+warthog::jps_expansion_policy_base<ID_T>::generate_target_node(
         warthog::problem_instance* pi)
 {
-    uint32_t max_id = map_->header_width() * map_->header_height();
-    if((uint32_t)pi->target_id_ >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id((uint32_t)pi->target_id_);
+    ID_T max_id = (ID_T)map_->header_width() * map_->header_height();
+    if(pi->target_id_ >= max_id) { return 0; }
+    ID_T padded_id = map_->to_padded_id((ID_T)pi->target_id_);
     if(map_->get_label(padded_id) == 0) { return 0; }
     return generate(padded_id);
 }
 
+template<typename ID_T>
 inline warthog::jps::direction
-warthog::jps_expansion_policy::compute_direction(
-        uint32_t n1_id, uint32_t n2_id)
+warthog::jps_expansion_policy_base<ID_T>::compute_direction(
+        ID_T n1_id, ID_T n2_id)
 {
-    if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
+    if(n1_id == (ID_T)warthog::SN_ID_MAX) { return warthog::jps::NONE; }
 
     int32_t x, y, x2, y2;
-    warthog::helpers::index_to_xy(n1_id, map_->width(), x, y);
-    warthog::helpers::index_to_xy(n2_id, map_->width(), x2, y2);
+    map_->to_padded_xy(n1_id, (uint32_t&)x, (uint32_t&)y);
+    map_->to_padded_xy(n2_id, (uint32_t&)x2, (uint32_t&)y2);
     warthog::jps::direction dir = warthog::jps::NONE;
     if(y2 == y)
     {
@@ -123,3 +138,6 @@ warthog::jps_expansion_policy::compute_direction(
     assert(dir != warthog::jps::NONE);
     return dir;
 }
+
+template class warthog::jps_expansion_policy_base<uint32_t>;
+template class warthog::jps_expansion_policy_base<uint64_t>;
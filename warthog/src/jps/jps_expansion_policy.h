@@ -15,6 +15,12 @@
 // [Harabor D. and Grastien A., 2011, Online Node Pruning for Pathfinding
 // On Grid Maps, AAAI] 
 //
+// Padded ids are of type ID_T; jps_expansion_policy is the 32-bit
+// version and jps_expansion_policy_base<uint64_t> works with maps that
+// have more than 2^32 padded tiles. The 64-bit version keeps its search
+// nodes in a warthog::mem::node_table, so memory grows with the number
+// of nodes generated rather than with the size of the map.
+//
 // @author: dharabor
 // @created: 06/01/2010
 
@@ -22,6 +28,7 @@
 #include "gridmap.h"
 #include "helpers.h"
 #include "jps.h"
+#include "node_table.h"
 #include "online_jump_point_locator.h"
 #include "problem_instance.h"
 #include "search_node.h"
@@ -31,11 +38,16 @@
 namespace warthog
 {
 
-class jps_expansion_policy : public expansion_policy
+template<typename ID_T>
+class jps_expansion_policy_base : public expansion_policy
 {
 	public:
-		jps_expansion_policy(warthog::gridmap* map);
-		virtual ~jps_expansion_policy();
+		// @param backward: when true the policy is used by the backward
+		// half of a bidirectional search; jumps then look for the start
+		// node instead of the target
+		jps_expansion_policy_base(warthog::gridmap_base<ID_T>* map,
+                bool backward = false);
+		virtual ~jps_expansion_policy_base();
 
 		virtual void 
 		expand(warthog::search_node*, warthog::problem_instance*);
@@ -53,19 +65,59 @@ class jps_expansion_policy : public expansion_policy
 		mem()
 		{
             return expansion_policy::mem() +
-                sizeof(*this) + map_->mem() + jpl_->mem();
+                sizeof(*this) + map_->mem() + jpl_->mem() +
+                (nodes_ ? nodes_->mem() : 0);
+		}
+
+        // these hide the versions in expansion_policy, which always use
+        // the node pool
+		inline warthog::search_node*
+		generate(warthog::sn_id_t node_id)
+		{
+            if(HASHED) { return nodes_->generate(node_id); }
+            return expansion_policy::generate(node_id);
+		}
+
+        warthog::search_node*
+        get_ptr(warthog::sn_id_t node_id, uint32_t search_number)
+        {
+            if(!HASHED)
+            { return expansion_policy::get_ptr(node_id, search_number); }
+
+            warthog::search_node* tmp = nodes_->get_ptr(node_id);
+            if(tmp && tmp->get_search_number() == search_number)
+            {
+                return tmp;
+            }
+            return 0;
+        }
+
+		// call between queries, after changing the traversability of 
+		// the cells @param changed_ids (padded ids) on the map
+		inline void
+		update_map(const std::vector<ID_T>& changed_ids)
+		{
+			for(ID_T id : changed_ids) { jpl_->update_label(id); }
 		}
 
 	private:
-		warthog::gridmap* map_;
-		warthog::online_jump_point_locator* jpl_;
+		// a node_pool keeps one pointer for every 8 ids, which is too
+		// much for maps that need 64-bit ids
+		static constexpr bool HASHED = sizeof(ID_T) > sizeof(uint32_t);
+
+		warthog::gridmap_base<ID_T>* map_;
+		warthog::online_jump_point_locator_base<ID_T>* jpl_;
+		warthog::mem::node_table* nodes_;
+		bool backward_;
 
 		// computes the direction of travel; from a node n1
 		// to a node n2.
 		inline warthog::jps::direction
-		compute_direction(uint32_t n1_id, uint32_t n2_id);
+		compute_direction(ID_T n1_id, ID_T n2_id);
 };
 
+typedef jps_expansion_policy_base<uint32_t> jps_expansion_policy;
+
 }
 
 #endif
@@ -0,0 +1,126 @@
+#include "jps_tiled_expansion_policy.h"
+#include "Statistic.h"
+
+extern Statistic g_statistic;
+
+warthog::jps_tiled_expansion_policy::jps_tiled_expansion_policy(
+        warthog::tiled_gridmap* map)
+    : expansion_policy(map->height()*map->width())
+{
+    map_ = map;
+    jpl_ = new warthog::tiled_jump_point_locator(map);
+    reset();
+}
+
+warthog::jps_tiled_expansion_policy::~jps_tiled_expansion_policy()
+{
+    delete jpl_;
+}
+
+void
+warthog::jps_tiled_expansion_policy::expand(
+        warthog::search_node* current, warthog::problem_instance* problem)
+{
+    reset();
+
+    // compute the direction of travel used to reach the current node.
+    warthog::jps::direction dir_c =
+        this->compute_direction(
+                (uint32_t)current->get_parent(), (uint32_t)current->get_id());
+
+    // get the tiles around the current node c
+    uint32_t c_tiles = 0;
+    uint32_t current_id = (uint32_t)current->get_id();
+    map_->get_neighbours(current_id, (uint8_t*)&c_tiles);
+
+    // look for jump points in the direction of each natural
+    // and forced neighbour
+    uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
+    uint32_t goal_id = (uint32_t)problem->target_id_;
+    for(uint32_t i = 0; i < 8; i++)
+    {
+        warthog::jps::direction d = (warthog::jps::direction) (1 << i);
+        if(succ_dirs & d)
+        {
+            g_statistic.expandCnt++;
+            warthog::cost_t jumpcost;
+            uint32_t succ_id;
+            jpl_->jump(d, current_id, goal_id, succ_id, jumpcost);
+
+            if(succ_id != warthog::INF32)
+            {
+                add_neighbour(this->generate(succ_id), jumpcost);
+            }
+        }
+    }
+}
+
+void
+warthog::jps_tiled_expansion_policy::get_xy(
+        warthog::sn_id_t nid, int32_t& x, int32_t& y)
+{
+    map_->to_unpadded_xy((uint32_t)nid, (uint32_t&)x, (uint32_t&)y);
+}
+
+warthog::search_node*
+warthog::jps_tiled_expansion_policy::generate_start_node(
+        warthog::problem_instance* pi)
+{
+    return generate_node((uint32_t)pi->start_id_);
+}
+
+warthog::search_node*
+warthog::jps_tiled_expansion_policy::generate_target_node(
+        warthog::problem_instance* pi)
+{
+    return generate_node((uint32_t)pi->target_id_);
+}
+
+warthog::search_node*
+warthog::jps_tiled_expansion_policy::generate_node(uint32_t node_id)
+{
+    uint32_t max_id = map_->header_width() * map_->header_height();
+    if(node_id >= max_id) { return 0; }
+    uint32_t padded_id = map_->to_padded_id(node_id);
+    if(!map_->get_label(padded_id)) { return 0; }
+    return generate(padded_id);
+}
+
+inline warthog::jps::direction
+warthog::jps_tiled_expansion_policy::compute_direction(
+        uint32_t n1_id, uint32_t n2_id)
+{
+    if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
+
+    uint32_t x, y, x2, y2;
+    map_->to_padded_xy(n1_id, x, y);
+    map_->to_padded_xy(n2_id, x2, y2);
+    warthog::jps::direction dir = warthog::jps::NONE;
+    if(y2 == y)
+    {
+        if(x2 > x)
+            dir = warthog::jps::EAST;
+        else
+            dir = warthog::jps::WEST;
+    }
+    else if(y2 < y)
+    {
+        if(x2 == x)
+            dir = warthog::jps::NORTH;
+        else if(x2 < x)
+            dir = warthog::jps::NORTHWEST;
+        else // x2 > x
+            dir = warthog::jps::NORTHEAST;
+    }
+    else // y2 > y
+    {
+        if(x2 == x)
+            dir = warthog::jps::SOUTH;
+        else if(x2 < x)
+            dir = warthog::jps::SOUTHWEST;
+        else // x2 > x
+            dir = warthog::jps::SOUTHEAST;
+    }
+    assert(dir != warthog::jps::NONE);
+    return dir;
+}
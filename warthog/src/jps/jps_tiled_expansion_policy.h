@@ -0,0 +1,67 @@
+#ifndef WARTHOG_JPS_TILED_EXPANSION_POLICY_H
+#define WARTHOG_JPS_TILED_EXPANSION_POLICY_H
+
+// jps_tiled_expansion_policy.h
+//
+// Jump point search on a tiled_gridmap. Successors are the same as for
+// jps_expansion_policy; only the storage of the map and the way jump
+// points are located differ (see tiled_jump_point_locator).
+//
+// Node ids are padded ids of the tiled_gridmap, so the heuristic should
+// be constructed with its (padded) width and height.
+//
+
+#include "expansion_policy.h"
+#include "helpers.h"
+#include "jps.h"
+#include "problem_instance.h"
+#include "search_node.h"
+#include "tiled_gridmap.h"
+#include "tiled_jump_point_locator.h"
+
+#include "stdint.h"
+
+namespace warthog
+{
+
+class jps_tiled_expansion_policy : public expansion_policy
+{
+    public:
+        jps_tiled_expansion_policy(warthog::tiled_gridmap* map);
+        virtual ~jps_tiled_expansion_policy();
+
+        virtual void
+        expand(warthog::search_node*, warthog::problem_instance*);
+
+        virtual void
+        get_xy(warthog::sn_id_t nid, int32_t& x, int32_t& y);
+
+        virtual warthog::search_node*
+        generate_start_node(warthog::problem_instance* pi);
+
+        virtual warthog::search_node*
+        generate_target_node(warthog::problem_instance* pi);
+
+        virtual inline size_t
+        mem()
+        {
+            return expansion_policy::mem() +
+                sizeof(*this) + map_->mem() + jpl_->mem();
+        }
+
+    private:
+        warthog::tiled_gridmap* map_;
+        warthog::tiled_jump_point_locator* jpl_;
+
+        // computes the direction of travel; from a node n1
+        // to a node n2.
+        inline warthog::jps::direction
+        compute_direction(uint32_t n1_id, uint32_t n2_id);
+
+        warthog::search_node*
+        generate_node(uint32_t node_id);
+};
+
+}
+
+#endif
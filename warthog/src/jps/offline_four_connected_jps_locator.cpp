@@ -0,0 +1,377 @@
+#include "gridmap.h"
+#include "offline_four_connected_jps_locator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace
+{
+
+const uint32_t JPS4CPLUS_MAGIC = 0x3243344A; // "J4C2"
+
+struct jps4cplus_header
+{
+	uint32_t magic_;
+	uint32_t dbsize_;
+
+	// size and modification time (in nanoseconds) of the map file the
+	// labels were computed from; zero if unknown
+	uint64_t source_size_;
+	int64_t source_mtime_;
+};
+
+// @return false if @param filename cannot be read
+bool
+file_stamp(const char* filename, uint64_t& size, int64_t& mtime)
+{
+	struct stat st;
+	if(filename == 0 || stat(filename, &st) != 0) { return false; }
+	size = (uint64_t)st.st_size;
+	mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	return true;
+}
+
+}
+
+warthog::offline_four_connected_jps_locator::
+offline_four_connected_jps_locator(warthog::gridmap* map)
+	: map_(map), dbsize_(0), db_(0)
+{
+	preproc();
+}
+
+warthog::offline_four_connected_jps_locator::
+~offline_four_connected_jps_locator()
+{
+	delete [] db_;
+}
+
+void
+warthog::offline_four_connected_jps_locator::preproc()
+{
+	if(load(map_->filename())) { return; }
+
+	dbsize_ = 4*map_->padded_mapsize();
+	db_ = new uint16_t[dbsize_];
+	for(uint32_t i = 0; i < dbsize_; i++) db_[i] = 0;
+
+	// each label is computed from the label of the next tile in the
+	// same direction, so we sweep the map against each direction.
+	// the first and last rows of the padded map are never traversable
+	// and neither are the padding tiles at the end of each row (which
+	// also separate the first tile of a row from the previous row).
+	uint32_t mapw = map_->width();
+	uint32_t maph = map_->height();
+	for(uint32_t y = 1; y < maph-1; y++)
+	{
+		for(uint32_t x = mapw; x > 0; x--)
+		{
+			uint32_t id = y*mapw + x-1;
+			db_[4*id+2] = compute_label(id, 2, db_[4*(id+1)+2]);
+		}
+		for(uint32_t x = 0; x < mapw; x++)
+		{
+			uint32_t id = y*mapw + x;
+			db_[4*id+3] = compute_label(id, 3, db_[4*(id-1)+3]);
+		}
+	}
+
+	// vertical jumps depend on the horizontal labels of each tile
+	// they pass through
+	for(uint32_t y = 1; y < maph-1; y++)
+	{
+		for(uint32_t x = 0; x < mapw; x++)
+		{
+			uint32_t id = y*mapw + x;
+			db_[4*id] = compute_label(id, 0, db_[4*(id-mapw)]);
+		}
+	}
+	for(uint32_t y = maph-1; y > 1; y--)
+	{
+		for(uint32_t x = 0; x < mapw; x++)
+		{
+			uint32_t id = (y-1)*mapw + x;
+			db_[4*id+1] = compute_label(id, 1, db_[4*(id+mapw)+1]);
+		}
+	}
+
+	save(map_->filename());
+}
+
+bool
+warthog::offline_four_connected_jps_locator::next_is_forced(
+		uint32_t id, uint32_t dir_idx)
+{
+	uint32_t mapw = map_->width();
+	uint32_t next = dir_idx == 2 ? id+1 : id-1;
+
+	// as in the online version: a traversable tile in the row above or
+	// below which follows immediately after an obstacle tile
+	return
+		(map_->get_label(next-mapw) && !map_->get_label(id-mapw)) ||
+		(map_->get_label(next+mapw) && !map_->get_label(id+mapw));
+}
+
+uint16_t
+warthog::offline_four_connected_jps_locator::compute_label(
+		uint32_t id, uint32_t dir_idx, uint16_t next_label)
+{
+	if(!map_->get_label(id)) { return 0; }
+
+	uint32_t mapw = map_->width();
+	uint32_t next;
+	switch(dir_idx)
+	{
+		case 0: next = id - mapw; break;
+		case 1: next = id + mapw; break;
+		case 2: next = id + 1; break;
+		default: next = id - 1; break;
+	}
+	if(!map_->get_label(next)) { return DEADEND; }
+
+	// the next tile is a jump point
+	bool stop;
+	if(dir_idx < 2)
+	{
+		stop = !(db_[4*next+2] & DEADEND) || !(db_[4*next+3] & DEADEND);
+	}
+	else
+	{
+		stop = next_is_forced(id, dir_idx);
+	}
+	if(stop) { return 1; }
+
+	if((next_label & MAX_STEPS) == MAX_STEPS)
+	{
+		std::cerr << "label overflow; maximum jump distance exceeded. "
+			<< "aborting\n";
+		exit(1);
+	}
+	return (uint16_t)(next_label + 1);
+}
+
+bool
+warthog::offline_four_connected_jps_locator::load(const char* filename)
+{
+	char fname[256];
+	strcpy(fname, filename);
+	strcat(fname, ".jps4c+");
+	FILE* f = fopen(fname, "rb");
+	std::cerr << "loading "<<fname << "... ";
+	if(f == NULL)
+	{
+		std::cerr << "no dice. oh well. keep going.\n"<<std::endl;
+		return false;
+	}
+
+	jps4cplus_header hdr;
+	if(fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+	   hdr.magic_ != JPS4CPLUS_MAGIC)
+	{
+		std::cerr << "old or unknown format; recomputing.\n";
+		fclose(f);
+		return false;
+	}
+	if(hdr.dbsize_ != 4*map_->padded_mapsize())
+	{
+		std::cerr << "size mismatch; recomputing.\n";
+		fclose(f);
+		return false;
+	}
+
+	// a map edited in place keeps its size but not its jump points
+	uint64_t size;
+	int64_t mtime;
+	if(file_stamp(filename, size, mtime) &&
+	   (size != hdr.source_size_ || mtime != hdr.source_mtime_))
+	{
+		std::cerr << "map changed since the labels were saved; "
+			<< "recomputing.\n";
+		fclose(f);
+		return false;
+	}
+
+	dbsize_ = hdr.dbsize_;
+	db_ = new uint16_t[dbsize_];
+	if(fread(db_, sizeof(uint16_t), dbsize_, f) != dbsize_)
+	{
+		std::cerr << "truncated file; recomputing.\n";
+		fclose(f);
+		delete [] db_;
+		db_ = 0;
+		return false;
+	}
+	fclose(f);
+	std::cerr <<"#labels="<<dbsize_<<std::endl;
+	return true;
+}
+
+void
+warthog::offline_four_connected_jps_locator::save(const char* filename)
+{
+	char fname[256];
+	strcpy(fname, filename);
+	strcat(fname, ".jps4c+");
+	std::cerr << "saving to file "<<fname<<"; nodes="<<dbsize_
+		<<" size: "<<sizeof(db_[0])<<std::endl;
+
+	FILE* f = fopen(fname, "wb");
+	if(f == NULL)
+	{
+		std::cerr << "err; cannot write jump table to file "
+			<<fname<<". oh well. try to keep going.\n"<<std::endl;
+		return;
+	}
+
+	jps4cplus_header hdr;
+	hdr.magic_ = JPS4CPLUS_MAGIC;
+	hdr.dbsize_ = dbsize_;
+	hdr.source_size_ = 0;
+	hdr.source_mtime_ = 0;
+	file_stamp(filename, hdr.source_size_, hdr.source_mtime_);
+	fwrite(&hdr, sizeof(hdr), 1, f);
+	fwrite(db_, sizeof(*db_), dbsize_, f);
+	fclose(f);
+	std::cerr << "jump table saved to disk. file="<<fname<<std::endl;
+}
+
+// Finds the jump point successor of node_id in direction d.
+// If encountered, the goal node is always returned as a jump point.
+// jumpnode_id is warthog::INF32 if no jump point exists.
+void
+warthog::offline_four_connected_jps_locator::jump(warthog::jps::direction d,
+		uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id,
+		double& jumpcost)
+{
+	switch(d)
+	{
+		case warthog::jps::NORTH:
+			jump_north(node_id, goal_id, jumpnode_id, jumpcost);
+			break;
+		case warthog::jps::SOUTH:
+			jump_south(node_id, goal_id, jumpnode_id, jumpcost);
+			break;
+		case warthog::jps::EAST:
+			jump_east(node_id, goal_id, jumpnode_id, jumpcost);
+			break;
+		case warthog::jps::WEST:
+			jump_west(node_id, goal_id, jumpnode_id, jumpcost);
+			break;
+		default:
+			jumpnode_id = warthog::INF32;
+			break;
+	}
+}
+
+void
+warthog::offline_four_connected_jps_locator::jump_north(uint32_t node_id,
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+	uint16_t label = db_[4*node_id];
+	uint32_t num_steps = label & MAX_STEPS;
+	uint32_t mapw = map_->width();
+
+	// stop early in the row of the goal, if the goal can be reached
+	// from there by a horizontal jump
+	if(goal_id < node_id)
+	{
+		uint32_t rows = node_id / mapw - goal_id / mapw;
+		uint32_t row_id = node_id - rows*mapw;
+		if(rows && rows <= num_steps && goal_in_row(row_id, goal_id))
+		{
+			jumpnode_id = row_id;
+			jumpcost = rows;
+			return;
+		}
+	}
+
+	if(label & DEADEND)
+	{
+		jumpnode_id = warthog::INF32;
+		return;
+	}
+	jumpnode_id = node_id - num_steps*mapw;
+	jumpcost = num_steps;
+}
+
+void
+warthog::offline_four_connected_jps_locator::jump_south(uint32_t node_id,
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+	uint16_t label = db_[4*node_id+1];
+	uint32_t num_steps = label & MAX_STEPS;
+	uint32_t mapw = map_->width();
+
+	if(goal_id > node_id)
+	{
+		uint32_t rows = goal_id / mapw - node_id / mapw;
+		uint32_t row_id = node_id + rows*mapw;
+		if(rows && rows <= num_steps && goal_in_row(row_id, goal_id))
+		{
+			jumpnode_id = row_id;
+			jumpcost = rows;
+			return;
+		}
+	}
+
+	if(label & DEADEND)
+	{
+		jumpnode_id = warthog::INF32;
+		return;
+	}
+	jumpnode_id = node_id + num_steps*mapw;
+	jumpcost = num_steps;
+}
+
+void
+warthog::offline_four_connected_jps_locator::jump_east(uint32_t node_id,
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+	uint16_t label = db_[4*node_id+2];
+	uint32_t num_steps = label & MAX_STEPS;
+
+	// do not jump over the goal. jumps never leave the row, so this
+	// test fails for goals in other rows
+	uint32_t goal_delta = goal_id - node_id;
+	if(goal_delta <= num_steps)
+	{
+		jumpnode_id = goal_id;
+		jumpcost = goal_delta;
+		return;
+	}
+
+	if(label & DEADEND)
+	{
+		jumpnode_id = warthog::INF32;
+		return;
+	}
+	jumpnode_id = node_id + num_steps;
+	jumpcost = num_steps;
+}
+
+void
+warthog::offline_four_connected_jps_locator::jump_west(uint32_t node_id,
+		uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+	uint16_t label = db_[4*node_id+3];
+	uint32_t num_steps = label & MAX_STEPS;
+
+	uint32_t goal_delta = node_id - goal_id;
+	if(goal_delta <= num_steps)
+	{
+		jumpnode_id = goal_id;
+		jumpcost = goal_delta;
+		return;
+	}
+
+	if(label & DEADEND)
+	{
+		jumpnode_id = warthog::INF32;
+		return;
+	}
+	jumpnode_id = node_id - num_steps;
+	jumpcost = num_steps;
+}
@@ -0,0 +1,115 @@
+#ifndef WARTHOG_OFFLINE_FOUR_CONNECTED_JPS_LOCATOR_H
+#define WARTHOG_OFFLINE_FOUR_CONNECTED_JPS_LOCATOR_H
+
+// jps/offline_four_connected_jps_locator.h
+//
+// Variant of warthog::four_connected_jps_locator.
+// Jump points are identified using a pre-computed database that stores,
+// for each node and each of the four cardinal directions, the number of
+// steps to the jump point in that direction (the leading bit of the
+// label is set if the jump ends in a dead-end, in which case the steps
+// are to the last traversable tile).
+//
+// The database gives the same successors as the online locator:
+// horizontal jumps stop at forced neighbours and vertical jumps stop at
+// the first tile from which a horizontal jump finds a jump point. Both
+// are independent of the goal, so the goal is handled at query time
+// using the labels of the tiles in the row of the goal.
+//
+// The database is computed once per map and saved to a file next to the
+// map (with the extension .jps4c+), then loaded on subsequent runs.
+// The file records the size and modification time of the map it was
+// computed from; if the map has changed since, the labels are computed
+// again.
+//
+
+#include "jps.h"
+
+#include <cstdint>
+
+namespace warthog
+{
+
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
+
+class offline_four_connected_jps_locator
+{
+	public:
+		offline_four_connected_jps_locator(warthog::gridmap* map);
+		~offline_four_connected_jps_locator();
+
+		// find the jump point successor of @param node_id in the
+		// cardinal direction @param d. if encountered, the goal
+		// @param goal_id is always a jump point. @param jumpnode_id is
+		// warthog::INF32 if the jump ends in a dead-end.
+		void
+		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goal_id,
+				uint32_t& jumpnode_id, double& jumpcost);
+
+		size_t
+		mem()
+		{
+			return sizeof(*this) + sizeof(*db_)*dbsize_;
+		}
+
+	private:
+		// labels are stored in the order of warthog::jps::direction
+		// (N=0, S=1, E=2, W=3)
+		static const uint16_t DEADEND = 32768;
+		static const uint16_t MAX_STEPS = 32767;
+
+		warthog::gridmap* map_;
+		uint32_t dbsize_;
+		uint16_t* db_;
+
+		void
+		preproc();
+
+		// load the labels saved for the map file @param filename.
+		// fails if they were saved for a different version of the map.
+		bool
+		load(const char* filename);
+
+		void
+		save(const char* filename);
+
+		// true if tile @param id is the last tile before a horizontal
+		// jump point in direction @param dir_idx (2=east, 3=west)
+		bool
+		next_is_forced(uint32_t id, uint32_t dir_idx);
+
+		// @return the label of @param id in direction @param dir_idx,
+		// given the label of the next tile in that direction.
+		uint16_t
+		compute_label(uint32_t id, uint32_t dir_idx, uint16_t next_label);
+
+		void
+		jump_north(uint32_t node_id, uint32_t goal_id,
+				uint32_t& jumpnode_id, double& jumpcost);
+		void
+		jump_south(uint32_t node_id, uint32_t goal_id,
+				uint32_t& jumpnode_id, double& jumpcost);
+		void
+		jump_east(uint32_t node_id, uint32_t goal_id,
+				uint32_t& jumpnode_id, double& jumpcost);
+		void
+		jump_west(uint32_t node_id, uint32_t goal_id,
+				uint32_t& jumpnode_id, double& jumpcost);
+
+		// true if the goal is in the same row as @param node_id and a
+		// horizontal jump from @param node_id reaches it
+		inline bool
+		goal_in_row(uint32_t node_id, uint32_t goal_id)
+		{
+			if(goal_id >= node_id)
+			{ return (goal_id - node_id) <= (db_[4*node_id+2] & MAX_STEPS); }
+			return (node_id - goal_id) <= (db_[4*node_id+3] & MAX_STEPS);
+		}
+};
+
+}
+
+#endif
+
@@ -15,7 +15,9 @@
 namespace warthog
 {
 
-class gridmap;
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
 class offline_jump_point_locator
 {
 	public:
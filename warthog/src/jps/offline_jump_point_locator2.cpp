@@ -9,7 +9,7 @@
 #include <stdio.h>
 
 warthog::offline_jump_point_locator2::offline_jump_point_locator2(
-		warthog::gridmap* map) : map_(map)
+		warthog::gridmap* map) : map_(map), jpl_(0)
 {
 	if(map_->padded_mapsize() > ((1 << 23)-1)) 
 	{
@@ -27,6 +27,7 @@ warthog::offline_jump_point_locator2::offline_jump_point_locator2(
 warthog::offline_jump_point_locator2::~offline_jump_point_locator2()
 {
 	delete [] db_;
+	delete jpl_;
 }
 
 void
@@ -38,53 +39,16 @@ warthog::offline_jump_point_locator2::preproc()
 	db_ = new uint16_t[dbsize_];
 	for(uint32_t i=0; i < dbsize_; i++) db_[i] = 0;
 
-	warthog::online_jump_point_locator jpl(map_);
+	jpl_ = new warthog::online_jump_point_locator(map_);
 	for(uint32_t y = 0; y < map_->header_height(); y++)
 	{
 		for(uint32_t x = 0; x < map_->header_width(); x++)
 		{
 			uint32_t mapid = map_->to_padded_id(x, y);
-//			std::cout << mapid << " ";
 			for(uint32_t i = 0; i < 8; i++)
 			{
-				warthog::jps::direction dir = 
-					(warthog::jps::direction)(1 << i);
-//				std::cout << dir << ": ";
-				uint32_t jumpnode_id;
-				double jumpcost;
-				jpl.jump(dir, mapid,
-						warthog::INF32, jumpnode_id, jumpcost);
-				
-				// convert from cost to number of steps
-				if(dir > 8)
-				{
-					jumpcost = (jumpcost / warthog::DBL_ROOT_TWO);
-				}
-				uint32_t num_steps = (uint16_t)floor((jumpcost + 0.5));
-//				std::cout << (jumpnode_id == warthog::INF ? 0 : num_steps) << " ";
-
-				// set the leading bit if the jump leads to a dead-end
-				if(jumpnode_id == warthog::INF32)
-				{
-					db_[mapid*8 + i] |= 32768;
-				}
-
-				// truncate jump cost so we can fit the label into a single byte
-				//if(num_steps > 32767)
-				//{
-				//	num_steps = 32767;
-				//	jumpnode_id = 0; 
-				//}
-
-				db_[mapid*8 + i] |= num_steps;
-
-				if(num_steps > 32768)
-				{
-					std::cerr << "label overflow; maximum jump distance exceeded. aborting\n";
-					exit(1);
-				}
+				compute_label(mapid, i);
 			}
-//			std::cout << std::endl;
 		}
 	}
 
@@ -92,6 +56,135 @@ warthog::offline_jump_point_locator2::preproc()
 }
 
 
+void
+warthog::offline_jump_point_locator2::compute_label(
+		uint32_t mapid, uint32_t i)
+{
+	warthog::jps::direction dir = (warthog::jps::direction)(1 << i);
+	uint32_t jumpnode_id;
+	double jumpcost;
+	jpl_->jump(dir, mapid, warthog::INF32, jumpnode_id, jumpcost);
+
+	// convert from cost to number of steps
+	if(dir > 8)
+	{
+		jumpcost = (jumpcost / warthog::DBL_ROOT_TWO);
+	}
+	uint32_t num_steps = (uint16_t)floor((jumpcost + 0.5));
+
+	if(num_steps > 32768)
+	{
+		std::cerr << "label overflow; maximum jump distance exceeded. aborting\n";
+		exit(1);
+	}
+
+	// set the leading bit if the jump leads to a dead-end
+	db_[mapid*8 + i] = (uint16_t)num_steps;
+	if(jumpnode_id == warthog::INF32)
+	{
+		db_[mapid*8 + i] |= 32768;
+	}
+}
+
+void
+warthog::offline_jump_point_locator2::update(
+		const std::vector<uint32_t>& changed_ids)
+{
+	if(changed_ids.size() == 0) { return; }
+	if(!jpl_) { jpl_ = new warthog::online_jump_point_locator(map_); }
+
+	int32_t mapw = (int32_t)map_->header_width();
+	int32_t maph = (int32_t)map_->header_height();
+
+	// changed cells are treated as traversable when bounding segments:
+	// each one may have been an obstacle before the update
+	std::unordered_map<uint32_t, uint8_t> dirty;
+	std::unordered_map<uint32_t, bool> changed;
+	for(uint32_t id : changed_ids)
+	{
+		changed[id] = true;
+		jpl_->update_label(id);
+	}
+	auto passable = [this, &changed](int32_t x, int32_t y) -> bool
+	{
+		uint32_t id = map_->to_padded_id((uint32_t)x, (uint32_t)y);
+		return map_->get_label(id) || changed.find(id) != changed.end();
+	};
+
+	// straight jumps: the row segments through the changed cell and its
+	// two neighbouring rows (which hold its forced neighbours), and the
+	// same for columns. every segment is widened by one cell at each end.
+	const uint8_t NS = (1 << 0) | (1 << 1);
+	const uint8_t EW = (1 << 2) | (1 << 3);
+	std::vector<uint32_t> straight;
+	for(uint32_t id : changed_ids)
+	{
+		uint32_t ux, uy;
+		map_->to_unpadded_xy(id, ux, uy);
+		int32_t cx = (int32_t)ux, cy = (int32_t)uy;
+		for(int32_t y = std::max(0, cy-1); y <= std::min(maph-1, cy+1); y++)
+		{
+			int32_t lo = cx, hi = cx;
+			while(lo > 0 && passable(lo-1, y)) { lo--; }
+			while(hi < mapw-1 && passable(hi+1, y)) { hi++; }
+			for(int32_t x = std::max(0, lo-1); x <= std::min(mapw-1, hi+1); x++)
+			{
+				uint32_t nid = map_->to_padded_id((uint32_t)x, (uint32_t)y);
+				if(dirty[nid] == 0) { straight.push_back(nid); }
+				dirty[nid] |= EW;
+			}
+		}
+		for(int32_t x = std::max(0, cx-1); x <= std::min(mapw-1, cx+1); x++)
+		{
+			int32_t lo = cy, hi = cy;
+			while(lo > 0 && passable(x, lo-1)) { lo--; }
+			while(hi < maph-1 && passable(x, hi+1)) { hi++; }
+			for(int32_t y = std::max(0, lo-1); y <= std::min(maph-1, hi+1); y++)
+			{
+				uint32_t nid = map_->to_padded_id((uint32_t)x, (uint32_t)y);
+				if(dirty[nid] == 0) { straight.push_back(nid); }
+				dirty[nid] |= NS;
+			}
+		}
+	}
+
+	// diagonal jumps stop at cells with a straight jump point, so every
+	// cell on a diagonal leading to a recomputed cell needs recomputing.
+	// we walk backwards along each diagonal until reaching an obstacle
+	// or a cell which an earlier walk already covered.
+	// (NE=4, NW=5, SE=6, SW=7; see warthog::jps::direction)
+	const int32_t back_dx[4] = { -1, 1, -1, 1 };
+	const int32_t back_dy[4] = { 1, 1, -1, -1 };
+	for(uint32_t start : straight)
+	{
+		uint32_t ux, uy;
+		map_->to_unpadded_xy(start, ux, uy);
+		for(uint32_t d = 0; d < 4; d++)
+		{
+			uint8_t bit = (uint8_t)(1 << (4 + d));
+			int32_t x = (int32_t)ux, y = (int32_t)uy;
+			while(x >= 0 && x < mapw && y >= 0 && y < maph)
+			{
+				uint32_t nid = map_->to_padded_id((uint32_t)x, (uint32_t)y);
+				uint8_t& mask = dirty[nid];
+				if(mask & bit) { break; }
+				mask |= bit;
+				if(!passable(x, y)) { break; }
+				x += back_dx[d];
+				y += back_dy[d];
+			}
+		}
+	}
+
+	for(auto& entry : dirty)
+	{
+		for(uint32_t i = 0; i < 8; i++)
+		{
+			if(entry.second & (1 << i)) { compute_label(entry.first, i); }
+		}
+	}
+}
+
 bool
 warthog::offline_jump_point_locator2::load(const char* filename)
 {
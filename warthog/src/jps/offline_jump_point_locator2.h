@@ -9,16 +9,27 @@
 // This version additionally prunes all jump points that do not have at
 // least one forced neighbour. 
 //
+// The map can change between queries (e.g. doors open and close). 
+// After setting the new labels on the gridmap, call ::update with the ids
+// of the changed cells; only the affected parts of the database are 
+// recomputed.
+//
 // @author: dharabor
 // @created: 05/05/2013
 //
 
 #include "jps.h"
+#include "online_jump_point_locator.h"
+
+#include <unordered_map>
+#include <vector>
 
 namespace warthog
 {
 
-class gridmap;
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
 class offline_jump_point_locator2
 {
 	public:
@@ -32,15 +43,30 @@ class offline_jump_point_locator2
 		uint32_t
 		mem()
 		{
-			return sizeof(this) + sizeof(*db_)*dbsize_;
+			return sizeof(this) + sizeof(*db_)*dbsize_ + 
+				(jpl_ ? jpl_->mem() : 0);
 		}
 
+		// repair the jump database after the traversability of the cells
+		// in @param changed_ids (padded ids) has been modified on the map.
+		// straight jumps are recomputed in each row and column segment 
+		// that crosses a changed cell, up to the nearest obstacle; 
+		// diagonal jumps are recomputed for every cell whose diagonal
+		// reaches one of the recomputed straight jumps.
+		void
+		update(const std::vector<uint32_t>& changed_ids);
+
 
 	private:
 
 		void
 		preproc();
 
+		// compute the label of @param mapid in the direction with
+		// index @param dir_idx (0-7) and store it in the database
+		void
+		compute_label(uint32_t mapid, uint32_t dir_idx);
+
 		bool
 		load(const char* filename);
 
@@ -75,6 +101,10 @@ class offline_jump_point_locator2
 		warthog::gridmap* map_;
 		uint32_t dbsize_;
 		uint16_t* db_;	
+
+		// online jump point locator, used to (re)compute labels.
+		// kept after preprocessing so that updates can reuse it.
+		warthog::online_jump_point_locator* jpl_;
 };
 
 }
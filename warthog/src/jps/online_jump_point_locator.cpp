@@ -9,36 +9,41 @@
 
 extern Statistic g_statistic;
 
-warthog::online_jump_point_locator::online_jump_point_locator(warthog::gridmap* map)
+template<typename ID_T>
+warthog::online_jump_point_locator_base<ID_T>::online_jump_point_locator_base(
+		warthog::gridmap_base<ID_T>* map)
 	: map_(map)//, jumplimit_(UINT32_MAX)
 {
-	rmap_ = create_rmap();
+	rmap_ = ROTATE ? create_rmap() : 0;
 }
 
-warthog::online_jump_point_locator::~online_jump_point_locator()
+template<typename ID_T>
+warthog::online_jump_point_locator_base<ID_T>::~online_jump_point_locator_base()
 {
 	delete rmap_;
 }
 
 // create a copy of the grid map which is rotated by 90 degrees clockwise.
 // this version will be used when jumping North or South. 
-warthog::gridmap*
-warthog::online_jump_point_locator::create_rmap()
+template<typename ID_T>
+warthog::gridmap_base<ID_T>*
+warthog::online_jump_point_locator_base<ID_T>::create_rmap()
 {
 	uint32_t maph = map_->header_height();
 	uint32_t mapw = map_->header_width();
 	uint32_t rmaph = mapw;
 	uint32_t rmapw = maph;
-	warthog::gridmap* rmap = new warthog::gridmap(rmaph, rmapw);
+	warthog::gridmap_base<ID_T>* rmap = 
+		new warthog::gridmap_base<ID_T>(rmaph, rmapw);
 
 	for(uint32_t x = 0; x < mapw; x++) 
 	{
 		for(uint32_t y = 0; y < maph; y++)
 		{
-			uint32_t label = map_->get_label(map_->to_padded_id(x, y));
+			warthog::dbword label = map_->get_label(map_->to_padded_id(x, y));
 			uint32_t rx = ((rmapw-1) - y);
 			uint32_t ry = x;
-			uint32_t rid = rmap->to_padded_id(rx, ry);
+			ID_T rid = rmap->to_padded_id(rx, ry);
 			rmap->set_label(rid, label);
 		}
 	}
@@ -51,10 +56,11 @@ warthog::online_jump_point_locator::create_rmap()
 // search instance. If encountered, the goal node is always returned as a 
 // jump point successor.
 //
-// @return: the id of a jump point successor or warthog::INF32 if no jp exists.
+// @return: the id of a jump point successor or INF if no jp exists.
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump(warthog::jps::direction d,
-	   	uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
+warthog::online_jump_point_locator_base<ID_T>::jump(warthog::jps::direction d,
+	   	ID_T node_id, ID_T goal_id, ID_T& jumpnode_id, 
 		warthog::cost_t& jumpcost)
 {
 	g_statistic.callFindJumpCnt++;
@@ -89,42 +95,56 @@ warthog::online_jump_point_locator::jump(warthog::jps::direction d,
 	}
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_north(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_north(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	g_statistic.callCardinalCnt++;
+	if(!ROTATE)
+	{
+		__scan_vertical(node_id, goal_id, jumpnode_id, jumpcost, true);
+		return;
+	}
 	node_id = this->map_id_to_rmap_id(node_id);
 	goal_id = this->map_id_to_rmap_id(goal_id);
 	__jump_north(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 	jumpnode_id = this->rmap_id_to_map_id(jumpnode_id);
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::__jump_north(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator_base<ID_T>::__jump_north(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::gridmap_base<ID_T>* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// east when we use a version of the map rotated 90 degrees.
 	__jump_east(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_south(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_south(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	g_statistic.callCardinalCnt++;
+	if(!ROTATE)
+	{
+		__scan_vertical(node_id, goal_id, jumpnode_id, jumpcost, false);
+		return;
+	}
 	node_id = this->map_id_to_rmap_id(node_id);
 	goal_id = this->map_id_to_rmap_id(goal_id);
 	__jump_south(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 	jumpnode_id = this->rmap_id_to_map_id(jumpnode_id);
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::__jump_south(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator_base<ID_T>::__jump_south(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::gridmap_base<ID_T>* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// west when we use a version of the map rotated 90 degrees.
@@ -132,19 +152,21 @@ warthog::online_jump_point_locator::__jump_south(uint32_t node_id,
 	__jump_west(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_east(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_east(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	g_statistic.callCardinalCnt++;
 	__jump_east(node_id, goal_id, jumpnode_id, jumpcost, map_);
 }
 
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::__jump_east(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator_base<ID_T>::__jump_east(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost, 
+		warthog::gridmap_base<ID_T>* mymap)
 {
 	jumpnode_id = node_id;
 
@@ -186,8 +208,8 @@ warthog::online_jump_point_locator::__jump_east(uint32_t node_id,
 		jumpnode_id += 31;
 	}
 
-	uint32_t num_steps = jumpnode_id - node_id;
-	uint32_t goal_dist = goal_id - node_id;
+	uint32_t num_steps = (uint32_t)(jumpnode_id - node_id);
+	ID_T goal_dist = goal_id - node_id;
 	if(num_steps > goal_dist)
 	{
 		jumpnode_id = goal_id;
@@ -201,25 +223,27 @@ warthog::online_jump_point_locator::__jump_east(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// looked for the first set bit. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = INF;
 	}
 	jumpcost = num_steps ;
 	
 }
 
 // analogous to ::jump_east 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_west(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_west(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	g_statistic.callCardinalCnt++;
 	__jump_west(node_id, goal_id, jumpnode_id, jumpcost, map_);
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::__jump_west(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator_base<ID_T>::__jump_west(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost, 
+		warthog::gridmap_base<ID_T>* mymap)
 {
 	bool deadend = false;
 	uint32_t neis[3] = {0, 0, 0};
@@ -254,8 +278,8 @@ warthog::online_jump_point_locator::__jump_west(uint32_t node_id,
 	
 	}
 
-	uint32_t num_steps = node_id - jumpnode_id;
-	uint32_t goal_dist = node_id - goal_id;
+	uint32_t num_steps = (uint32_t)(node_id - jumpnode_id);
+	ID_T goal_dist = node_id - goal_id;
 	if(num_steps > goal_dist)
 	{
 		jumpnode_id = goal_id;
@@ -269,32 +293,88 @@ warthog::online_jump_point_locator::__jump_west(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// counted leading zeroes. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = INF;
 	}
 	jumpcost = num_steps ;
 }
 
+// analogous to ::__jump_east, but reads a 3x3 block of tiles per step
+template<typename ID_T>
+void
+warthog::online_jump_point_locator_base<ID_T>::__scan_vertical(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost, bool north)
+{
+	// the row we move into is tiles[0] (north) or tiles[2] (south).
+	// bits 0, 1 and 2 of each row are the columns x-1, x and x+1
+	uint32_t mapw = map_->width();
+	uint32_t ahead = north ? 0 : 2;
+	uint8_t tiles[3];
+	bool deadend = false;
+	uint32_t num_steps = 0;
+
+	// diagonal jumps can step onto an obstacle before scanning; stop
+	// there with cost 0, as ::__jump_east does
+	if(!map_->get_label(node_id))
+	{
+		jumpnode_id = INF;
+		jumpcost = 0;
+		return;
+	}
+
+	jumpnode_id = node_id;
+	while(true)
+	{
+		g_statistic.cardinalCnt++;
+		map_->get_neighbours(jumpnode_id, tiles);
+		num_steps++;
+		jumpnode_id = north ? jumpnode_id - mapw : jumpnode_id + mapw;
+
+		// stop at a dead-end tile or at a forced neighbour; i.e. a
+		// tile beside the next one which is traversable while the tile
+		// beside the current one is not
+		if(!(tiles[ahead] & 2)) { deadend = true; break; }
+		if(tiles[ahead] & ~tiles[1] & 5) { break; }
+	}
+
+	// the goal is ahead if it is in the same column
+	ID_T goal_dist = north ? node_id - goal_id : goal_id - node_id;
+	if(goal_dist % mapw == 0 && num_steps > goal_dist / mapw)
+	{
+		jumpnode_id = goal_id;
+		jumpcost = (warthog::cost_t)(goal_dist / mapw);
+		return;
+	}
+
+	if(deadend)
+	{
+		num_steps--;
+		jumpnode_id = INF;
+	}
+	jumpcost = num_steps;
+}
+
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_northeast(uint32_t node_id,
-	   	uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_northeast(ID_T node_id,
+	   	ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	uint32_t num_steps = 0;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
-	uint32_t next_id = node_id;
+	ID_T next_id = node_id;
 	uint32_t mapw = map_->width();
 
 	// early return if the first diagonal step is invalid
 	// (validity of subsequent steps is checked by straight jump functions)
 	uint32_t neis;
 	map_->get_neighbours(next_id, (uint8_t*)&neis);
-	if((neis & 1542) != 1542) { jumpnode_id = warthog::INF32; jumpcost=0; return; }
+	if((neis & 1542) != 1542) { jumpnode_id = INF; jumpcost=0; return; }
 
 	// jump a single step at a time (no corner cutting)
-	uint32_t rnext_id = map_id_to_rmap_id(next_id);
-	uint32_t rgoal_id = map_id_to_rmap_id(goal_id);
-	uint32_t rmapw = rmap_->width();
+	ID_T rnext_id = ROTATE ? map_id_to_rmap_id(next_id) : 0;
+	ID_T rgoal_id = ROTATE ? map_id_to_rmap_id(goal_id) : 0;
+	uint32_t rmapw = ROTATE ? rmap_->width() : 0;
 	g_statistic.callDiagonalCnt++;
 	while(true)
 	{
@@ -304,41 +384,43 @@ warthog::online_jump_point_locator::jump_northeast(uint32_t node_id,
 		g_statistic.diagonalCnt++;
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		uint32_t jp_id1, jp_id2;
+		ID_T jp_id1, jp_id2;
         warthog::cost_t cost1, cost2;
-		__jump_north(rnext_id, rgoal_id, jp_id1, cost1, rmap_);
-		if(jp_id1 != warthog::INF32) { break; }
+		if(ROTATE) { __jump_north(rnext_id, rgoal_id, jp_id1, cost1, rmap_); }
+		else { __scan_vertical(next_id, goal_id, jp_id1, cost1, true); }
+		if(jp_id1 != INF) { break; }
 		__jump_east(next_id, goal_id, jp_id2, cost2, map_);
-		if(jp_id2 != warthog::INF32) { break; }
+		if(jp_id2 != INF) { break; }
 
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = warthog::INF32; break; }
+		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = INF; break; }
 
 	}
 	jumpnode_id = next_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_northwest(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_northwest(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	uint32_t num_steps = 0;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
-	uint32_t next_id = node_id;
+	ID_T next_id = node_id;
 	uint32_t mapw = map_->width();
 
 	// early termination (invalid first step)
 	uint32_t neis;
 	map_->get_neighbours(next_id, (uint8_t*)&neis);
-	if((neis & 771) != 771) { jumpnode_id = warthog::INF32; jumpcost = 0; return; }
+	if((neis & 771) != 771) { jumpnode_id = INF; jumpcost = 0; return; }
 
 	// jump a single step at a time (no corner cutting)
-	uint32_t rnext_id = map_id_to_rmap_id(next_id);
-	uint32_t rgoal_id = map_id_to_rmap_id(goal_id);
-	uint32_t rmapw = rmap_->width();
+	ID_T rnext_id = ROTATE ? map_id_to_rmap_id(next_id) : 0;
+	ID_T rgoal_id = ROTATE ? map_id_to_rmap_id(goal_id) : 0;
+	uint32_t rmapw = ROTATE ? rmap_->width() : 0;
 	g_statistic.callDiagonalCnt++;
 	while(true)
 	{
@@ -348,41 +430,43 @@ warthog::online_jump_point_locator::jump_northwest(uint32_t node_id,
 		g_statistic.diagonalCnt++;
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		uint32_t jp_id1, jp_id2;
+		ID_T jp_id1, jp_id2;
         warthog::cost_t cost1, cost2;
-		__jump_north(rnext_id, rgoal_id, jp_id1, cost1, rmap_);
-		if(jp_id1 != warthog::INF32) { break; }
+		if(ROTATE) { __jump_north(rnext_id, rgoal_id, jp_id1, cost1, rmap_); }
+		else { __scan_vertical(next_id, goal_id, jp_id1, cost1, true); }
+		if(jp_id1 != INF) { break; }
 		__jump_west(next_id, goal_id, jp_id2, cost2, map_);
-		if(jp_id2 != warthog::INF32) { break; }
+		if(jp_id2 != INF) { break; }
 
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = warthog::INF32; break; }
+		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = INF; break; }
 	}
 	jumpnode_id = next_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_southeast(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_southeast(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	uint32_t num_steps = 0;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
-	uint32_t next_id = node_id;
+	ID_T next_id = node_id;
 	uint32_t mapw = map_->width();
 	
 	// early return if the first diagonal step is invalid
 	// (validity of subsequent steps is checked by straight jump functions)
 	uint32_t neis;
 	map_->get_neighbours(next_id, (uint8_t*)&neis);
-	if((neis & 394752) != 394752) { jumpnode_id = warthog::INF32; jumpcost = 0; return; }
+	if((neis & 394752) != 394752) { jumpnode_id = INF; jumpcost = 0; return; }
 
 	// jump a single step at a time (no corner cutting)
-	uint32_t rnext_id = map_id_to_rmap_id(next_id);
-	uint32_t rgoal_id = map_id_to_rmap_id(goal_id);
-	uint32_t rmapw = rmap_->width();
+	ID_T rnext_id = ROTATE ? map_id_to_rmap_id(next_id) : 0;
+	ID_T rgoal_id = ROTATE ? map_id_to_rmap_id(goal_id) : 0;
+	uint32_t rmapw = ROTATE ? rmap_->width() : 0;
 	g_statistic.callDiagonalCnt++;
 	while(true)
 	{
@@ -393,40 +477,42 @@ warthog::online_jump_point_locator::jump_southeast(uint32_t node_id,
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		uint32_t jp_id1, jp_id2;
+		ID_T jp_id1, jp_id2;
         warthog::cost_t cost1, cost2;
-		__jump_south(rnext_id, rgoal_id, jp_id1, cost1, rmap_);
-		if(jp_id1 != warthog::INF32) { break; }
+		if(ROTATE) { __jump_south(rnext_id, rgoal_id, jp_id1, cost1, rmap_); }
+		else { __scan_vertical(next_id, goal_id, jp_id1, cost1, false); }
+		if(jp_id1 != INF) { break; }
 		__jump_east(next_id, goal_id, jp_id2, cost2, map_);
-		if(jp_id2 != warthog::INF32) { break; }
+		if(jp_id2 != INF) { break; }
 
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = warthog::INF32; break; }
+		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = INF; break; }
 	}
 	jumpnode_id = next_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename ID_T>
 void
-warthog::online_jump_point_locator::jump_southwest(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost)
+warthog::online_jump_point_locator_base<ID_T>::jump_southwest(ID_T node_id, 
+		ID_T goal_id, ID_T& jumpnode_id, warthog::cost_t& jumpcost)
 {
 	uint32_t num_steps = 0;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
 	uint32_t neis;
-	uint32_t next_id = node_id;
+	ID_T next_id = node_id;
 	uint32_t mapw = map_->width();
 
 	// early termination (first step is invalid)
 	map_->get_neighbours(next_id, (uint8_t*)&neis);
-	if((neis & 197376) != 197376) { jumpnode_id = warthog::INF32; jumpcost = 0; return; }
+	if((neis & 197376) != 197376) { jumpnode_id = INF; jumpcost = 0; return; }
 
 	// jump a single step (no corner cutting)
-	uint32_t rnext_id = map_id_to_rmap_id(next_id);
-	uint32_t rgoal_id = map_id_to_rmap_id(goal_id);
-	uint32_t rmapw = rmap_->width();
+	ID_T rnext_id = ROTATE ? map_id_to_rmap_id(next_id) : 0;
+	ID_T rgoal_id = ROTATE ? map_id_to_rmap_id(goal_id) : 0;
+	uint32_t rmapw = ROTATE ? rmap_->width() : 0;
 	g_statistic.callDiagonalCnt++;
 	while(true)
 	{
@@ -437,17 +523,20 @@ warthog::online_jump_point_locator::jump_southwest(uint32_t node_id,
 
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
-		uint32_t jp_id1, jp_id2;
+		ID_T jp_id1, jp_id2;
         warthog::cost_t cost1, cost2;
-		__jump_south(rnext_id, rgoal_id, jp_id1, cost1, rmap_);
-		if(jp_id1 != warthog::INF32) { break; }
+		if(ROTATE) { __jump_south(rnext_id, rgoal_id, jp_id1, cost1, rmap_); }
+		else { __scan_vertical(next_id, goal_id, jp_id1, cost1, false); }
+		if(jp_id1 != INF) { break; }
 		__jump_west(next_id, goal_id, jp_id2, cost2, map_);
-		if(jp_id2 != warthog::INF32) { break; }
+		if(jp_id2 != INF) { break; }
 
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = warthog::INF32; break; }
+		if(!((uint64_t)cost1 && (uint64_t)cost2)) { next_id = INF; break; }
 	}
 	jumpnode_id = next_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template class warthog::online_jump_point_locator_base<uint32_t>;
+template class warthog::online_jump_point_locator_base<uint64_t>;
@@ -10,6 +10,17 @@
 // [Harabor D. and Grastien A, 2011, 
 // Online Graph Pruning Pathfinding on Grid Maps, AAAI]
 //
+// Padded ids are of type ID_T; use online_jump_point_locator for maps
+// with 32-bit ids and online_jump_point_locator_base<uint64_t> for
+// larger maps.
+//
+// With 32-bit ids, jumps north and south read a copy of the map rotated
+// by 90 degrees so they can scan 32 tiles at a time, like jumps east and
+// west. Larger maps are usually memory-mapped bit files, and a rotated
+// copy would double their footprint. Building it would also read every
+// page of the file. With 64-bit ids there is no copy; north and south
+// jumps scan the columns of the map one tile at a time.
+//
 // @author: dharabor
 // @created: 03/09/2012
 //
@@ -20,72 +31,95 @@
 namespace warthog
 {
 
-class online_jump_point_locator 
+template<typename ID_T>
+class online_jump_point_locator_base
 {
 	public: 
-		online_jump_point_locator(warthog::gridmap* map);
-		~online_jump_point_locator();
+		online_jump_point_locator_base(warthog::gridmap_base<ID_T>* map);
+		~online_jump_point_locator_base();
+
+		// the id of a jump point that does not exist
+		static constexpr ID_T INF = (ID_T)~(ID_T)0;
 
 		void
-		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump(warthog::jps::direction d, ID_T node_id, ID_T goalid, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 
 		size_t 
 		mem()
 		{
-			return sizeof(this) + rmap_->mem();
+			return sizeof(this) + (rmap_ ? rmap_->mem() : 0);
+		}
+
+		// call this after changing the label of @param node_id in the
+		// input map; it updates the rotated copy used for N/S jumps
+		void
+		update_label(ID_T node_id)
+		{
+			if(!rmap_) { return; }
+			rmap_->set_label(map_id_to_rmap_id(node_id), 
+					map_->get_label(node_id));
 		}
 
 	private:
+		// whether north and south jumps use the rotated map rmap_
+		static constexpr bool ROTATE = sizeof(ID_T) <= sizeof(uint32_t);
+
 		void
-		jump_northwest(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_northwest(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_northeast(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_northeast(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_southwest(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_southwest(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_southeast(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_southeast(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_north(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_south(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_east(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_west(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost);
 
 		// these versions can be passed a map parameter to
 		// use when jumping. they allow switching between
 		// map_ and rmap_ (a rotated counterpart).
 		void
-		__jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_east(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost, 
+				warthog::gridmap_base<ID_T>* mymap);
 		void
-		__jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_west(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost, 
+				warthog::gridmap_base<ID_T>* mymap);
 		void
-		__jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				warthog::gridmap* mymap);
+		__jump_north(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::gridmap_base<ID_T>* mymap);
 		void
-		__jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_south(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost, 
+				warthog::gridmap_base<ID_T>* mymap);
 
-		inline uint32_t
-		map_id_to_rmap_id(uint32_t mapid)
+		// jump north (@param north = true) or south without the rotated
+		// map, one tile at a time. ids are ids of map_
+		void
+		__scan_vertical(ID_T node_id, ID_T goal_id, 
+				ID_T& jumpnode_id, warthog::cost_t& jumpcost, bool north);
+
+		inline ID_T
+		map_id_to_rmap_id(ID_T mapid)
 		{
-			if(mapid == warthog::INF32) { return mapid; }
+			if(mapid == INF) { return mapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -95,10 +129,10 @@ class online_jump_point_locator
 			return rmap_->to_padded_id(rx, ry);
 		}
 
-		inline uint32_t
-		rmap_id_to_map_id(uint32_t rmapid)
+		inline ID_T
+		rmap_id_to_map_id(ID_T rmapid)
 		{
-			if(rmapid == warthog::INF32) { return rmapid; }
+			if(rmapid == INF) { return rmapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -108,14 +142,16 @@ class online_jump_point_locator
 			return map_->to_padded_id(x, y);
 		}
 
-		warthog::gridmap*
+		warthog::gridmap_base<ID_T>*
 		create_rmap();
 
-		warthog::gridmap* map_;
-		warthog::gridmap* rmap_;
+		warthog::gridmap_base<ID_T>* map_;
+		warthog::gridmap_base<ID_T>* rmap_;
 		//uint32_t jumplimit_;
 };
 
+typedef online_jump_point_locator_base<uint32_t> online_jump_point_locator;
+
 }
 
 #endif
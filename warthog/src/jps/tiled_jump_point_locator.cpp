@@ -0,0 +1,324 @@
+#include "tiled_jump_point_locator.h"
+
+#include "Statistic.h"
+
+extern Statistic g_statistic;
+
+warthog::tiled_jump_point_locator::tiled_jump_point_locator(
+        warthog::tiled_gridmap* map) : map_(map)
+{
+}
+
+warthog::tiled_jump_point_locator::~tiled_jump_point_locator()
+{
+}
+
+void
+warthog::tiled_jump_point_locator::jump(warthog::jps::direction d,
+        uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id,
+        warthog::cost_t& jumpcost)
+{
+    g_statistic.callFindJumpCnt++;
+
+    uint32_t x, y, gx, gy, jx, jy;
+    bool found = false;
+    map_->to_padded_xy(node_id, x, y);
+    map_->to_padded_xy(goal_id, gx, gy);
+    switch(d)
+    {
+        case warthog::jps::NORTH:
+            found = jump_north(x, y, gx, gy, jx, jy, jumpcost);
+            break;
+        case warthog::jps::SOUTH:
+            found = jump_south(x, y, gx, gy, jx, jy, jumpcost);
+            break;
+        case warthog::jps::EAST:
+            found = jump_east(x, y, gx, gy, jx, jy, jumpcost);
+            break;
+        case warthog::jps::WEST:
+            found = jump_west(x, y, gx, gy, jx, jy, jumpcost);
+            break;
+        case warthog::jps::NORTHEAST:
+            jump_diagonal(1, -1, node_id, goal_id, jumpnode_id, jumpcost);
+            return;
+        case warthog::jps::NORTHWEST:
+            jump_diagonal(-1, -1, node_id, goal_id, jumpnode_id, jumpcost);
+            return;
+        case warthog::jps::SOUTHEAST:
+            jump_diagonal(1, 1, node_id, goal_id, jumpnode_id, jumpcost);
+            return;
+        case warthog::jps::SOUTHWEST:
+            jump_diagonal(-1, 1, node_id, goal_id, jumpnode_id, jumpcost);
+            return;
+        default:
+            jumpnode_id = warthog::INF32;
+            jumpcost = 0;
+            return;
+    }
+    jumpnode_id = found ? map_->to_id(jx, jy) : warthog::INF32;
+}
+
+// straight jumps read 64 tiles at a time, one superblock wide, from three
+// adjacent rows (or columns). a forced neighbour is a traversable tile in
+// the row above or below which follows immediately after an obstacle; the
+// bit carried over from the previous superblock is the last tile before
+// the current one. a dead-end is an obstacle in the middle row. the tile
+// we start from is never a stop.
+bool
+warthog::tiled_jump_point_locator::jump_east(uint32_t x, uint32_t y,
+        uint32_t gx, uint32_t gy, uint32_t& jx, uint32_t& jy,
+        warthog::cost_t& jumpcost)
+{
+    g_statistic.callCardinalCnt++;
+    uint32_t sx = x >> 6;
+    uint64_t carry_a = 1, carry_b = 1;
+    uint64_t mask = (~0ull << (x & 63)) << 1;
+    uint32_t stop_pos;
+    bool deadend;
+    while(true)
+    {
+        g_statistic.cardinalCnt++;
+        uint64_t above = map_->row_segment(sx, y - 1);
+        uint64_t mid = map_->row_segment(sx, y);
+        uint64_t below = map_->row_segment(sx, y + 1);
+        uint64_t forced_bits =
+            (above & ~((above << 1) | carry_a)) |
+            (below & ~((below << 1) | carry_b));
+        uint64_t deadend_bits = ~mid;
+        uint64_t stop_bits = (forced_bits | deadend_bits) & mask;
+        if(stop_bits)
+        {
+            stop_pos = (uint32_t)__builtin_ctzll(stop_bits);
+            deadend = (deadend_bits >> stop_pos) & 1;
+            break;
+        }
+        carry_a = above >> 63;
+        carry_b = below >> 63;
+        mask = ~0ull;
+        sx++;
+    }
+
+    uint32_t num_steps = (sx << 6) + stop_pos - x;
+    jx = x + num_steps;
+    jy = y;
+    if(gy == y && gx >= x && num_steps > gx - x)
+    {
+        jx = gx;
+        jumpcost = gx - x;
+        return true;
+    }
+
+    // the dead-end is the obstacle; stop one tile before it
+    if(deadend) { num_steps--; }
+    jumpcost = num_steps;
+    return !deadend;
+}
+
+// analogous to ::jump_east; tiles are processed from the highest bit
+// of each segment to the lowest
+bool
+warthog::tiled_jump_point_locator::jump_west(uint32_t x, uint32_t y,
+        uint32_t gx, uint32_t gy, uint32_t& jx, uint32_t& jy,
+        warthog::cost_t& jumpcost)
+{
+    g_statistic.callCardinalCnt++;
+    uint32_t sx = x >> 6;
+    uint64_t carry_a = 1ull << 63, carry_b = 1ull << 63;
+    uint64_t mask = (1ull << (x & 63)) - 1;
+    uint32_t stop_pos;
+    bool deadend;
+    while(true)
+    {
+        g_statistic.cardinalCnt++;
+        uint64_t above = map_->row_segment(sx, y - 1);
+        uint64_t mid = map_->row_segment(sx, y);
+        uint64_t below = map_->row_segment(sx, y + 1);
+        uint64_t forced_bits =
+            (above & ~((above >> 1) | carry_a)) |
+            (below & ~((below >> 1) | carry_b));
+        uint64_t deadend_bits = ~mid;
+        uint64_t stop_bits = (forced_bits | deadend_bits) & mask;
+        if(stop_bits)
+        {
+            stop_pos = 63 - (uint32_t)__builtin_clzll(stop_bits);
+            deadend = (deadend_bits >> stop_pos) & 1;
+            break;
+        }
+        carry_a = above << 63;
+        carry_b = below << 63;
+        mask = ~0ull;
+        sx--;
+    }
+
+    uint32_t num_steps = x - ((sx << 6) + stop_pos);
+    jx = x - num_steps;
+    jy = y;
+    if(gy == y && gx <= x && num_steps > x - gx)
+    {
+        jx = gx;
+        jumpcost = x - gx;
+        return true;
+    }
+
+    if(deadend) { num_steps--; }
+    jumpcost = num_steps;
+    return !deadend;
+}
+
+// analogous to ::jump_west, reading columns instead of rows
+bool
+warthog::tiled_jump_point_locator::jump_north(uint32_t x, uint32_t y,
+        uint32_t gx, uint32_t gy, uint32_t& jx, uint32_t& jy,
+        warthog::cost_t& jumpcost)
+{
+    g_statistic.callCardinalCnt++;
+    uint32_t sy = y >> 6;
+    uint64_t carry_l = 1ull << 63, carry_r = 1ull << 63;
+    uint64_t mask = (1ull << (y & 63)) - 1;
+    uint32_t stop_pos;
+    bool deadend;
+    while(true)
+    {
+        g_statistic.cardinalCnt++;
+        uint64_t left = map_->col_segment(x - 1, sy);
+        uint64_t mid = map_->col_segment(x, sy);
+        uint64_t right = map_->col_segment(x + 1, sy);
+        uint64_t forced_bits =
+            (left & ~((left >> 1) | carry_l)) |
+            (right & ~((right >> 1) | carry_r));
+        uint64_t deadend_bits = ~mid;
+        uint64_t stop_bits = (forced_bits | deadend_bits) & mask;
+        if(stop_bits)
+        {
+            stop_pos = 63 - (uint32_t)__builtin_clzll(stop_bits);
+            deadend = (deadend_bits >> stop_pos) & 1;
+            break;
+        }
+        carry_l = left << 63;
+        carry_r = right << 63;
+        mask = ~0ull;
+        sy--;
+    }
+
+    uint32_t num_steps = y - ((sy << 6) + stop_pos);
+    jx = x;
+    jy = y - num_steps;
+    if(gx == x && gy <= y && num_steps > y - gy)
+    {
+        jy = gy;
+        jumpcost = y - gy;
+        return true;
+    }
+
+    if(deadend) { num_steps--; }
+    jumpcost = num_steps;
+    return !deadend;
+}
+
+// analogous to ::jump_east, reading columns instead of rows
+bool
+warthog::tiled_jump_point_locator::jump_south(uint32_t x, uint32_t y,
+        uint32_t gx, uint32_t gy, uint32_t& jx, uint32_t& jy,
+        warthog::cost_t& jumpcost)
+{
+    g_statistic.callCardinalCnt++;
+    uint32_t sy = y >> 6;
+    uint64_t carry_l = 1, carry_r = 1;
+    uint64_t mask = (~0ull << (y & 63)) << 1;
+    uint32_t stop_pos;
+    bool deadend;
+    while(true)
+    {
+        g_statistic.cardinalCnt++;
+        uint64_t left = map_->col_segment(x - 1, sy);
+        uint64_t mid = map_->col_segment(x, sy);
+        uint64_t right = map_->col_segment(x + 1, sy);
+        uint64_t forced_bits =
+            (left & ~((left << 1) | carry_l)) |
+            (right & ~((right << 1) | carry_r));
+        uint64_t deadend_bits = ~mid;
+        uint64_t stop_bits = (forced_bits | deadend_bits) & mask;
+        if(stop_bits)
+        {
+            stop_pos = (uint32_t)__builtin_ctzll(stop_bits);
+            deadend = (deadend_bits >> stop_pos) & 1;
+            break;
+        }
+        carry_l = left >> 63;
+        carry_r = right >> 63;
+        mask = ~0ull;
+        sy++;
+    }
+
+    uint32_t num_steps = (sy << 6) + stop_pos - y;
+    jx = x;
+    jy = y + num_steps;
+    if(gx == x && gy >= y && num_steps > gy - y)
+    {
+        jy = gy;
+        jumpcost = gy - y;
+        return true;
+    }
+
+    if(deadend) { num_steps--; }
+    jumpcost = num_steps;
+    return !deadend;
+}
+
+void
+warthog::tiled_jump_point_locator::jump_diagonal(int32_t dx, int32_t dy,
+        uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id,
+        warthog::cost_t& jumpcost)
+{
+    uint32_t x, y, gx, gy;
+    map_->to_padded_xy(node_id, x, y);
+    map_->to_padded_xy(goal_id, gx, gy);
+
+    // early return if the first diagonal step is invalid
+    // (validity of subsequent steps is checked by straight jump functions)
+    if(!(map_->get_label(x + dx, y + dy) && map_->get_label(x + dx, y) &&
+         map_->get_label(x, y + dy)))
+    {
+        jumpnode_id = warthog::INF32;
+        jumpcost = 0;
+        return;
+    }
+
+    // jump a single step at a time (no corner cutting)
+    g_statistic.callDiagonalCnt++;
+    uint32_t num_steps = 0;
+    while(true)
+    {
+        num_steps++;
+        x += dx;
+        y += dy;
+        g_statistic.diagonalCnt++;
+
+        // the straight jumps below assume they start on a traversable tile
+        if(!map_->get_label(x, y))
+        {
+            jumpnode_id = warthog::INF32;
+            jumpcost = num_steps * warthog::DBL_ROOT_TWO;
+            return;
+        }
+
+        // recurse straight before stepping again diagonally;
+        // (ensures we do not miss any optimal turning points)
+        uint32_t jx, jy;
+        warthog::cost_t cost1, cost2;
+        if(dy < 0 ? jump_north(x, y, gx, gy, jx, jy, cost1)
+                  : jump_south(x, y, gx, gy, jx, jy, cost1)) { break; }
+        if(dx > 0 ? jump_east(x, y, gx, gy, jx, jy, cost2)
+                  : jump_west(x, y, gx, gy, jx, jy, cost2)) { break; }
+
+        // couldn't move in either straight dir; (x, y) is a dead-end
+        if(!((uint64_t)cost1 && (uint64_t)cost2))
+        {
+            jumpnode_id = warthog::INF32;
+            jumpcost = num_steps * warthog::DBL_ROOT_TWO;
+            return;
+        }
+    }
+    jumpnode_id = map_->to_id(x, y);
+    jumpcost = num_steps * warthog::DBL_ROOT_TWO;
+}
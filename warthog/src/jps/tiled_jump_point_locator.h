@@ -0,0 +1,68 @@
+#ifndef WARTHOG_TILED_JUMP_POINT_LOCATOR_H
+#define WARTHOG_TILED_JUMP_POINT_LOCATOR_H
+
+// tiled_jump_point_locator.h
+//
+// Finds jump point successors online, like online_jump_point_locator,
+// but on a tiled_gridmap. Horizontal scans read 64 tiles at a time from
+// the rows of the map; vertical scans read 64 tiles at a time from its
+// columns. Both come from the same cache-blocked copy of the map, so
+// there is no need for the rotated map that online_jump_point_locator
+// keeps for N/S jumps.
+//
+// Node ids are padded ids of the tiled_gridmap.
+//
+
+#include "jps.h"
+#include "tiled_gridmap.h"
+
+namespace warthog
+{
+
+class tiled_jump_point_locator
+{
+    public:
+        tiled_jump_point_locator(warthog::tiled_gridmap* map);
+        ~tiled_jump_point_locator();
+
+        // find a jump point successor of @param node_id in direction
+        // @param d. if encountered, the goal is always a jump point.
+        // @param jumpnode_id is warthog::INF32 if no jump point exists.
+        void
+        jump(warthog::jps::direction d, uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+
+        size_t
+        mem() { return sizeof(*this); }
+
+    private:
+        warthog::tiled_gridmap* map_;
+
+        // straight jumps, in padded coordinates. on return, @param jx
+        // and @param jy are the location of the jump point and
+        // @return false if the jump ran into an obstacle instead
+        bool
+        jump_east(uint32_t x, uint32_t y, uint32_t gx, uint32_t gy,
+                uint32_t& jx, uint32_t& jy, warthog::cost_t& jumpcost);
+        bool
+        jump_west(uint32_t x, uint32_t y, uint32_t gx, uint32_t gy,
+                uint32_t& jx, uint32_t& jy, warthog::cost_t& jumpcost);
+        bool
+        jump_north(uint32_t x, uint32_t y, uint32_t gx, uint32_t gy,
+                uint32_t& jx, uint32_t& jy, warthog::cost_t& jumpcost);
+        bool
+        jump_south(uint32_t x, uint32_t y, uint32_t gx, uint32_t gy,
+                uint32_t& jx, uint32_t& jy, warthog::cost_t& jumpcost);
+
+        // diagonal jumps step one tile at a time and look for jump
+        // points in the two straight directions after every step.
+        // (@param dx, @param dy) is the direction of travel.
+        void
+        jump_diagonal(int32_t dx, int32_t dy, uint32_t node_id,
+                uint32_t goal_id, uint32_t& jumpnode_id,
+                warthog::cost_t& jumpcost);
+};
+
+}
+
+#endif
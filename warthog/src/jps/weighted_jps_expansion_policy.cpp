@@ -0,0 +1,129 @@
+#include "weighted_jps_expansion_policy.h"
+#include "Statistic.h"
+
+extern Statistic g_statistic;
+
+warthog::weighted_jps_expansion_policy::weighted_jps_expansion_policy(
+        warthog::vl_gridmap* map)
+    : expansion_policy(map->height()*map->width())
+{
+    map_ = map;
+    jpl_ = new warthog::jps::weighted_jump_point_locator(map);
+    jp_ids_.reserve(100);
+    jp_costs_.reserve(100);
+    reset();
+}
+
+warthog::weighted_jps_expansion_policy::~weighted_jps_expansion_policy()
+{
+    delete jpl_;
+}
+
+void
+warthog::weighted_jps_expansion_policy::expand(
+        warthog::search_node* current, warthog::problem_instance* problem)
+{
+    reset();
+
+    // compute the direction of travel used to reach the current node.
+    warthog::jps::direction dir_c =
+        this->compute_direction(
+                (uint32_t)current->get_parent(), (uint32_t)current->get_id());
+
+    // get the tiles around the current node c, in the same format as
+    // gridmap::get_neighbours, and check if c is mixed
+    uint32_t current_id = (uint32_t)current->get_id();
+    uint32_t w = map_->width();
+    warthog::dbword t = map_->get_label(current_id);
+    uint32_t c_tiles = 0;
+    bool mixed = false;
+    for(uint32_t row = 0; row < 3; row++)
+    {
+        warthog::dbword* label = &map_->get_label(current_id + (row - 1) * w);
+        for(uint32_t col = 0; col < 3; col++)
+        {
+            warthog::dbword n = label[(int32_t)col - 1];
+            c_tiles |= (uint32_t)(n != 0) << (row * 8 + col);
+            mixed |= (n != 0 && n != t);
+        }
+    }
+
+    // look for jump points in the direction of each natural
+    // and forced neighbour; in every direction if c is mixed
+    if(mixed) { dir_c = warthog::jps::NONE; }
+    uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
+    uint32_t goal_id = (uint32_t)problem->target_id_;
+    jp_ids_.clear();
+    jp_costs_.clear();
+    for(uint32_t i = 0; i < 8; i++)
+    {
+        warthog::jps::direction d = (warthog::jps::direction) (1 << i);
+        if(succ_dirs & d)
+        {
+            g_statistic.expandCnt++;
+            jpl_->jump(d, current_id, goal_id, jp_ids_, jp_costs_);
+        }
+    }
+
+    for(uint32_t i = 0; i < jp_ids_.size(); i++)
+    {
+        add_neighbour(this->generate(jp_ids_[i]), jp_costs_[i]);
+    }
+}
+
+void
+warthog::weighted_jps_expansion_policy::get_xy(
+        warthog::sn_id_t nid, int32_t& x, int32_t& y)
+{
+    map_->to_unpadded_xy((uint32_t)nid, (uint32_t&)x, (uint32_t&)y);
+}
+
+warthog::search_node*
+warthog::weighted_jps_expansion_policy::generate_start_node(
+        warthog::problem_instance* pi)
+{
+    return generate_node((uint32_t)pi->start_id_);
+}
+
+warthog::search_node*
+warthog::weighted_jps_expansion_policy::generate_target_node(
+        warthog::problem_instance* pi)
+{
+    return generate_node((uint32_t)pi->target_id_);
+}
+
+warthog::search_node*
+warthog::weighted_jps_expansion_policy::generate_node(uint32_t node_id)
+{
+    uint32_t max_id = map_->header_width() * map_->header_height();
+    if(node_id >= max_id) { return 0; }
+    uint32_t padded_id = map_->to_padded_id(node_id);
+    if(!map_->get_label(padded_id)) { return 0; }
+    return generate(padded_id);
+}
+
+inline warthog::jps::direction
+warthog::weighted_jps_expansion_policy::compute_direction(
+        uint32_t n1_id, uint32_t n2_id)
+{
+    if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
+
+    int32_t x, y, x2, y2;
+    warthog::helpers::index_to_xy(n1_id, map_->width(), x, y);
+    warthog::helpers::index_to_xy(n2_id, map_->width(), x2, y2);
+    int32_t dx = abs(x2 - x);
+    int32_t dy = abs(y2 - y);
+
+    if(dx > dy)
+    {
+        if(x2 > x)
+        { return warthog::jps::EAST; }
+
+        return warthog::jps::WEST;
+    }
+
+    if(y2 > y)
+    { return warthog::jps::SOUTH; }
+
+    return warthog::jps::NORTH;
+}
@@ -0,0 +1,85 @@
+#ifndef WARTHOG_WEIGHTED_JPS_EXPANSION_POLICY_H
+#define WARTHOG_WEIGHTED_JPS_EXPANSION_POLICY_H
+
+// weighted_jps_expansion_policy.h
+//
+// Jump point search for gridmaps with terrain costs. Edge costs are the
+// same as for vl_gridmap_expansion_policy, and so are the costs of the
+// paths this policy finds.
+//
+// Tiles whose neighbours all have the same terrain (or are obstacles)
+// are pruned exactly as in jps_expansion_policy. Mixed tiles, which have
+// a neighbour of another terrain, are expanded in every direction: the
+// cheapest way past a terrain boundary depends on the costs on both
+// sides, so nothing can be pruned there. Jump points are located by
+// weighted_jump_point_locator.
+//
+// Like jps2_expansion_policy, intermediate diagonal jump points are
+// skipped. Every successor which is not mixed is reached by a straight
+// move, so its direction of travel is the axis along which it is
+// furthest from its parent.
+//
+// Node ids are padded ids of the vl_gridmap, so the heuristic should be
+// constructed with its (padded) width and height.
+//
+
+#include "expansion_policy.h"
+#include "helpers.h"
+#include "jps.h"
+#include "labelled_gridmap.h"
+#include "problem_instance.h"
+#include "search_node.h"
+#include "weighted_jump_point_locator.h"
+
+#include "stdint.h"
+#include <vector>
+
+namespace warthog
+{
+
+class weighted_jps_expansion_policy : public expansion_policy
+{
+    public:
+        weighted_jps_expansion_policy(warthog::vl_gridmap* map);
+        virtual ~weighted_jps_expansion_policy();
+
+        virtual void
+        expand(warthog::search_node*, warthog::problem_instance*);
+
+        virtual void
+        get_xy(warthog::sn_id_t nid, int32_t& x, int32_t& y);
+
+        virtual warthog::search_node*
+        generate_start_node(warthog::problem_instance* pi);
+
+        virtual warthog::search_node*
+        generate_target_node(warthog::problem_instance* pi);
+
+        inline warthog::vl_gridmap*
+        get_map() { return map_; }
+
+        virtual inline size_t
+        mem()
+        {
+            return expansion_policy::mem() +
+                sizeof(*this) + map_->mem() + jpl_->mem();
+        }
+
+    private:
+        warthog::vl_gridmap* map_;
+        warthog::jps::weighted_jump_point_locator* jpl_;
+        std::vector<uint32_t> jp_ids_;
+        std::vector<warthog::cost_t> jp_costs_;
+
+        // computes the direction of travel; from a node n1
+        // to a node n2. always a cardinal direction.
+        inline warthog::jps::direction
+        compute_direction(uint32_t n1_id, uint32_t n2_id);
+
+        warthog::search_node*
+        generate_node(uint32_t node_id);
+};
+
+}
+
+#endif
@@ -0,0 +1,380 @@
+#include "weighted_jump_point_locator.h"
+
+#include "Statistic.h"
+
+extern Statistic g_statistic;
+
+warthog::jps::weighted_jump_point_locator::weighted_jump_point_locator(
+        warthog::vl_gridmap* map)
+    : map_(map), num_terrains_(0), terrain_(256, 0), rterrain_(256, 0)
+{
+    current_node_id_ = node_id_ = rnode_id_ = warthog::INF32;
+    current_goal_id_ = goal_id_ = rgoal_id_ = warthog::INF32;
+    create_bitmaps();
+}
+
+warthog::jps::weighted_jump_point_locator::~weighted_jump_point_locator()
+{
+    for(uint32_t i = 0; i < terrain_.size(); i++)
+    {
+        delete terrain_[i];
+        delete rterrain_[i];
+    }
+    delete mixed_;
+    delete rmixed_;
+}
+
+// build the terrain bitmaps and the bitmap of mixed tiles. the rotated
+// copies are turned 90 degrees clockwise, as in online_jump_point_locator
+void
+warthog::jps::weighted_jump_point_locator::create_bitmaps()
+{
+    uint32_t maph = map_->header_height();
+    uint32_t mapw = map_->header_width();
+    mixed_ = new warthog::gridmap(maph, mapw);
+    rmixed_ = new warthog::gridmap(mapw, maph);
+
+    uint32_t w = map_->width();
+    for(uint32_t y = 0; y < maph; y++)
+    {
+        for(uint32_t x = 0; x < mapw; x++)
+        {
+            uint32_t id = map_->to_padded_id(x, y);
+            warthog::dbword t = map_->get_label(id);
+            if(t == 0) { continue; }
+
+            if(terrain_[t] == 0)
+            {
+                terrain_[t] = new warthog::gridmap(maph, mapw);
+                rterrain_[t] = new warthog::gridmap(mapw, maph);
+                num_terrains_++;
+            }
+
+            uint32_t bid = mixed_->to_padded_id(x, y);
+            uint32_t rbid = rmixed_->to_padded_id((maph - 1) - y, x);
+            terrain_[t]->set_label(bid, 1);
+            rterrain_[t]->set_label(rbid, 1);
+
+            bool mixed = false;
+            for(int32_t dy = -1; dy <= 1; dy++)
+            {
+                for(int32_t dx = -1; dx <= 1; dx++)
+                {
+                    warthog::dbword n =
+                        map_->get_label(id + (uint32_t)(dy * (int32_t)w + dx));
+                    mixed |= (n != 0 && n != t);
+                }
+            }
+            if(mixed)
+            {
+                mixed_->set_label(bid, 1);
+                rmixed_->set_label(rbid, 1);
+            }
+        }
+    }
+}
+
+void
+warthog::jps::weighted_jump_point_locator::set_ids(
+        uint32_t node_id, uint32_t goal_id)
+{
+    uint32_t x, y;
+    uint32_t maph = map_->header_height();
+    if(node_id != current_node_id_)
+    {
+        current_node_id_ = node_id;
+        map_->to_unpadded_xy(node_id, x, y);
+        node_id_ = mixed_->to_padded_id(x, y);
+        rnode_id_ = rmixed_->to_padded_id((maph - 1) - y, x);
+    }
+    if(goal_id != current_goal_id_)
+    {
+        current_goal_id_ = goal_id;
+        map_->to_unpadded_xy(goal_id, x, y);
+        goal_id_ = mixed_->to_padded_id(x, y);
+        rgoal_id_ = rmixed_->to_padded_id((maph - 1) - y, x);
+    }
+}
+
+void
+warthog::jps::weighted_jump_point_locator::jump(warthog::jps::direction d,
+        uint32_t node_id, uint32_t goal_id, std::vector<uint32_t>& jpoints,
+        std::vector<warthog::cost_t>& costs)
+{
+    g_statistic.callFindJumpCnt++;
+    set_ids(node_id, goal_id);
+
+    switch(d)
+    {
+        case warthog::jps::NORTH:
+        case warthog::jps::SOUTH:
+        case warthog::jps::EAST:
+        case warthog::jps::WEST:
+            jump_straight(d, node_id, jpoints, costs);
+            break;
+        case warthog::jps::NORTHEAST:
+        case warthog::jps::NORTHWEST:
+        case warthog::jps::SOUTHEAST:
+        case warthog::jps::SOUTHWEST:
+            jump_diagonal(d, node_id, jpoints, costs);
+            break;
+        default:
+            break;
+    }
+}
+
+void
+warthog::jps::weighted_jump_point_locator::jump_straight(
+        warthog::jps::direction d, uint32_t node_id,
+        std::vector<uint32_t>& jpoints, std::vector<warthog::cost_t>& costs)
+{
+    uint32_t w = map_->width();
+    uint32_t offset =
+        d == warthog::jps::NORTH ? (uint32_t)-w :
+        d == warthog::jps::SOUTH ? w :
+        d == warthog::jps::EAST ? 1 : (uint32_t)-1;
+
+    // the first step decides which terrain we travel through. if it
+    // leads into another terrain, the next tile is mixed and we stop
+    warthog::dbword t = map_->get_label(node_id);
+    warthog::dbword tn = map_->get_label(node_id + offset);
+    if(tn == 0) { return; }
+    if(tn != t)
+    {
+        jpoints.push_back(node_id + offset);
+        costs.push_back(((uint32_t)t + (uint32_t)tn) * 0.5);
+        return;
+    }
+
+    // jumping north (resp. south) is the same as jumping east
+    // (resp. west) on the rotated bitmaps
+    uint32_t jp_id, num_steps;
+    switch(d)
+    {
+        case warthog::jps::NORTH:
+            num_steps = scan_east(rnode_id_, rgoal_id_, jp_id,
+                    rterrain_[t], rmixed_);
+            break;
+        case warthog::jps::SOUTH:
+            num_steps = scan_west(rnode_id_, rgoal_id_, jp_id,
+                    rterrain_[t], rmixed_);
+            break;
+        case warthog::jps::EAST:
+            num_steps = scan_east(node_id_, goal_id_, jp_id,
+                    terrain_[t], mixed_);
+            break;
+        default:
+            num_steps = scan_west(node_id_, goal_id_, jp_id,
+                    terrain_[t], mixed_);
+            break;
+    }
+    if(jp_id == warthog::INF32) { return; }
+
+    jpoints.push_back(node_id + num_steps * offset);
+    costs.push_back(num_steps * (warthog::cost_t)t);
+}
+
+void
+warthog::jps::weighted_jump_point_locator::jump_diagonal(
+        warthog::jps::direction d, uint32_t node_id,
+        std::vector<uint32_t>& jpoints, std::vector<warthog::cost_t>& costs)
+{
+    bool north =
+        d == warthog::jps::NORTHEAST || d == warthog::jps::NORTHWEST;
+    bool east =
+        d == warthog::jps::NORTHEAST || d == warthog::jps::SOUTHEAST;
+
+    uint32_t w = map_->width();
+    uint32_t v_offset = north ? (uint32_t)-w : w;
+    uint32_t h_offset = east ? 1 : (uint32_t)-1;
+
+    // as with straight jumps, the first step may cross into another
+    // terrain. diagonal moves need all four tiles (no corner cutting)
+    warthog::dbword t = map_->get_label(node_id);
+    warthog::dbword tv = map_->get_label(node_id + v_offset);
+    warthog::dbword th = map_->get_label(node_id + h_offset);
+    warthog::dbword td = map_->get_label(node_id + v_offset + h_offset);
+    if(!(tv && th && td)) { return; }
+    if(tv != t || th != t || td != t)
+    {
+        jpoints.push_back(node_id + v_offset + h_offset);
+        costs.push_back(
+                ((uint32_t)t + (uint32_t)tv + (uint32_t)th + (uint32_t)td)
+                * warthog::DBL_ROOT_TWO * 0.25);
+        return;
+    }
+
+    // the same step in the coordinate spaces of the bitmaps. moving
+    // north is moving east in the rotated bitmaps, and moving east
+    // is moving south
+    uint32_t bw = mixed_->width();
+    uint32_t rbw = rmixed_->width();
+    uint32_t b_offset = (north ? (uint32_t)-bw : bw) + h_offset;
+    uint32_t rb_offset =
+        (north ? 1 : (uint32_t)-1) + (east ? rbw : (uint32_t)-rbw);
+    warthog::gridmap* tmap = terrain_[t];
+    warthog::gridmap* rtmap = rterrain_[t];
+
+    uint32_t id = node_id_;
+    uint32_t rid = rnode_id_;
+    uint32_t next_id = node_id;
+    warthog::cost_t next_cost = 0;
+    while(true)
+    {
+        id += b_offset;
+        rid += rb_offset;
+        next_id += v_offset + h_offset;
+        next_cost += warthog::DBL_ROOT_TWO * t;
+        g_statistic.diagonalCnt++;
+
+        // mixed tiles and the goal end the jump
+        if(mixed_->get_label(id) || id == goal_id_)
+        {
+            jpoints.push_back(next_id);
+            costs.push_back(next_cost);
+            return;
+        }
+
+        // jump straight before stepping again diagonally and keep
+        // the jump points we find
+        uint32_t jp_id1, jp_id2, steps1, steps2;
+        steps1 = north ?
+            scan_east(rid, rgoal_id_, jp_id1, rtmap, rmixed_) :
+            scan_west(rid, rgoal_id_, jp_id1, rtmap, rmixed_);
+        if(jp_id1 != warthog::INF32)
+        {
+            jpoints.push_back(next_id + steps1 * v_offset);
+            costs.push_back(next_cost + steps1 * (warthog::cost_t)t);
+        }
+        steps2 = east ?
+            scan_east(id, goal_id_, jp_id2, tmap, mixed_) :
+            scan_west(id, goal_id_, jp_id2, tmap, mixed_);
+        if(jp_id2 != warthog::INF32)
+        {
+            jpoints.push_back(next_id + steps2 * h_offset);
+            costs.push_back(next_cost + steps2 * (warthog::cost_t)t);
+        }
+
+        // stop if the next diagonal step is blocked (no corner
+        // cutting) or if this tile is an obstacle
+        if(!(steps1 && steps2)) { return; }
+    }
+}
+
+uint32_t
+warthog::jps::weighted_jump_point_locator::scan_east(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id,
+        warthog::gridmap* tmap, warthog::gridmap* mmap)
+{
+    uint32_t neis[3] = {0, 0, 0};
+    uint32_t mixed[3] = {0, 0, 0};
+    bool deadend = false;
+
+    jumpnode_id = node_id;
+    while(true)
+    {
+        // 32 tiles from three adjacent rows. the current node is
+        // in the lowest bit of the middle row
+        tmap->get_neighbours_32bit(jumpnode_id, neis);
+        mmap->get_neighbours_32bit(jumpnode_id, mixed);
+        g_statistic.cardinalCnt++;
+
+        // forced neighbours and dead-ends are identified as in
+        // online_jump_point_locator. we also stop at mixed tiles,
+        // except the one we started from.
+        uint32_t
+        forced_bits = (~neis[0] << 1) & neis[0];
+        forced_bits |= (~neis[2] << 1) & neis[2];
+        uint32_t
+        deadend_bits = ~neis[1];
+
+        uint32_t stop_bits = forced_bits | deadend_bits | (mixed[1] & ~1u);
+        if(stop_bits)
+        {
+            uint32_t stop_pos = (uint32_t)__builtin_ctz(stop_bits);
+            jumpnode_id += stop_pos;
+            deadend = deadend_bits & (1u << stop_pos);
+            break;
+        }
+        jumpnode_id += 31;
+    }
+
+    uint32_t num_steps = jumpnode_id - node_id;
+    uint32_t goal_dist = goal_id - node_id;
+    if(num_steps > goal_dist)
+    {
+        jumpnode_id = goal_id;
+        return goal_dist;
+    }
+
+    if(deadend)
+    {
+        // the dead-end tile is an obstacle; stop one step earlier
+        num_steps -= (1 && num_steps);
+        jumpnode_id = warthog::INF32;
+    }
+    return num_steps;
+}
+
+uint32_t
+warthog::jps::weighted_jump_point_locator::scan_west(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id,
+        warthog::gridmap* tmap, warthog::gridmap* mmap)
+{
+    uint32_t neis[3] = {0, 0, 0};
+    uint32_t mixed[3] = {0, 0, 0};
+    bool deadend = false;
+
+    jumpnode_id = node_id;
+    while(true)
+    {
+        // current node is in the highest bit of the middle row
+        tmap->get_neighbours_upper_32bit(jumpnode_id, neis);
+        mmap->get_neighbours_upper_32bit(jumpnode_id, mixed);
+        g_statistic.cardinalCnt++;
+
+        uint32_t
+        forced_bits = (~neis[0] >> 1) & neis[0];
+        forced_bits |= (~neis[2] >> 1) & neis[2];
+        uint32_t
+        deadend_bits = ~neis[1];
+
+        uint32_t stop_bits =
+            forced_bits | deadend_bits | (mixed[1] & 0x7fffffff);
+        if(stop_bits)
+        {
+            uint32_t stop_pos = (uint32_t)__builtin_clz(stop_bits);
+            jumpnode_id -= stop_pos;
+            deadend = deadend_bits & (0x80000000 >> stop_pos);
+            break;
+        }
+        jumpnode_id -= 31;
+    }
+
+    uint32_t num_steps = node_id - jumpnode_id;
+    uint32_t goal_dist = node_id - goal_id;
+    if(num_steps > goal_dist)
+    {
+        jumpnode_id = goal_id;
+        return goal_dist;
+    }
+
+    if(deadend)
+    {
+        num_steps -= (1 && num_steps);
+        jumpnode_id = warthog::INF32;
+    }
+    return num_steps;
+}
+
+size_t
+warthog::jps::weighted_jump_point_locator::mem()
+{
+    size_t retval = sizeof(*this) + mixed_->mem() + rmixed_->mem() +
+        sizeof(warthog::gridmap*) * (terrain_.capacity() + rterrain_.capacity());
+    for(uint32_t i = 0; i < terrain_.size(); i++)
+    {
+        if(terrain_[i]) { retval += terrain_[i]->mem() + rterrain_[i]->mem(); }
+    }
+    return retval;
+}
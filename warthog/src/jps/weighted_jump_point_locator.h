@@ -0,0 +1,120 @@
+#ifndef WARTHOG_WEIGHTED_JUMP_POINT_LOCATOR_H
+#define WARTHOG_WEIGHTED_JUMP_POINT_LOCATOR_H
+
+// weighted_jump_point_locator.h
+//
+// Finds jump point successors online on a vertex-labelled gridmap, where
+// the label of each tile is its terrain cost (see
+// vl_gridmap_expansion_policy for how edge costs are computed).
+//
+// Jumps only travel through tiles of the same terrain. For every terrain
+// that appears on the map we keep a bitmap of the tiles of that terrain,
+// plus a copy rotated by 90 degrees for N/S jumps. Inside a terrain the
+// map is a uniform-cost grid in which tiles of every other terrain are
+// obstacles, so straight jumps read 32 tiles at a time and look for
+// forced neighbours just like online_jump_point_locator does.
+//
+// A tile is "mixed" if one of its eight neighbours is traversable but
+// has a different terrain. Edges whose cost is not uniform only join
+// mixed tiles, so every mixed tile is a jump point: jumps stop when they
+// reach one, and a jump which begins with a move into another terrain
+// stops after that single step. A separate bitmap of mixed tiles (and
+// its rotated copy) lets straight jumps test for them word-wide too.
+//
+// Terrain boundaries are everywhere, so most straight jumps made during
+// a diagonal jump end at a mixed tile. As in online_jump_point_locator2
+// the jump points they find are returned directly and the diagonal jump
+// carries on, instead of stopping at every such diagonal step. Apart
+// from mixed tiles and the goal, every successor is therefore reached
+// by a straight move (see weighted_jps_expansion_policy).
+//
+// Node ids are padded ids of the vl_gridmap. Jump costs are in the same
+// units as vl_gridmap_expansion_policy.
+//
+
+#include "gridmap.h"
+#include "jps.h"
+#include "labelled_gridmap.h"
+
+#include <vector>
+
+namespace warthog
+{
+
+namespace jps
+{
+
+class weighted_jump_point_locator
+{
+    public:
+        weighted_jump_point_locator(warthog::vl_gridmap* map);
+        ~weighted_jump_point_locator();
+
+        // find the jump point successors of @param node_id in direction
+        // @param d and append them to @param jpoints (with their costs
+        // in @param costs). if encountered, the goal is always a jump
+        // point.
+        void
+        jump(warthog::jps::direction d, uint32_t node_id, uint32_t goal_id,
+                std::vector<uint32_t>& jpoints,
+                std::vector<warthog::cost_t>& costs);
+
+        // @return the number of different terrains on the map
+        inline uint32_t
+        get_num_terrains() { return num_terrains_; }
+
+        size_t
+        mem();
+
+    private:
+        warthog::vl_gridmap* map_;
+        uint32_t num_terrains_;
+
+        // one bitmap per terrain, indexed by label. null if the label
+        // does not appear on the map. all bitmaps share the same layout.
+        std::vector<warthog::gridmap*> terrain_;
+        std::vector<warthog::gridmap*> rterrain_;
+        warthog::gridmap* mixed_;
+        warthog::gridmap* rmixed_;
+
+        // ids of the current node and goal in the bitmaps and in their
+        // rotated counterparts
+        uint32_t current_node_id_, node_id_, rnode_id_;
+        uint32_t current_goal_id_, goal_id_, rgoal_id_;
+
+        // convert @param node_id and @param goal_id to bitmap ids
+        void
+        set_ids(uint32_t node_id, uint32_t goal_id);
+
+        void
+        jump_straight(warthog::jps::direction d, uint32_t node_id,
+                std::vector<uint32_t>& jpoints,
+                std::vector<warthog::cost_t>& costs);
+
+        void
+        jump_diagonal(warthog::jps::direction d, uint32_t node_id,
+                std::vector<uint32_t>& jpoints,
+                std::vector<warthog::cost_t>& costs);
+
+        // scan east (resp. west) from @param node_id on the bitmap
+        // @param tmap, stopping at forced neighbours, the goal and the
+        // tiles set in @param mmap. ids are in the bitmap coordinate
+        // space. @return the number of steps taken; @param jumpnode_id
+        // is warthog::INF32 if the scan ended at an obstacle.
+        uint32_t
+        scan_east(uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id,
+                warthog::gridmap* tmap, warthog::gridmap* mmap);
+
+        uint32_t
+        scan_west(uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id,
+                warthog::gridmap* tmap, warthog::gridmap* mmap);
+
+        void
+        create_bitmaps();
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef WARTHOG_AF_FILTER_H
+#define WARTHOG_AF_FILTER_H
+
+// label/af_filter.h
+//
+// An edge filter making use of arc flags. An edge is pruned if its
+// flag for the cell containing the target is not set.
+//
+// Arc flags can be combined with geometric containers: if a
+// bb_filter is supplied, an edge is pruned when either filter
+// prunes it.
+//
+
+#include "af_labelling.h"
+#include "bb_filter.h"
+#include "forward.h"
+
+namespace warthog
+{
+
+class af_filter
+{
+
+    public:
+        af_filter(warthog::label::af_labelling* afl,
+                warthog::bb_filter* bbf = 0)
+        {
+            afl_ = afl;
+            bbf_ = bbf;
+            tpart_ = warthog::INF32;
+        }
+
+        ~af_filter() { }
+
+        inline void
+        set_target(uint32_t target_id)
+        {
+            tpart_ = afl_->get_part(target_id);
+            if(bbf_) { bbf_->set_target(target_id); }
+        }
+
+        // return true if the specified edge is not flagged for the cell
+        // of the target (or if the bounding box filter prunes it) and
+        // return false otherwise.
+        inline bool
+        filter(uint32_t node_id, uint32_t edge_id)
+        {
+            if(!afl_->get_flag(node_id, edge_id, tpart_))
+            {
+                return true;
+            }
+            return bbf_ && bbf_->filter(node_id, edge_id);
+        }
+
+    private:
+        uint32_t tpart_;
+        warthog::label::af_labelling* afl_;
+        warthog::bb_filter* bbf_;
+
+};
+
+}
+
+#endif
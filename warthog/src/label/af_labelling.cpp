@@ -0,0 +1,277 @@
+#include "label/af_labelling.h"
+#include "util/helpers.h"
+#include "util/timer.h"
+#include "util/workload_manager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+
+namespace
+{
+
+struct af_shared_data
+{
+    warthog::label::af_labelling* lab_;
+    std::vector<uint32_t>* sources_;
+};
+
+}
+
+warthog::label::af_labelling::af_labelling(
+        warthog::graph::xy_graph* g, std::vector<uint32_t>* part)
+    : g_(g), part_(part)
+{
+    assert(part_->size() == g_->get_num_nodes());
+    uint32_t num_nodes = g_->get_num_nodes();
+    num_parts_ = 0;
+    for(uint32_t p : *part_) { num_parts_ = std::max(num_parts_, p+1); }
+    words_per_edge_ = (num_parts_ + 63) >> 6;
+
+    edge_begin_.resize(num_nodes+1, 0);
+    rev_begin_.resize(num_nodes+1, 0);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g_->get_node(i);
+        edge_begin_[i+1] = edge_begin_[i] + n->out_degree();
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            rev_begin_[it->node_id_+1]++;
+        }
+    }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        rev_begin_[i+1] += rev_begin_[i];
+    }
+
+    uint32_t num_edges = edge_begin_[num_nodes];
+    flags_.resize((size_t)num_edges * words_per_edge_, 0);
+    rev_tail_.resize(num_edges);
+    rev_edge_.resize(num_edges);
+
+    std::vector<uint32_t> fill(rev_begin_.begin(), rev_begin_.end()-1);
+    std::vector<bool> is_boundary(num_nodes, false);
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g_->get_node(i);
+        for(uint32_t idx = 0; idx < n->out_degree(); idx++)
+        {
+            uint32_t head = (n->outgoing_begin() + idx)->node_id_;
+            uint32_t pos = fill[head]++;
+            rev_tail_[pos] = i;
+            rev_edge_[pos] = edge_begin_[i] + idx;
+            if(part_->at(head) != part_->at(i)) { is_boundary[head] = true; }
+        }
+    }
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        if(is_boundary[i]) { boundary_.push_back(i); }
+    }
+
+    // FNV-1a
+    checksum_ = 0xcbf29ce484222325ull;
+    auto mix = [this](uint64_t value) -> void
+    {
+        for(uint32_t b = 0; b < 64; b += 8)
+        {
+            checksum_ ^= (value >> b) & 0xff;
+            checksum_ *= 0x100000001b3ull;
+        }
+    };
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g_->get_node(i);
+        mix(part_->at(i));
+        mix(n->out_degree());
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            // weights are doubles; hash their bits, not a truncated
+            // value, or a change of 1.2 to 1.7 would go unnoticed
+            uint64_t wt;
+            memcpy(&wt, &it->wt_, sizeof(wt));
+            mix(it->node_id_);
+            mix(wt);
+        }
+    }
+}
+
+warthog::label::af_labelling::~af_labelling()
+{ }
+
+void
+warthog::label::af_labelling::flag_shortest_paths(uint32_t source,
+        std::vector<warthog::cost_t>& dist, std::vector<uint32_t>& touched)
+{
+    typedef std::pair<warthog::cost_t, uint32_t> qentry;
+    std::priority_queue<qentry, std::vector<qentry>, std::greater<qentry>> open;
+
+    dist[source] = 0;
+    touched.push_back(source);
+    open.push(qentry(0, source));
+    while(!open.empty())
+    {
+        qentry top = open.top();
+        open.pop();
+        uint32_t v = top.second;
+        if(top.first > dist[v]) { continue; }
+
+        for(uint32_t a = rev_begin_[v]; a < rev_begin_[v+1]; a++)
+        {
+            uint32_t u = rev_tail_[a];
+            uint32_t idx = rev_edge_[a] - edge_begin_[u];
+            warthog::cost_t gval =
+                top.first + (g_->get_node(u)->outgoing_begin() + idx)->wt_;
+            if(gval < dist[u])
+            {
+                if(dist[u] == warthog::INF32) { touched.push_back(u); }
+                dist[u] = gval;
+                open.push(qentry(gval, u));
+            }
+        }
+    }
+
+    // flag every edge on every shortest path to source, not just the
+    // edges of one shortest path tree. otherwise ties can be broken
+    // differently than by other filters (e.g. bounding boxes) and
+    // combining the two may prune all optimal paths.
+    uint32_t part_id = part_->at(source);
+    for(uint32_t u : touched)
+    {
+        warthog::graph::node* n = g_->get_node(u);
+        for(uint32_t idx = 0; idx < n->out_degree(); idx++)
+        {
+            warthog::graph::edge* e = n->outgoing_begin() + idx;
+            if(dist[e->node_id_] != warthog::INF32 &&
+               dist[e->node_id_] + e->wt_ == dist[u])
+            {
+                set_flag(edge_begin_[u] + idx, part_id);
+            }
+        }
+    }
+
+    // reset the scratch space for the next search
+    for(uint32_t id : touched) { dist[id] = warthog::INF32; }
+    touched.clear();
+}
+
+void
+warthog::label::af_labelling::precompute(
+        warthog::util::workload_manager* cells)
+{
+    warthog::timer t;
+    t.start();
+
+    // clear the old flags of every cell in the workload and set the
+    // flags of edges which lie entirely inside their cell
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        warthog::graph::node* n = g_->get_node(i);
+        for(uint32_t idx = 0; idx < n->out_degree(); idx++)
+        {
+            uint32_t e = edge_begin_[i] + idx;
+            for(uint32_t p = 0; p < num_parts_; p++)
+            {
+                if(!cells->get_flag(p)) { continue; }
+                flags_[(size_t)e * words_per_edge_ + (p >> 6)] &=
+                    ~(1ull << (p & 63));
+            }
+
+            uint32_t head = (n->outgoing_begin() + idx)->node_id_;
+            uint32_t p = part_->at(i);
+            if(part_->at(head) == p && cells->get_flag(p))
+            {
+                set_flag(e, p);
+            }
+        }
+    }
+
+    std::vector<uint32_t> sources;
+    for(uint32_t id : boundary_)
+    {
+        if(cells->get_flag(part_->at(id))) { sources.push_back(id); }
+    }
+
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        af_shared_data* shared = (af_shared_data*) par->shared_;
+        warthog::label::af_labelling* lab = shared->lab_;
+
+        uint32_t num_nodes = lab->g_->get_num_nodes();
+        std::vector<warthog::cost_t> dist(num_nodes, warthog::INF32);
+        std::vector<uint32_t> touched;
+
+        // source nodes are evenly divided among all threads
+        std::vector<uint32_t>& sources = *shared->sources_;
+        for(size_t i = par->thread_id_; i < sources.size();
+                i += par->max_threads_)
+        {
+            lab->flag_shortest_paths(sources[i], dist, touched);
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    af_shared_data shared;
+    shared.lab_ = this;
+    shared.sources_ = &sources;
+
+    // workload flags past the last cell may be set too; count only cells
+    uint32_t num_cells = 0;
+    for(uint32_t p = 0; p < num_parts_; p++)
+    {
+        if(cells->get_flag(p)) { num_cells++; }
+    }
+    std::cerr << "computing arc flags for " << num_cells
+        << " of " << num_parts_ << " cells\n";
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, (uint32_t)sources.size());
+    t.stop();
+    std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+// arc flag files have a one-line text header followed by the raw flags
+std::ostream&
+warthog::label::operator<<(std::ostream& out, af_labelling& lab)
+{
+    out << "af " << lab.g_->get_num_nodes() << " "
+        << lab.edge_begin_.back() << " " << lab.num_parts_ << " "
+        << lab.checksum_ << "\n";
+    out.write((const char*)lab.flags_.data(),
+            (std::streamsize)(sizeof(uint64_t) * lab.flags_.size()));
+    if(!out.good())
+    {
+        std::cerr << "unexpected error while writing arc flags\n";
+    }
+    return out;
+}
+
+std::istream&
+warthog::label::operator>>(std::istream& in, af_labelling& lab)
+{
+    std::string magic;
+    uint32_t num_nodes, num_edges, num_parts;
+    uint64_t checksum;
+    in >> magic >> num_nodes >> num_edges >> num_parts >> checksum;
+    in.get(); // eat the newline
+    if(!in.good() || magic != "af" || num_nodes != lab.g_->get_num_nodes() ||
+       num_edges != lab.edge_begin_.back() || num_parts != lab.num_parts_ ||
+       checksum != lab.checksum_)
+    {
+        std::cerr << "err; arc flags do not match the graph or partition\n";
+        in.setstate(std::ios::failbit);
+        return in;
+    }
+    in.read((char*)lab.flags_.data(),
+            (std::streamsize)(sizeof(uint64_t) * lab.flags_.size()));
+    if(!in.good())
+    {
+        std::cerr << "unexpected error while reading arc flags\n";
+    }
+    return in;
+}
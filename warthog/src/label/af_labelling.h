@@ -0,0 +1,142 @@
+#ifndef WARTHOG_AF_LABELLING_H
+#define WARTHOG_AF_LABELLING_H
+
+// label/af_labelling.h
+//
+// Arc flags. The nodes of the graph are partitioned into cells
+// (e.g. by running METIS on the output of dimacs2metis). For every
+// outgoing edge of every node we store one bit per cell. The bit for
+// cell c is set if the edge appears on some shortest path that ends
+// at a node inside c.
+//
+// Flags are computed with one backward Dijkstra search from every
+// boundary node of every cell (i.e. every node with an incoming edge from
+// a different cell). Edges on any shortest path to a boundary node, and
+// every edge with both endpoints inside the cell, have their flag set.
+// The flags of a subset of cells can be recomputed without touching the
+// rest, but only when the partition of those cells changes. A cell's
+// flags come from searches over the whole graph, so a change to any arc
+// cost can change the flags of every cell; that needs a full recompute.
+//
+// For more details see:
+// [Hilger, Kohler, Mohring and Schilling.
+// Fast Point-to-Point Shortest Path Computations with Arc-Flags.
+// 9th DIMACS Implementation Challenge, 2006]
+//
+
+#include "xy_graph.h"
+#include "sys/forward.h"
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+class af_labelling
+{
+    friend std::ostream&
+    operator<<(std::ostream& out, af_labelling& lab);
+
+    friend std::istream&
+    operator>>(std::istream& in, af_labelling& lab);
+
+    public:
+        // @param g: the input graph
+        // @param part: the cell of every node in @param g
+        af_labelling(warthog::graph::xy_graph* g, std::vector<uint32_t>* part);
+        ~af_labelling();
+
+        inline warthog::graph::xy_graph*
+        get_graph() { return g_; }
+
+        inline uint32_t
+        get_num_parts() { return num_parts_; }
+
+        inline uint32_t
+        get_part(uint32_t node_id) { return part_->at(node_id); }
+
+        // @return true if the @param edge_idx-th outgoing edge of
+        // @param node_id has its flag set for cell @param part_id
+        inline bool
+        get_flag(uint32_t node_id, uint32_t edge_idx, uint32_t part_id)
+        {
+            uint64_t word = flags_[
+                (size_t)(edge_begin_[node_id] + edge_idx) * words_per_edge_ +
+                (part_id >> 6)];
+            return word & (1ull << (part_id & 63));
+        }
+
+        // (re)compute flags for every cell whose flag is set in
+        // @param cells. the workload is indexed by cell id. after arc
+        // costs change, every cell must be recomputed.
+        void
+        precompute(warthog::util::workload_manager* cells);
+
+        inline size_t
+        mem()
+        {
+            return sizeof(*this) +
+                sizeof(uint64_t) * flags_.size() +
+                sizeof(uint32_t) * (edge_begin_.size() + rev_begin_.size() +
+                    rev_tail_.size() + rev_edge_.size());
+        }
+
+    private:
+        warthog::graph::xy_graph* g_;
+        std::vector<uint32_t>* part_;
+        uint32_t num_parts_;
+        uint32_t words_per_edge_;
+
+        // a hash of every edge (head and weight) and of the partition.
+        // it is written to the file header, so that flags computed for
+        // other weights or another partition are not loaded by mistake
+        uint64_t checksum_;
+
+        // global index of the first outgoing edge of every node
+        std::vector<uint32_t> edge_begin_;
+        std::vector<uint64_t> flags_;
+
+        // incoming edges, for the backward searches. rev_edge_ is
+        // the global index of the corresponding outgoing edge.
+        std::vector<uint32_t> rev_begin_;
+        std::vector<uint32_t> rev_tail_;
+        std::vector<uint32_t> rev_edge_;
+
+        // nodes with an incoming edge from another cell
+        std::vector<uint32_t> boundary_;
+
+        inline void
+        set_flag(uint32_t edge_id, uint32_t part_id)
+        {
+            uint64_t* word = &flags_[(size_t)edge_id * words_per_edge_ +
+                (part_id >> 6)];
+            __atomic_fetch_or(word, (1ull << (part_id & 63)),
+                    __ATOMIC_RELAXED);
+        }
+
+        // backward Dijkstra from @param source; flags every edge which
+        // appears on a shortest path to the source. @param dist and
+        // @param touched are scratch space for the calling thread.
+        void
+        flag_shortest_paths(uint32_t source,
+                std::vector<warthog::cost_t>& dist,
+                std::vector<uint32_t>& touched);
+};
+
+std::ostream&
+operator<<(std::ostream& out, af_labelling& lab);
+
+std::istream&
+operator>>(std::istream& in, af_labelling& lab);
+
+}
+
+}
+
+#endif
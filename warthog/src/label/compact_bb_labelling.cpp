@@ -0,0 +1,168 @@
+#include "compact_bb_labelling.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace
+{
+
+const uint32_t CBB_MAGIC = 0x32424243; // "CBB2"
+const uint32_t CBB_MAX_CELL = UINT16_MAX;
+
+struct cbb_header
+{
+    uint32_t magic_;
+    uint32_t num_nodes_;
+    uint32_t num_labels_;
+    int32_t origin_x_;
+    int32_t origin_y_;
+    uint32_t shift_;
+
+    // size and modification time (in nanoseconds) of the file the
+    // labels were compressed from; zero if unknown
+    uint64_t source_size_;
+    int64_t source_mtime_;
+};
+
+// @return false if @param filename cannot be read
+bool
+file_stamp(const char* filename, uint64_t& size, int64_t& mtime)
+{
+    struct stat st;
+    if(filename == 0 || stat(filename, &st) != 0) { return false; }
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+}
+
+warthog::label::compact_bb_labelling::compact_bb_labelling(
+        warthog::graph::xy_graph* g)
+    : g_(g), num_labels_(0), begin_(0), rect_(0)
+{
+    int32_t min_x = INT32_MAX, min_y = INT32_MAX;
+    int32_t max_x = INT32_MIN, max_y = INT32_MIN;
+    for(uint32_t i = 0; i < g_->get_num_nodes(); i++)
+    {
+        int32_t x, y;
+        g_->get_xy(i, x, y);
+        min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+    }
+    if(g_->get_num_nodes() == 0) { min_x = max_x = min_y = max_y = 0; }
+
+    // the last cell index is reserved, so that empty labels can be
+    // represented by an inverted rectangle
+    origin_x_ = min_x;
+    origin_y_ = min_y;
+    int64_t extent = std::max((int64_t)max_x - min_x, (int64_t)max_y - min_y);
+    shift_ = 0;
+    while((extent >> shift_) >= CBB_MAX_CELL) { shift_++; }
+}
+
+warthog::label::compact_bb_labelling::~compact_bb_labelling()
+{ }
+
+warthog::label::compact_rect
+warthog::label::compact_bb_labelling::quantise(
+        const warthog::geom::rectangle& r)
+{
+    compact_rect c;
+    if(r.x1 > r.x2 || r.y1 > r.y2)
+    {
+        c.x1 = c.y1 = CBB_MAX_CELL;
+        c.x2 = c.y2 = 0;
+        return c;
+    }
+
+    // both corners round down to the cell which contains them; points
+    // outside the map are clamped outward
+    int64_t lo_x = ((int64_t)r.x1 - origin_x_);
+    int64_t lo_y = ((int64_t)r.y1 - origin_y_);
+    int64_t hi_x = ((int64_t)r.x2 - origin_x_);
+    int64_t hi_y = ((int64_t)r.y2 - origin_y_);
+    c.x1 = (uint16_t)(lo_x < 0 ? 0 :
+            std::min<int64_t>(lo_x >> shift_, CBB_MAX_CELL));
+    c.y1 = (uint16_t)(lo_y < 0 ? 0 :
+            std::min<int64_t>(lo_y >> shift_, CBB_MAX_CELL));
+    c.x2 = (uint16_t)(hi_x < 0 ? 0 :
+            std::min<int64_t>(hi_x >> shift_, CBB_MAX_CELL));
+    c.y2 = (uint16_t)(hi_y < 0 ? 0 :
+            std::min<int64_t>(hi_y >> shift_, CBB_MAX_CELL));
+    return c;
+}
+
+bool
+warthog::label::compact_bb_labelling::save(
+        const char* filename, const char* source)
+{
+    std::ofstream ofs(filename, std::ios_base::out|std::ios_base::binary);
+    if(!ofs.good()) { return false; }
+
+    cbb_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic_ = CBB_MAGIC;
+    hdr.num_nodes_ = g_->get_num_nodes();
+    hdr.num_labels_ = num_labels_;
+    hdr.origin_x_ = origin_x_;
+    hdr.origin_y_ = origin_y_;
+    hdr.shift_ = shift_;
+    file_stamp(source, hdr.source_size_, hdr.source_mtime_);
+    ofs.write((const char*)&hdr, sizeof(hdr));
+    ofs.write((const char*)begin_, sizeof(uint32_t) * (hdr.num_nodes_ + 1));
+    ofs.write((const char*)rect_, sizeof(compact_rect) * num_labels_);
+    return ofs.good();
+}
+
+bool
+warthog::label::compact_bb_labelling::load(
+        const char* filename, const char* source)
+{
+    if(!file_.open(filename)) { return false; }
+
+    cbb_header hdr;
+    if(file_.size() < sizeof(hdr)) { file_.close(); return false; }
+    memcpy(&hdr, file_.data(), sizeof(hdr));
+
+    uint32_t num_nodes = g_->get_num_nodes();
+    size_t expected = sizeof(hdr) + sizeof(uint32_t) * (num_nodes + 1) +
+        sizeof(compact_rect) * hdr.num_labels_;
+    if(hdr.magic_ != CBB_MAGIC || hdr.num_nodes_ != num_nodes ||
+       hdr.origin_x_ != origin_x_ || hdr.origin_y_ != origin_y_ ||
+       hdr.shift_ != shift_ || file_.size() != expected)
+    {
+        file_.close();
+        return false;
+    }
+
+    uint64_t size;
+    int64_t mtime;
+    if(file_stamp(source, size, mtime) &&
+       (size != hdr.source_size_ || mtime != hdr.source_mtime_))
+    {
+        std::cerr << "compact labels in " << filename
+            << " were not made from the current " << source
+            << "; rebuilding them\n";
+        file_.close();
+        return false;
+    }
+
+    const uint32_t* begin = (const uint32_t*)(file_.data() + sizeof(hdr));
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        if(begin[i+1] - begin[i] < g_->get_node(i)->out_degree())
+        {
+            file_.close();
+            return false;
+        }
+    }
+
+    num_labels_ = hdr.num_labels_;
+    begin_ = begin;
+    rect_ = (const compact_rect*)(begin_ + num_nodes + 1);
+    return true;
+}
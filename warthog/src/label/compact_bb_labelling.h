@@ -0,0 +1,147 @@
+#ifndef WARTHOG_COMPACT_BB_LABELLING_H
+#define WARTHOG_COMPACT_BB_LABELLING_H
+
+// label/compact_bb_labelling.h
+//
+// A compact store for rectangular geometric containers (i.e. the
+// bounding boxes of bb_labelling and dfs_labelling).
+//
+// All labels sit in one contiguous array, indexed by the CSR offset
+// of each edge (i.e. the index of the first outgoing edge of its tail
+// node plus the index of the edge in the list). Coordinates are stored
+// as 16-bit fixed-point values: the map is divided into square cells
+// of side 2^shift, measured from the bottom-left corner of the graph,
+// and each rectangle records the first and last cell it touches. The
+// shift is the smallest that makes every cell index fit in 16 bits.
+//
+// Rounding is conservative: every point inside the original rectangle
+// is in a cell covered by the compact one. The compact rectangle is
+// larger, so pruning is weaker, but never prunes an edge that the
+// original label would keep.
+//
+// Compact labels are saved as a flat binary file which is mapped into
+// memory when loaded. The file records the size and modification time
+// of the labels it was made from, so a cache whose source has changed
+// is not loaded.
+//
+
+#include "geom.h"
+#include "mapped_file.h"
+#include "xy_graph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+struct compact_rect
+{
+    uint16_t x1, y1, x2, y2;
+};
+
+class compact_bb_labelling
+{
+    public:
+        compact_bb_labelling(warthog::graph::xy_graph* g);
+        ~compact_bb_labelling();
+
+        // quantise the bounding box of every outgoing edge of every
+        // node in the graph. LABELLING is any type whose labels have a
+        // rectangle called bbox_ (e.g. bb_labelling or dfs_labelling)
+        template<class LABELLING>
+        void
+        compress(LABELLING* lab)
+        {
+            uint32_t num_nodes = g_->get_num_nodes();
+            v_begin_.assign(num_nodes+1, 0);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                v_begin_[i+1] = v_begin_[i] + g_->get_node(i)->out_degree();
+            }
+
+            v_rect_.resize(v_begin_[num_nodes]);
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                uint32_t degree = v_begin_[i+1] - v_begin_[i];
+                for(uint32_t idx = 0; idx < degree; idx++)
+                {
+                    v_rect_[v_begin_[i] + idx] =
+                        quantise(lab->get_label(i, idx).bbox_);
+                }
+            }
+            num_labels_ = (uint32_t)v_rect_.size();
+            begin_ = v_begin_.data();
+            rect_ = v_rect_.data();
+        }
+
+        // write compact labels to @param filename. @param source is
+        // the file the labels were compressed from (if any).
+        // @return true if successful, false otherwise.
+        bool
+        save(const char* filename, const char* source = 0);
+
+        // map the compact labels in @param filename into memory.
+        // fails if the file does not have a label for every outgoing
+        // edge of the graph, or if @param source exists and is not the
+        // file the labels were saved from (i.e. its size or modification
+        // time has changed).
+        // @return true if successful, false otherwise.
+        bool
+        load(const char* filename, const char* source = 0);
+
+        inline warthog::graph::xy_graph*
+        get_graph() { return g_; }
+
+        // convert the point (@param x, @param y) into cell coordinates
+        inline void
+        to_cell(int32_t x, int32_t y, uint32_t& cx, uint32_t& cy)
+        {
+            cx = (uint32_t)((int64_t)x - origin_x_) >> shift_;
+            cy = (uint32_t)((int64_t)y - origin_y_) >> shift_;
+        }
+
+        // @return true if the label of the @param edge_idx-th outgoing
+        // edge of @param node_id covers the cell (@param cx, @param cy)
+        inline bool
+        contains(uint32_t node_id, uint32_t edge_idx, uint32_t cx, uint32_t cy)
+        {
+            const compact_rect& r = rect_[begin_[node_id] + edge_idx];
+            return cx >= r.x1 && cx <= r.x2 && cy >= r.y1 && cy <= r.y2;
+        }
+
+        inline size_t
+        mem()
+        {
+            return sizeof(*this) +
+                sizeof(uint32_t) * (g_->get_num_nodes() + 1) +
+                sizeof(compact_rect) * num_labels_;
+        }
+
+    private:
+        warthog::graph::xy_graph* g_;
+        int32_t origin_x_, origin_y_;
+        uint32_t shift_;
+        uint32_t num_labels_;
+
+        // point into the vectors below (after compress) or into
+        // the mapped file (after load)
+        const uint32_t* begin_;
+        const compact_rect* rect_;
+
+        warthog::util::mapped_file file_;
+        std::vector<uint32_t> v_begin_;
+        std::vector<compact_rect> v_rect_;
+
+        compact_rect
+        quantise(const warthog::geom::rectangle& r);
+};
+
+}
+
+}
+
+#endif
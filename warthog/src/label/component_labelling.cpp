@@ -0,0 +1,224 @@
+#include "component_labelling.h"
+#include "gridmap.h"
+#include "helpers.h"
+#include "xy_graph.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+
+const uint32_t NONE = warthog::label::component_labelling::NONE;
+
+// union-find with path halving. every set is represented by its
+// smallest member.
+inline uint32_t
+uf_find(uint32_t* parent, uint32_t x)
+{
+    while(parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+inline void
+uf_union(uint32_t* parent, uint32_t a, uint32_t b)
+{
+    a = uf_find(parent, a);
+    b = uf_find(parent, b);
+    if(a < b) { parent[b] = a; }
+    else if(b < a) { parent[a] = b; }
+}
+
+struct stripe_shared_data
+{
+    warthog::gridmap* map_;
+    uint32_t* parent_;
+    uint32_t rows_per_stripe_;
+};
+
+}
+
+warthog::label::component_labelling::component_labelling(
+        warthog::gridmap* map)
+{
+    uint32_t width = map->width();
+    uint32_t height = map->height();
+    std::vector<uint32_t> parent(map->padded_mapsize(), NONE);
+
+    // phase 1: label each stripe independently. union-find trees never
+    // leave the stripe, so threads do not share any memory.
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        stripe_shared_data* shared = (stripe_shared_data*) par->shared_;
+        warthog::gridmap* map = shared->map_;
+        uint32_t* parent = shared->parent_;
+        uint32_t width = map->width();
+        uint32_t height = map->height();
+        uint32_t num_stripes =
+            (height + shared->rows_per_stripe_ - 1) / shared->rows_per_stripe_;
+
+        for(uint32_t s = par->thread_id_; s < num_stripes;
+                s += par->max_threads_)
+        {
+            uint32_t first_row = s * shared->rows_per_stripe_;
+            uint32_t last_row =
+                std::min(height, first_row + shared->rows_per_stripe_);
+            for(uint32_t y = first_row; y < last_row; y++)
+            {
+                for(uint32_t x = 0; x < width; x++)
+                {
+                    uint32_t id = y * width + x;
+                    if(!map->get_label(id)) { continue; }
+                    parent[id] = id;
+                    if(x > 0 && map->get_label(id - 1))
+                    { uf_union(parent, id - 1, id); }
+                    if(y > first_row && map->get_label(id - width))
+                    { uf_union(parent, id - width, id); }
+                }
+            }
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    stripe_shared_data shared;
+    shared.map_ = map;
+    shared.parent_ = parent.data();
+    shared.rows_per_stripe_ = 64;
+    uint32_t num_stripes =
+        (height + shared.rows_per_stripe_ - 1) / shared.rows_per_stripe_;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, num_stripes);
+
+    // phase 2: stitch each stripe to the one above it
+    for(uint32_t s = 1; s < num_stripes; s++)
+    {
+        uint32_t y = s * shared.rows_per_stripe_;
+        for(uint32_t x = 0; x < width; x++)
+        {
+            uint32_t id = y * width + x;
+            if(map->get_label(id) && map->get_label(id - width))
+            { uf_union(parent.data(), id - width, id); }
+        }
+    }
+
+    // phase 3: dense component ids
+    flatten(parent);
+}
+
+warthog::label::component_labelling::component_labelling(
+        warthog::graph::xy_graph* g)
+{
+    uint32_t num_nodes = g->get_num_nodes();
+    std::vector<uint32_t> parent(num_nodes);
+    for(uint32_t i = 0; i < num_nodes; i++) { parent[i] = i; }
+
+    for(uint32_t i = 0; i < num_nodes; i++)
+    {
+        warthog::graph::node* n = g->get_node(i);
+        for(warthog::graph::edge_iter it = n->outgoing_begin();
+                it != n->outgoing_end(); it++)
+        {
+            uf_union(parent.data(), i, it->node_id_);
+        }
+    }
+    flatten(parent);
+    compute_scc(g);
+}
+
+warthog::label::component_labelling::~component_labelling()
+{ }
+
+void
+warthog::label::component_labelling::flatten(std::vector<uint32_t>& parent)
+{
+    // every root is the smallest member of its set, so it is assigned
+    // an id before any other member is visited
+    num_components_ = 0;
+    comp_.assign(parent.size(), NONE);
+    for(uint32_t id = 0; id < parent.size(); id++)
+    {
+        if(parent[id] == NONE) { continue; }
+        uint32_t root = uf_find(parent.data(), id);
+        comp_[id] = (root == id) ? num_components_++ : comp_[root];
+    }
+}
+
+void
+warthog::label::component_labelling::compute_scc(
+        warthog::graph::xy_graph* g)
+{
+    uint32_t num_nodes = g->get_num_nodes();
+    std::vector<uint32_t> index(num_nodes, NONE);
+    std::vector<uint32_t> lowlink(num_nodes, 0);
+    std::vector<bool> on_stack(num_nodes, false);
+    std::vector<uint32_t> scc_stack;
+
+    // each frame is a node and the index of its next outgoing edge
+    std::vector<std::pair<uint32_t, uint32_t>> dfs;
+
+    scc_.assign(num_nodes, NONE);
+    uint32_t next_index = 0;
+    uint32_t next_scc = 0;
+    for(uint32_t root = 0; root < num_nodes; root++)
+    {
+        if(index[root] != NONE) { continue; }
+        dfs.push_back(std::pair<uint32_t, uint32_t>(root, 0));
+        index[root] = lowlink[root] = next_index++;
+        scc_stack.push_back(root);
+        on_stack[root] = true;
+
+        while(dfs.size())
+        {
+            uint32_t v = dfs.back().first;
+            uint32_t& edge_idx = dfs.back().second;
+            warthog::graph::node* n = g->get_node(v);
+            if(edge_idx < n->out_degree())
+            {
+                uint32_t w = (n->outgoing_begin() + edge_idx)->node_id_;
+                edge_idx++;
+                if(index[w] == NONE)
+                {
+                    index[w] = lowlink[w] = next_index++;
+                    scc_stack.push_back(w);
+                    on_stack[w] = true;
+                    dfs.push_back(std::pair<uint32_t, uint32_t>(w, 0));
+                }
+                else if(on_stack[w])
+                {
+                    lowlink[v] = std::min(lowlink[v], index[w]);
+                }
+                continue;
+            }
+
+            // all successors visited; v closes an SCC if it is the root
+            if(lowlink[v] == index[v])
+            {
+                uint32_t w;
+                do
+                {
+                    w = scc_stack.back();
+                    scc_stack.pop_back();
+                    on_stack[w] = false;
+                    scc_[w] = next_scc;
+                } while(w != v);
+                next_scc++;
+            }
+            dfs.pop_back();
+            if(dfs.size())
+            {
+                uint32_t u = dfs.back().first;
+                lowlink[u] = std::min(lowlink[u], lowlink[v]);
+            }
+        }
+    }
+    std::cerr << "component labelling: " << num_components_
+        << " weak components; " << next_scc << " strong components\n";
+}
@@ -0,0 +1,97 @@
+#ifndef WARTHOG_COMPONENT_LABELLING_H
+#define WARTHOG_COMPONENT_LABELLING_H
+
+// label/component_labelling.h
+//
+// Labels every node with the id of its connected component, so that
+// queries between disconnected nodes can be rejected in constant time,
+// before any search effort is spent.
+//
+// Grids are undirected: two traversable tiles are in the same component
+// if they are linked by a sequence of cardinal moves (diagonal moves do
+// not cut corners, so they never connect anything that cardinal moves
+// do not). The map is split into horizontal stripes which are labelled
+// in parallel with union-find; the stripes are then stitched together.
+// Labels are indexed by padded id (i.e. the internal ids of the grid
+// expansion policies).
+//
+// Graphs are directed. Here we store the weakly connected component of
+// each node and its strongly connected component (SCC). SCC ids are
+// assigned in reverse topological order, so a path from s to t can
+// only exist if the SCC id of s is at least the SCC id of t.
+//
+
+#include "sys/forward.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+class component_labelling
+{
+    public:
+        // label the traversable tiles of @param map
+        component_labelling(warthog::gridmap* map);
+
+        // label the nodes of @param g
+        component_labelling(warthog::graph::xy_graph* g);
+
+        ~component_labelling();
+
+        // @return true if there is certainly no path from @param from
+        // to @param to. Ids which are out of range, or which refer to
+        // untraversable tiles, are never rejected (they are left for the
+        // search to handle).
+        inline bool
+        unreachable(uint32_t from, uint32_t to)
+        {
+            if(from >= comp_.size() || to >= comp_.size()) { return false; }
+            uint32_t cf = comp_[from];
+            uint32_t ct = comp_[to];
+            if(cf == NONE || ct == NONE) { return false; }
+            if(cf != ct) { return true; }
+            return scc_.size() && scc_[from] < scc_[to];
+        }
+
+        // @return the id of the (weakly) connected component containing
+        // @param id
+        inline uint32_t
+        get_component(uint32_t id) { return comp_.at(id); }
+
+        inline uint32_t
+        get_num_components() { return num_components_; }
+
+        inline size_t
+        mem()
+        {
+            return sizeof(*this) +
+                sizeof(uint32_t) * (comp_.capacity() + scc_.capacity());
+        }
+
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+    private:
+        uint32_t num_components_;
+        std::vector<uint32_t> comp_;
+        std::vector<uint32_t> scc_;
+
+        // replace union-find pointers with dense component ids
+        void
+        flatten(std::vector<uint32_t>& parent);
+
+        // iterative version of Tarjan's algorithm
+        void
+        compute_scc(warthog::graph::xy_graph* g);
+};
+
+}
+
+}
+
+#endif
@@ -353,15 +353,30 @@ warthog::label::operator<<(std::ostream& out, warthog::label::dfs_label& label)
 std::istream&
 warthog::label::operator>>(std::istream& in, warthog::label::dfs_labelling& lab)
 {
-    //warthog::ch::ch_data* chd = lab.get_ch_data();
-    for(uint32_t n_id = 0; n_id < lab.g_->get_num_nodes(); n_id++)
+    // labels are binary, so any of them may start with the terminator
+    // character ';'. read the number of labels each node should have
+    // instead: one per outgoing edge of the UP_DOWN hierarchy the labels
+    // were computed on. an UP_ONLY hierarchy keeps the down edges of a
+    // node as incoming edges of their heads, so count those too
+    uint32_t num_nodes = lab.g_->get_num_nodes();
+    std::vector<uint32_t> num_labels(num_nodes);
+    for(uint32_t n_id = 0; n_id < num_nodes; n_id++)
     {
+        num_labels[n_id] += lab.g_->get_node(n_id)->out_degree();
+        if(lab.chd_->type_ != warthog::ch::UP_ONLY) { continue; }
+
         warthog::graph::node* n = lab.g_->get_node(n_id);
-        warthog::graph::edge_iter begin = n->outgoing_begin();
-        //warthog::graph::edge_iter end = n->outgoing_end();
-        for(    warthog::graph::edge_iter it = begin;
-                in.peek() != ';';
-                it++)
+        for(warthog::graph::edge_iter it = n->incoming_begin();
+                it != n->incoming_end(); it++)
+        {
+            num_labels.at(it->node_id_)++;
+        }
+    }
+
+    for(uint32_t n_id = 0; n_id < num_nodes; n_id++)
+    {
+        lab.lab_->at(n_id).clear();
+        for(uint32_t idx = 0; idx < num_labels[n_id]; idx++)
         {
             dfs_label bbox;
             in >> bbox;
@@ -372,11 +387,20 @@ warthog::label::operator>>(std::istream& in, warthog::label::dfs_labelling& lab)
                 std::cerr << "unexpected error while reading labels\n";
                 std::cerr
                     << "[debug info] node: " << n_id
-                    << " out-edge-index: " << (it - begin) << "\n";
+                    << " out-edge-index: " << idx << "\n";
                 return in;
             }
         }
-        in.get(); // eat the terminator character ';'
+
+        // eat the terminator character ';'
+        if(in.get() != ';')
+        {
+            std::cerr << "unexpected error while reading labels\n";
+            std::cerr << "[debug info] node: " << n_id
+                << " expected " << num_labels[n_id] << " labels\n";
+            in.setstate(std::ios::failbit);
+            return in;
+        }
     }
     return in;
 }
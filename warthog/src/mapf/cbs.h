@@ -14,6 +14,7 @@
 #include "pqueue.h"
 #include "reservation_table.h"
 #include "search_node.h"
+#include "sparse_reservation_table.h"
 
 namespace warthog
 {
@@ -56,13 +57,17 @@ struct cbs_constraint
 // 2. larger g-value and !is_reserved, then
 // 3. !is_reserved, then
 // 4. larger g-value
-class cmp_cbs_ll_lessthan
+//
+// RESERVATION_TABLE is either the dense reservation_table or the
+// sparse_reservation_table.
+template<class RESERVATION_TABLE>
+class cmp_cbs_ll_lessthan_base
 {
     public:
-        cmp_cbs_ll_lessthan(warthog::reservation_table* restab)
+        cmp_cbs_ll_lessthan_base(RESERVATION_TABLE* restab)
             : restab_(restab)
         { 
-            is_reserved_fn_ = &cmp_cbs_ll_lessthan::__is_reserved;
+            is_reserved_fn_ = &cmp_cbs_ll_lessthan_base::__is_reserved;
         }
 
         bool
@@ -121,9 +126,9 @@ class cmp_cbs_ll_lessthan
         }
     
     private:
-        typedef bool(cmp_cbs_ll_lessthan::*fn_is_reserved)(warthog::sn_id_t time_indexed_id);
+        typedef bool(cmp_cbs_ll_lessthan_base::*fn_is_reserved)(warthog::sn_id_t time_indexed_id);
 
-        warthog::reservation_table* restab_;
+        RESERVATION_TABLE* restab_;
         fn_is_reserved  is_reserved_fn_;
 
         bool
@@ -136,7 +141,13 @@ class cmp_cbs_ll_lessthan
         }
 };
 
+typedef cmp_cbs_ll_lessthan_base<warthog::reservation_table>
+    cmp_cbs_ll_lessthan;
+typedef cmp_cbs_ll_lessthan_base<warthog::sparse_reservation_table>
+    cmp_cbs_ll_sparse_lessthan;
+
 typedef pqueue<cmp_cbs_ll_lessthan> pqueue_cbs_ll;
+typedef pqueue<cmp_cbs_ll_sparse_lessthan> pqueue_cbs_ll_sparse;
 
 }
 
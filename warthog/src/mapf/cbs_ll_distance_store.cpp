@@ -0,0 +1,146 @@
+#include "cbs_ll_distance_store.h"
+#include "helpers.h"
+
+warthog::cbs_ll_distance_store::cbs_ll_distance_store(
+        warthog::gridmap* map, uint32_t max_tables)
+    : map_(map), max_tables_(max_tables == 0 ? 1 : max_tables),
+      num_computed_(0)
+{ }
+
+warthog::cbs_ll_distance_store::~cbs_ll_distance_store()
+{ }
+
+warthog::cbs_ll_distance_store::table_ptr
+warthog::cbs_ll_distance_store::get(uint32_t target_id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true)
+    {
+        auto it = tables_.find(target_id);
+        if(it == tables_.end()) { break; }
+        if(it->second.table_)
+        {
+            lru_.splice(lru_.begin(), lru_, it->second.lru_pos_);
+            return it->second.table_;
+        }
+
+        // another thread is computing this table
+        cv_.wait(lock);
+    }
+
+    // claim the target, then compute its table without holding the lock
+    tables_[target_id].table_ = 0;
+    num_computed_++;
+    lock.unlock();
+
+    std::shared_ptr<std::vector<uint16_t>> table;
+    try
+    {
+        table.reset(new std::vector<uint16_t>());
+        bfs(target_id, *table);
+    }
+    catch(...)
+    {
+        // release the claim so that waiting threads do not block forever;
+        // one of them will try again
+        lock.lock();
+        tables_.erase(target_id);
+        cv_.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    entry& e = tables_[target_id];
+    e.table_ = table;
+    lru_.push_front(target_id);
+    e.lru_pos_ = lru_.begin();
+    while(lru_.size() > max_tables_)
+    {
+        tables_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    cv_.notify_all();
+    return table;
+}
+
+void
+warthog::cbs_ll_distance_store::bfs(
+        uint32_t target_id, std::vector<uint16_t>& dist)
+{
+    uint32_t mapw = map_->width();
+    dist.assign((size_t)mapw * map_->height(), UNREACHABLE);
+    if(target_id >= map_->header_width() * map_->header_height()) { return; }
+    uint32_t padded_id = map_->to_padded_id(target_id);
+    if(!map_->get_label(padded_id)) { return; }
+
+    // the padding around the map is never traversable, so neighbours
+    // need no bounds checks
+    std::vector<uint32_t> queue;
+    queue.reserve(1024);
+    queue.push_back(padded_id);
+    dist[padded_id] = 0;
+    for(size_t head = 0; head < queue.size(); head++)
+    {
+        uint32_t id = queue[head];
+        uint16_t d = dist[id] == MAX_DISTANCE ? MAX_DISTANCE : dist[id] + 1;
+        uint32_t neis[4] = { id - mapw, id + mapw, id + 1, id - 1 };
+        for(uint32_t nei : neis)
+        {
+            if(dist[nei] != UNREACHABLE || !map_->get_label(nei)) { continue; }
+            dist[nei] = d;
+            queue.push_back(nei);
+        }
+    }
+}
+
+void
+warthog::cbs_ll_distance_store::precompute(
+        const std::vector<uint32_t>& targets)
+{
+    struct shared_data
+    {
+        warthog::cbs_ll_distance_store* store_;
+        const std::vector<uint32_t>* targets_;
+        uint32_t num_targets_;
+    };
+
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        shared_data* shared = (shared_data*) par->shared_;
+        const std::vector<uint32_t>& targets = *shared->targets_;
+        for(uint32_t i = par->thread_id_; i < shared->num_targets_;
+                i += par->max_threads_)
+        {
+            shared->store_->get(targets[i]);
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    shared_data shared;
+    shared.store_ = this;
+    shared.targets_ = &targets;
+    shared.num_targets_ =
+        (uint32_t)std::min<size_t>(targets.size(), max_tables_);
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, shared.num_targets_);
+}
+
+size_t
+warthog::cbs_ll_distance_store::mem()
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t sz = sizeof(*this);
+    for(auto& it : tables_)
+    {
+        sz += sizeof(it) + sizeof(uint32_t);
+        if(it.second.table_)
+        {
+            sz += sizeof(uint16_t) * it.second.table_->capacity();
+        }
+    }
+    return sz;
+}
@@ -0,0 +1,105 @@
+#ifndef WARTHOG_CBS_LL_DISTANCE_STORE_H
+#define WARTHOG_CBS_LL_DISTANCE_STORE_H
+
+// mapf/cbs_ll_distance_store.h
+//
+// Exact distances on a 4-connected uniform-cost grid, from every cell to
+// a set of targets. These are the values of cbs_ll_heuristic.
+//
+// Each target has one table with a 16-bit distance per padded cell,
+// computed by breadth-first search the first time the target is
+// requested. Distances which do not fit are capped (which keeps them
+// admissible) and unreachable cells are UNREACHABLE.
+//
+// The store can be shared by the low-level searches of several threads.
+// Tables are immutable once computed and are handed out as shared
+// pointers. Different targets are computed concurrently by the threads
+// which request them; a thread requesting a table that is being
+// computed waits for it. The number of resident tables can be bounded:
+// when the bound is exceeded, the least recently requested table is
+// dropped from the store (its memory is released once no heuristic is
+// using it) and recomputed if it is requested again.
+//
+
+#include "gridmap.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace warthog
+{
+
+class cbs_ll_distance_store
+{
+    public:
+        typedef std::shared_ptr<const std::vector<uint16_t>> table_ptr;
+
+        static constexpr uint16_t UNREACHABLE = UINT16_MAX;
+        static constexpr uint16_t MAX_DISTANCE = UINT16_MAX - 1;
+
+        // keep at most @param max_tables tables in the store
+        cbs_ll_distance_store(warthog::gridmap* map,
+                uint32_t max_tables = UINT32_MAX);
+        ~cbs_ll_distance_store();
+
+        // @return the distance table of @param target_id (an unpadded
+        // id). tables are indexed by padded id.
+        table_ptr
+        get(uint32_t target_id);
+
+        // compute the tables of @param targets (unpadded ids), in
+        // parallel. only the first max_tables targets are computed.
+        void
+        precompute(const std::vector<uint32_t>& targets);
+
+        inline uint32_t
+        get_num_tables()
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return (uint32_t)lru_.size();
+        }
+
+        // number of breadth-first searches so far (more than the number
+        // of targets if tables were dropped and recomputed)
+        inline uint64_t
+        get_num_computed()
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return num_computed_;
+        }
+
+        size_t
+        mem();
+
+    private:
+        struct entry
+        {
+            table_ptr table_;
+            std::list<uint32_t>::iterator lru_pos_;
+        };
+
+        warthog::gridmap* map_;
+        uint32_t max_tables_;
+        uint64_t num_computed_;
+
+        // tables being computed have an entry with a null table_ and
+        // are not in lru_. the most recently requested table is at the
+        // front of lru_.
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::unordered_map<uint32_t, entry> tables_;
+        std::list<uint32_t> lru_;
+
+        void
+        bfs(uint32_t target_id, std::vector<uint16_t>& dist);
+};
+
+}
+
+#endif
+
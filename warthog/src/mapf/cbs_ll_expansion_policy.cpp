@@ -11,7 +11,7 @@ using namespace warthog::cbs;
 
 warthog::cbs_ll_expansion_policy::cbs_ll_expansion_policy(
 		warthog::gridmap* map, warthog::cbs_ll_heuristic* h) 
-    : map_(map), h_(h)
+    : map_(map), h_(h), restab_(0), start_time_(0), stay_at_target_(false)
 {
     neis_ = new warthog::arraylist<neighbour_record>(32);
 
@@ -21,24 +21,14 @@ warthog::cbs_ll_expansion_policy::cbs_ll_expansion_policy(
     cons_ = new warthog::mapf::time_constraints<warthog::cbs::cbs_constraint>
                 (map_xy_sz_);
 
-    // preallocate memory for up to some number of timesteps 
-    // in advance. for subsequent timesteps memory is allocated
-    // dynamically
-    time_map_ = new std::vector<warthog::mem::node_pool*>();
-    for(uint32_t i = 0; i < 128; i++)
-    {
-        time_map_->push_back(new warthog::mem::node_pool(map_xy_sz_));
-    }
+    // nodes are hashed by (timestep, xy) so memory grows with the
+    // number of nodes generated per search, not with the horizon
+    nodes_ = new warthog::mem::node_table();
 }
 
 warthog::cbs_ll_expansion_policy::~cbs_ll_expansion_policy()
 {
-    for(uint32_t i = 0; i < time_map_->size(); i++)
-    {
-        delete time_map_->at(i);
-    }
-    time_map_->clear();
-    delete time_map_;
+    delete nodes_;
     delete cons_;
     delete neis_;
 }
@@ -70,7 +60,8 @@ warthog::cbs_ll_expansion_policy::expand(warthog::search_node* current,
     cbs_constraint* succ_cc = cons_->get_constraint(nid_m_w, timestep+1);
     if( ((tiles & 514) == 514) && // NORTH is not an obstacle
         (!cur_cc || !(cur_cc->e_ & warthog::grid::NORTH)) &&  // no edge constraint
-        (!succ_cc || !succ_cc->v_) )  // no vertex constraint
+        (!succ_cc || !succ_cc->v_) &&  // no vertex constraint
+        !is_reserved_move(nodeid, nid_m_w, timestep) )
 	{  
 		add_neighbour(__generate(nid_m_w, timestep+1), 1);
 	} 
@@ -78,7 +69,8 @@ warthog::cbs_ll_expansion_policy::expand(warthog::search_node* current,
     succ_cc = cons_->get_constraint(nodeid + 1, timestep+1);
 	if( ((tiles & 1536) == 1536) && // E
         (!cur_cc || !(cur_cc->e_ & warthog::grid::EAST)) &&
-        (!succ_cc || !succ_cc->v_ ) )
+        (!succ_cc || !succ_cc->v_ ) &&
+        !is_reserved_move(nodeid, nodeid + 1, timestep) )
 	{
 		add_neighbour(__generate(nodeid + 1, timestep+1), 1);
 	}
@@ -86,7 +78,8 @@ warthog::cbs_ll_expansion_policy::expand(warthog::search_node* current,
     succ_cc = cons_->get_constraint(nid_p_w, timestep+1);
 	if( ((tiles & 131584) == 131584) && // S
         (!cur_cc || !(cur_cc->e_ & warthog::grid::SOUTH)) && 
-        (!succ_cc || !succ_cc->v_) )
+        (!succ_cc || !succ_cc->v_) &&
+        !is_reserved_move(nodeid, nid_p_w, timestep) )
 	{ 
 
 		add_neighbour(__generate(nid_p_w, timestep+1), 1);
@@ -95,15 +88,17 @@ warthog::cbs_ll_expansion_policy::expand(warthog::search_node* current,
     succ_cc = cons_->get_constraint(nodeid - 1, timestep+1);
 	if( ((tiles & 768) == 768) && // W
         (!cur_cc || !(cur_cc->e_ & warthog::grid::WEST)) && 
-        (!succ_cc || !succ_cc->v_) )
+        (!succ_cc || !succ_cc->v_) &&
+        !is_reserved_move(nodeid, nodeid - 1, timestep) )
 	{ 
 		add_neighbour(__generate(nodeid - 1, timestep+1), 1);
 	}
 
     // wait successor
     succ_cc = cons_->get_constraint(nodeid, timestep+1);
-    if( (!cur_cc || !(cur_cc->e_ & warthog::grid::WEST)) && 
-        (!succ_cc || !succ_cc->v_) )
+    if( (!cur_cc || !(cur_cc->e_ & (1 << warthog::cbs::WAIT))) && 
+        (!succ_cc || !succ_cc->v_) &&
+        !is_reserved_move(nodeid, nodeid, timestep) )
     {
         add_neighbour(__generate(nodeid, timestep+1), 1);
     }
@@ -123,6 +118,9 @@ warthog::cbs_ll_expansion_policy::generate_start_node(
     if(pi->start_id_ >= max_id) { return 0; }
     uint32_t padded_id = map_->to_padded_id((uint32_t)pi->start_id_);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    // a new search begins; nodes from the previous one are discarded
+    nodes_->clear();
     return __generate(padded_id, 0);
 }
 
@@ -145,11 +143,7 @@ size_t
 warthog::cbs_ll_expansion_policy::mem()
 {
    size_t total = sizeof(*this) + map_->mem();
-   size_t tm_sz = time_map_->size();
-   for(uint32_t i = 0; i < tm_sz; i++)
-   {
-       total += time_map_->at(i)->mem();
-   }
+   total += nodes_->mem();
    total += sizeof(neighbour_record) * neis_->capacity();
    return total;
 }
@@ -12,6 +12,11 @@
 // location to an adjacent grid location. Each action (including wait)
 // advances time by one time-step.
 //
+// Moves can be forbidden by CBS constraints (see ::add_constraint) and,
+// optionally, by the paths in a sparse_reservation_table: a move is
+// then pruned if it ends on a reserved cell or if it swaps places with
+// a reserved move.
+//
 // @author: dharabor
 // @created: 2018-11-01
 //
@@ -19,7 +24,9 @@
 #include "expansion_policy.h"
 #include "forward.h"
 #include "gridmap.h"
+#include "node_table.h"
 #include "search_node.h"
+#include "sparse_reservation_table.h"
 #include "time_constraints.h"
 
 #include <memory>
@@ -103,6 +110,17 @@ class cbs_ll_expansion_policy
             uint32_t xy_id = (uint32_t)(n->get_id() & UINT32_MAX);
             if(xy_id != (uint32_t)pi->target_id_) { return false; }
 
+            if(stay_at_target_ && restab_)
+            {
+                uint32_t arrival_time = 
+                    (uint32_t)(n->get_id() >> 32) + start_time_;
+                for(uint32_t t = arrival_time + 1; 
+                        t < restab_->get_end_timestep(); t++)
+                {
+                    if(restab_->is_reserved(xy_id, t)) { return false; }
+                }
+            }
+
             // ENABLE THIS CODE FOR MAPF TARGET CONDITION
             //uint32_t arrival_time = (uint32_t)(n->get_id() >> 32);
             //std::vector<warthog::cbs::cbs_constraint>& xy_cons = 
@@ -157,6 +175,28 @@ class cbs_ll_expansion_policy
         warthog::mapf::time_constraints<warthog::cbs::cbs_constraint>*
         get_time_constraints() { return cons_; }
 
+        // prune moves which collide with the reservations in
+        // @param restab (or with nothing, if @param restab is null).
+        // timestep 0 of the search is timestep @param start_time of
+        // the reservation table.
+        inline void
+        set_reservation_table(warthog::sparse_reservation_table* restab,
+                uint32_t start_time = 0)
+        { 
+            restab_ = restab; 
+            start_time_ = start_time;
+        }
+
+        // by default agents disappear once they reach their target.
+        // if @param stay is true, agents stay at their target instead:
+        // an arrival only counts if the target is not reserved at any
+        // later time.
+        inline void
+        set_stay_at_target(bool stay) { stay_at_target_ = stay; }
+
+        inline warthog::sparse_reservation_table*
+        get_reservation_table() { return restab_; }
+
 		size_t 
         mem();
 
@@ -164,10 +204,13 @@ class cbs_ll_expansion_policy
 	private:
 		warthog::gridmap* map_;
         uint32_t map_xy_sz_;
-        std::vector<warthog::mem::node_pool*>* time_map_;
+        warthog::mem::node_table* nodes_;
         warthog::cbs_ll_heuristic* h_;
 
         warthog::mapf::time_constraints<warthog::cbs::cbs_constraint>* cons_;
+        warthog::sparse_reservation_table* restab_;
+        uint32_t start_time_;
+        bool stay_at_target_;
 
         struct neighbour_record
         {
@@ -186,19 +229,23 @@ class cbs_ll_expansion_policy
         inline warthog::search_node* 
         __generate(uint32_t xy_id, uint32_t timestep)
         {
-            while(timestep >= time_map_->size())
-            {
-                time_map_->push_back(
-                            new warthog::mem::node_pool(
-                                map_->height() * map_->width()));
-            }
-            warthog::search_node* nei = time_map_->at(timestep)->generate(xy_id);
             warthog::sn_id_t node_id = ((uint64_t)timestep << 32) | xy_id;
-            nei->set_id(node_id);
-            return nei;
+            return nodes_->generate(node_id);
         }
 
 
+        // true if moving from @param from_xy_id at @param timestep to
+        // @param to_xy_id collides with a reservation
+        inline bool
+        is_reserved_move(uint32_t from_xy_id, uint32_t to_xy_id,
+                uint32_t timestep)
+        {
+            if(!restab_) { return false; }
+            timestep += start_time_;
+            return restab_->is_reserved(to_xy_id, timestep+1) ||
+                   restab_->is_edge_reserved(to_xy_id, from_xy_id, timestep);
+        }
+
         inline void 
         add_neighbour(warthog::search_node* nei, double cost)
         {
@@ -4,8 +4,9 @@
 // mapf/cbs_ll_heuristic.h
 //
 // The low-level (i.e. single-agent) heuristic function used in 
-// Conflict-based Search. Pre-computes all distances, from every 
-// target node to every other node in the input graph. 
+// Conflict-based Search. Looks up exact distances, from every 
+// target node to every other node in the input graph, in a
+// cbs_ll_distance_store.
 //
 // This implementation assumes the input graph is a 4-connected 
 // uniform-cost grid. 
@@ -18,10 +19,9 @@
 // @created: 2018-11-04
 //
 
-#include "forward.h"
+#include "cbs_ll_distance_store.h"
+#include "constants.h"
 #include "gridmap.h"
-#include "pqueue.h"
-#include <unordered_map>
 
 namespace warthog
 {
@@ -29,8 +29,13 @@ namespace warthog
 class cbs_ll_heuristic
 {
     public:
+        // distances are computed by a private distance store
         cbs_ll_heuristic(warthog::gridmap* gm);
 
+        // distances come from @param store, which may be shared with
+        // other heuristics (including those of other threads)
+        cbs_ll_heuristic(warthog::cbs_ll_distance_store* store);
+
         ~cbs_ll_heuristic();
 
         // estimate the cost-to-go of a path that begins at 
@@ -39,74 +44,39 @@ class cbs_ll_heuristic
         inline warthog::cost_t
         h(warthog::sn_id_t p_from_id, warthog::sn_id_t p_to_id)
         {
-            return h_[t_index_][(uint32_t)p_from_id];
+            uint16_t d = table_[(uint32_t)p_from_id];
+            if(d == warthog::cbs_ll_distance_store::UNREACHABLE)
+            { return warthog::INF32; }
+            return d;
         }
 
-        // The current target specifies which set of g-values to
+        // The current target specifies which set of distances to
         // refer to when answering ::h queries
         // 
-        // If the target hasn't been seen before, we run a Dijkstra grid 
-        // search (not time expanded!) using @param target_id as the  source
-        // 
-        // We store g-values from @param target_id to every node in the grid.
-        // These precomputed g-values are a lower-bound on the
-        // distance from any location@time to each target.
+        // If the target hasn't been seen before, the distance store runs
+        // a breadth-first search (not time expanded!) from 
+        // @param target_id over the grid. These distances are a 
+        // lower-bound on the distance from any location@time to 
+        // each target.
         //
         // @param target_id: unpadded xy index specifying the current target
-        // 
-        // NB: @param target_nodes must comprise UNPADDED IDENTIFIERS
         void
         set_current_target(warthog::sn_id_t target_id);
 
+        inline warthog::cbs_ll_distance_store*
+        get_store() { return store_; }
+
+        // memory of the distance store is counted only if it is private
         size_t
         mem();
 
     private:
+        warthog::cbs_ll_distance_store* store_;
+        bool own_store_;
 
-        // callback listener used to construct a perfect 2D heuristic
-        struct listener
-        {
-            listener(cbs_ll_heuristic* ptr)
-            { this->ptr = ptr; }
-
-            inline void
-            generate_node(warthog::search_node* parent, 
-                          warthog::search_node* child, 
-                          warthog::cost_t edge_cost,
-                          uint32_t edge_id) { } 
-
-            inline void
-            expand_node(warthog::search_node* current) 
-            {
-                ptr->h_[ptr->t_index_][(uint32_t)current->get_id()] = 
-                    current->get_g();
-            }
-
-            inline void
-            relax_node(warthog::search_node* current) { }
-
-            cbs_ll_heuristic* ptr;
-        };
-
-
-        // things we need to compute a perfect heuristic
-        warthog::solution* sol_;
-        warthog::pqueue_min* open_;
-        warthog::zero_heuristic* zh_;
-        warthog::gridmap_expansion_policy* expander_;
-        warthog::cbs_ll_heuristic::listener* listener_;
-
-        warthog::flexible_astar< 
-            warthog::zero_heuristic, 
-            warthog::gridmap_expansion_policy,
-            warthog::pqueue_min, 
-            warthog::cbs_ll_heuristic::listener >* alg_;
-
-        // things we need to store perfect heuristic values
-        std::vector<std::vector<warthog::cost_t>> h_;
-        std::unordered_map<uint32_t, uint32_t> t_map_;
-        uint32_t t_index_;
-        uint32_t gm_sz_;
+        // holding the table keeps it alive if the store drops it
+        warthog::cbs_ll_distance_store::table_ptr current_;
+        const uint16_t* table_;
 };
 
 }
@@ -0,0 +1,412 @@
+#include "cbs_search.h"
+#include "grid.h"
+#include "problem_instance.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+// the edge label of a move between adjacent (padded) cells
+uint8_t
+move_label(uint32_t from_xy, uint32_t to_xy, uint32_t mapw)
+{
+    if(to_xy + mapw == from_xy) { return warthog::grid::NORTH; }
+    if(to_xy == from_xy + mapw) { return warthog::grid::SOUTH; }
+    if(to_xy == from_xy + 1) { return warthog::grid::EAST; }
+    return warthog::grid::WEST;
+}
+
+}
+
+warthog::cbs::cbs_search::cbs_search(
+        warthog::gridmap* map, uint32_t num_threads, uint32_t max_tables)
+    : map_(map), store_(map, max_tables), incumbent_(0), busy_(0),
+      done_(false), max_ct_nodes_(UINT64_MAX), ct_expanded_(0), ct_generated_(0),
+      ll_searches_(0), ll_expanded_(0), time_elapsed_nano_(0)
+{
+    if(num_threads == 0) { num_threads = 1; }
+    for(uint32_t i = 0; i < num_threads; i++)
+    {
+        worker* w = new worker(map, &store_);
+        w->occupant_.assign(map->width() * map->height(), UINT32_MAX);
+        w->ll_searches_ = 0;
+        w->ll_expanded_ = 0;
+        workers_.push_back(w);
+    }
+}
+
+warthog::cbs::cbs_search::~cbs_search()
+{
+    clear();
+    for(worker* w : workers_) { delete w; }
+}
+
+void
+warthog::cbs::cbs_search::clear()
+{
+    for(ct_node* n : nodes_) { delete n; }
+    nodes_.clear();
+    open_.clear();
+    incumbent_ = 0;
+    busy_ = 0;
+    done_ = false;
+    ct_expanded_ = 0;
+    ct_generated_ = 0;
+    ll_searches_ = 0;
+    ll_expanded_ = 0;
+    time_elapsed_nano_ = 0;
+    for(worker* w : workers_)
+    {
+        w->ll_searches_ = 0;
+        w->ll_expanded_ = 0;
+    }
+}
+
+bool
+warthog::cbs::cbs_search::solve(
+        std::vector<uint32_t>& starts, std::vector<uint32_t>& targets,
+        warthog::mapf::plan& theplan)
+{
+    clear();
+    starts_ = starts;
+    targets_ = targets;
+    uint32_t num_agents = (uint32_t)starts_.size();
+
+    warthog::timer mytimer;
+    mytimer.start();
+    store_.precompute(targets_);
+
+    // the root: every agent follows a shortest path, ignoring the others
+    ct_node* root = new ct_node();
+    root->parent_ = 0;
+    root->agent_ = UINT32_MAX;
+    root->xy_id_ = 0;
+    root->depth_ = 0;
+    root->cost_ = 0;
+    nodes_.push_back(root);
+    ct_generated_++;
+
+    worker& w = *workers_[0];
+    root_paths_.assign(num_agents, std::vector<warthog::sn_id_t>());
+    for(uint32_t a = 0; a < num_agents; a++)
+    {
+        if(!replan(root, a, w, root_paths_[a]))
+        {
+            std::cerr << "err; agent " << a << " cannot reach its target\n";
+            mytimer.stop();
+            time_elapsed_nano_ = mytimer.elapsed_time_nano();
+            return false;
+        }
+        root->cost_ += (warthog::cost_t)(root_paths_[a].size() - 1);
+    }
+
+    cbs_conflict first;
+    collect_paths(root, w);
+    root->conflicts_ = find_conflicts(w, first);
+    if(root->conflicts_ && !first.edge_ && first.timestep_ == 0)
+    {
+        std::cerr << "err; agents " << first.a1_ << " and " << first.a2_
+            << " have the same start location\n";
+        mytimer.stop();
+        time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        return false;
+    }
+    open_.push_back(root);
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 1; i < workers_.size(); i++)
+    {
+        threads.push_back(std::thread(&cbs_search::work, this, i));
+    }
+    work(0);
+    for(std::thread& t : threads) { t.join(); }
+
+    for(worker* w : workers_)
+    {
+        ll_searches_ += w->ll_searches_;
+        ll_expanded_ += w->ll_expanded_;
+    }
+    mytimer.stop();
+    time_elapsed_nano_ = mytimer.elapsed_time_nano();
+
+    if(!incumbent_) { return false; }
+
+    theplan.clear();
+    collect_paths(incumbent_, w);
+    for(uint32_t a = 0; a < num_agents; a++)
+    {
+        theplan.paths_.push_back(warthog::solution());
+        warthog::solution& sol = theplan.paths_.back();
+        sol.path_ = *w.paths_[a];
+        sol.sum_of_edge_costs_ = (warthog::cost_t)(sol.path_.size() - 1);
+    }
+    return true;
+}
+
+void
+warthog::cbs::cbs_search::work(uint32_t worker_id)
+{
+    worker& w = *workers_[worker_id];
+    ct_node_cmp cmp;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!done_)
+    {
+        // nothing left in the frontier can improve on the incumbent
+        if(incumbent_ && !open_.empty() &&
+           open_.front()->cost_ >= incumbent_->cost_)
+        {
+            open_.clear();
+        }
+
+        if(open_.empty())
+        {
+            // other workers may still add nodes to the frontier
+            if(busy_ == 0)
+            {
+                done_ = true;
+                cv_.notify_all();
+                break;
+            }
+            cv_.wait(lock);
+            continue;
+        }
+
+        if(ct_generated_ >= max_ct_nodes_)
+        {
+            done_ = true;
+            cv_.notify_all();
+            break;
+        }
+
+        std::pop_heap(open_.begin(), open_.end(), cmp);
+        ct_node* n = open_.back();
+        open_.pop_back();
+        busy_++;
+        ct_expanded_++;
+
+        lock.unlock();
+        expand(n, w);
+        lock.lock();
+
+        busy_--;
+        if(busy_ == 0) { cv_.notify_all(); }
+    }
+}
+
+void
+warthog::cbs::cbs_search::expand(ct_node* n, worker& w)
+{
+    cbs_conflict c;
+    collect_paths(n, w);
+    if(find_conflicts(w, c) == 0)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if(!incumbent_ || n->cost_ < incumbent_->cost_) { incumbent_ = n; }
+        return;
+    }
+
+    // one child per agent in the conflict
+    uint32_t mapw = map_->width();
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        ct_node* child = new ct_node();
+        child->parent_ = n;
+        child->agent_ = (i == 0) ? c.a1_ : c.a2_;
+        child->depth_ = n->depth_ + 1;
+        if(c.edge_)
+        {
+            uint32_t from = (i == 0) ? c.xy1_ : c.xy2_;
+            uint32_t to = (i == 0) ? c.xy2_ : c.xy1_;
+            child->xy_id_ = from;
+            child->con_ = warthog::cbs::cbs_constraint(
+                    (uint16_t)c.timestep_, 0, move_label(from, to, mapw));
+        }
+        else
+        {
+            child->xy_id_ = c.xy1_;
+            child->con_ = warthog::cbs::cbs_constraint(
+                    (uint16_t)c.timestep_, 1, 0);
+        }
+
+        if(!replan(child, child->agent_, w, child->path_))
+        {
+            delete child;
+            continue;
+        }
+
+        const std::vector<warthog::sn_id_t>* old_path =
+            w.paths_[child->agent_];
+        child->cost_ = n->cost_
+            - (warthog::cost_t)(old_path->size() - 1)
+            + (warthog::cost_t)(child->path_.size() - 1);
+
+        // count conflicts with the new path, for tie-breaking
+        cbs_conflict tmp;
+        w.paths_[child->agent_] = &child->path_;
+        child->conflicts_ = find_conflicts(w, tmp);
+        w.paths_[child->agent_] = old_path;
+
+        std::lock_guard<std::mutex> guard(mutex_);
+        open_.push_back(child);
+        std::push_heap(open_.begin(), open_.end(), ct_node_cmp());
+        nodes_.push_back(child);
+        ct_generated_++;
+        cv_.notify_one();
+    }
+}
+
+bool
+warthog::cbs::cbs_search::replan(ct_node* n, uint32_t agent, worker& w,
+        std::vector<warthog::sn_id_t>& path)
+{
+    for(ct_node* m = n; m; m = m->parent_)
+    {
+        if(m->agent_ != agent) { continue; }
+        warthog::sn_id_t time_id =
+            ((warthog::sn_id_t)m->con_.timestep_ << 32) | m->xy_id_;
+        warthog::cbs::cbs_constraint* con =
+            w.expander_.get_constraint(time_id);
+        con->v_ |= m->con_.v_;
+        con->e_ |= m->con_.e_;
+        w.constrained_.push_back(m->xy_id_);
+    }
+
+    warthog::problem_instance pi(starts_[agent], targets_[agent]);
+    w.sol_.reset();
+    w.astar_.get_path(pi, w.sol_);
+    w.ll_searches_++;
+    w.ll_expanded_ += w.sol_.nodes_expanded_;
+
+    for(uint32_t xy_id : w.constrained_)
+    {
+        w.expander_.get_time_constraints()->clear_constraint_set(xy_id);
+    }
+    w.constrained_.clear();
+
+    if(w.sol_.path_.empty()) { return false; }
+    path = w.sol_.path_;
+    return true;
+}
+
+void
+warthog::cbs::cbs_search::collect_paths(ct_node* n, worker& w)
+{
+    uint32_t num_agents = (uint32_t)root_paths_.size();
+    w.paths_.assign(num_agents, 0);
+    for(ct_node* m = n; m->parent_; m = m->parent_)
+    {
+        if(!w.paths_[m->agent_]) { w.paths_[m->agent_] = &m->path_; }
+    }
+    for(uint32_t a = 0; a < num_agents; a++)
+    {
+        if(!w.paths_[a]) { w.paths_[a] = &root_paths_[a]; }
+    }
+}
+
+uint32_t
+warthog::cbs::cbs_search::find_conflicts(
+        warthog::mapf::plan& theplan, cbs_conflict& first)
+{
+    worker& w = *workers_[0];
+    w.paths_.clear();
+    for(warthog::solution& sol : theplan.paths_)
+    {
+        w.paths_.push_back(&sol.path_);
+    }
+    return find_conflicts(w, first);
+}
+
+uint32_t
+warthog::cbs::cbs_search::find_conflicts(worker& w, cbs_conflict& first)
+{
+    uint32_t num_agents = (uint32_t)w.paths_.size();
+    size_t max_len = 0;
+    for(uint32_t a = 0; a < num_agents; a++)
+    {
+        max_len = std::max(max_len, w.paths_[a]->size());
+    }
+
+    // the location of agent a at time t is the t-th element of its path;
+    // agents disappear after reaching their target
+    uint32_t conflicts = 0;
+    for(uint32_t t = 0; t < max_len; t++)
+    {
+        // vertex conflicts
+        for(uint32_t a = 0; a < num_agents; a++)
+        {
+            const std::vector<warthog::sn_id_t>& path = *w.paths_[a];
+            if(t >= path.size()) { continue; }
+            uint32_t xy_id = (uint32_t)path[t];
+            uint32_t b = w.occupant_[xy_id];
+            if(b == UINT32_MAX)
+            {
+                w.occupant_[xy_id] = a;
+                w.occupied_.push_back(xy_id);
+                continue;
+            }
+            if(conflicts++ == 0)
+            {
+                first.a1_ = b;
+                first.a2_ = a;
+                first.xy1_ = first.xy2_ = xy_id;
+                first.timestep_ = t;
+                first.edge_ = false;
+            }
+        }
+
+        // edge conflicts: two agents swap locations between t and t+1
+        for(uint32_t a = 0; a < num_agents; a++)
+        {
+            const std::vector<warthog::sn_id_t>& path = *w.paths_[a];
+            if(t+1 >= path.size()) { continue; }
+            uint32_t from = (uint32_t)path[t];
+            uint32_t to = (uint32_t)path[t+1];
+            if(from == to) { continue; }
+
+            uint32_t b = w.occupant_[to];
+            if(b == UINT32_MAX || b <= a) { continue; }
+            const std::vector<warthog::sn_id_t>& other = *w.paths_[b];
+            if(t+1 >= other.size() || (uint32_t)other[t+1] != from)
+            { continue; }
+            if(conflicts++ == 0)
+            {
+                first.a1_ = a;
+                first.a2_ = b;
+                first.xy1_ = from;
+                first.xy2_ = to;
+                first.timestep_ = t;
+                first.edge_ = true;
+            }
+        }
+
+        for(uint32_t xy_id : w.occupied_) { w.occupant_[xy_id] = UINT32_MAX; }
+        w.occupied_.clear();
+    }
+    return conflicts;
+}
+
+size_t
+warthog::cbs::cbs_search::mem()
+{
+    size_t total = sizeof(*this) + store_.mem();
+    for(ct_node* n : nodes_)
+    {
+        total += sizeof(*n) + sizeof(warthog::sn_id_t) * n->path_.capacity();
+    }
+    total += sizeof(ct_node*) * (nodes_.capacity() + open_.capacity());
+    for(auto& path : root_paths_)
+    {
+        total += sizeof(warthog::sn_id_t) * path.capacity();
+    }
+    for(worker* w : workers_)
+    {
+        total += sizeof(*w) + w->astar_.mem() + w->heuristic_.mem()
+            + sizeof(uint32_t) * w->occupant_.capacity();
+    }
+    return total;
+}
@@ -0,0 +1,238 @@
+#ifndef WARTHOG_CBS_SEARCH_H
+#define WARTHOG_CBS_SEARCH_H
+
+// mapf/cbs_search.h
+//
+// The high level of Conflict-based Search. CBS searches a binary
+// constraint tree (CT). Each CT node has a set of constraints and a
+// plan in which every agent follows a shortest path that satisfies its
+// own constraints. When two agents of a plan conflict (i.e. they are
+// at the same cell at the same time, or they swap cells) the node is
+// split in two: each child forbids the conflicting move to one of the
+// two agents and replans only that agent. CT nodes are expanded in
+// best-first order of their sum of costs; the first conflict-free plan
+// to be expanded is optimal.
+//
+// CT nodes do not copy the constraints and paths of their parent.
+// Each node stores only the constraint it adds and the new path of the
+// agent it constrains; everything else is found by walking up the tree
+// (the constraints of an agent are those of the ancestors which
+// constrain it; its path is that of the closest such ancestor, or the
+// root). Nodes stay in memory until the search finishes.
+//
+// Several worker threads expand CT nodes at the same time. They share
+// one best-first frontier and each has its own low-level search
+// (cbs_ll_expansion_policy). The heuristic distance tables of the
+// low-level searches are shared too, and computed in parallel before
+// the search starts. Because nodes are expanded out of order, a
+// conflict-free plan is only returned once no node in the frontier or
+// in progress can lead to a cheaper one.
+//
+// As in the prioritised planners of programs/mapf.cpp, an agent
+// disappears once it reaches its target, so it occupies the target
+// only at the time of arrival. The cost of a path is its arrival time.
+//
+// For more details see:
+// Sharon, Guni, et al. "Conflict-based search for optimal multi-agent
+// pathfinding." Artificial Intelligence 219 (2015): 40-66.
+//
+
+#include "cbs.h"
+#include "cbs_ll_distance_store.h"
+#include "cbs_ll_expansion_policy.h"
+#include "cbs_ll_heuristic.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "mapf/plan.h"
+#include "pqueue.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace warthog
+{
+
+namespace cbs
+{
+
+// a conflict between agents a1_ and a2_. vertex conflicts happen at
+// cell xy1_ at time timestep_; edge conflicts happen when a1_ moves
+// from xy1_ to xy2_ while a2_ moves from xy2_ to xy1_, between
+// timestep_ and timestep_+1.
+struct cbs_conflict
+{
+    uint32_t a1_;
+    uint32_t a2_;
+    uint32_t xy1_;
+    uint32_t xy2_;
+    uint32_t timestep_;
+    bool edge_;
+};
+
+class cbs_search
+{
+    public:
+        // keep at most @param max_tables heuristic tables in memory
+        // (see cbs_ll_distance_store)
+        cbs_search(warthog::gridmap* map, uint32_t num_threads = 1,
+                uint32_t max_tables = UINT32_MAX);
+        ~cbs_search();
+
+        // plan the agents whose start and target locations (unpadded
+        // ids) are given in @param starts and @param targets. paths are
+        // written to @param theplan, as time-indexed padded ids.
+        // @return false if no conflict-free plan was found before the
+        // limit on CT nodes was reached
+        bool
+        solve(std::vector<uint32_t>& starts, std::vector<uint32_t>& targets,
+                warthog::mapf::plan& theplan);
+
+        // find the earliest conflict in @param theplan, if any.
+        // @return the number of conflicts in the plan
+        uint32_t
+        find_conflicts(warthog::mapf::plan& theplan, cbs_conflict& first);
+
+        // give up after generating this many CT nodes
+        inline void
+        set_max_ct_nodes(uint64_t max_nodes) { max_ct_nodes_ = max_nodes; }
+
+        inline uint64_t
+        get_ct_expanded() { return ct_expanded_; }
+
+        inline uint64_t
+        get_ct_generated() { return ct_generated_; }
+
+        inline uint64_t
+        get_ll_searches() { return ll_searches_; }
+
+        inline uint64_t
+        get_ll_expanded() { return ll_expanded_; }
+
+        inline double
+        get_time_elapsed_nano() { return time_elapsed_nano_; }
+
+        inline uint32_t
+        get_num_threads() { return (uint32_t)workers_.size(); }
+
+        inline warthog::cbs_ll_distance_store*
+        get_distance_store() { return &store_; }
+
+        size_t
+        mem();
+
+    private:
+        // a node in the constraint tree. the root has no constraint and
+        // agent_ == UINT32_MAX; its paths are in root_paths_.
+        struct ct_node
+        {
+            ct_node* parent_;
+            uint32_t agent_;
+            uint32_t xy_id_;
+            warthog::cbs::cbs_constraint con_;
+            uint32_t depth_;
+            uint32_t conflicts_;
+            warthog::cost_t cost_;
+            std::vector<warthog::sn_id_t> path_;
+        };
+
+        struct ct_node_cmp
+        {
+            // true if @param second should be expanded before @param first
+            bool
+            operator()(const ct_node* first, const ct_node* second) const
+            {
+                if(first->cost_ != second->cost_)
+                { return first->cost_ > second->cost_; }
+                if(first->conflicts_ != second->conflicts_)
+                { return first->conflicts_ > second->conflicts_; }
+                return first->depth_ < second->depth_;
+            }
+        };
+
+        // everything a thread needs to replan one agent
+        struct worker
+        {
+            worker(warthog::gridmap* map,
+                    warthog::cbs_ll_distance_store* store)
+                : heuristic_(store), expander_(map, &heuristic_),
+                  astar_(&heuristic_, &expander_, &open_)
+            { }
+
+            warthog::cbs_ll_heuristic heuristic_;
+            warthog::cbs_ll_expansion_policy expander_;
+            warthog::pqueue_min open_;
+            warthog::flexible_astar<
+                warthog::cbs_ll_heuristic,
+                warthog::cbs_ll_expansion_policy,
+                warthog::pqueue_min> astar_;
+            warthog::solution sol_;
+
+            // cells whose constraints need to be cleared after replanning
+            std::vector<uint32_t> constrained_;
+
+            // the paths of the plan being expanded and, per padded
+            // cell, the agent occupying it (for conflict detection)
+            std::vector<const std::vector<warthog::sn_id_t>*> paths_;
+            std::vector<uint32_t> occupant_;
+            std::vector<uint32_t> occupied_;
+
+            uint64_t ll_searches_;
+            uint64_t ll_expanded_;
+        };
+
+        warthog::gridmap* map_;
+        warthog::cbs_ll_distance_store store_;
+        std::vector<worker*> workers_;
+        std::vector<uint32_t> starts_;
+        std::vector<uint32_t> targets_;
+        std::vector<std::vector<warthog::sn_id_t>> root_paths_;
+
+        // shared search state; protected by mutex_
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<ct_node*> open_;
+        std::vector<ct_node*> nodes_;
+        ct_node* incumbent_;
+        uint32_t busy_;
+        bool done_;
+
+        uint64_t max_ct_nodes_;
+        uint64_t ct_expanded_;
+        uint64_t ct_generated_;
+        uint64_t ll_searches_;
+        uint64_t ll_expanded_;
+        double time_elapsed_nano_;
+
+        // expand CT nodes until the search finishes
+        void
+        work(uint32_t worker_id);
+
+        void
+        expand(ct_node* n, worker& w);
+
+        // shortest path for @param agent subject to the constraints of
+        // @param n and its ancestors. @return false if there is none.
+        bool
+        replan(ct_node* n, uint32_t agent, worker& w,
+                std::vector<warthog::sn_id_t>& path);
+
+        // point w.paths_ to the path of each agent at @param n
+        void
+        collect_paths(ct_node* n, worker& w);
+
+        // find the earliest conflict among the paths in w.paths_.
+        // @return the number of conflicts
+        uint32_t
+        find_conflicts(worker& w, cbs_conflict& first);
+
+        void
+        clear();
+};
+
+}
+
+}
+
+#endif
+
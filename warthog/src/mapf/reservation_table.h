@@ -36,7 +36,8 @@ class reservation_table
         reservation_table(uint32_t map_sz) : map_sz_(map_sz) 
         {
             map_sz_in_qwords_ = (map_sz_ >> LOG2_QWORD_SZ)+1;
-            pool_ = new warthog::mem::cpool(map_sz_in_qwords_);
+            pool_ = new warthog::mem::cpool(
+                    map_sz_in_qwords_ * sizeof(uint64_t));
         }
         ~reservation_table() 
         {
@@ -48,7 +49,7 @@ class reservation_table
         {
             if(timestep >= table_.size()) { return false; }
             return table_[timestep][xy_id >> LOG2_QWORD_SZ] & 
-                   (1 << (xy_id & 63));
+                   (1ull << (xy_id & 63));
         }
 
         inline bool
@@ -70,7 +71,7 @@ class reservation_table
                 { map[i] = 0; }
                 table_.push_back(map);
             }
-            table_[timestep][xy_id >> LOG2_QWORD_SZ] |= (1 << (xy_id & 63));
+            table_[timestep][xy_id >> LOG2_QWORD_SZ] |= (1ull << (xy_id & 63));
         }
 
         inline void
@@ -86,7 +87,7 @@ class reservation_table
         {
             assert(timestep < table_.size());
             assert(xy_id < map_sz_);
-            table_[timestep][xy_id >> LOG2_QWORD_SZ] &= ~(1 << (xy_id & 63));
+            table_[timestep][xy_id >> LOG2_QWORD_SZ] &= ~(1ull << (xy_id & 63));
         }
 
         inline void
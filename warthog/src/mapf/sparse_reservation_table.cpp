@@ -0,0 +1,136 @@
+#include "sparse_reservation_table.h"
+
+#include <algorithm>
+
+warthog::sparse_reservation_table::sparse_reservation_table()
+    : first_timestep_(0)
+{ }
+
+warthog::sparse_reservation_table::~sparse_reservation_table()
+{ }
+
+void
+warthog::sparse_reservation_table::reserve_path(
+        const std::vector<warthog::sn_id_t>& path)
+{
+    for(size_t i = 0; i < path.size(); i++)
+    {
+        reserve(path[i]);
+        if(i + 1 < path.size() &&
+           (uint32_t)path[i] != (uint32_t)path[i+1])
+        {
+            reserve_edge((uint32_t)path[i], (uint32_t)path[i+1],
+                    (uint32_t)(path[i] >> 32));
+        }
+    }
+}
+
+void
+warthog::sparse_reservation_table::unreserve_path(
+        const std::vector<warthog::sn_id_t>& path)
+{
+    for(size_t i = 0; i < path.size(); i++)
+    {
+        unreserve(path[i]);
+        if(i + 1 < path.size() &&
+           (uint32_t)path[i] != (uint32_t)path[i+1])
+        {
+            unreserve_edge((uint32_t)path[i], (uint32_t)path[i+1],
+                    (uint32_t)(path[i] >> 32));
+        }
+    }
+}
+
+void
+warthog::sparse_reservation_table::advance(uint32_t timestep)
+{
+    if(timestep <= first_timestep_) { return; }
+    size_t num_dropped =
+        std::min<size_t>(timestep - first_timestep_, steps_.size());
+    steps_.erase(steps_.begin(), steps_.begin() + num_dropped);
+    first_timestep_ = timestep;
+}
+
+size_t
+warthog::sparse_reservation_table::size()
+{
+    size_t retval = 0;
+    for(step_set& step : steps_) { retval += step.size_; }
+    return retval;
+}
+
+void
+warthog::sparse_reservation_table::clear_reservations()
+{
+    steps_.clear();
+    first_timestep_ = 0;
+}
+
+size_t
+warthog::sparse_reservation_table::mem()
+{
+    size_t retval = sizeof(*this);
+    for(step_set& step : steps_)
+    {
+        retval += sizeof(step_set) + sizeof(uint64_t) * step.keys_.capacity();
+    }
+    return retval;
+}
+
+void
+warthog::sparse_reservation_table::step_set::insert(uint64_t key)
+{
+    // keep the load factor at or below one half; most queries made
+    // during search are misses, which are slow at higher loads
+    if((size_ + 1) * 2 > keys_.size()) { grow(); }
+    size_t mask = keys_.size() - 1;
+    size_t i = hash(key);
+    for( ; keys_[i] != EMPTY; i = (i + 1) & mask)
+    {
+        if(keys_[i] == key) { return; }
+    }
+    keys_[i] = key;
+    size_++;
+}
+
+void
+warthog::sparse_reservation_table::step_set::erase(uint64_t key)
+{
+    if(size_ == 0) { return; }
+    size_t mask = keys_.size() - 1;
+    size_t i = hash(key);
+    for( ; keys_[i] != key; i = (i + 1) & mask)
+    {
+        if(keys_[i] == EMPTY) { return; }
+    }
+
+    // shift back any later key of the same run which would no longer
+    // be reachable from its home slot
+    size_t j = i;
+    while(true)
+    {
+        j = (j + 1) & mask;
+        if(keys_[j] == EMPTY) { break; }
+        size_t home = hash(keys_[j]);
+        if(((j - home) & mask) >= ((j - i) & mask))
+        {
+            keys_[i] = keys_[j];
+            i = j;
+        }
+    }
+    keys_[i] = EMPTY;
+    size_--;
+}
+
+void
+warthog::sparse_reservation_table::step_set::grow()
+{
+    std::vector<uint64_t> old(keys_.size() == 0 ? 8 : keys_.size() * 2, EMPTY);
+    old.swap(keys_);
+    shift_ = 64 - __builtin_ctzll(keys_.size());
+    size_ = 0;
+    for(uint64_t key : old)
+    {
+        if(key != EMPTY) { insert(key); }
+    }
+}
@@ -0,0 +1,202 @@
+#ifndef WARTHOG_SPARSE_RESERVATION_TABLE_H
+#define WARTHOG_SPARSE_RESERVATION_TABLE_H
+
+// mapf/sparse_reservation_table.h
+//
+// A reservation table whose memory grows with the number of
+// reservations rather than with map size x horizon (cf.
+// reservation_table, which keeps one map-sized bitmap per timestep).
+//
+// Each timestep has a small open-addressing hash set holding the cells
+// reserved at that time and the moves which start at that time. Moves
+// (edges) are reserved so that other agents can be kept from swapping
+// places with the agent making the move. There is no limit on the
+// horizon: timesteps are added as reservations are made, and a rolling
+// horizon can be kept by dropping all timesteps before a given time
+// (see ::advance). Reservations and queries before the first kept
+// timestep are ignored.
+//
+
+#include "constants.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace warthog
+{
+
+class sparse_reservation_table
+{
+    public:
+        sparse_reservation_table();
+        ~sparse_reservation_table();
+
+        inline bool
+        is_reserved(uint32_t xy_id, uint32_t timestep)
+        {
+            uint32_t index = timestep - first_timestep_;
+            if(index >= steps_.size()) { return false; }
+            return steps_[index].contains(xy_id);
+        }
+
+        inline bool
+        is_reserved(warthog::sn_id_t time_indexed_map_id)
+        {
+            uint32_t timestep = (uint32_t)(time_indexed_map_id >> 32);
+            uint32_t xy_id = (uint32_t)(time_indexed_map_id & UINT32_MAX);
+            return is_reserved(xy_id, timestep);
+        }
+
+        // @return true if an agent moves from @param from_xy_id at
+        // @param timestep to @param to_xy_id at @param timestep+1
+        inline bool
+        is_edge_reserved(uint32_t from_xy_id, uint32_t to_xy_id,
+                uint32_t timestep)
+        {
+            uint32_t index = timestep - first_timestep_;
+            if(index >= steps_.size()) { return false; }
+            return steps_[index].contains(edge_key(from_xy_id, to_xy_id));
+        }
+
+        inline void
+        reserve(uint32_t xy_id, uint32_t timestep)
+        {
+            step_set* step = get_or_create_step(timestep);
+            if(step) { step->insert(xy_id); }
+        }
+
+        inline void
+        reserve(warthog::sn_id_t time_indexed_map_id)
+        {
+            uint32_t timestep = (uint32_t)(time_indexed_map_id >> 32);
+            uint32_t xy_id = (uint32_t)(time_indexed_map_id & UINT32_MAX);
+            reserve(xy_id, timestep);
+        }
+
+        inline void
+        reserve_edge(uint32_t from_xy_id, uint32_t to_xy_id,
+                uint32_t timestep)
+        {
+            step_set* step = get_or_create_step(timestep);
+            if(step) { step->insert(edge_key(from_xy_id, to_xy_id)); }
+        }
+
+        inline void
+        unreserve(uint32_t xy_id, uint32_t timestep)
+        {
+            uint32_t index = timestep - first_timestep_;
+            if(index >= steps_.size()) { return; }
+            steps_[index].erase(xy_id);
+        }
+
+        inline void
+        unreserve(warthog::sn_id_t time_indexed_map_id)
+        {
+            uint32_t timestep = (uint32_t)(time_indexed_map_id >> 32);
+            uint32_t xy_id = (uint32_t)(time_indexed_map_id & UINT32_MAX);
+            unreserve(xy_id, timestep);
+        }
+
+        inline void
+        unreserve_edge(uint32_t from_xy_id, uint32_t to_xy_id,
+                uint32_t timestep)
+        {
+            uint32_t index = timestep - first_timestep_;
+            if(index >= steps_.size()) { return; }
+            steps_[index].erase(edge_key(from_xy_id, to_xy_id));
+        }
+
+        // reserve every location on @param path (a sequence of
+        // time-indexed ids, one per timestep) and every move between
+        // consecutive locations. waits are not reserved as moves.
+        void
+        reserve_path(const std::vector<warthog::sn_id_t>& path);
+
+        void
+        unreserve_path(const std::vector<warthog::sn_id_t>& path);
+
+        // drop all reservations before @param timestep. later
+        // reservations before this time are ignored.
+        void
+        advance(uint32_t timestep);
+
+        inline uint32_t
+        get_first_timestep() { return first_timestep_; }
+
+        // one past the latest timestep with a (possibly since removed)
+        // reservation
+        inline uint32_t
+        get_end_timestep() { return first_timestep_ + (uint32_t)steps_.size(); }
+
+        // number of vertex and edge reservations
+        size_t
+        size();
+
+        // drop all reservations and start again from timestep 0
+        void
+        clear_reservations();
+
+        size_t
+        mem();
+
+    private:
+        // a set of 64-bit keys with linear probing. cells are stored as
+        // their xy id and moves as (to_xy_id+1) << 32 | from_xy_id, so
+        // the two never collide.
+        struct step_set
+        {
+            static constexpr uint64_t EMPTY = UINT64_MAX;
+
+            step_set() : size_(0), shift_(64) { }
+
+            inline bool
+            contains(uint64_t key) const
+            {
+                if(size_ == 0) { return false; }
+                size_t mask = keys_.size() - 1;
+                for(size_t i = hash(key); ; i = (i + 1) & mask)
+                {
+                    if(keys_[i] == key) { return true; }
+                    if(keys_[i] == EMPTY) { return false; }
+                }
+            }
+
+            inline size_t
+            hash(uint64_t key) const
+            { return (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+            void
+            insert(uint64_t key);
+
+            void
+            erase(uint64_t key);
+
+            void
+            grow();
+
+            std::vector<uint64_t> keys_;
+            uint32_t size_;
+            uint32_t shift_;
+        };
+
+        std::deque<step_set> steps_;
+        uint32_t first_timestep_;
+
+        static inline uint64_t
+        edge_key(uint32_t from_xy_id, uint32_t to_xy_id)
+        { return (((uint64_t)to_xy_id + 1) << 32) | from_xy_id; }
+
+        inline step_set*
+        get_or_create_step(uint32_t timestep)
+        {
+            if(timestep < first_timestep_) { return 0; }
+            uint32_t index = timestep - first_timestep_;
+            if(index >= steps_.size()) { steps_.resize(index + 1); }
+            return &steps_[index];
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,229 @@
+#include "speculative_planner.h"
+#include "timer.h"
+
+#include <thread>
+
+warthog::mapf::speculative_planner::speculative_planner(
+        warthog::gridmap* map, uint32_t num_threads)
+    : map_(map), prioritised_(false), committed_(0), next_(0), searches_(0),
+      discarded_(0), time_elapsed_nano_(0)
+{
+    num_threads = std::max<uint32_t>(num_threads, 1);
+    for(uint32_t i = 0; i < num_threads; i++)
+    {
+        workers_.push_back(new worker(map));
+    }
+    lookahead_ = 2 * num_threads;
+}
+
+warthog::mapf::speculative_planner::~speculative_planner()
+{
+    for(worker* w : workers_) { delete w; }
+}
+
+void
+warthog::mapf::speculative_planner::solve(
+        std::vector<uint32_t>& starts, std::vector<uint32_t>& targets,
+        warthog::mapf::plan& hoplan, std::vector<warthog::solution>& sols)
+{
+    warthog::timer mytimer;
+    mytimer.start();
+
+    // every call starts from a map without temporal obstacles
+    for(worker*& w : workers_)
+    {
+        if(w->num_obstacles_ == 0) { continue; }
+        delete w;
+        w = new worker(map_);
+    }
+
+    uint32_t map_sz = map_->header_width() * map_->header_height();
+    footprints_.resize(lookahead_);
+    for(footprint& fp : footprints_)
+    {
+        fp.cells_.clear();
+        fp.bits_.assign((map_sz + 63) / 64, 0);
+    }
+
+    starts_ = &starts;
+    targets_ = &targets;
+    hoplan_ = &hoplan;
+    sols_ = &sols;
+    sols.clear();
+    sols.resize(starts.size());
+    planned_.assign(starts.size(), false);
+    retry_.clear();
+    committed_ = 0;
+    next_ = 0;
+    searches_ = 0;
+    discarded_ = 0;
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 1; i < workers_.size(); i++)
+    {
+        threads.push_back(
+                std::thread(&warthog::mapf::speculative_planner::work, this, i));
+    }
+    work(0);
+    for(std::thread& t : threads) { t.join(); }
+    catch_up(*workers_.at(0), (uint32_t)starts.size());
+
+    mytimer.stop();
+    time_elapsed_nano_ = mytimer.elapsed_time_nano();
+}
+
+void
+warthog::mapf::speculative_planner::work(uint32_t worker_id)
+{
+    worker& w = *workers_.at(worker_id);
+    uint32_t num_agents = (uint32_t)starts_->size();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(committed_ < num_agents)
+    {
+        // agents which need to be planned again come first
+        uint32_t agent;
+        if(retry_.size() > 0)
+        {
+            auto it = std::min_element(retry_.begin(), retry_.end());
+            agent = *it;
+            retry_.erase(it);
+        }
+        else if(next_ < num_agents && next_ < committed_ + lookahead_)
+        {
+            agent = next_++;
+        }
+        else
+        {
+            cv_.wait(lock);
+            continue;
+        }
+        uint32_t snapshot = committed_;
+        lock.unlock();
+
+        catch_up(w, snapshot);
+        footprint& fp = footprints_.at(agent % lookahead_);
+        mark(fp, false);
+        fp.cells_.clear();
+        fp.cells_.push_back(starts_->at(agent));
+        w.listener_.cells_ = &fp.cells_;
+
+        warthog::solution& sol = sols_->at(agent);
+        warthog::problem_instance pi(starts_->at(agent), targets_->at(agent));
+        w.astar_.get_path(pi, sol);
+        if(prioritised_ && sol.path_.size() > 0)
+        {
+            std::vector<warthog::sn_id_t> ti_path;
+            w.expander_.get_time_indexed_path(sol.path_, ti_path);
+            sol.path_.swap(ti_path);
+        }
+        mark(fp, true);
+
+        lock.lock();
+        searches_++;
+
+        // check the obstacles committed since the snapshot
+        bool valid = true;
+        for(uint32_t i = snapshot; i < committed_ && valid; i++)
+        {
+            valid = !conflicts(i, fp);
+        }
+        if(!valid)
+        {
+            retry_.push_back(agent);
+            discarded_++;
+            continue;
+        }
+        planned_[agent] = true;
+
+        // commit agents in priority order. planned agents are checked
+        // against the obstacles of every agent that is committed
+        while(committed_ < num_agents && planned_[committed_])
+        {
+            uint32_t next = committed_++;
+            for(uint32_t i = committed_; i < next_; i++)
+            {
+                if(!planned_[i] ||
+                   !conflicts(next, footprints_.at(i % lookahead_)))
+                { continue; }
+                planned_[i] = false;
+                retry_.push_back(i);
+                discarded_++;
+            }
+        }
+        cv_.notify_all();
+    }
+}
+
+void
+warthog::mapf::speculative_planner::catch_up(worker& w, uint32_t num_agents)
+{
+    for( ; w.num_obstacles_ < num_agents; w.num_obstacles_++)
+    {
+        uint32_t agent = w.num_obstacles_;
+        if(prioritised_ && sols_->at(agent).path_.size() > 0)
+        {
+            w.sipp_map_->add_path(sols_->at(agent).path_);
+        }
+        if(agent < hoplan_->paths_.size())
+        {
+            w.sipp_map_->add_path(hoplan_->paths_.at(agent).path_);
+        }
+    }
+}
+
+bool
+warthog::mapf::speculative_planner::conflicts(uint32_t agent, footprint& fp)
+{
+    auto touches = [&fp](const std::vector<warthog::sn_id_t>& path) -> bool
+    {
+        for(warthog::sn_id_t id : path)
+        {
+            uint32_t xy_id = (uint32_t)id;
+            if(fp.bits_[xy_id >> 6] & (1ull << (xy_id & 63))) { return true; }
+        }
+        return false;
+    };
+
+    if(prioritised_ && touches(sols_->at(agent).path_)) { return true; }
+    return agent < hoplan_->paths_.size() &&
+           touches(hoplan_->paths_.at(agent).path_);
+}
+
+void
+warthog::mapf::speculative_planner::mark(footprint& fp, bool value)
+{
+    uint32_t map_width = map_->header_width();
+    uint32_t map_sz = map_width * map_->header_height();
+    auto set = [&fp, value](uint32_t xy_id) -> void
+    {
+        if(value) { fp.bits_[xy_id >> 6] |= (1ull << (xy_id & 63)); }
+        else { fp.bits_[xy_id >> 6] &= ~(1ull << (xy_id & 63)); }
+    };
+
+    for(uint32_t xy_id : fp.cells_)
+    {
+        set(xy_id);
+        if(xy_id % map_width != 0) { set(xy_id - 1); }
+        if((xy_id + 1) % map_width != 0) { set(xy_id + 1); }
+        if(xy_id >= map_width) { set(xy_id - map_width); }
+        if(xy_id + map_width < map_sz) { set(xy_id + map_width); }
+    }
+}
+
+size_t
+warthog::mapf::speculative_planner::mem()
+{
+    size_t sz = sizeof(*this) + sizeof(uint32_t) * retry_.capacity() +
+        planned_.capacity() / 8;
+    for(worker* w : workers_)
+    {
+        sz += sizeof(worker) + w->astar_.mem();
+    }
+    for(footprint& fp : footprints_)
+    {
+        sz += sizeof(footprint) + sizeof(uint32_t) * fp.cells_.capacity() +
+            sizeof(uint64_t) * fp.bits_.capacity();
+    }
+    return sz;
+}
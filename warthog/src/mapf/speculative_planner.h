@@ -0,0 +1,207 @@
+#ifndef WARTHOG_SPECULATIVE_PLANNER_H
+#define WARTHOG_SPECULATIVE_PLANNER_H
+
+// mapf/speculative_planner.h
+//
+// Prioritised planning with SIPP, spread over several threads. Agents
+// are planned in priority order: agent i avoids the obstacles committed
+// by agents 0..i-1, which are its own path (if ::set_prioritised) and/or
+// the paths of a reference plan of higher priority agents.
+//
+// Each thread keeps its own sipp_gridmap. A thread that is free takes
+// the next agent, catches its map up with the obstacles committed so
+// far and plans the agent against this snapshot, while agents of
+// higher priority may still be in progress. The search records which
+// cells it looked at the safe intervals of (the expanded cells and
+// their neighbours). If no obstacle committed after the snapshot is at
+// one of these cells, the search would have gone exactly the same way
+// with every obstacle in place, so its result (path, cost and search
+// statistics) is that of sequential prioritised planning. Planned
+// agents are checked against each obstacle as it is committed, and
+// agents which conflict are planned again straight away, from a newer
+// snapshot. Agents are committed in priority order.
+//
+// Threads only look a bounded number of agents ahead of the last
+// committed agent (see ::set_lookahead), which limits how stale a
+// snapshot can be.
+//
+
+#include "cbs.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "manhattan_heuristic.h"
+#include "mapf/plan.h"
+#include "pqueue.h"
+#include "sipp/sipp_expansion_policy.h"
+#include "sipp/sipp_gridmap.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace warthog
+{
+
+namespace mapf
+{
+
+class speculative_planner
+{
+    public:
+        speculative_planner(warthog::gridmap* map, uint32_t num_threads = 1);
+        ~speculative_planner();
+
+        // plan the agents whose start and target locations (unpadded
+        // ids) are given in @param starts and @param targets, in that
+        // order of priority. after agent i is planned, the ith path of
+        // @param hoplan (if any) becomes an obstacle for all agents
+        // after i. solutions are written to @param sols; if the planner
+        // is prioritised, their paths are time-indexed (see
+        // sipp_expansion_policy::get_time_indexed_path).
+        void
+        solve(std::vector<uint32_t>& starts, std::vector<uint32_t>& targets,
+                warthog::mapf::plan& hoplan,
+                std::vector<warthog::solution>& sols);
+
+        // make the path of each agent an obstacle for every agent after
+        // it. default=false
+        inline void
+        set_prioritised(bool prioritised) { prioritised_ = prioritised; }
+
+        // plan at most @param lookahead agents beyond the last committed
+        // agent. default=2*num_threads
+        inline void
+        set_lookahead(uint32_t lookahead)
+        { lookahead_ = std::max<uint32_t>(lookahead, 1); }
+
+        inline uint32_t
+        get_num_threads() { return (uint32_t)workers_.size(); }
+
+        // number of searches, including those which were discarded
+        inline uint64_t
+        get_searches() { return searches_; }
+
+        // number of searches discarded because obstacles committed after
+        // their snapshot changed safe intervals they had looked at
+        inline uint64_t
+        get_discarded() { return discarded_; }
+
+        inline double
+        get_time_elapsed_nano() { return time_elapsed_nano_; }
+
+        // a map with the obstacles of every agent planned by the last
+        // call to ::solve
+        inline warthog::sipp_gridmap*
+        get_sipp_map() { return workers_.at(0)->sipp_map_; }
+
+        size_t
+        mem();
+
+    private:
+        // records the cells expanded by a search
+        struct footprint_listener
+        {
+            inline void
+            generate_node(warthog::search_node*, warthog::search_node*,
+                    warthog::cost_t, uint32_t) { }
+
+            inline void
+            expand_node(warthog::search_node* current)
+            { cells_->push_back((uint32_t)(current->get_id() & INT32_MAX)); }
+
+            inline void
+            relax_node(warthog::search_node*) { }
+
+            std::vector<uint32_t>* cells_;
+        };
+
+        struct worker
+        {
+            worker(warthog::gridmap* map)
+                : sipp_map_(new warthog::sipp_gridmap(map)),
+                  heuristic_(map->header_width(), map->header_height()),
+                  expander_(sipp_map_),
+                  astar_(&heuristic_, &expander_, &open_, &listener_),
+                  num_obstacles_(0)
+            { }
+
+            ~worker() { delete sipp_map_; }
+
+            warthog::sipp_gridmap* sipp_map_;
+            warthog::manhattan_heuristic heuristic_;
+            warthog::sipp_expansion_policy expander_;
+            warthog::pqueue_min open_;
+            footprint_listener listener_;
+            warthog::flexible_astar<
+                warthog::manhattan_heuristic,
+                warthog::sipp_expansion_policy,
+                warthog::pqueue_min,
+                footprint_listener> astar_;
+
+            // obstacles of agents 0..num_obstacles_-1 are in sipp_map_
+            uint32_t num_obstacles_;
+        };
+
+        // the cells whose safe intervals a search looked at, as a list
+        // of expanded cells and as a bitset with their neighbours
+        struct footprint
+        {
+            std::vector<uint32_t> cells_;
+            std::vector<uint64_t> bits_;
+        };
+
+        warthog::gridmap* map_;
+        std::vector<worker*> workers_;
+        bool prioritised_;
+        uint32_t lookahead_;
+
+        std::vector<uint32_t>* starts_;
+        std::vector<uint32_t>* targets_;
+        warthog::mapf::plan* hoplan_;
+        std::vector<warthog::solution>* sols_;
+
+        // agents being planned are less than lookahead_ apart, so agent
+        // i can use footprint i % lookahead_
+        std::vector<footprint> footprints_;
+
+        // shared search state; protected by mutex_. agents in
+        // [committed_, next_) are being planned, planned or in retry_.
+        // the solutions of agents being planned are written outside the
+        // lock; nobody else reads them until they are committed.
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        uint32_t committed_;
+        uint32_t next_;
+        std::vector<bool> planned_;
+        std::vector<uint32_t> retry_;
+
+        uint64_t searches_;
+        uint64_t discarded_;
+        double time_elapsed_nano_;
+
+        // plan and commit agents until every agent is committed
+        void
+        work(uint32_t worker_id);
+
+        // add the obstacles of the first @param num_agents agents to the
+        // map of @param w
+        void
+        catch_up(worker& w, uint32_t num_agents);
+
+        // true if an obstacle of @param agent is at a cell of
+        // @param fp
+        bool
+        conflicts(uint32_t agent, footprint& fp);
+
+        // record the cells in @param fp.cells_ and their neighbours in
+        // @param fp.bits_ (or erase them, if @param value is false)
+        void
+        mark(footprint& fp, bool value);
+};
+
+}
+
+}
+
+#endif
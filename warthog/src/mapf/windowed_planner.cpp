@@ -0,0 +1,182 @@
+#include "windowed_planner.h"
+#include "problem_instance.h"
+#include "solution.h"
+
+#include <algorithm>
+
+warthog::mapf::windowed_planner::windowed_planner(
+        warthog::gridmap* map, uint32_t window, uint32_t max_tables)
+    : map_(map), window_(std::max<uint32_t>(window, 1)), timestep_(0),
+      store_(map, max_tables), heuristic_(&store_),
+      expander_(map, &heuristic_),
+      astar_(&heuristic_, &expander_, &open_),
+      ll_searches_(0), ll_expanded_(0), num_trapped_(0)
+{
+    expander_.set_stay_at_target(true);
+}
+
+warthog::mapf::windowed_planner::~windowed_planner()
+{ }
+
+uint32_t
+warthog::mapf::windowed_planner::add_agent(uint32_t start_id)
+{
+    agent_state agent;
+    agent.location_ = map_->to_padded_id(start_id);
+    agent.goal_ = agent.location_;
+    agent.replan_ = true;
+    agent.reserved_ = false;
+    agent.trajectory_.push_back(
+            ((warthog::sn_id_t)timestep_ << 32) | agent.location_);
+    agents_.push_back(agent);
+    return (uint32_t)(agents_.size() - 1);
+}
+
+void
+warthog::mapf::windowed_planner::set_goal(uint32_t agent, uint32_t goal_id)
+{
+    agents_.at(agent).goal_ = map_->to_padded_id(goal_id);
+    agents_.at(agent).replan_ = true;
+}
+
+uint32_t
+warthog::mapf::windowed_planner::replan(uint32_t until)
+{
+    queue_.clear();
+    for(uint32_t i = 0; i < agents_.size(); i++)
+    {
+        agent_state& agent = agents_[i];
+        if(agent.replan_ || agent.path_.empty() || 
+           timestep_ + agent.path_.size() - 1 < until)
+        {
+            unreserve(agent);
+            queue_.push_back(i);
+        }
+    }
+
+    // the queue grows when trapped agents push others back
+    for(size_t i = 0; i < queue_.size(); i++)
+    {
+        agent_state& agent = agents_[queue_[i]];
+        if(plan(agent))
+        {
+            agent.replan_ = false;
+            reserve(agent);
+            continue;
+        }
+
+        num_trapped_++;
+        wait(agent);
+        for(uint32_t j = 0; j < agents_.size(); j++)
+        {
+            agent_state& other = agents_[j];
+            if(!other.reserved_) { continue; }
+            for(warthog::sn_id_t id : other.path_)
+            {
+                if((uint32_t)id != agent.location_) { continue; }
+                unreserve(other);
+                queue_.push_back(j);
+                break;
+            }
+        }
+        reserve(agent);
+
+        // try again at the next replanning step
+        agent.replan_ = true;
+    }
+    return (uint32_t)queue_.size();
+}
+
+bool
+warthog::mapf::windowed_planner::plan(agent_state& agent)
+{
+    // agents wait in place if their goal is unreachable
+    uint32_t start_id = map_->to_unpadded_id(agent.location_);
+    uint32_t goal_id = map_->to_unpadded_id(agent.goal_);
+    if((*store_.get(goal_id))[agent.location_] == 
+            warthog::cbs_ll_distance_store::UNREACHABLE)
+    { return false; }
+
+    expander_.set_reservation_table(&restab_, timestep_);
+    warthog::problem_instance pi(start_id, goal_id);
+    warthog::solution sol;
+    astar_.get_path(pi, sol);
+    ll_searches_++;
+    ll_expanded_ += sol.nodes_expanded_;
+    if(sol.path_.empty()) { return false; }
+
+    // keep the window; the agent waits at its goal after arriving
+    agent.path_.clear();
+    for(uint32_t i = 0; i <= window_; i++)
+    {
+        uint32_t xy_id = (uint32_t)sol.path_[
+            std::min<size_t>(i, sol.path_.size() - 1)];
+        agent.path_.push_back(
+                ((warthog::sn_id_t)(timestep_ + i) << 32) | xy_id);
+    }
+    return true;
+}
+
+void
+warthog::mapf::windowed_planner::wait(agent_state& agent)
+{
+    agent.path_.clear();
+    for(uint32_t i = 0; i <= window_; i++)
+    {
+        agent.path_.push_back(
+                ((warthog::sn_id_t)(timestep_ + i) << 32) | agent.location_);
+    }
+}
+
+void
+warthog::mapf::windowed_planner::reserve(agent_state& agent)
+{
+    restab_.reserve_path(agent.path_);
+    agent.reserved_ = true;
+}
+
+void
+warthog::mapf::windowed_planner::unreserve(agent_state& agent)
+{
+    if(!agent.reserved_) { return; }
+    restab_.unreserve_path(agent.path_);
+    agent.reserved_ = false;
+}
+
+void
+warthog::mapf::windowed_planner::step()
+{
+    for(agent_state& agent : agents_)
+    {
+        // agents without reservations stay where they are. callers
+        // should replan before this happens.
+        if(agent.path_.size() > 1) 
+        { 
+            agent.path_.erase(agent.path_.begin()); 
+        }
+        else
+        {
+            unreserve(agent);
+            agent.path_.assign(1, 
+                ((warthog::sn_id_t)(timestep_ + 1) << 32) | agent.location_);
+            agent.replan_ = true;
+        }
+        agent.location_ = (uint32_t)agent.path_.front();
+        agent.trajectory_.push_back(agent.path_.front());
+    }
+    timestep_++;
+    restab_.advance(timestep_);
+}
+
+size_t
+warthog::mapf::windowed_planner::mem()
+{
+    size_t sz = sizeof(*this) + astar_.mem() + store_.mem() + restab_.mem();
+    for(agent_state& agent : agents_)
+    {
+        sz += sizeof(agent_state) + sizeof(warthog::sn_id_t) * 
+            (agent.path_.capacity() + agent.trajectory_.capacity());
+    }
+    sz += sizeof(uint32_t) * queue_.capacity();
+    return sz;
+}
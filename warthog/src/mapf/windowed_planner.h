@@ -0,0 +1,170 @@
+#ifndef WARTHOG_WINDOWED_PLANNER_H
+#define WARTHOG_WINDOWED_PLANNER_H
+
+// mapf/windowed_planner.h
+//
+// Rolling-horizon prioritised planning for lifelong MAPF. Agents are
+// given new goals while they move and they stay at a goal until they
+// are given another one.
+//
+// Collisions are only resolved for a window of timesteps ahead of the
+// current time. Each agent keeps the first window timesteps of its
+// shortest path in a shared sparse_reservation_table, and agents are
+// only replanned when they run out of reserved timesteps or when their
+// goal changes. All other reservations are kept, so each replanning
+// step only plans the agents that need it, around the reservations of
+// everyone else. Timesteps that have been executed are dropped from
+// the table.
+//
+// An agent can find itself trapped: higher priority agents may reserve
+// every move it could make. It then waits in place for the window and
+// the agents whose reservations collide with its waits are replanned
+// after it, at lower priority. Since two waiting agents never collide,
+// every replanning step terminates with collision-free reservations.
+//
+// For more details see:
+// Li, Jiaoyang, et al. "Lifelong multi-agent path finding in large-scale
+// warehouses." Proceedings of AAAI 2021.
+//
+
+#include "cbs.h"
+#include "cbs_ll_distance_store.h"
+#include "cbs_ll_expansion_policy.h"
+#include "cbs_ll_heuristic.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "pqueue.h"
+#include "sparse_reservation_table.h"
+
+#include <vector>
+
+namespace warthog
+{
+
+namespace mapf
+{
+
+class windowed_planner
+{
+    public:
+        // resolve collisions for @param window timesteps ahead. keep
+        // at most @param max_tables heuristic tables in memory (see
+        // cbs_ll_distance_store)
+        windowed_planner(warthog::gridmap* map, uint32_t window,
+                uint32_t max_tables = UINT32_MAX);
+        ~windowed_planner();
+
+        // add an agent at location @param start_id (an unpadded id).
+        // the agent stays there until it is given a goal.
+        // @return the index of the agent
+        uint32_t
+        add_agent(uint32_t start_id);
+
+        // send @param agent to @param goal_id (an unpadded id). the
+        // agent is replanned at the next call to ::replan
+        void
+        set_goal(uint32_t agent, uint32_t goal_id);
+
+        // plan every agent whose reservations end before timestep
+        // @param until or whose goal has changed.
+        // @return the number of agents planned
+        uint32_t
+        replan(uint32_t until);
+
+        // move every agent one timestep along its plan
+        void
+        step();
+
+        inline uint32_t
+        get_timestep() { return timestep_; }
+
+        inline uint32_t
+        get_num_agents() { return (uint32_t)agents_.size(); }
+
+        inline uint32_t
+        get_window() { return window_; }
+
+        // the current location of @param agent (an unpadded id)
+        inline uint32_t
+        get_location(uint32_t agent)
+        { return map_->to_unpadded_id(agents_.at(agent).location_); }
+
+        inline bool
+        at_goal(uint32_t agent)
+        { return agents_.at(agent).location_ == agents_.at(agent).goal_; }
+
+        // the locations (time-indexed padded ids) visited by @param
+        // agent so far, one per timestep
+        inline const std::vector<warthog::sn_id_t>&
+        get_trajectory(uint32_t agent)
+        { return agents_.at(agent).trajectory_; }
+
+        inline uint64_t
+        get_ll_searches() { return ll_searches_; }
+
+        inline uint64_t
+        get_ll_expanded() { return ll_expanded_; }
+
+        // number of times an agent was trapped and had to wait
+        inline uint64_t
+        get_num_trapped() { return num_trapped_; }
+
+        size_t
+        mem();
+
+    private:
+        struct agent_state
+        {
+            uint32_t location_;
+            uint32_t goal_;
+            bool replan_;
+            bool reserved_;
+
+            // the reserved locations of the agent, from the current
+            // timestep to the end of its window
+            std::vector<warthog::sn_id_t> path_;
+            std::vector<warthog::sn_id_t> trajectory_;
+        };
+
+        warthog::gridmap* map_;
+        uint32_t window_;
+        uint32_t timestep_;
+
+        warthog::cbs_ll_distance_store store_;
+        warthog::cbs_ll_heuristic heuristic_;
+        warthog::cbs_ll_expansion_policy expander_;
+        warthog::pqueue_min open_;
+        warthog::flexible_astar<
+            warthog::cbs_ll_heuristic,
+            warthog::cbs_ll_expansion_policy,
+            warthog::pqueue_min> astar_;
+        warthog::sparse_reservation_table restab_;
+
+        std::vector<agent_state> agents_;
+        std::vector<uint32_t> queue_;
+
+        uint64_t ll_searches_;
+        uint64_t ll_expanded_;
+        uint64_t num_trapped_;
+
+        // plan a path for @param agent around the current reservations.
+        // @return false if the agent is trapped
+        bool
+        plan(agent_state& agent);
+
+        // make @param agent wait in place for the whole window
+        void
+        wait(agent_state& agent);
+
+        void
+        reserve(agent_state& agent);
+
+        void
+        unreserve(agent_state& agent);
+};
+
+}
+
+}
+
+#endif
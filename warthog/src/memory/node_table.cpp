@@ -0,0 +1,65 @@
+#include "node_table.h"
+
+warthog::mem::node_table::node_table(size_t capacity)
+    : generation_(1), num_nodes_(0)
+{
+    // at least twice as many slots as nodes, rounded up to a power of two
+    uint32_t log2_slots = 4;
+    while(((size_t)1 << log2_slots) < 2 * capacity) { log2_slots++; }
+
+    mask_ = ((size_t)1 << log2_slots) - 1;
+    shift_ = 64 - log2_slots;
+    slots_ = new slot[mask_ + 1];
+    reset_slots();
+}
+
+warthog::mem::node_table::~node_table()
+{
+    for(warthog::search_node* block : blocks_)
+    {
+        delete [] block;
+    }
+    delete [] slots_;
+}
+
+void
+warthog::mem::node_table::grow()
+{
+    slot* old_slots = slots_;
+    size_t old_size = mask_ + 1;
+
+    mask_ = 2 * old_size - 1;
+    shift_--;
+    slots_ = new slot[mask_ + 1];
+    for(size_t i = 0; i <= mask_; i++) { slots_[i].generation_ = 0; }
+
+    // nodes from earlier generations are dropped
+    for(size_t i = 0; i < old_size; i++)
+    {
+        if(old_slots[i].generation_ != generation_) { continue; }
+        size_t index = hash(old_slots[i].id_);
+        while(slots_[index].generation_ == generation_)
+        {
+            index = (index + 1) & mask_;
+        }
+        slots_[index] = old_slots[i];
+    }
+    delete [] old_slots;
+}
+
+void
+warthog::mem::node_table::reset_slots()
+{
+    for(size_t i = 0; i <= mask_; i++) { slots_[i].generation_ = 0; }
+    generation_ = 1;
+}
+
+size_t
+warthog::mem::node_table::mem()
+{
+	return sizeof(*this) +
+        sizeof(slot) * (mask_ + 1) +
+        sizeof(warthog::search_node*) * blocks_.capacity() +
+        sizeof(warthog::search_node) *
+            node_table_ns::BLOCK_SIZE * blocks_.size();
+}
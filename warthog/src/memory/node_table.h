@@ -0,0 +1,156 @@
+#ifndef WARTHOG_NODE_TABLE_H
+#define WARTHOG_NODE_TABLE_H
+
+// memory/node_table.h
+//
+// A store of warthog::search_node objects for state spaces which are
+// too large to index directly, e.g. time-expanded grids where the id
+// of a node is (timestep << 32 | xy). Unlike warthog::mem::node_pool,
+// memory is proportional to the number of nodes generated rather than
+// to the largest id.
+//
+// Ids are hashed into an open-addressing table (linear probing) whose
+// slots point into an arena of nodes. The arena is allocated in blocks
+// and never moves, so pointers to nodes stay valid until the table is
+// cleared.
+//
+// ::clear forgets every node in constant time: each slot records the
+// generation in which it was written and slots from earlier
+// generations are treated as empty. Expansion policies call ::clear
+// at the start of each search; memory is then reused by the next one.
+//
+
+#include "constants.h"
+#include "search_node.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace mem
+{
+
+namespace node_table_ns
+{
+	static const uint64_t LOG2_BLOCK_SIZE = 10; // nodes per arena block
+	static const uint64_t BLOCK_SIZE = 1 << LOG2_BLOCK_SIZE;
+	static const uint64_t BLOCK_MASK = BLOCK_SIZE - 1;
+}
+
+class node_table
+{
+	public:
+        // @param capacity is the number of nodes expected per search.
+        // the table grows as needed
+        node_table(size_t capacity = 1024);
+		~node_table();
+
+		// return a warthog::search_node object corresponding to the given id.
+		// if the node has already been generated (since the last call to
+		// ::clear), return a pointer to the previous instance; otherwise
+		// initialise a new object.
+		inline warthog::search_node*
+		generate(sn_id_t node_id)
+        {
+            size_t index = hash(node_id);
+            while(slots_[index].generation_ == generation_)
+            {
+                if(slots_[index].id_ == node_id)
+                { return node_at(slots_[index].node_); }
+                index = (index + 1) & mask_;
+            }
+
+            // keep the load factor at most 1/2
+            if(2 * (num_nodes_ + 1) > mask_ + 1)
+            {
+                grow();
+                return generate(node_id);
+            }
+
+            if(num_nodes_ == blocks_.size() * node_table_ns::BLOCK_SIZE)
+            {
+                blocks_.push_back(
+                        new warthog::search_node[node_table_ns::BLOCK_SIZE]);
+            }
+            slots_[index].id_ = node_id;
+            slots_[index].generation_ = generation_;
+            slots_[index].node_ = (uint32_t)num_nodes_;
+            warthog::search_node* node = node_at(num_nodes_++);
+            *node = warthog::search_node(node_id);
+            return node;
+        }
+
+        // return the node with id @param node_id or null if it has not
+        // been generated since the last call to ::clear
+        inline warthog::search_node*
+        get_ptr(sn_id_t node_id)
+        {
+            size_t index = hash(node_id);
+            while(slots_[index].generation_ == generation_)
+            {
+                if(slots_[index].id_ == node_id)
+                { return node_at(slots_[index].node_); }
+                index = (index + 1) & mask_;
+            }
+            return 0;
+        }
+
+        // forget every node. previously returned pointers are invalid
+        // after the call
+        inline void
+        clear()
+        {
+            num_nodes_ = 0;
+            if(++generation_ == 0) { reset_slots(); }
+        }
+
+        // number of nodes generated since the last call to ::clear
+        inline size_t
+        size() { return num_nodes_; }
+
+		size_t
+		mem();
+
+	private:
+        struct slot
+        {
+            sn_id_t id_;
+            uint32_t generation_;
+            uint32_t node_;
+        };
+
+        slot* slots_;
+        size_t mask_;
+        uint32_t shift_;
+        uint32_t generation_;
+        size_t num_nodes_;
+		std::vector<warthog::search_node*> blocks_;
+
+        // fibonacci hashing: the high bits of id * 2^64/phi
+        inline size_t
+        hash(sn_id_t node_id)
+        { return (size_t)((node_id * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+        inline warthog::search_node*
+        node_at(size_t index)
+        {
+            return &blocks_[index >> node_table_ns::LOG2_BLOCK_SIZE]
+                           [index & node_table_ns::BLOCK_MASK];
+        }
+
+        // double the number of slots
+        void
+        grow();
+
+        // mark every slot empty and restart from generation 1
+        void
+        reset_slots();
+};
+
+}
+
+}
+
+#endif
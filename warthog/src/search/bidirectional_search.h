@@ -6,6 +6,15 @@
 // A customisable variant of bidirectional best-first search.
 // Users can pass in any heuristic and any (domain-specific) expansion policy.
 //
+// The search stops once no unexplored path can be cheaper than the best
+// one found so far. With a (consistent) heuristic this is the case when
+// either open list has a minimum f-value no smaller than the incumbent
+// [Pohl, 1971]. The test only requires that each direction, on its own,
+// is a complete A* search, so it also holds for expansion policies which
+// prune successors, such as jump point search, where the two searches
+// generate different nodes and may meet at some point other than the
+// middle (in the worst case, at the start or target itself).
+//
 // @author: dharabor
 // @created: 2016-02-14
 //
@@ -48,6 +57,7 @@ class bidirectional_search  : public warthog::search
 
             exp_cutoff_ = warthog::INF32;
             cost_cutoff_ = warthog::COST_MAX;
+            time_cutoff_nanos_ = 0;
         }
 
         ~bidirectional_search()
@@ -134,7 +144,7 @@ class bidirectional_search  : public warthog::search
             return sizeof(*this) + 
                 fopen_->mem() +
                 bopen_->mem() +
-                fexpander_->mem();
+                fexpander_->mem() +
                 bexpander_->mem();
         }
 
@@ -224,12 +234,16 @@ class bidirectional_search  : public warthog::search
             }
         }
 
-        // modify this function to balance the search
-        // by default the search expands one node in
-        // each direction then switches to the other direction
+        // modify this function to balance the search.
+        // Dijkstra search expands the node with the smallest g-value,
+        // in either direction. A* search can only stop once one of its
+        // two frontiers reaches the cost of the best path, so it extends
+        // the direction with fewer open nodes [Pohl, 1971].
         bool
         forward_next()
         {
+            if(!dijkstra_) { return fopen_->size() <= bopen_->size(); }
+
             warthog::cost_t fwd_min, bwd_min;
             bwd_min = bopen_->size() ? bopen_->peek()->get_f() : warthog::COST_MAX;
             fwd_min = fopen_->size() ? fopen_->peek()->get_f() : warthog::COST_MAX;
@@ -260,21 +274,30 @@ class bidirectional_search  : public warthog::search
             uint32_t bwd_instance_id = pi_.instance_id_;
 
             // check for valid start and target
-            if(!bexpander_->generate_start_node(&pi_)  ||
-               !bexpander_->generate_target_node(&pi_) ||
-               !fexpander_->generate_start_node(&pi_)  ||
-               !fexpander_->generate_target_node(&pi_))
+            warthog::search_node* bwd_start = 
+                bexpander_->generate_start_node(&pi_);
+            warthog::search_node* bwd_target = 
+                bexpander_->generate_target_node(&pi_);
+            warthog::search_node* fwd_start = 
+                fexpander_->generate_start_node(&pi_);
+            warthog::search_node* fwd_target = 
+                fexpander_->generate_target_node(&pi_);
+            if(!bwd_start || !bwd_target || !fwd_start || !fwd_target)
             { return; } 
+
+            // from here on, the problem is stated in terms of node ids,
+            // which the expansion policy may number differently to the
+            // input (e.g. padded ids on a gridmap)
+            pi_.start_id_ = fwd_start->get_id();
+            pi_.target_id_ = fwd_target->get_id();
             
             // initialise the backward search
             { 
-                bexpander_->generate_target_node(&pi_)->init(
+                bwd_target->init(
                     bwd_instance_id, warthog::NO_PARENT, 0,
-                    heuristic_->h(
-                        bexpander_->generate_target_node(&pi_)->get_id(),
-                        bexpander_->generate_start_node(&pi_)->get_id()));
+                    heuristic_->h(bwd_target->get_id(), bwd_start->get_id()));
                 bopen_->clear();
-                bopen_->push(bexpander_->generate_target_node(&pi_));
+                bopen_->push(bwd_target);
 
             }
 
@@ -282,10 +305,6 @@ class bidirectional_search  : public warthog::search
             // (only dijkstra search is forward resumable)
             if(dijkstra_ && resume)
             { 
-                warthog::search_node* fwd_start = 
-                    fexpander_->generate_start_node(&pi_);
-                warthog::search_node* fwd_target = 
-                    fexpander_->generate_target_node(&pi_);
                 if( fwd_target->get_search_number() == 
                      fwd_start->get_search_number() )
                 {
@@ -298,13 +317,21 @@ class bidirectional_search  : public warthog::search
             }
             else
             {
-                fexpander_->generate_start_node(&pi_)->init(
+                fwd_start->init(
                     fwd_instance_id, warthog::NO_PARENT, 0,
-                    heuristic_->h(
-                        fexpander_->generate_start_node(&pi_)->get_id(), 
-                        fexpander_->generate_target_node(&pi_)->get_id()));
+                    heuristic_->h(fwd_start->get_id(), fwd_target->get_id()));
                 fopen_->clear();
-                fopen_->push(fexpander_->generate_start_node(&pi_));
+                fopen_->push(fwd_start);
+            }
+
+            // the two searches only meet on nodes that they generate, and
+            // jump point expanders never generate the start node again.
+            // with best_cost_ = 0 the loop below stops straight away
+            if(fwd_start->get_id() == fwd_target->get_id())
+            {
+                best_cost_ = 0;
+                v_ = fwd_start;
+                w_ = bwd_target;
             }
 
 
@@ -314,7 +341,7 @@ class bidirectional_search  : public warthog::search
                 warthog::cost_t fwd_bound = fopen_->peek()->get_f();
                 warthog::cost_t bwd_bound = bopen_->peek()->get_f();
                 warthog::cost_t best_bound = dijkstra_ ? 
-                    (fwd_bound + bwd_bound) : std::min(fwd_bound, bwd_bound);
+                    (fwd_bound + bwd_bound) : std::max(fwd_bound, bwd_bound);
 
                 // check if we can terminate 
                 if(best_bound >= best_cost_ ||
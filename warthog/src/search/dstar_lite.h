@@ -0,0 +1,418 @@
+#ifndef WARTHOG_DSTAR_LITE_H
+#define WARTHOG_DSTAR_LITE_H
+
+// search/dstar_lite.h
+//
+// D* Lite: an incremental search which repairs the results of previous
+// searches instead of starting from scratch. The search runs backwards,
+// from the target toward the start, and keeps two cost estimates for
+// every node: g, the cost of the best path found so far, and rhs, the
+// one-step lookahead value computed from the g-values of its successors.
+// Nodes where the two disagree are "inconsistent" and sit on the open
+// list; a search only has to process those. g/rhs values persist across
+// calls to get_path for as long as the target stays the same.
+//
+// When tiles of the map change, call ::update_cells with their (padded)
+// ids; only the nodes adjacent to those tiles are re-examined and the
+// next search repairs the affected part of the search tree. When the
+// agent moves, use ::advance (one step along the current path) or give
+// a new start to ::get_path; the heuristic offset km is increased so
+// that keys already on the open list remain valid lower bounds.
+//
+// The expansion policy E must describe an undirected graph (i.e. the
+// successors of a node are also its predecessors and edge costs are
+// symmetric) whose nodes are the tiles of a grid, and it must provide
+// a method get_map(). gridmap_expansion_policy and
+// vl_gridmap_expansion_policy both satisfy these requirements.
+//
+// For more details see:
+// [Koenig and Likhachev. D* Lite. AAAI, 2002]
+//
+
+#include "constants.h"
+#include "problem_instance.h"
+#include "search.h"
+#include "search_node.h"
+#include "solution.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+template<class H, class E>
+class dstar_lite : public warthog::search
+{
+    public:
+        dstar_lite(H* heuristic, E* expander)
+            : heuristic_(heuristic), expander_(expander)
+        {
+            start_ = last_ = goal_ = UINT32_MAX;
+            km_ = 0;
+            expanded_ = touched_ = heap_ops_ = 0;
+        }
+
+        virtual ~dstar_lite() { }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            sol.reset();
+            search(pi, sol);
+        }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            sol.reset();
+            if(!search(pi, sol)) { return; }
+
+            // descend the g-values from the start to the target
+            uint32_t current = start_;
+            sol.path_.push_back(current);
+            while(current != goal_)
+            {
+                current = best_successor(current);
+                if(current == UINT32_MAX || sol.path_.size() > g_.size())
+                {
+                    sol.path_.clear();
+                    return;
+                }
+                sol.path_.push_back(current);
+            }
+        }
+
+        // move the start one step along the current path.
+        // @return false if the start is at the target or no path exists
+        bool
+        advance()
+        {
+            if(start_ == goal_ || start_ == UINT32_MAX) { return false; }
+            uint32_t next = best_successor(start_);
+            if(next == UINT32_MAX) { return false; }
+            set_start(next);
+            return true;
+        }
+
+        // notify the search that the tiles with (padded) ids
+        // @param cells have changed. the map must already contain the
+        // new values. edges which may have changed are those between
+        // any two tiles in the 3x3 block centred on each changed tile
+        // (diagonal moves depend on the tiles in the corners).
+        void
+        update_cells(const std::vector<uint32_t>& cells)
+        {
+            if(goal_ == UINT32_MAX) { return; }
+
+            uint32_t width = expander_->get_map()->width();
+            std::vector<uint32_t> affected;
+            for(uint32_t id : cells)
+            {
+                for(int32_t dy = -1; dy <= 1; dy++)
+                {
+                    for(int32_t dx = -1; dx <= 1; dx++)
+                    {
+                        affected.push_back(
+                                (uint32_t)((int64_t)id + dy*(int64_t)width + dx));
+                    }
+                }
+            }
+            std::sort(affected.begin(), affected.end());
+            affected.erase(std::unique(affected.begin(), affected.end()),
+                    affected.end());
+
+            for(uint32_t id : affected)
+            {
+                if(id < g_.size()) { update_vertex(id); }
+            }
+        }
+
+        // @return the internal id of the current start node
+        inline uint32_t
+        get_start() { return start_; }
+
+        // @return the internal id of the current target node
+        inline uint32_t
+        get_target() { return goal_; }
+
+        virtual size_t
+        mem()
+        {
+            return sizeof(*this) +
+                (sizeof(warthog::cost_t) * 2 + sizeof(dsl_key) + 1) *
+                    g_.capacity() +
+                sizeof(heap_entry) * heap_.capacity() +
+                expander_->mem() + heuristic_->mem();
+        }
+
+    private:
+        struct dsl_key
+        {
+            warthog::cost_t k1_, k2_;
+
+            inline bool
+            operator<(const dsl_key& other) const
+            {
+                return k1_ < other.k1_ ||
+                    (k1_ == other.k1_ && k2_ < other.k2_);
+            }
+
+            inline bool
+            operator==(const dsl_key& other) const
+            {
+                return k1_ == other.k1_ && k2_ == other.k2_;
+            }
+        };
+
+        // open list entries are never removed or updated in place.
+        // an entry is stale if its node is no longer open or if the
+        // node has been re-inserted with a different key.
+        struct heap_entry
+        {
+            dsl_key key_;
+            uint32_t id_;
+        };
+
+        struct heap_cmp
+        {
+            inline bool
+            operator()(const heap_entry& a, const heap_entry& b) const
+            { return b.key_ < a.key_; }
+        };
+
+        H* heuristic_;
+        E* expander_;
+        warthog::problem_instance pi_;
+
+        uint32_t start_;
+        uint32_t last_;
+        uint32_t goal_;
+        warthog::cost_t km_;
+
+        std::vector<warthog::cost_t> g_;
+        std::vector<warthog::cost_t> rhs_;
+        std::vector<dsl_key> key_;
+        std::vector<uint8_t> open_;
+        std::vector<heap_entry> heap_;
+        std::vector<uint32_t> preds_;
+
+        uint32_t expanded_;
+        uint32_t touched_;
+        uint32_t heap_ops_;
+
+        // no copy ctor
+        dstar_lite(const dstar_lite& other) { }
+        dstar_lite&
+        operator=(const dstar_lite& other) { return *this; }
+
+        // start a new search if the target has changed; otherwise
+        // update the start and repair the existing search
+        // @return true if the start can reach the target
+        bool
+        search(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            expanded_ = touched_ = heap_ops_ = 0;
+            pi_ = pi;
+
+            warthog::search_node* target =
+                expander_->generate_target_node(&pi_);
+            warthog::search_node* start = expander_->generate_start_node(&pi_);
+            if(!target || !start) { return false; }
+
+            uint32_t target_id = (uint32_t)target->get_id();
+            uint32_t start_id = (uint32_t)start->get_id();
+            if(target_id != goal_) { initialise(start_id, target_id); }
+            else if(start_id != start_) { set_start(start_id); }
+
+            compute_shortest_path();
+
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+            sol.nodes_expanded_ = expanded_;
+            sol.nodes_touched_ = touched_;
+            sol.nodes_surplus_ = (uint32_t)heap_.size();
+            sol.heap_ops_ = heap_ops_;
+            if(g_[start_] == warthog::COST_MAX) { return false; }
+            sol.sum_of_edge_costs_ = g_[start_];
+            return true;
+        }
+
+        void
+        initialise(uint32_t start_id, uint32_t target_id)
+        {
+            size_t sz = expander_->get_nodes_pool_size();
+            g_.assign(sz, warthog::COST_MAX);
+            rhs_.assign(sz, warthog::COST_MAX);
+            key_.resize(sz);
+            open_.assign(sz, 0);
+            heap_.clear();
+
+            start_ = last_ = start_id;
+            goal_ = target_id;
+            km_ = 0;
+            rhs_[goal_] = 0;
+            push(goal_, calculate_key(goal_));
+        }
+
+        void
+        set_start(uint32_t start_id)
+        {
+            start_ = start_id;
+            km_ += heuristic_->h(last_, start_);
+            last_ = start_;
+        }
+
+        inline dsl_key
+        calculate_key(uint32_t id)
+        {
+            dsl_key k;
+            k.k2_ = std::min(g_[id], rhs_[id]);
+            k.k1_ = k.k2_ == warthog::COST_MAX ? warthog::COST_MAX :
+                k.k2_ + heuristic_->h(start_, id) + km_;
+            return k;
+        }
+
+        inline void
+        push(uint32_t id, const dsl_key& k)
+        {
+            key_[id] = k;
+            open_[id] = 1;
+            heap_entry e;
+            e.key_ = k;
+            e.id_ = id;
+            heap_.push_back(e);
+            std::push_heap(heap_.begin(), heap_.end(), heap_cmp());
+            heap_ops_++;
+        }
+
+        // discard stale entries from the top of the open list
+        // @return false if the open list is empty
+        inline bool
+        top(heap_entry& e)
+        {
+            while(heap_.size())
+            {
+                e = heap_.front();
+                if(open_[e.id_] && key_[e.id_] == e.key_) { return true; }
+                pop();
+            }
+            return false;
+        }
+
+        inline void
+        pop()
+        {
+            std::pop_heap(heap_.begin(), heap_.end(), heap_cmp());
+            heap_.pop_back();
+            heap_ops_++;
+        }
+
+        // recompute rhs from the successors of @param id and
+        // (re)insert the node into the open list if it is inconsistent
+        void
+        update_vertex(uint32_t id)
+        {
+            touched_++;
+            if(id != goal_)
+            {
+                warthog::cost_t best = warthog::COST_MAX;
+                expander_->expand(expander_->generate(id), &pi_);
+                warthog::search_node* n;
+                warthog::cost_t cost;
+                for(expander_->first(n, cost); n; expander_->next(n, cost))
+                {
+                    warthog::cost_t gn = g_[n->get_id()];
+                    if(gn != warthog::COST_MAX) { best = std::min(best, gn + cost); }
+                }
+                rhs_[id] = best;
+            }
+
+            if(g_[id] != rhs_[id]) { push(id, calculate_key(id)); }
+            else { open_[id] = 0; }
+        }
+
+        void
+        get_predecessors(uint32_t id)
+        {
+            preds_.clear();
+            expander_->expand(expander_->generate(id), &pi_);
+            warthog::search_node* n;
+            warthog::cost_t cost;
+            for(expander_->first(n, cost); n; expander_->next(n, cost))
+            {
+                preds_.push_back((uint32_t)n->get_id());
+            }
+        }
+
+        void
+        compute_shortest_path()
+        {
+            heap_entry e;
+            while(top(e))
+            {
+                if(!(e.key_ < calculate_key(start_)) &&
+                   rhs_[start_] == g_[start_])
+                {
+                    break;
+                }
+
+                uint32_t u = e.id_;
+                pop();
+                expanded_++;
+
+                dsl_key k_new = calculate_key(u);
+                if(e.key_ < k_new)
+                {
+                    push(u, k_new);
+                }
+                else if(g_[u] > rhs_[u])
+                {
+                    // overconsistent: the node's cost improved
+                    g_[u] = rhs_[u];
+                    open_[u] = 0;
+                    get_predecessors(u);
+                    for(uint32_t p : preds_) { update_vertex(p); }
+                }
+                else
+                {
+                    // underconsistent: the node's cost got worse
+                    g_[u] = warthog::COST_MAX;
+                    open_[u] = 0;
+                    get_predecessors(u);
+                    preds_.push_back(u);
+                    for(uint32_t p : preds_) { update_vertex(p); }
+                }
+            }
+        }
+
+        // @return the successor of @param id on a shortest path to the
+        // target, or UINT32_MAX if none exists
+        uint32_t
+        best_successor(uint32_t id)
+        {
+            uint32_t best_id = UINT32_MAX;
+            warthog::cost_t best = warthog::COST_MAX;
+            expander_->expand(expander_->generate(id), &pi_);
+            warthog::search_node* n;
+            warthog::cost_t cost;
+            for(expander_->first(n, cost); n; expander_->next(n, cost))
+            {
+                warthog::cost_t gn = g_[n->get_id()];
+                if(gn != warthog::COST_MAX && gn + cost < best)
+                {
+                    best = gn + cost;
+                    best_id = (uint32_t)n->get_id();
+                }
+            }
+            return best_id;
+        }
+};
+
+}
+
+#endif
@@ -16,6 +16,7 @@
 // @created: 21/08/2012
 //
 
+#include "component_labelling.h"
 #include "cpool.h"
 #include "search/dummy_listener.h"
 #include "pqueue.h"
@@ -50,6 +51,7 @@ class flexible_astar: public warthog::search
 		{
             cost_cutoff_ = warthog::COST_MAX;
             exp_cutoff_ = UINT32_MAX;
+            components_ = 0;
             pi_.instance_id_ = UINT32_MAX;
 		}
 
@@ -171,6 +173,13 @@ class flexible_astar: public warthog::search
         set_listener(L* listener)
         { listener_ = listener; }
 
+        // reject queries whose start and target are in different
+        // components of @param comp, before any nodes are expanded.
+        // labels are indexed by the internal ids of the expansion policy.
+        inline void
+        set_component_labelling(warthog::label::component_labelling* comp)
+        { components_ = comp; }
+
 		virtual inline size_t
 		mem()
 		{
@@ -181,6 +190,8 @@ class flexible_astar: public warthog::search
 				expander_->mem() +
                 // heuristic uses some memory too
                 heuristic_->mem() +
+                // connectivity filter, if any
+                (components_ ? components_->mem() : 0) +
 				// misc
 				sizeof(*this);
 			return bytes;
@@ -199,6 +210,9 @@ class flexible_astar: public warthog::search
         warthog::cost_t cost_cutoff_;
         uint32_t exp_cutoff_;
 
+        // optional connectivity filter
+        warthog::label::component_labelling* components_;
+
 		// no copy ctor
 		flexible_astar(const flexible_astar& other) { }
 		flexible_astar&
@@ -233,6 +247,17 @@ class flexible_astar: public warthog::search
             if(!start) { return 0; } // invalid start location
             pi_.start_id_ = start->get_id();
 
+            if(components_ && pi_.target_id_ != warthog::SN_ID_MAX &&
+               components_->unreachable(
+                   (uint32_t)pi_.start_id_, (uint32_t)pi_.target_id_))
+            {
+                mytimer.stop();
+                g_statistic.TimerStop();
+                sol.short_circuited_ = 1;
+                sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+                return 0;
+            }
+
 			start->init(pi_.instance_id_, warthog::SN_ID_MAX,
                     0, heuristic_->h(pi_.start_id_, pi_.target_id_));
 
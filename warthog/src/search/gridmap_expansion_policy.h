@@ -50,6 +50,9 @@ class gridmap_expansion_policy : public expansion_policy
 
 		virtual size_t
 		mem();
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
 	
 	private:
 		warthog::gridmap* map_;
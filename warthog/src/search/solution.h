@@ -32,6 +32,7 @@ class solution
             nodes_surplus_(other.nodes_surplus_),
             nodes_reopen_(other.nodes_reopen_),
             heap_ops_(other.heap_ops_),
+            short_circuited_(other.short_circuited_),
             path_(other.path_)
         { }
 
@@ -55,7 +56,8 @@ class solution
                 << " touched = " << nodes_touched_ 
                 << " reopened = " << nodes_reopen_ 
                 << " surplus= " << nodes_surplus_
-                << " heap-ops= " << heap_ops_;
+                << " heap-ops= " << heap_ops_
+                << " short-circuited= " << short_circuited_;
         }
 
         inline void
@@ -75,6 +77,7 @@ class solution
             nodes_surplus_ = 0;
             nodes_reopen_ = 0;
             heap_ops_ = 0;
+            short_circuited_ = 0;
             path_.clear();
         }
 
@@ -87,6 +90,10 @@ class solution
         uint32_t nodes_reopen_;
         uint32_t heap_ops_;
 
+        // 1 if the query was rejected without searching (e.g. because
+        // start and target are in different connected components)
+        uint32_t short_circuited_;
+
         // the sequence of states that comprise 
         // a solution path
         std::vector<warthog::sn_id_t> path_;
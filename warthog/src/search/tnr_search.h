@@ -0,0 +1,99 @@
+#ifndef WARTHOG_TNR_SEARCH_H
+#define WARTHOG_TNR_SEARCH_H
+
+// tnr_search.h
+//
+// Transit Node Routing query algorithm. Queries which pass the
+// locality filter are answered with a lookup in the transit distance
+// table; local queries are passed to a fallback search (e.g. bch).
+//
+// TNR is a distance oracle: queries answered by table lookup report
+// the cost of the optimal path but not the path itself.
+//
+
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+#include "transit_node_routing.h"
+
+namespace warthog
+{
+
+class tnr_search : public warthog::search
+{
+    public:
+        tnr_search(warthog::ch::transit_node_routing* tnr,
+                warthog::search* fallback)
+            : tnr_(tnr), fallback_(fallback)
+        {
+            reset_counters();
+        }
+
+        virtual ~tnr_search() { }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            get_pathcost(pi, sol);
+        }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            sol.reset();
+
+            uint32_t s = (uint32_t)pi.start_id_;
+            uint32_t t = (uint32_t)pi.target_id_;
+            if(s >= tnr_->get_num_nodes() || t >= tnr_->get_num_nodes())
+            {
+                mytimer.stop();
+                sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+                return;
+            }
+
+            if(tnr_->is_local(s, t))
+            {
+                local_queries_++;
+                fallback_->get_pathcost(pi, sol);
+                return;
+            }
+
+            table_queries_++;
+            uint32_t lookups = 0;
+            warthog::cost_t cost = tnr_->get_distance(s, t, lookups);
+            if(cost != warthog::INF32) { sol.sum_of_edge_costs_ = cost; }
+            sol.nodes_touched_ = lookups;
+
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        }
+
+        // number of queries answered by table lookup
+        inline uint32_t
+        get_table_queries() { return table_queries_; }
+
+        // number of queries answered by the fallback search
+        inline uint32_t
+        get_local_queries() { return local_queries_; }
+
+        inline void
+        reset_counters() { table_queries_ = local_queries_ = 0; }
+
+        virtual size_t
+        mem()
+        {
+            return sizeof(*this) + tnr_->mem() + fallback_->mem();
+        }
+
+    private:
+        warthog::ch::transit_node_routing* tnr_;
+        warthog::search* fallback_;
+        uint32_t table_queries_;
+        uint32_t local_queries_;
+};
+
+}
+
+#endif
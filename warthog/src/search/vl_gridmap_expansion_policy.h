@@ -63,6 +63,8 @@ class vl_gridmap_expansion_policy : public expansion_policy
         virtual warthog::search_node*
         generate_target_node(warthog::problem_instance* pi);
 
+        inline warthog::vl_gridmap*
+        get_map() { return map_; }
 
 	private:
 		warthog::vl_gridmap* map_;
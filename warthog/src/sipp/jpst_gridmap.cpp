@@ -8,10 +8,19 @@ warthog::jpst_gridmap::jpst_gridmap(warthog::gridmap* gm)
 
     // one copy of the map for jumping E<->W; one copy for jumping N<->S
     t_gm_ = new warthog::gridmap(gm_->header_height(), gm_->header_width());
+    jump_cache_ = 0;
 }
 
 warthog::jpst_gridmap::~jpst_gridmap()
 {
+    delete jump_cache_;
     delete t_gm_;
     delete sipp_map_;
 }
+
+void
+warthog::jpst_gridmap::enable_jump_cache()
+{
+    if(jump_cache_) { return; }
+    jump_cache_ = new warthog::jpst_jump_cache(gm_, t_gm_);
+}
@@ -15,12 +15,18 @@
 // In addition, we store a second copy of the same gridmap but
 // rotated 90 degrees. This speeds up grid scans moving vertically.
 //
+// Jumps can also be precomputed (see ::enable_jump_cache). The cache
+// is told about every tile whose temporal obstacles change and only
+// the rows around such tiles are recomputed.
+//
 // @author: dharabor
 // @created: 2019-11-11
 //
 
 #include "domains/gridmap.h"
 #include "mapf/cbs.h"
+#include "mapf/plan.h"
+#include "sipp/jpst_jump_cache.h"
 #include "sipp/sipp_gridmap.h"
 
 #include <vector>
@@ -39,7 +45,8 @@ class jpst_gridmap
         // after the call, the location is blocked for the duration of the
         // **OPEN** interval (@param start_time, @param end_time).
         // 
-        // NB: runs in time _linear_ to the number of intervals at (x, y)
+        // NB: runs in time logarithmic in the number of intervals at 
+        // (x, y), plus the number of intervals it modifies
         inline void
         add_obstacle(uint32_t x, uint32_t y, cost_t start_time, cost_t end_time, 
                      warthog::cbs::move action = warthog::cbs::move::WAIT)
@@ -48,8 +55,7 @@ class jpst_gridmap
 
             // record the fact that there are temporal obstacles at this location
             uint32_t node_id = y * t_gm_->header_width() + x;
-            uint32_t gm_id = t_gm_->to_padded_id(node_id);
-            t_gm_->set_label(gm_id, true);
+            set_temporal_label(t_gm_->to_padded_id(node_id), true);
         }
 
 
@@ -66,37 +72,69 @@ class jpst_gridmap
 
             // record the fact that there are no temporal obstacles at this location
             uint32_t node_id = y * t_gm_->header_width() + x;
-            uint32_t gm_id = t_gm_->to_padded_id(node_id);
-            t_gm_->set_label(gm_id, false);
+            set_temporal_label(t_gm_->to_padded_id(node_id), false);
+        }
+
+        // add the path of an agent as a sequence of temporal obstacles
+        // (see sipp_gridmap::add_path)
+        inline void
+        add_path(const std::vector<warthog::sn_id_t>& path)
+        {
+            sipp_map_->add_path(path);
+            mark_temporal_obstacles(path);
+        }
+
+        // add the paths of every agent in @param theplan
+        // (see sipp_gridmap::add_plan)
+        inline void
+        add_plan(warthog::mapf::plan& theplan)
+        {
+            sipp_map_->add_plan(theplan);
+            for(warthog::solution& sol : theplan.paths_)
+            {
+                mark_temporal_obstacles(sol.path_);
+            }
         }
 
         // return a reference to the (@param index)th safe interval 
         // associated with the grid cell index @param node_id. 
-        warthog::sipp::safe_interval&
+        inline const warthog::sipp::safe_interval&
         get_safe_interval(uint32_t node_id, uint32_t index)
         {
             return sipp_map_->get_safe_interval(node_id, index);
         }
 
-        // return a reference to the list of safe intervals for the
-        // grid cell with index @param node_id
-        std::vector<warthog::sipp::safe_interval>& 
-        get_all_intervals(uint32_t node_id)
+        // return the safe intervals of the grid cell with index
+        // @param node_id, sorted by start time
+        inline const warthog::sipp::safe_interval*
+        get_intervals(uint32_t node_id)
+        {
+            return sipp_map_->get_intervals(node_id);
+        }
+
+        inline uint32_t
+        get_num_intervals(uint32_t node_id)
         {
-            return sipp_map_->get_all_intervals(node_id);
+            return sipp_map_->get_num_intervals(node_id);
         }
 
-        warthog::sipp::safe_interval* 
+        // return the first safe interval at location @param xy_id 
+        // which ends at or after @param current_time, or null if there
+        // is no such interval
+        inline const warthog::sipp::safe_interval* 
         find_first_reachable(uint32_t xy_id, warthog::cost_t current_time)
         {
-            for(auto& si : intervals_.at(xy_id))
-            {
-                if(si.e_time_ >= current_time) 
-                { return &si; }
-            }
-            return 0;
+            return sipp_map_->find_first_reachable(xy_id, current_time);
         }
 
+        // precompute jumps (see jpst_jump_cache). jpst_locator uses the
+        // cache, if there is one
+        void
+        enable_jump_cache();
+
+        inline warthog::jpst_jump_cache*
+        get_jump_cache() { return jump_cache_; }
+
         size_t
         mem()
         {
@@ -104,6 +142,7 @@ class jpst_gridmap
             sipp_map_->mem() + 
             t_gm_->mem();
             retval += sizeof(this);
+            if(jump_cache_) { retval += jump_cache_->mem(); }
 
             return retval;
         }
@@ -118,7 +157,26 @@ class jpst_gridmap
         warthog::sipp_gridmap* sipp_map_;
 
     private:
-        std::vector<std::vector<warthog::sipp::safe_interval>> intervals_;
+        warthog::jpst_jump_cache* jump_cache_;
+
+        inline void
+        set_temporal_label(uint32_t gm_id, bool label)
+        {
+            if((bool)t_gm_->get_label(gm_id) == label) { return; }
+            t_gm_->set_label(gm_id, label);
+            if(jump_cache_) { jump_cache_->invalidate(gm_id); }
+        }
+
+        // record that there are temporal obstacles at the locations
+        // of @param path
+        inline void
+        mark_temporal_obstacles(const std::vector<warthog::sn_id_t>& path)
+        {
+            for(warthog::sn_id_t id : path)
+            {
+                set_temporal_label(t_gm_->to_padded_id((uint32_t)id), true);
+            }
+        }
 };
 
 }
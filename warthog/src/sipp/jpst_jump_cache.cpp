@@ -0,0 +1,288 @@
+#include "sipp/jpst_jump_cache.h"
+
+#include <algorithm>
+
+warthog::jpst_jump_cache::jpst_jump_cache(
+        warthog::gridmap* gm, warthog::gridmap* t_gm)
+    : gm_(gm), t_gm_(t_gm)
+{
+    width_ = gm_->width();
+    height_ = gm_->height();
+    uint32_t map_sz = width_ * height_;
+
+    // spatial jumps. a jump east from x stops at the first obstacle at
+    // or after x, or the first forced neighbour after x (see
+    // four_connected_jps_locator::jump_east). jumps west are the mirror
+    // image
+    auto label = [this](uint32_t id) -> bool
+    { return id < width_ * height_ && gm_->get_label(id); };
+    stop_east_.assign(map_sz, 0);
+    stop_west_.assign(map_sz, 0);
+
+    // rows are separated by padding, so no jump crosses from one row
+    // into the next and the whole map can be swept at once
+    uint32_t next_dead = map_sz - 1;
+    uint32_t next_forced = warthog::INF32;
+    for(uint32_t x = map_sz; x-- > 0; )
+    {
+        if(!label(x)) { next_dead = x; }
+        uint32_t stop = std::min(next_dead, next_forced);
+        stop_east_[x] = (stop - x) | (stop == next_dead ? DEADEND : 0);
+        if( (label(x - width_) && !label(x - width_ - 1)) ||
+            (label(x + width_) && !label(x + width_ - 1)) )
+        { next_forced = x; }
+    }
+
+    uint32_t prev_dead = 0;
+    uint32_t prev_forced = warthog::INF32;
+    for(uint32_t x = 0; x < map_sz; x++)
+    {
+        if(!label(x)) { prev_dead = x; }
+        uint32_t stop = prev_forced == warthog::INF32 ? prev_dead :
+            std::max(prev_dead, prev_forced);
+        stop_west_[x] = (x - stop) | (stop == prev_dead ? DEADEND : 0);
+        if( (label(x - width_) && !label(x - width_ + 1)) ||
+            (label(x + width_) && !label(x + width_ + 1)) )
+        { prev_forced = x; }
+    }
+
+    // temporal jumps and vertical stops are computed on demand. until
+    // then, every tile stops vertical jumps (so that they look at it)
+    temporal_east_.assign(map_sz, INF);
+    temporal_west_.assign(map_sz, INF);
+    col_words_ = (height_ + 63) / 64;
+    col_stop_.assign((size_t)width_ * col_words_, ~0ull);
+    dirty_.assign(col_words_, ~0ull);
+    row_bits_.resize(5 * (width_ / 32));
+}
+
+warthog::jpst_jump_cache::~jpst_jump_cache()
+{ }
+
+bool
+warthog::jpst_jump_cache::refresh_rows(uint32_t first_row, uint32_t last_row)
+{
+    bool refreshed = false;
+    for(uint32_t index = first_row >> 6; index <= (last_row >> 6); index++)
+    {
+        uint64_t word = dirty_[index];
+        if(index == (first_row >> 6)) { word &= ~0ull << (first_row & 63); }
+        if(index == (last_row >> 6)) { word &= ~0ull >> (63 - (last_row & 63)); }
+        while(word)
+        {
+            refresh_row(index * 64 + (uint32_t)__builtin_ctzll(word));
+            word &= word - 1;
+            refreshed = true;
+        }
+    }
+    return refreshed;
+}
+
+void
+warthog::jpst_jump_cache::refresh_row(uint32_t row)
+{
+    uint32_t first = row * width_;
+    uint64_t bit = 1ull << (row & 63);
+    dirty_[row >> 6] &= ~bit;
+
+    // the first and last rows are padding; nothing stops there but
+    // vertical jumps, which find an obstacle
+    if(row == 0 || row + 2 >= height_)
+    {
+        for(uint32_t col = 0; col < width_; col++)
+        { col_stop_[col * col_words_ + (row >> 6)] |= bit; }
+        return;
+    }
+
+    // read the row, and the rows above and below, 32 tiles at a time
+    // (rows are padded to a multiple of 32 tiles).
+    // band: the tile, or the tile above or below it, has temporal
+    // obstacles. such tiles are temporal jump points.
+    // diag: the tile above or below has temporal obstacles. jumps stop
+    // straight away if the tiles diagonally behind are like this
+    // (see jpst_locator::__jump_east)
+    uint32_t num_words = width_ / 32;
+    uint32_t* band = &row_bits_[0];
+    uint32_t* diag = band + num_words;
+    uint32_t* here = diag + num_words;
+    uint32_t* traversable = here + num_words;
+    uint32_t* east_ok = traversable + num_words;
+    for(uint32_t i = 0; i < num_words; i++)
+    {
+        uint32_t neis[3];
+        t_gm_->get_neighbours_32bit(first + i * 32, neis);
+        band[i] = neis[0] | neis[1] | neis[2];
+        diag[i] = neis[0] | neis[2];
+        here[i] = neis[1];
+        gm_->get_neighbours_32bit(first + i * 32, neis);
+        traversable[i] = neis[1];
+    }
+
+    // temporal jumps east, and whether they find a jump point when the
+    // goal is elsewhere (see ::finds_jump_point)
+    uint32_t next = INF;
+    for(uint32_t i = num_words; i-- > 0; )
+    {
+        uint32_t diag_behind = (diag[i] << 1) | (i > 0 ? diag[i-1] >> 31 : 0);
+        uint32_t ok = 0;
+        for(uint32_t b = 32; b-- > 0; )
+        {
+            uint32_t col = i * 32 + b;
+            uint32_t t_dist = ((diag_behind >> b) & 1) ? 1 :
+                (next == INF ? INF : next - col);
+            temporal_east_[first + col] = t_dist;
+            ok |= (uint32_t)finds_jump_point(stop_east_[first + col], t_dist) << b;
+            if((band[i] >> b) & 1) { next = col; }
+        }
+        east_ok[i] = ok;
+    }
+
+    // temporal jumps west. then the tiles which stop vertical jumps
+    uint32_t prev = INF;
+    for(uint32_t i = 0; i < num_words; i++)
+    {
+        uint32_t diag_behind = (diag[i] >> 1) |
+            (i + 1 < num_words ? diag[i+1] << 31 : 0);
+        uint32_t ok = 0;
+        for(uint32_t b = 0; b < 32; b++)
+        {
+            uint32_t col = i * 32 + b;
+            uint32_t t_dist = ((diag_behind >> b) & 1) ? 1 :
+                (prev == INF ? INF : col - prev);
+            temporal_west_[first + col] = t_dist;
+            ok |= (uint32_t)finds_jump_point(stop_west_[first + col], t_dist) << b;
+            if((band[i] >> b) & 1) { prev = col; }
+        }
+
+        uint32_t stop_bits = ~traversable[i] | here[i] | east_ok[i] | ok;
+        for(uint32_t b = 0; b < 32; b++)
+        {
+            uint64_t& word = col_stop_[(i * 32 + b) * col_words_ + (row >> 6)];
+            if((stop_bits >> b) & 1) { word |= bit; }
+            else { word &= ~bit; }
+        }
+    }
+}
+
+void
+warthog::jpst_jump_cache::jump_east(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+    refresh_row_if_dirty(node_id / width_);
+
+    uint32_t fc_jp_id, fc_jp_cost;
+    spatial_jump(node_id, 1, stop_east_[node_id], goal_id,
+            fc_jp_id, fc_jp_cost);
+
+    // temporal jump points come first, if they are within reach
+    uint32_t t_dist = temporal_east_[node_id];
+    if(t_dist <= fc_jp_cost)
+    {
+        jumpnode_id = node_id + t_dist;
+        jumpcost = t_dist;
+        return;
+    }
+    jumpnode_id = fc_jp_id;
+    jumpcost = fc_jp_cost;
+}
+
+void
+warthog::jpst_jump_cache::jump_west(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+    refresh_row_if_dirty(node_id / width_);
+
+    uint32_t fc_jp_id, fc_jp_cost;
+    spatial_jump(node_id, -1, stop_west_[node_id], goal_id,
+            fc_jp_id, fc_jp_cost);
+
+    uint32_t t_dist = temporal_west_[node_id];
+    if(t_dist <= fc_jp_cost)
+    {
+        jumpnode_id = node_id - t_dist;
+        jumpcost = t_dist;
+        return;
+    }
+    jumpnode_id = fc_jp_id;
+    jumpcost = fc_jp_cost;
+}
+
+void
+warthog::jpst_jump_cache::jump_north(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+    uint32_t col = node_id % width_;
+    uint32_t row = node_id / width_;
+    const uint64_t* column = &col_stop_[(size_t)col * col_words_];
+
+    // the nearest row above with a stop bit. the first row is padding,
+    // so there always is one. the rows up to there must be up to date;
+    // if they were not, look again
+    uint32_t stop_row;
+    do
+    {
+        uint32_t index = row >> 6;
+        uint64_t word = column[index] & ((1ull << (row & 63)) - 1);
+        while(!word) { word = column[--index]; }
+        stop_row = index * 64 + 63 - (uint32_t)__builtin_clzll(word);
+    }
+    while(refresh_rows(stop_row, row - 1));
+
+    // a horizontal jump from the row of the goal can also stop at
+    // the goal
+    uint32_t goal_row = goal_id / width_;
+    if(goal_row > stop_row && goal_row < row)
+    {
+        uint32_t goal_row_id = goal_row * width_ + col;
+        if( (goal_id - goal_row_id) < (stop_east_[goal_row_id] & ~DEADEND) ||
+            (goal_row_id - goal_id) < (stop_west_[goal_row_id] & ~DEADEND) )
+        { stop_row = goal_row; }
+    }
+
+    uint32_t next_id = stop_row * width_ + col;
+    jumpnode_id = gm_->get_label(next_id) ? next_id : warthog::INF32;
+    jumpcost = row - stop_row;
+}
+
+void
+warthog::jpst_jump_cache::jump_south(uint32_t node_id,
+        uint32_t goal_id, uint32_t& jumpnode_id, double& jumpcost)
+{
+    uint32_t col = node_id % width_;
+    uint32_t row = node_id / width_;
+    const uint64_t* column = &col_stop_[(size_t)col * col_words_];
+
+    // the nearest row below with a stop bit. the last row is padding
+    uint32_t stop_row;
+    do
+    {
+        uint32_t index = row >> 6;
+        uint64_t word = column[index] & ~((2ull << (row & 63)) - 1);
+        while(!word) { word = column[++index]; }
+        stop_row = index * 64 + (uint32_t)__builtin_ctzll(word);
+    }
+    while(refresh_rows(row + 1, stop_row));
+
+    uint32_t goal_row = goal_id / width_;
+    if(goal_row < stop_row && goal_row > row)
+    {
+        uint32_t goal_row_id = goal_row * width_ + col;
+        if( (goal_id - goal_row_id) < (stop_east_[goal_row_id] & ~DEADEND) ||
+            (goal_row_id - goal_id) < (stop_west_[goal_row_id] & ~DEADEND) )
+        { stop_row = goal_row; }
+    }
+
+    uint32_t next_id = stop_row * width_ + col;
+    jumpnode_id = gm_->get_label(next_id) ? next_id : warthog::INF32;
+    jumpcost = stop_row - row;
+}
+
+size_t
+warthog::jpst_jump_cache::mem()
+{
+    return sizeof(*this) +
+        sizeof(uint32_t) * (stop_east_.capacity() + stop_west_.capacity() +
+            temporal_east_.capacity() + temporal_west_.capacity() +
+            row_bits_.capacity()) +
+        sizeof(uint64_t) * (col_stop_.capacity() + dirty_.capacity());
+}
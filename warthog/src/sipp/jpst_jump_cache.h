@@ -0,0 +1,184 @@
+#ifndef WARTHOG_JPST_JUMP_CACHE_H
+#define WARTHOG_JPST_JUMP_CACHE_H
+
+// sipp/jpst_jump_cache.h
+//
+// Precomputed jumps for Temporal JPS. The results are the same as those
+// of jpst_locator, which scans the grid at every jump, but most of the
+// scanning is done once and kept until temporal obstacles change
+// nearby.
+//
+// Each (padded) cell stores:
+//  - the distance to the tile where a spatial jump east or west stops
+//    (a forced neighbour or an obstacle). this depends only on the
+//    static map and is computed once.
+//  - the distance to the first temporal jump point east or west, i.e.
+//    the first column with temporal obstacles in the row or in the rows
+//    above and below it. these are computed one row at a time. a row
+//    is marked dirty when temporal obstacles are added to or cleared
+//    from it or the rows next to it (see ::invalidate) and recomputed
+//    the next time a jump reads it.
+//
+// A vertical jump stops at the first tile which is an obstacle, has
+// temporal obstacles or from which a horizontal jump finds a jump
+// point. These tiles are kept in a bitset stored column by column (the
+// map, rotated), so vertical jumps are scans over 64-bit words rather
+// than a pair of horizontal jumps per step. The one row where the goal
+// can change the outcome of a horizontal jump is checked separately.
+//
+
+#include "gridmap.h"
+#include "jps.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+class jpst_jump_cache
+{
+    public:
+        // @param gm is the static map. @param t_gm marks the tiles with
+        // temporal obstacles (see jpst_gridmap)
+        jpst_jump_cache(warthog::gridmap* gm, warthog::gridmap* t_gm);
+        ~jpst_jump_cache();
+
+        // as jpst_locator::jump
+        inline void
+        jump(warthog::jps::direction d, uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, double& jumpcost)
+        {
+            switch(d)
+            {
+                case warthog::jps::NORTH:
+                    jump_north(node_id, goal_id, jumpnode_id, jumpcost);
+                    break;
+                case warthog::jps::SOUTH:
+                    jump_south(node_id, goal_id, jumpnode_id, jumpcost);
+                    break;
+                case warthog::jps::EAST:
+                    jump_east(node_id, goal_id, jumpnode_id, jumpcost);
+                    break;
+                case warthog::jps::WEST:
+                    jump_west(node_id, goal_id, jumpnode_id, jumpcost);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // the temporal obstacles at padded id @param gm_id have changed.
+        // NB: a change in a row changes jumps in the rows above and below
+        inline void
+        invalidate(uint32_t gm_id)
+        {
+            uint32_t row = gm_id / width_;
+            for(uint32_t r = row - (row > 0); r <= row + 1 && r < height_; r++)
+            {
+                dirty_[r >> 6] |= (1ull << (r & 63));
+            }
+        }
+
+        size_t
+        mem();
+
+    private:
+        static constexpr uint32_t INF = UINT32_MAX;
+        static constexpr uint32_t DEADEND = 1u << 31;
+
+        warthog::gridmap* gm_;
+        warthog::gridmap* t_gm_;
+        uint32_t width_;
+        uint32_t height_;
+
+        // per padded id: distance to the tile where a spatial jump stops
+        // (DEADEND is set if the tile is an obstacle) and distance to
+        // the first temporal jump point (INF if there is none)
+        std::vector<uint32_t> stop_east_;
+        std::vector<uint32_t> stop_west_;
+        std::vector<uint32_t> temporal_east_;
+        std::vector<uint32_t> temporal_west_;
+
+        // the tiles where vertical jumps stop; column x, row y is bit
+        // y % 64 of word x * col_words_ + y / 64
+        std::vector<uint64_t> col_stop_;
+        uint32_t col_words_;
+
+        // rows whose temporal jumps and stop bits are out of date; row y
+        // is bit y % 64 of word y / 64
+        std::vector<uint64_t> dirty_;
+
+        // scratch space for ::refresh_row
+        std::vector<uint32_t> row_bits_;
+
+        inline void
+        refresh_row_if_dirty(uint32_t row)
+        {
+            if(dirty_[row >> 6] & (1ull << (row & 63))) { refresh_row(row); }
+        }
+
+        // recompute the dirty rows in [@param first_row, @param last_row].
+        // returns false if there were none
+        bool
+        refresh_rows(uint32_t first_row, uint32_t last_row);
+
+        void
+        refresh_row(uint32_t row);
+
+        // the result of a spatial jump from @param node_id in direction
+        // @param dir (+1 or -1), given the stop distance @param stop
+        inline void
+        spatial_jump(uint32_t node_id, int32_t dir, uint32_t stop,
+                uint32_t goal_id, uint32_t& jumpnode_id, uint32_t& jumpcost)
+        {
+            uint32_t num_steps = stop & ~DEADEND;
+            uint32_t goal_dist = (goal_id - node_id) * (uint32_t)dir;
+            if(num_steps > goal_dist)
+            {
+                jumpnode_id = goal_id;
+                jumpcost = goal_dist;
+            }
+            else if(stop & DEADEND)
+            {
+                jumpnode_id = warthog::INF32;
+                jumpcost = num_steps - (num_steps > 0);
+            }
+            else
+            {
+                jumpnode_id = node_id + (uint32_t)dir * num_steps;
+                jumpcost = num_steps;
+            }
+        }
+
+        // true if a horizontal jump, from a tile which is not on the row
+        // of the goal, finds a jump point. @param stop is the distance
+        // to the spatial stop, @param t_dist to the first temporal jump
+        // point (in the same direction)
+        inline bool
+        finds_jump_point(uint32_t stop, uint32_t t_dist)
+        {
+            uint32_t num_steps = stop & ~DEADEND;
+            return !(stop & DEADEND) || t_dist <= num_steps - (num_steps > 0);
+        }
+
+        void
+        jump_north(uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, double& jumpcost);
+
+        void
+        jump_south(uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, double& jumpcost);
+
+        void
+        jump_east(uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, double& jumpcost);
+
+        void
+        jump_west(uint32_t node_id, uint32_t goal_id,
+                uint32_t& jumpnode_id, double& jumpcost);
+};
+
+}
+
+#endif
@@ -26,6 +26,13 @@ warthog::jpst_locator::jump(warthog::jps::direction d,
 	   	uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
 		double& jumpcost)
 {
+    warthog::jpst_jump_cache* cache = jpst_gm_->get_jump_cache();
+    if(cache)
+    {
+        cache->jump(d, node_id, goal_id, jumpnode_id, jumpcost);
+        return;
+    }
+
 	switch(d)
 	{
 		case warthog::jps::NORTH:
@@ -133,6 +133,30 @@ class sipp_expansion_policy
             x = (int32_t)(xy_id % sipp_map_->gm_->header_width());
         }
 
+        // convert @param path, a sequence of safe interval ids found by
+        // the most recent search, into a sequence of time-indexed xy ids,
+        // one per timestep (i.e. with the waits made explicit).
+        // the result is written to @param ti_path
+        void
+        get_time_indexed_path(const std::vector<warthog::sn_id_t>& path,
+                std::vector<warthog::sn_id_t>& ti_path)
+        {
+            ti_path.clear();
+            for(uint32_t i = 0; i < path.size(); i++)
+            {
+                warthog::sn_id_t xy_id = path[i] & INT32_MAX;
+                warthog::sn_id_t arrival =
+                    (warthog::sn_id_t)generate(path[i])->get_g();
+                warthog::sn_id_t departure = (i+1) < path.size() ?
+                    (warthog::sn_id_t)generate(path[i+1])->get_g() :
+                    arrival + 1;
+                for(warthog::sn_id_t t = arrival; t < departure; t++)
+                {
+                    ti_path.push_back((t << 32) | xy_id);
+                }
+            }
+        }
+
         // SIPP looks for successors among the set of safe intervals stored
         // with each xy location adjacent to that of @param current
         // Generated are all safe intervals which begin before the end (<=)
@@ -258,16 +282,17 @@ class sipp_expansion_policy
 
         inline void 
         generate_successors(warthog::search_node* current, 
-                warthog::sipp::safe_interval& c_si, 
+                const warthog::sipp::safe_interval& c_si, 
                 uint32_t succ_xy_id, warthog::cbs::move ec_direction,
                 warthog::problem_instance* pi)
         {
             // iterate over adjacent safe intervals
-            std::vector<warthog::sipp::safe_interval>& neis 
-                = sipp_map_->get_all_intervals(succ_xy_id);
+            const warthog::sipp::safe_interval* neis 
+                = sipp_map_->get_intervals(succ_xy_id);
+            uint32_t num_neis = sipp_map_->get_num_intervals(succ_xy_id);
 
             for(uint32_t i = 0;
-                         i < neis.size(); 
+                         i < num_neis; 
                          i++)
             {
                 // we generate safe intervals for adjacent cells but:
@@ -277,7 +302,7 @@ class sipp_expansion_policy
                 // the duration of the action that moves the agent
                 // (iii) only if the successor is safe at the time the 
                 // agent finishes moving.
-                warthog::sipp::safe_interval& succ_si = neis.at(i);
+                const warthog::sipp::safe_interval& succ_si = neis[i];
 
                 warthog::cost_t action_cost = 1;
                 if( succ_si.s_time_ <= c_si.e_time_ && 
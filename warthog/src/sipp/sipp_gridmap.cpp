@@ -1,65 +1,59 @@
 #include "sipp/sipp_gridmap.h"
 #include <algorithm>
+#include <cstring>
 
 warthog::sipp_gridmap::sipp_gridmap(warthog::gridmap* gm)
     : gm_(gm)
 {
     uint32_t mapsize = gm_->header_width() * gm_->header_height();
-    intervals_.resize(mapsize);
+    cell_.resize(mapsize);
     for(uint32_t i = 0; i < mapsize; i++)
     {
         uint32_t gm_id = gm->to_padded_id(i);
-
-        warthog::sipp::safe_interval si; 
-        if(!gm_->get_label(gm_id))
-        { 
-            si.e_time_ = warthog::COST_MIN;
-            si.s_time_ = warthog::COST_MAX;
-        }
-        else 
-        {
-            si.s_time_ = 0; 
-            si.e_time_ = warthog::COST_MAX;
-        }
-        intervals_.at(i).push_back(si);
+        cell_[i] = gm_->get_label(gm_id) ? FREE : BLOCKED;
     }
 
-//    xy_id_offsets[warthog::cbs::NONE] = 0;
-//    xy_id_offsets[warthog::cbs::WAIT] = 0;
-//    xy_id_offsets[warthog::cbs::EAST] = 1;
-//    xy_id_offsets[warthog::cbs::WEST] = -1;
-//    xy_id_offsets[warthog::cbs::SOUTH] = gm_->header_width();
-//    xy_id_offsets[warthog::cbs::NORTH] = -1 * gm_->header_width();
-//
-//    ec_moves[warthog::cbs::NONE] = 0;
-//    ec_moves[warthog::cbs::WAIT] = 0;
-//    ec_moves[warthog::cbs::NORTH] = warthog::cbs::SOUTH;
-//    ec_moves[warthog::cbs::SOUTH] = warthog::cbs::NORTH;
-//    ec_moves[warthog::cbs::EAST] = warthog::cbs::WEST;
-//    ec_moves[warthog::cbs::WEST] = warthog::cbs::EAST;
+    // the single interval of cells without temporal obstacles
+    free_si_.s_time_ = 0; 
+    free_si_.e_time_ = warthog::COST_MAX;
+    blocked_si_.e_time_ = warthog::COST_MIN;
+    blocked_si_.s_time_ = warthog::COST_MAX;
+
+    free_offsets_.resize(32);
 }
 
 warthog::sipp_gridmap::~sipp_gridmap()
 { }
 
-
 void
 warthog::sipp_gridmap::add_obstacle(
     uint32_t x, uint32_t y, cost_t start_time, cost_t end_time, 
     warthog::cbs::move action)
+{
+    add_obstacle(y * gm_->header_width() + x, start_time, end_time, action);
+}
+
+void
+warthog::sipp_gridmap::add_obstacle(
+    uint32_t node_id, cost_t start_time, cost_t end_time, 
+    warthog::cbs::move action)
 {
     // temporal obstacles need to have a non-zero duration
     if((end_time - start_time) == 0) { return; } 
 
-    uint32_t node_id = y * gm_->header_width() + x;
-    std::vector<warthog::sipp::safe_interval> temp;
-    for(uint32_t i = 0; i < intervals_.at(node_id).size(); i++)
-    {
-        warthog::sipp::safe_interval si = intervals_.at(node_id).at(i);
+    // the obstacle affects the intervals which overlap (or touch) 
+    // [start_time, end_time]. the others are still safe.
+    const warthog::sipp::safe_interval* ivals = get_intervals(node_id);
+    uint32_t num_si = get_num_intervals(node_id);
+    uint32_t first = lower_bound(ivals, num_si, start_time);
+    uint32_t last = first;
+    while(last < num_si && ivals[last].s_time_ <= end_time) { last++; }
+    if(first == last) { return; }
 
-        // these intervals are unaffected by the new obstacle (still safe)
-        if(end_time < si.s_time_) { temp.push_back(si); continue; }
-        if(start_time > si.e_time_) { temp.push_back(si); continue; }
+    scratch_.clear();
+    for(uint32_t i = first; i < last; i++)
+    {
+        warthog::sipp::safe_interval si = ivals[i];
 
         // these intervals are dominated by the obstacle so we remove them
         if(start_time <= si.s_time_ && si.e_time_ <= end_time)
@@ -70,7 +64,7 @@ warthog::sipp_gridmap::add_obstacle(
         {
             si.s_time_ = end_time; 
             si.action_  = action;
-            temp.push_back(si);
+            scratch_.push_back(si);
             continue;
         }
 
@@ -78,7 +72,7 @@ warthog::sipp_gridmap::add_obstacle(
         if(si.s_time_ < start_time && si.e_time_ <= end_time)
         {
             si.e_time_ = start_time;
-            temp.push_back(si);
+            scratch_.push_back(si);
             continue;
         }
 
@@ -90,39 +84,188 @@ warthog::sipp_gridmap::add_obstacle(
             new_si.s_time_ = end_time;
             new_si.e_time_ = si.e_time_;
             new_si.action_ = action;
-            temp.push_back(new_si);
 
             // existing interval, safe only up to the time of the obstacle
             si.e_time_ = start_time;
-            temp.push_back(si);
+            scratch_.push_back(si);
+            scratch_.push_back(new_si);
         }
     }
 
-    // sort the new list of safe intervals by start times
-    std::sort(temp.begin(), temp.end(), 
-        [](warthog::sipp::safe_interval first, 
-           warthog::sipp::safe_interval second) -> bool
+    // cells with implied intervals get a block of their own
+    uint32_t block_id = cell_[node_id];
+    if(block_id >= BLOCKED)
+    {
+        if(free_blocks_.empty())
         {
-            return first.s_time_ < second.s_time_;
+            free_blocks_.push_back((uint32_t)blocks_.size());
+            blocks_.push_back(interval_block());
+        }
+        block_id = free_blocks_.back();
+        free_blocks_.pop_back();
+
+        warthog::sipp::safe_interval si = *ivals;
+        interval_block& block = blocks_[block_id];
+        block.offset_ = allocate(MIN_BLOCK_CAPACITY);
+        block.size_ = 1;
+        block.capacity_ = MIN_BLOCK_CAPACITY;
+        arena_[block.offset_] = si;
+        cell_[node_id] = block_id;
+    }
+
+    // replace intervals [first, last) with those in scratch_
+    uint32_t new_size = num_si - (last - first) + (uint32_t)scratch_.size();
+    if(new_size > blocks_[block_id].capacity_)
+    {
+        uint32_t capacity = blocks_[block_id].capacity_ * 2;
+        uint32_t offset = allocate(capacity);
+        interval_block& block = blocks_[block_id];
+        std::copy(arena_.begin() + block.offset_, 
+                  arena_.begin() + block.offset_ + block.size_,
+                  arena_.begin() + offset);
+        release(block.offset_, block.capacity_);
+        block.offset_ = offset;
+        block.capacity_ = capacity;
+    }
+    interval_block& block = blocks_[block_id];
+    warthog::sipp::safe_interval* block_si = arena_.data() + block.offset_;
+    std::memmove(block_si + first + scratch_.size(), block_si + last, 
+                 sizeof(warthog::sipp::safe_interval) * (num_si - last));
+    std::copy(scratch_.begin(), scratch_.end(), block_si + first);
+    block.size_ = new_size;
+}
+
+void
+warthog::sipp_gridmap::add_path(const std::vector<warthog::sn_id_t>& path)
+{
+    obstacles_.clear();
+    collect_obstacles(path);
+    add_obstacles();
+}
+
+void
+warthog::sipp_gridmap::add_plan(warthog::mapf::plan& theplan)
+{
+    obstacles_.clear();
+    for(warthog::solution& sol : theplan.paths_)
+    {
+        collect_obstacles(sol.path_);
+    }
+    add_obstacles();
+}
+
+void
+warthog::sipp_gridmap::collect_obstacles(
+        const std::vector<warthog::sn_id_t>& path)
+{
+    uint32_t map_width = gm_->header_width();
+    for(uint32_t i = 0; i < path.size(); )
+    {
+        uint32_t xy_id = (uint32_t)path[i];
+        warthog::cost_t timestep = (warthog::cost_t)(path[i] >> 32);
+
+        // skip over any waits; the agent blocks its location until
+        // it moves away
+        uint32_t j = i + 1;
+        while(j < path.size() && (uint32_t)path[j] == xy_id) { j++; }
+
+        // agents occupy their target location for one 
+        // timestep then disappear (DIFFERENT FROM STANDARD MAPF!!)
+        if(j == path.size())
+        {
+            warthog::cost_t arrival_time = 
+                (warthog::cost_t)(path.back() >> 32);
+            obstacles_.push_back(obstacle{xy_id, timestep, arrival_time + 1, 
+                                          warthog::cbs::move::WAIT});
+            break;
+        }
+
+        // impute the next move from xy locations of nodes on the path
+        uint32_t next_xy_id = (uint32_t)path[j];
+        warthog::cost_t timestep_next = (warthog::cost_t)(path[j] >> 32);
+        warthog::cbs::move direction = warthog::cbs::move::WAIT;
+        if(next_xy_id + map_width == xy_id) 
+        { direction = warthog::cbs::move::NORTH; }
+        else if(next_xy_id == xy_id + map_width) 
+        { direction = warthog::cbs::move::SOUTH; }
+        else if(next_xy_id + 1 == xy_id) 
+        { direction = warthog::cbs::move::WEST; }
+        else if(next_xy_id == xy_id + 1) 
+        { direction = warthog::cbs::move::EAST; }
+
+        obstacles_.push_back(
+            obstacle{xy_id, timestep, timestep_next, direction});
+        i = j;
+    }
+}
+
+void
+warthog::sipp_gridmap::add_obstacles()
+{
+    std::stable_sort(obstacles_.begin(), obstacles_.end(), 
+        [](const obstacle& first, const obstacle& second) -> bool
+        {
+            if(first.xy_id_ != second.xy_id_) 
+            { return first.xy_id_ < second.xy_id_; }
+            return first.start_time_ < second.start_time_;
         });
 
-    // replace the old list with the new list
-    intervals_.at(node_id) = temp;
+    for(obstacle& obs : obstacles_)
+    {
+        add_obstacle(obs.xy_id_, obs.start_time_, obs.end_time_, obs.action_);
+    }
+    obstacles_.clear();
 }
 
 void
 warthog::sipp_gridmap::clear_obstacles(uint32_t x, uint32_t y)
 {
     uint32_t node_id = y*gm_->header_width() + x;
-    intervals_.at(node_id).clear();
-    warthog::sipp::safe_interval si;
+    uint32_t block_id = cell_.at(node_id);
+    if(block_id < BLOCKED)
+    {
+        release(blocks_[block_id].offset_, blocks_[block_id].capacity_);
+        free_blocks_.push_back(block_id);
+    }
+    cell_[node_id] = gm_->get_label(gm_->to_padded_id(node_id)) ? 
+                     FREE : BLOCKED;
+}
 
-    if(!gm_->get_label(node_id))
-    { si.s_time_ = warthog::COST_MAX; }
-    else
-    { si.s_time_ = 0; }
-    si.e_time_ = warthog::COST_MAX;
+uint32_t
+warthog::sipp_gridmap::allocate(uint32_t capacity)
+{
+    std::vector<uint32_t>& offsets = free_offsets_[__builtin_ctz(capacity)];
+    if(!offsets.empty())
+    {
+        uint32_t offset = offsets.back();
+        offsets.pop_back();
+        return offset;
+    }
+    uint32_t offset = (uint32_t)arena_.size();
+    arena_.resize(arena_.size() + capacity);
+    return offset;
+}
 
-    intervals_.at(node_id).push_back(si);
+void
+warthog::sipp_gridmap::release(uint32_t offset, uint32_t capacity)
+{
+    free_offsets_[__builtin_ctz(capacity)].push_back(offset);
 }
 
+size_t
+warthog::sipp_gridmap::mem()
+{
+    size_t retval = sizeof(*this);
+    retval += sizeof(uint32_t) * cell_.capacity();
+    retval += sizeof(interval_block) * blocks_.capacity();
+    retval += sizeof(uint32_t) * free_blocks_.capacity();
+    retval += sizeof(warthog::sipp::safe_interval) * arena_.capacity();
+    for(std::vector<uint32_t>& offsets : free_offsets_)
+    {
+        retval += sizeof(offsets) + sizeof(uint32_t) * offsets.capacity();
+    }
+    retval += sizeof(warthog::sipp::safe_interval) * scratch_.capacity();
+    retval += sizeof(obstacle) * obstacles_.capacity();
+    retval += gm_->mem();
+    return retval;
+}
@@ -19,6 +19,7 @@
 
 #include "domains/gridmap.h"
 #include "mapf/cbs.h"
+#include "mapf/plan.h"
 
 #include <vector>
 
@@ -56,6 +57,18 @@ struct safe_interval
 } // ns sipp
 
 // id is padded_id (4 bytes) and then an index for the interval (
+//
+// Safe intervals are stored flat. Most cells never have a temporal
+// obstacle and keep the single interval implied by the static map:
+// [0, INF) if the cell is traversable and an empty interval otherwise.
+// These cells use no storage beyond one 32-bit word in a per-cell
+// index. The intervals of every other cell are kept sorted in a
+// contiguous block of a shared arena. Blocks have power-of-two
+// capacities, are recycled through per-capacity free lists and move
+// to a larger block when they fill up. Lookups are by binary search.
+//
+// NB: adding or clearing obstacles may move the arena, which
+// invalidates pointers and references to safe intervals.
 class sipp_gridmap
 {
     public:
@@ -67,11 +80,28 @@ class sipp_gridmap
         // after the call, the location is blocked for the duration of the
         // **OPEN** interval (@param start_time, @param end_time).
         // 
-        // NB: runs in time _linear_ to the number of intervals at (x, y)
+        // NB: runs in time logarithmic in the number of intervals at
+        // (x, y), plus the number of intervals it modifies
         void
         add_obstacle(uint32_t x, uint32_t y, cost_t start_time, cost_t end_time, 
                      warthog::cbs::move action = warthog::cbs::move::WAIT);
 
+        // add the path of an agent as a sequence of temporal obstacles.
+        // @param path is a sequence of time-indexed (unpadded) xy ids, 
+        // one per timestep. the agent blocks each location until it 
+        // moves away and it occupies its target for one timestep before
+        // disappearing. consecutive waits at a location become a single
+        // obstacle.
+        void
+        add_path(const std::vector<warthog::sn_id_t>& path);
+
+        // add the paths of every agent in @param theplan. obstacles are
+        // sorted by location and time first, so each location is 
+        // updated in a single pass. if the paths of the plan collide,
+        // the result can differ from adding the paths one at a time.
+        void
+        add_plan(warthog::mapf::plan& theplan);
+
         // remove all temporal obstacles at location (@param x, @param y)
         // after the call this location has a single safe interval. 
         // for traversable tile, this interval begins
@@ -83,105 +113,122 @@ class sipp_gridmap
 
         // return a reference to the (@param index)th safe interval 
         // associated with the grid cell index @param node_id. 
-        warthog::sipp::safe_interval&
+        inline const warthog::sipp::safe_interval&
         get_safe_interval(uint32_t node_id, uint32_t index)
         {
-            assert(index < intervals_.at(node_id).size());
-            return intervals_.at(node_id).at(index);
+            assert(index < get_num_intervals(node_id));
+            return get_intervals(node_id)[index];
         }
 
-        //inline warthog::sipp::safe_interval*
-        //step( uint32_t from_xy_id, uint32_t si_index, 
-        //      warthog::cost_t start_time, warthog::cbs::move action )
-        //{
-        //    warthog::sipp::safe_interval* from_si = 
-        //        &(intervals_.at(from_xy_id).at(si_index));
-        //    assert(start_time >= from_si.s_time_ && start_time < from_si.e_time_);
-
-        //    // every step has a minimum cost of 1 (== earliest arrival)
-        //    warthog::cost_t action_cost = 1;
-        //    warthog::cost_t arrive_time = start_time + action_cost;
-
-        //    // agent needs to be safe until it can finish moving 
-        //    // off the current location
-        //    if((start_time + action_cost) > from_si.e_time_)
-        //    { return 0; }
-
-        //    // the new location cannot be a static obstacle
-        //    uint32_t to_id = from_xy_id + xy_id_offsets[action];
-        //    if(!gm_->get_label(gm_->to_padded_id(to_id)))
-        //    { return 0; }
-
-        //    // scan the safe intervals of the "to" location.
-        //    // we want the first one that finishes __after__
-        //    // the earliest possible arrival time of the agent.
-        //    warthog::sipp::safe_interval to_si = 
-        //        find_interval(to_id, arrive_time);
-
-        //    // the move needs to succeed; i.e. the destination 
-        //    // interval needs to overlap in time with the safe
-        //    // interval the agent currently occupies.
-        //    if(to_si == 0 || (to_si.s_time_ >= from_si.e_time_))
-        //    { return 0; }
-
-        //    // avoid edge collisions with other agents (i.e. simultaneously 
-        //    // a1 moves from there to here and a2 moves from here to there)
-        //    if(  to_si->s_time_ == arrive_time &&
-        //         to_si->action_ == ec_moves[action] )
-        //    {
-        //        return 0;
-        //    }
-        //    return to_si;
-        //}
-
-
-        // return the index of the first safe interval at location @param node_id
-        // which has an end time later than @param timepoint. If this interval 
-        // doesn't exist, return UINT32_MAX
-        //warthog::sipp::safe_interval*
-        //find_interval(uint32_t node_id, warthog::cost_t timepoint)
-        //{
-        //    uint32_t num_si = intervals_.at(node_id).size();
-        //    for(uint32_t i = 0; i < num_si; i++)
-        //    {
-        //        warthog::sipp::safe_interval& si = intervals_.at(node_id).at(i);
-
-        //        if( //(timepoint >= si.s_time_ && timepoint < si.e_time) ||
-        //            (si.s_time_ > timepoint) )
-        //        { 
-        //            return &si; 
-        //        }
-        //    }
-        //    return 0;
-        //}
-
-        // return a reference to the list of safe intervals for the
-        // grid cell with index @param node_id
-        std::vector<warthog::sipp::safe_interval>& 
-        get_all_intervals(uint32_t node_id)
-        { return intervals_.at(node_id); }
+        // return the safe intervals of the grid cell with index 
+        // @param node_id, sorted by start time
+        inline const warthog::sipp::safe_interval*
+        get_intervals(uint32_t node_id)
+        {
+            uint32_t block_id = cell_.at(node_id);
+            if(block_id == FREE) { return &free_si_; }
+            if(block_id == BLOCKED) { return &blocked_si_; }
+            return arena_.data() + blocks_[block_id].offset_;
+        }
+
+        inline uint32_t
+        get_num_intervals(uint32_t node_id)
+        {
+            uint32_t block_id = cell_.at(node_id);
+            if(block_id >= BLOCKED) { return 1; }
+            return blocks_[block_id].size_;
+        }
+
+        // return the first safe interval at location @param node_id
+        // which ends at or after @param timepoint, or null if there is
+        // no such interval
+        const warthog::sipp::safe_interval*
+        find_first_reachable(uint32_t node_id, warthog::cost_t timepoint)
+        {
+            const warthog::sipp::safe_interval* ivals = get_intervals(node_id);
+            uint32_t num_si = get_num_intervals(node_id);
+            uint32_t index = lower_bound(ivals, num_si, timepoint);
+            return index < num_si ? &ivals[index] : 0;
+        }
 
         size_t
-        mem()
+        mem();
+
+        warthog::gridmap* gm_; 
+
+    private:
+        // values of cell_ for locations without a block of intervals
+        static constexpr uint32_t FREE = UINT32_MAX;
+        static constexpr uint32_t BLOCKED = UINT32_MAX - 1;
+        static constexpr uint32_t MIN_BLOCK_CAPACITY = 4;
+
+        struct interval_block
         {
-            size_t retval = 0;
-            for(uint32_t i = 0; i < intervals_.size(); i++)
+            uint32_t offset_;
+            uint32_t size_;
+            uint32_t capacity_;
+        };
+
+        struct obstacle
+        {
+            uint32_t xy_id_;
+            warthog::cost_t start_time_;
+            warthog::cost_t end_time_;
+            warthog::cbs::move action_;
+        };
+
+        // per xy location: FREE, BLOCKED or the index of its block
+        std::vector<uint32_t> cell_;
+        std::vector<interval_block> blocks_;
+        std::vector<uint32_t> free_blocks_;
+
+        // the intervals of every block, and the offsets of released
+        // blocks, by log2 of their capacity
+        std::vector<warthog::sipp::safe_interval> arena_;
+        std::vector<std::vector<uint32_t>> free_offsets_;
+
+        warthog::sipp::safe_interval free_si_;
+        warthog::sipp::safe_interval blocked_si_;
+        std::vector<warthog::sipp::safe_interval> scratch_;
+        std::vector<obstacle> obstacles_;
+
+        // index of the first of the @param num_si intervals @param ivals
+        // which ends at or after @param timepoint
+        inline uint32_t
+        lower_bound(const warthog::sipp::safe_interval* ivals, 
+                uint32_t num_si, warthog::cost_t timepoint)
+        {
+            uint32_t first = 0;
+            while(num_si > 0)
             {
-                retval += sizeof(warthog::sipp::safe_interval)*intervals_.at(i).size();
-                retval += sizeof(intervals_.at(i));
+                uint32_t half = num_si >> 1;
+                if(ivals[first + half].e_time_ < timepoint)
+                {
+                    first += half + 1;
+                    num_si -= half + 1;
+                }
+                else { num_si = half; }
             }
-            retval += gm_->mem();
-            retval += sizeof(this);
-            return retval;
+            return first;
         }
 
+        void
+        add_obstacle(uint32_t node_id, cost_t start_time, cost_t end_time, 
+                     warthog::cbs::move action);
 
-        warthog::gridmap* gm_; 
+        // collect the obstacles of @param path in obstacles_
+        void
+        collect_obstacles(const std::vector<warthog::sn_id_t>& path);
 
-    private:
-        std::vector<std::vector<warthog::sipp::safe_interval>> intervals_;
-        //int32_t xy_id_offsets[6];
-        //warthog::cbs::move ec_moves[6];
+        // sort and add the obstacles in obstacles_
+        void
+        add_obstacles();
+
+        uint32_t
+        allocate(uint32_t capacity);
+
+        void
+        release(uint32_t offset, uint32_t capacity);
 };
 
 }
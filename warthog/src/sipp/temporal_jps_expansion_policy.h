@@ -252,7 +252,7 @@ class temporal_jps_expansion_policy
         uint32_t c_xy_id_;
         uint32_t c_index_;
         uint32_t c_gm_id_;
-        warthog::sipp::safe_interval* c_si_;
+        const warthog::sipp::safe_interval* c_si_;
 
         uint32_t jumplimit_[4]; 
 
@@ -285,9 +285,10 @@ class temporal_jps_expansion_policy
         {
             warthog::cost_t firstmove_cost = 1;
             // iterate over adjacent safe intervals
-            std::vector<warthog::sipp::safe_interval>& neis 
-                = jpst_gm_->get_all_intervals(succ_xy_id);
-            for(uint32_t i = 0; i < neis.size(); i++)
+            const warthog::sipp::safe_interval* neis 
+                = jpst_gm_->get_intervals(succ_xy_id);
+            uint32_t num_neis = jpst_gm_->get_num_intervals(succ_xy_id);
+            for(uint32_t i = 0; i < num_neis; i++)
             {
                 // we generate safe intervals for adjacent cells but:
                 // (i) only if the successor safe interval begins before 
@@ -296,7 +297,7 @@ class temporal_jps_expansion_policy
                 // the duration of the action that moves the agent
                 // (iii) only the successor is safe at the time the 
                 // agent finishes moving.
-                warthog::sipp::safe_interval* succ_si = &(neis.at(i));
+                const warthog::sipp::safe_interval* succ_si = &(neis[i]);
 
                 if( succ_si->s_time_ <= c_si_->e_time_ && 
                     c_node_->get_g() < succ_si->e_time_)
@@ -541,7 +542,7 @@ class temporal_jps_expansion_policy
             if(jpst_gm_->t_gm_->get_label(d1_gm_id))
             {
                 // can we move in direction d1 grid optimally?
-                warthog::sipp::safe_interval* d1_si = 
+                const warthog::sipp::safe_interval* d1_si = 
                     jpst_gm_->find_first_reachable(
                         d1_xy_id, can_step_d1_time);
                 can_step_d1 = d1_si && 
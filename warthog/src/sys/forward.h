@@ -14,6 +14,7 @@
 namespace warthog
 {
 
+class af_filter;
 class apriori_filter;
 class apex_filter;
 class bb_filter;
@@ -22,7 +23,9 @@ class dummy_filter;
 class dummy_listener;
 class expansion_policy;
 class euclidean_heuristic;
-class gridmap;
+template<typename ID_T>
+class gridmap_base;
+typedef gridmap_base<uint32_t> gridmap;
 class gridmap_expansion_policy;
 class problem_instance;
 class search_node;
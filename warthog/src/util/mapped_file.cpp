@@ -0,0 +1,53 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+warthog::util::mapped_file::mapped_file() : data_(0), size_(0)
+{ }
+
+warthog::util::mapped_file::~mapped_file()
+{
+    close();
+}
+
+bool
+warthog::util::mapped_file::open(const char* filename)
+{
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    if(fd == -1) { return false; }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* addr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED)
+    {
+        std::cerr << "err; could not map file " << filename << "\n";
+        return false;
+    }
+
+    data_ = (const char*)addr;
+    size_ = (size_t)st.st_size;
+    return true;
+}
+
+void
+warthog::util::mapped_file::close()
+{
+    if(data_)
+    {
+        munmap((void*)data_, size_);
+        data_ = 0;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef WARTHOG_MAPPED_FILE_H
+#define WARTHOG_MAPPED_FILE_H
+
+// util/mapped_file.h
+//
+// A read-only memory mapping of a file. Large precomputed tables
+// (e.g. distance tables, edge labels) can be mapped instead of read,
+// which avoids copying their contents onto the heap and lets several
+// processes share the same physical pages.
+//
+// The mapping is released when the object is destroyed.
+//
+
+#include <cstddef>
+#include <cstdint>
+
+namespace warthog
+{
+
+namespace util
+{
+
+class mapped_file
+{
+    public:
+        mapped_file();
+        ~mapped_file();
+
+        // map the file @param filename into memory.
+        // @return true if successful, false otherwise.
+        bool
+        open(const char* filename);
+
+        void
+        close();
+
+        inline bool
+        is_open() { return data_ != 0; }
+
+        inline const char*
+        data() { return data_; }
+
+        inline size_t
+        size() { return size_; }
+
+    private:
+        const char* data_;
+        size_t size_;
+
+        // no copying
+        mapped_file(const mapped_file&) = delete;
+        mapped_file&
+        operator=(const mapped_file&) = delete;
+};
+
+}
+
+}
+
+#endif
@@ -174,7 +174,9 @@ warthog::scenario_manager::load_gppc_scenario(std::ifstream& infile)
     // sanity check
     if(experiments_.size() == 0) { return; }
 
-    warthog::gridmap gm(experiments_.at(0)->map().c_str());
+    // 64-bit ids, so that the check also accepts maps too large for
+    // warthog::gridmap. bit files are mapped, not read, so this is cheap
+    warthog::gridmap_base<uint64_t> gm(experiments_.at(0)->map().c_str());
     for(uint32_t i = 0; i < experiments_.size(); i++)
     {
         if(experiments_.at(i)->map() != experiments_.at(0)->map())
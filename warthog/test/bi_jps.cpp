@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_RUNNER
+// the bundled catch.hpp does not build against newer glibc (SIGSTKSZ is
+// no longer a constant) unless its signal handlers are turned off
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+
+#include "catch.hpp"
+#include "bidirectional_search.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "jps2_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "problem_instance.h"
+#include "solution.h"
+#include "Statistic.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+Statistic g_statistic;
+
+int
+main(int argv, char* args[])
+{
+    Catch::Session session;
+    int res = session.run(argv, args);
+    return res;
+}
+
+// a small map with scattered obstacles. @param blocked decides which tiles
+// are obstacles
+template<typename F>
+void
+make_map(warthog::gridmap& map, F blocked)
+{
+    for(uint32_t y = 0; y < map.header_height(); y++)
+    {
+        for(uint32_t x = 0; x < map.header_width(); x++)
+        {
+            map.set_label(map.to_padded_id(x, y), !blocked(x, y));
+        }
+    }
+}
+
+double
+bi_jps_cost(warthog::gridmap& map, uint32_t start, uint32_t target)
+{
+	warthog::jps2_expansion_policy fexp(&map, false);
+	warthog::jps2_expansion_policy bexp(&map, true);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::bidirectional_search<
+        warthog::octile_heuristic,
+        warthog::jps2_expansion_policy> alg(&fexp, &bexp, &heuristic);
+
+    warthog::problem_instance pi(start, target);
+    warthog::solution sol;
+    alg.get_pathcost(pi, sol);
+    return sol.sum_of_edge_costs_;
+}
+
+double
+jps2_cost(warthog::gridmap& map, uint32_t start, uint32_t target)
+{
+	warthog::jps2_expansion_policy expander(&map);
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::jps2_expansion_policy,
+        warthog::pqueue_min> astar(&heuristic, &expander, &open);
+
+    warthog::problem_instance pi(start, target);
+    warthog::solution sol;
+    astar.get_pathcost(pi, sol);
+    return sol.sum_of_edge_costs_;
+}
+
+SCENARIO("Test bidirectional JPS against JPS", "[bi-jps]")
+{
+    const uint32_t width = 16;
+    const uint32_t height = 12;
+    warthog::gridmap map(height, width);
+    make_map(map, [](uint32_t x, uint32_t y)
+            { return ((x * 7 + y * 13) % 11) == 0 || (x == 8 && y > 2); });
+
+    vector<uint32_t> tiles;
+    for(uint32_t id = 0; id < width * height; id++)
+    {
+        if(map.get_label(map.to_padded_id(id))) { tiles.push_back(id); }
+    }
+
+    GIVEN("A query whose start is its target")
+    {
+        // cf. den202d.map.scen, query 6: (10, 13) to (10, 13)
+        uint32_t start = tiles.at(tiles.size() / 2);
+
+        THEN("The cost is zero")
+        {
+            REQUIRE(bi_jps_cost(map, start, start) == 0);
+            REQUIRE(jps2_cost(map, start, start) == 0);
+        }
+    }
+
+    GIVEN("Every pair of traversable tiles")
+    {
+        THEN("Bidirectional JPS finds the same costs as JPS")
+        {
+            uint32_t mismatches = 0;
+            for(uint32_t start : tiles)
+            {
+                for(uint32_t target : tiles)
+                {
+                    double expected = jps2_cost(map, start, target);
+                    double actual = bi_jps_cost(map, start, target);
+                    if(fabs(expected - actual) > 1e-6) { mismatches++; }
+                }
+            }
+            REQUIRE(mismatches == 0);
+        }
+    }
+}